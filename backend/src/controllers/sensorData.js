@@ -2,7 +2,8 @@
 import { 
   deleteSensorData,
   getAllSensorData,
-  deleteManySensorData
+  deleteManySensorData,
+  requestDeviceHistory
 } from "../services/sensorData.js";
 import { HttpException } from "../middleware/error.js";
 
@@ -59,5 +60,18 @@ export const sensorDataController = {
     } catch (e) {
       next(e);
     }
+  },
+
+  requestHistory: async (req, res, next) => {
+    try {
+      const { device_id: deviceId, start, end, resolution } = req.body;
+      if (!deviceId) {
+        throw new HttpException(400, 'device_id is required');
+      }
+      const result = await requestDeviceHistory(req.user.id, { deviceId, start, end, resolution });
+      res.json(result);
+    } catch (e) {
+      next(e);
+    }
   }
-};
\ No newline at end of file
+};
@@ -5,6 +5,9 @@ import {
   TOPIC_SENSOR,
   TOPIC_SENSSET,
   TOPIC_SENSACK,
+  TOPIC_SENSBATCH,
+  TOPIC_HISTORY,
+  TOPIC_CLOCK,
 } from './mqttPublisher.js';
 import eventBus from './lib/eventBus.js';
 import { prisma } from './application/database.js';
@@ -12,6 +15,17 @@ import { notifyOutOfRange, bot, pendingAck, pendingStore, SensorLabel } from './
 
 export const sensorBuffer = [];
 
+// Dedupe pesan ESP per device berdasarkan msgId (ESP mengirim ulang sampai dapat ACK_MSG).
+// Batasan: hanya 256 msgId terakhir per device, disimpan di memori proses, dan
+// hilang saat backend restart. Duplikat yang datang setelah restart (atau setelah
+// >256 pesan lain dari device yang sama) diproses ulang. State DB tetap benar:
+// SET_SENSOR/INIT_SENSOR/ACK_SET_SENSOR melakukan update-or-create pada baris yang
+// sama, dan backfill/HISTORY_PAGE melewati timestamp yang sudah ada di DB
+// (insertHistoryRows). Efek sampingnya hanya notifikasi Telegram yang terkirim
+// dua kali. Telemetry live (sensordata) tidak pernah dikirim ulang oleh ESP.
+const DEDUPE_WINDOW = 256;
+const seenMsgIds = new Map();
+
 // ------------- Utils -------------
 function safeParseJson(str) {
   try {
@@ -26,6 +40,43 @@ function isFiniteNumber(n) {
   return typeof n === 'number' && Number.isFinite(n);
 }
 
+/**
+ * Catat msgId dari device. Return false jika msgId sudah pernah diterima.
+ * Window dibatasi DEDUPE_WINDOW id terakhir per device (Set menjaga urutan insert).
+ */
+function rememberMsgId(deviceId, msgId) {
+  let seen = seenMsgIds.get(deviceId);
+  if (!seen) {
+    seen = new Set();
+    seenMsgIds.set(deviceId, seen);
+  }
+  if (seen.has(msgId)) return false;
+  seen.add(msgId);
+  if (seen.size > DEDUPE_WINDOW) seen.delete(seen.values().next().value);
+  return true;
+}
+
+/**
+ * Simpan baris riwayat dari device (backfill offline / HISTORY_PAGE) dengan
+ * timestamp aslinya. Halaman/batch bisa terkirim ulang dengan msgId baru,
+ * jadi timestamp yang sudah ada di DB dilewati.
+ */
+async function insertHistoryRows(userDevice, rows) {
+  if (!rows.length) return 0;
+  const existing = await prisma.sensorData.findMany({
+    where: { deviceId: userDevice.id, createdAt: { in: rows.map(r => r.createdAt) } },
+    select: { createdAt: true },
+  });
+  const seen = new Set(existing.map(e => e.createdAt.getTime()));
+  const fresh = rows
+    .filter(r => !seen.has(r.createdAt.getTime()))
+    .map(r => ({ ...r, userId: userDevice.userId, deviceId: userDevice.id }));
+  if (fresh.length) {
+    await prisma.sensorData.createMany({ data: fresh });
+  }
+  return fresh.length;
+}
+
 function sanitizeMarkdown(text) {
   // Minimal sanitizer untuk Markdown
   return String(text).replace(/([_*[\]()~`>#+\-=|{}.!])/g, '\\$1');
@@ -63,6 +114,21 @@ export default function initMqtt(io) {
     const msg = buf?.toString?.() ?? '';
     if (!msg) return;
 
+    // Delivery ACK + dedupe untuk pesan ESP yang membawa msgId
+    const envelope = safeParseJson(msg);
+    if (envelope?.msgId != null && envelope.deviceId) {
+      const fresh = rememberMsgId(envelope.deviceId, envelope.msgId);
+      if (envelope.from === 'ESP') {
+        mqttPublish('msgack', {
+          cmd: 'ACK_MSG',
+          from: 'BACKEND',
+          deviceId: envelope.deviceId,
+          msgId: envelope.msgId,
+        }, { retain: false });
+      }
+      if (!fresh) return;
+    }
+
     try {
       switch (topic) {
         case TOPIC_SENSOR:
@@ -74,6 +140,15 @@ export default function initMqtt(io) {
         case TOPIC_SENSACK:
           await handleAckSetSensor(buf, packet);
           break;
+        case TOPIC_SENSBATCH:
+          await handleSensorBatch(msg);
+          break;
+        case TOPIC_HISTORY:
+          await handleHistoryPage(msg);
+          break;
+        case TOPIC_CLOCK:
+          await handleClockStatus(msg);
+          break;
         default:
           break;
       }
@@ -132,6 +207,92 @@ export default function initMqtt(io) {
     }
   }
 
+  // Backfill snapshot yang direkam ESP selama offline.
+  // rows: [[ts (unix detik, UTC), tds, ph, turbidity, temperature], ...]
+  async function handleSensorBatch(msg) {
+    const data = safeParseJson(msg);
+    if (!data?.deviceId || !Array.isArray(data.rows)) return;
+
+    const userDevice = await prisma.usersDevice.findUnique({
+      where: { id: data.deviceId },
+    });
+    if (!userDevice) {
+      console.warn(`⚠️ Skipped batch: device ${data.deviceId} belum terdaftar`);
+      return;
+    }
+
+    const rows = data.rows
+      .filter(r => Array.isArray(r) && r.length >= 5 && r.every(isFiniteNumber) && r[0] > 0)
+      .map(([ts, tds, ph, turbidity, temperature]) => ({
+        createdAt: new Date(ts * 1000),
+        temperature,
+        tds,
+        ph,
+        turbidity,
+      }));
+    const inserted = await insertHistoryRows(userDevice, rows);
+    console.log(`📥 Backfill ${userDevice.deviceName || userDevice.id}: ${inserted}/${data.rows.length} rows`);
+  }
+
+  // Status jam device setelah tiap sinkron SNTP (offset RTC, drift, aging DS3231)
+  async function handleClockStatus(msg) {
+    const data = safeParseJson(msg);
+    if (data?.cmd !== 'CLOCK_STATUS' || data.from !== 'ESP' || !data.deviceId) return;
+    if (!isFiniteNumber(data.offsetMs) || !isFiniteNumber(data.driftPpm)) return;
+
+    const userDevice = await prisma.usersDevice.findUnique({
+      where: { id: data.deviceId },
+    });
+    if (!userDevice) return;
+
+    console.log(`🕒 Clock ${userDevice.deviceName || userDevice.id}: offset ${data.offsetMs}ms, drift ${data.driftPpm.toFixed(2)}ppm, aging ${data.aging}`);
+    eventBus.emitTo(`${userDevice.userId}-clock_status`, {
+      deviceId: userDevice.id,
+      offsetMs: data.offsetMs,
+      driftPpm: data.driftPpm,
+      aging: data.aging,
+      steps: data.steps,
+      sqw: !!data.sqw,
+      syncedAt: data.syncedAt,
+    });
+  }
+
+  // Balasan QUERY_HISTORY, dipakai untuk mengisi celah data di DB.
+  // raw (resolution 0): [ts, tds, ph, turbidity, temperature]
+  // agregat (60/900 s): [ts, count, tdsAvg, tdsMin, tdsMax, phAvg, ..., temperatureMax]
+  async function handleHistoryPage(msg) {
+    const data = safeParseJson(msg);
+    if (data?.cmd !== 'HISTORY_PAGE' || data.from !== 'ESP') return;
+    if (!data.deviceId || !Array.isArray(data.rows)) return;
+
+    const userDevice = await prisma.usersDevice.findUnique({
+      where: { id: data.deviceId },
+    });
+    if (!userDevice) return;
+
+    const raw = data.resolution === 0;
+    // Index avg tiap kanal (tds, ph, turbidity, temperature) di dalam baris
+    const idx = raw ? [1, 2, 3, 4] : [2, 5, 8, 11];
+    const rows = data.rows
+      .filter(r => Array.isArray(r) && isFiniteNumber(r[0]) && r[0] > 0 && idx.every(i => isFiniteNumber(r[i])))
+      .map(r => ({
+        createdAt: new Date(r[0] * 1000),
+        tds: r[idx[0]],
+        ph: r[idx[1]],
+        turbidity: r[idx[2]],
+        temperature: r[idx[3]],
+      }));
+    const inserted = await insertHistoryRows(userDevice, rows);
+
+    eventBus.emitTo(`${userDevice.userId}-history_fill`, {
+      deviceId: userDevice.id,
+      queryId: data.queryId,
+      page: data.page,
+      inserted,
+      done: !!data.done,
+    });
+  }
+
   async function handleSetSensor(msg) {
     const req = safeParseJson(msg);
     if (!req) return;
@@ -20,6 +20,10 @@ export const TOPIC_SENSSET = "AkhyarAzamta/sensorset/IoTWebApp";
 export const TOPIC_SENSACK = "AkhyarAzamta/sensorack/IoTWebApp";
 export const TOPIC_ALARMSET = "AkhyarAzamta/alarmset/IoTWebApp";
 export const TOPIC_ALARMACK = "AkhyarAzamta/alarmack/IoTWebApp";
+export const TOPIC_MSGACK = "AkhyarAzamta/msgack/IoTWebApp";
+export const TOPIC_SENSBATCH = "AkhyarAzamta/sensorbatch/IoTWebApp";
+export const TOPIC_HISTORY = "AkhyarAzamta/history/IoTWebApp";
+export const TOPIC_CLOCK = "AkhyarAzamta/clockstatus/IoTWebApp";
 
 // Single shared MQTT client
 const client = mqtt.connect(BROKER_URL);
@@ -39,7 +43,10 @@ client.on("connect", async () => {
     TOPIC_SENSSET,
     TOPIC_SENSACK,
     TOPIC_ALARMSET,
-    TOPIC_ALARMACK
+    TOPIC_ALARMACK,
+    TOPIC_SENSBATCH,
+    TOPIC_HISTORY,
+    TOPIC_CLOCK
   ];
   
   await client.subscribe(topics, (err) => {
@@ -70,7 +77,7 @@ client.on('offline', () => {
 /**
 * Publish a JSON payload to AkhyarAzamta/{topicType}/IoTWebApp.
 *
-* @param {'sensordata'|'relay'|'sensorset'|'sensorack'|'alarmset'|'alarmack'} topicType
+* @param {'sensordata'|'relay'|'sensorset'|'sensorack'|'alarmset'|'alarmack'|'msgack'|'sensorbatch'|'history'|'clockstatus'} topicType
 * @param {object} payload Plain object; will be JSON.stringified
 * @param {object} [opts] Optional publish options (e.g. { retain: true })
 */
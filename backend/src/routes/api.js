@@ -33,6 +33,7 @@ router.get('/sensor/:deviceId', sensorSettingController.get);
 router.patch('/sensor/:type', sensorSettingController.update);
 
 router.get('/sensordata', sensorDataController.get);
+router.post('/sensordata/history', sensorDataController.requestHistory);
 router.delete('/sensordata/:id', sensorDataController.delete);
 router.delete('/sensordata', sensorDataController.deleteMany);
 
@@ -1,6 +1,9 @@
 // ===== SERVICE (sensorData.js) =====
 import { prisma } from '../application/database.js';
 import { HttpException } from '../middleware/error.js';
+import { publish as mqttPublish } from '../mqttPublisher.js';
+
+const HISTORY_RESOLUTIONS = [0, 60, 900]; // raw (±1 jam), 1 menit (24 jam), 15 menit (30 hari)
 
 export const getAllSensorData = async (userId, options = {}) => {
   const { 
@@ -167,4 +170,38 @@ export const deleteManySensorData = async (userId, ids) => {
   });
 
   return { message: `${ids.length} sensor data deleted successfully` };
-};
\ No newline at end of file
+};
+
+// Minta riwayat dari device (QUERY_HISTORY). Device mengirim balik halaman
+// HISTORY_PAGE yang disimpan mqttClient untuk mengisi celah data.
+export const requestDeviceHistory = async (userId, { deviceId, start, end, resolution = 60 }) => {
+  const device = await prisma.usersDevice.findFirst({
+    where: { id: deviceId, userId }
+  });
+  if (!device) {
+    throw new HttpException(404, 'Device not found or not accessible');
+  }
+
+  const startMs = new Date(start).getTime();
+  const endMs = new Date(end).getTime();
+  if (isNaN(startMs) || isNaN(endMs) || startMs >= endMs) {
+    throw new HttpException(400, 'Invalid start/end range');
+  }
+  resolution = Number(resolution);
+  if (!HISTORY_RESOLUTIONS.includes(resolution)) {
+    throw new HttpException(400, `Invalid resolution. Use: ${HISTORY_RESOLUTIONS.join(', ')}`);
+  }
+
+  const queryId = Date.now() >>> 0;
+  mqttPublish('history', {
+    cmd: 'QUERY_HISTORY',
+    from: 'BACKEND',
+    deviceId: device.id,
+    queryId,
+    start: Math.floor(startMs / 1000),
+    end: Math.ceil(endMs / 1000),
+    resolution
+  }, { retain: false });
+
+  return { queryId, message: 'History request sent to device' };
+};
@@ -0,0 +1,139 @@
+#include "Actuator.h"
+
+struct ActuatorRun
+{
+  uint32_t durationMs;
+  uint32_t requestedMs; // millis() saat run diminta (untuk statistik telat)
+  uint16_t sourceId;
+};
+
+struct Channel
+{
+  bool on;
+  uint32_t startMs;
+  ActuatorRun current;
+  ActuatorRun queue[ACTUATOR_QUEUE_LEN];
+  uint8_t head;
+  uint8_t count;
+};
+
+static Channel channels[ACTUATOR_CHANNELS];
+static ActuatorStats counters = {};
+
+static void start(uint8_t ch, const ActuatorRun &r)
+{
+  Channel &c = channels[ch];
+  c.current = r;
+  c.startMs = millis();
+  c.on = true;
+  uint32_t late = c.startMs - r.requestedMs;
+  if (late > counters.maxLateMs)
+    counters.maxLateMs = late;
+  digitalWrite(ACTUATOR_PINS[ch], LED_ON);
+  Serial.printf("[ACT] ch%u on id=%u for %lums\n", ch, r.sourceId, (unsigned long)r.durationMs);
+}
+
+static void stop(uint8_t ch)
+{
+  channels[ch].on = false;
+  digitalWrite(ACTUATOR_PINS[ch], LED_OFF);
+}
+
+void Actuator::begin()
+{
+  for (uint8_t ch = 0; ch < ACTUATOR_CHANNELS; ch++)
+  {
+    pinMode(ACTUATOR_PINS[ch], OUTPUT);
+    stop(ch);
+    channels[ch].head = channels[ch].count = 0;
+  }
+}
+
+bool Actuator::run(uint8_t ch, uint32_t durationMs, uint16_t sourceId)
+{
+  if (ch >= ACTUATOR_CHANNELS)
+  {
+    counters.dropped++;
+    Serial.printf("[ACT] id=%u: no channel %u\n", sourceId, ch);
+    return false;
+  }
+  ActuatorRun r{durationMs, uint32_t(millis()), sourceId};
+  Channel &c = channels[ch];
+  if (!c.on)
+  {
+    start(ch, r);
+    return true;
+  }
+  if (c.count >= ACTUATOR_QUEUE_LEN)
+  {
+    counters.dropped++;
+    Serial.printf("[ACT] ch%u queue full, id=%u dropped\n", ch, sourceId);
+    return false;
+  }
+  c.queue[(c.head + c.count) % ACTUATOR_QUEUE_LEN] = r;
+  c.count++;
+  counters.queued++;
+  return true;
+}
+
+void Actuator::loop()
+{
+  uint32_t now = millis();
+  for (uint8_t ch = 0; ch < ACTUATOR_CHANNELS; ch++)
+  {
+    Channel &c = channels[ch];
+    // Selisih unsigned: benar walau millis() wrap di antara start dan now
+    if (!c.on || now - c.startMs < c.current.durationMs)
+      continue;
+    stop(ch);
+    counters.runs++;
+    if (c.count)
+    {
+      ActuatorRun next = c.queue[c.head];
+      c.head = (c.head + 1) % ACTUATOR_QUEUE_LEN;
+      c.count--;
+      start(ch, next);
+    }
+  }
+}
+
+void Actuator::cancel(uint8_t ch)
+{
+  if (ch >= ACTUATOR_CHANNELS)
+    return;
+  channels[ch].count = 0;
+  if (channels[ch].on)
+    stop(ch);
+}
+
+bool Actuator::active(uint8_t ch)
+{
+  return ch < ACTUATOR_CHANNELS && channels[ch].on;
+}
+
+uint8_t Actuator::pending(uint8_t ch)
+{
+  return ch < ACTUATOR_CHANNELS ? channels[ch].count : 0;
+}
+
+uint32_t Actuator::idleMs()
+{
+  uint32_t now = millis();
+  uint32_t wait = UINT32_MAX;
+  for (uint8_t ch = 0; ch < ACTUATOR_CHANNELS; ch++)
+  {
+    const Channel &c = channels[ch];
+    if (!c.on)
+      continue;
+    uint32_t ran = now - c.startMs;
+    uint32_t left = ran >= c.current.durationMs ? 0 : c.current.durationMs - ran;
+    if (left < wait)
+      wait = left;
+  }
+  return wait;
+}
+
+const ActuatorStats &Actuator::stats()
+{
+  return counters;
+}
@@ -0,0 +1,42 @@
+// Actuator.h
+#ifndef ACTUATOR_H
+#define ACTUATOR_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// Output pakan/relay per kanal (indeks = AlarmData::channel). Tambah pin
+// relay feeder berikutnya di sini.
+static const uint8_t ACTUATOR_PINS[] = {LED_PIN};
+#define ACTUATOR_CHANNELS (sizeof(ACTUATOR_PINS) / sizeof(ACTUATOR_PINS[0]))
+#define ACTUATOR_QUEUE_LEN 8 // run yang menunggu per kanal
+
+struct ActuatorStats
+{
+  uint32_t runs;     // run yang selesai
+  uint32_t queued;   // run yang harus menunggu run lain di kanal yang sama
+  uint32_t dropped;  // antrian penuh / kanal tidak ada
+  uint32_t maxLateMs; // keterlambatan terbesar start run terhadap permintaan
+};
+
+// Timeline aktuator: setiap kanal menjalankan satu run pada satu waktu;
+// run yang tumpang tindih diantrikan (FIFO) sehingga durasi tiap alarm
+// tetap utuh, bukan saling menimpa. Waktu memakai selisih millis() (aman
+// saat millis() wrap setelah ±49 hari).
+class Actuator
+{
+public:
+  static void begin();
+  // false jika kanal tidak ada atau antrian penuh
+  static bool run(uint8_t channel, uint32_t durationMs, uint16_t sourceId);
+  // Panggil dari loop(): selesaikan run yang habis lalu mulai berikutnya
+  static void loop();
+  static void cancel(uint8_t channel); // hentikan run aktif & buang antrian
+  static bool active(uint8_t channel);
+  static uint8_t pending(uint8_t channel);
+  // ms sampai run aktif terdekat selesai; UINT32_MAX jika semua kanal mati
+  static uint32_t idleMs();
+  static const ActuatorStats &stats();
+};
+
+#endif // ACTUATOR_H
@@ -1,21 +1,42 @@
 #include "Alarm.h"
-#include <LittleFS.h>
-#include <RTClib.h>
+#include "Storage.h"
+#include "Clock.h"
 #include <Arduino.h>
 #include "Config.h"
+#include "Schema.h"
+#include "Persistence.h"
+#include "AlarmTable.h"
+#include "Actuator.h"
 
-static const char *ALARM_FILE = "/alarms.bin";
-extern RTC_DS3231 rtc;
+// maxLen menampung record schema lama (log tanpa header) selama migrasi
+static RecordLog alarmLog(STORAGE_ALARMS_LOG, MAX_ALARMS, LEGACY_ALARM_SIZE, SCHEMA_ALARM, ALARM_RECORD_SIZE);
 
 // ======= DATA GLOBAL (file‐scope) =======
-static AlarmData alarms[MAX_ALARMS]; // array penyimpanan alarm
-static uint8_t alarmCount = 0;       // jumlah alarm saat ini
+static AlarmTable table;             // penyimpanan alarm + indeks id & waktu
 static uint8_t tempCounter = 0;      // untuk generate ID sementara offline
 static uint16_t nextAlarmId = 1;     // ID berikutnya (dari backend)
-static bool feeding = false;         // state output (contoh: buzzer/relay)
-static unsigned long feedingEnd = 0; // waktu kapan mematikan output
 static bool isEditing = false;       // true jika user sedang di‐edit via tombol/display
 
+// ======= SCHEDULER =======
+// Waktu dalam detik "unixtime lokal" Clock (DS3231 menyimpan WIB), jadi
+// kelipatan 86400 = tengah malam lokal.
+// Alarm 1 DS3231 sengaja tidak dipakai: pin SQW/INT (RTC_INT_PIN) hanya bisa
+// mengeluarkan salah satu, interrupt alarm (INTCN=1) atau detak 1 Hz
+// (INTCN=0), dan detak itu yang menggerakkan Clock. Jadwal "alarm terdekat"
+// tetap dipertahankan, tapi dibandingkan dengan Clock::now() tiap loop
+// (O(1), tanpa I2C); detak SQW sekaligus membangunkan light sleep.
+static bool armed = false;            // ada alarm terdekat di nextAt
+static uint32_t nextAt = 0;           // waktu kejadian alarm terdekat
+static bool scheduleValid = false;    // false → cari ulang alarm terdekat
+static uint32_t lastScan = 0;         // detik terakhir yang sudah diperiksa; 0 = belum sejak boot
+static uint32_t revisionCount = 0;    // naik tiap isi tabel berubah (UI)
+
+static void tableChanged()
+{
+  scheduleValid = false;
+  revisionCount++;
+}
+
 // ======= DEFINISI MEMBER STATIC =======
 String Alarm::lastMessage; // <<<< Definisi sebenarnya (harus ada satu kali di .cpp)
 
@@ -26,73 +47,116 @@ const String &Alarm::getLastMessage()
 
 void Alarm::loadAll()
 {
-  if (!LittleFS.exists(ALARM_FILE))
-  {
-    alarmCount = 0;
-    nextAlarmId = 1;
+  table.clear();
+  tableChanged();
+  nextAlarmId = 1;
+  if (!alarmLog.begin())
     return;
+
+  // Record yang gagal divalidasi (atau ID ganda) dibuang satu per satu,
+  // sisanya tetap dipakai
+  uint16_t dropped = 0;
+  AlarmData a;
+  bool migrate = alarmLog.schema() != SCHEMA_ALARM;
+  if (alarmLog.count() == 0 && Storage::fs().exists(STORAGE_LEGACY_ALARMS))
+  {
+    // Migrasi sekali dari format lama (byte jumlah + dump struct AlarmData)
+    File f = Storage::fs().open(STORAGE_LEGACY_ALARMS, "r");
+    if (!f)
+      return;
+    uint8_t cnt = f.read();
+    uint8_t rec[LEGACY_ALARM_SIZE];
+    for (uint8_t i = 0; i < cnt && table.size() < MAX_ALARMS; i++)
+    {
+      if (f.read(rec, sizeof(rec)) != sizeof(rec))
+        break;
+      if (!decodeAlarm(SCHEMA_LEGACY, rec, sizeof(rec), a) || !table.insert(a))
+        dropped++;
+    }
+    f.close();
+    migrate = true;
   }
-  File f = LittleFS.open(ALARM_FILE, "r");
-  if (!f)
-    return;
-  uint8_t cnt = f.read();
-  if (cnt > MAX_ALARMS)
-    cnt = 0;
-  alarmCount = cnt;
-  for (uint8_t i = 0; i < alarmCount; i++)
+  else
   {
-    f.read((uint8_t *)&alarms[i], sizeof(AlarmData));
+    for (uint16_t i = 0; i < alarmLog.count() && table.size() < MAX_ALARMS; i++)
+    {
+      uint16_t key;
+      const uint8_t *rec;
+      uint8_t len;
+      alarmLog.at(i, key, rec, len);
+      if (!decodeAlarm(alarmLog.schema(), rec, len, a) || !table.insert(a))
+        dropped++;
+    }
+  }
+
+  if (migrate || dropped)
+  {
+    // Tulis ulang seluruh log dengan schema sekarang
+    uint8_t rec[ALARM_RECORD_SIZE];
+    alarmLog.clear();
+    AlarmData *alarms = table.data();
+    for (uint16_t i = 0; i < table.size(); i++)
+      alarmLog.stage(alarms[i].id, rec, encodeAlarm(alarms[i], rec));
+    if (alarmLog.compact())
+      Storage::fs().remove(STORAGE_LEGACY_ALARMS);
+    Serial.printf("[ALARM] Migrated %u alarms to schema %u (%u invalid dropped)\n",
+                  table.size(), SCHEMA_ALARM, dropped);
   }
-  f.close();
 
   // Hitung nextAlarmId = max(existing IDs + 1)
   nextAlarmId = 1;
-  for (uint8_t i = 0; i < alarmCount; i++)
+  for (uint16_t i = 0; i < table.size(); i++)
   {
-    uint16_t candidate = uint16_t(alarms[i].id) + 1;
+    uint16_t candidate = uint16_t(table.data()[i].id) + 1;
     nextAlarmId = (nextAlarmId > candidate) ? nextAlarmId : candidate;
   }
 }
 
+static bool alarmExists(uint16_t key)
+{
+  return table.find(key) >= 0;
+}
+
+// Sinkronkan array ke log: hanya alarm yang berubah (atau terhapus) yang
+// ditulis, masing-masing satu record kecil.
 void Alarm::saveAll()
 {
-  File f = LittleFS.open(ALARM_FILE, "w");
-  if (!f)
-    return;
-  f.write(alarmCount);
-  for (uint8_t i = 0; i < alarmCount; i++)
-  {
-    f.write((uint8_t *)&alarms[i], sizeof(AlarmData));
-  }
-  f.close();
+  uint8_t rec[ALARM_RECORD_SIZE];
+  AlarmData *alarms = table.data();
+  for (uint16_t i = 0; i < table.size(); i++)
+    alarmLog.put(alarms[i].id, rec, encodeAlarm(alarms[i], rec));
+  alarmLog.retainIf(alarmExists);
+}
+
+const RecordLogStats &Alarm::storageStats()
+{
+  return alarmLog.stats();
 }
 
 bool Alarm::exists(uint16_t id)
 {
-  for (uint8_t i = 0; i < alarmCount; i++)
-  {
-    if (alarms[i].id == id)
-      return true;
-  }
-  return false;
+  return table.find(id) >= 0;
 }
 
-bool Alarm::add(uint16_t id, uint8_t h, uint8_t m, int durSec, bool en)
+AlarmData *Alarm::find(uint16_t id)
 {
-  if (alarmCount >= MAX_ALARMS)
+  int32_t i = table.find(id);
+  return i < 0 ? nullptr : &table.data()[i];
+}
+
+bool Alarm::add(uint16_t id, uint8_t h, uint8_t m, int durSec, bool en, uint8_t days, uint8_t channel)
+{
+  if (table.size() >= MAX_ALARMS)
   {
     lastMessage = String("capacity full (id=") + id + ")";
     return false;
   }
-  for (uint8_t i = 0; i < alarmCount; i++)
+  if (exists(id))
   {
-    if (alarms[i].id == id)
-    {
-      lastMessage = String("id=") + id + " already exists";
-      return false;
-    }
+    lastMessage = String("id=") + id + " already exists";
+    return false;
   }
-  alarms[alarmCount] = AlarmData{
+  table.insert(AlarmData{
       id,     // ID final dari backend
       h,      // jam
       m,      // menit
@@ -102,9 +166,11 @@ bool Alarm::add(uint16_t id, uint8_t h, uint8_t m, int durSec, bool en)
       -1,     // lastMinTrig
       false,  // pending (karena ini datang dari backend)
       false,  // isTemporary
-      -1      // tempIndex
-  };
-  alarmCount++;
+      -1,     // tempIndex
+      days,   // hari aktif
+      channel // kanal aktuator
+  });
+  tableChanged();
 
   // Update nextAlarmId = max(nextAlarmId, id+1)
   {
@@ -115,85 +181,102 @@ bool Alarm::add(uint16_t id, uint8_t h, uint8_t m, int durSec, bool en)
   lastMessage = String("id=") + id +
                 " time=" + (h < 10 ? "0" : "") + h + ":" + (m < 10 ? "0" : "") + m +
                 " dur=" + durSec + "s en=" + (en ? "1" : "0");
-  saveAll();
+  Persistence::markDirty(PERSIST_ALARMS);
   return true;
 }
 
-bool Alarm::edit(uint16_t id, uint8_t h, uint8_t m, int durSec, bool en)
+bool Alarm::edit(uint16_t id, uint8_t h, uint8_t m, int durSec, bool en, uint8_t days, uint8_t channel)
 {
-  for (uint8_t i = 0; i < alarmCount; i++)
+  AlarmData *a = find(id);
+  if (!a)
   {
-    if (alarms[i].id == id)
-    {
-      alarms[i].hour = h;
-      alarms[i].minute = m;
-      alarms[i].duration = durSec;
-      alarms[i].enabled = en;
-      alarms[i].pending = false;
-      alarms[i].isTemporary = false;
-      lastMessage = String("id=") + id +
-                    " time=" + (h < 10 ? "0" : "") + h + ":" + (m < 10 ? "0" : "") + m +
-                    " dur=" + durSec + "s en=" + (en ? "1" : "0");
-      saveAll();
-      return true;
-    }
+    lastMessage = String("id=") + id + " not found";
+    return false;
   }
-  lastMessage = String("id=") + id + " not found";
-  return false;
+  a->hour = h;
+  a->minute = m;
+  a->duration = durSec;
+  a->enabled = en;
+  a->days = days;
+  a->channel = channel;
+  a->pending = false;
+  a->isTemporary = false;
+  touch();
+  lastMessage = String("id=") + id +
+                " time=" + (h < 10 ? "0" : "") + h + ":" + (m < 10 ? "0" : "") + m +
+                " dur=" + durSec + "s en=" + (en ? "1" : "0");
+  Persistence::markDirty(PERSIST_ALARMS);
+  return true;
 }
 
 bool Alarm::enable(uint16_t id, bool en)
 {
-  for (uint8_t i = 0; i < alarmCount; i++)
+  AlarmData *a = find(id);
+  if (!a)
   {
-    if (alarms[i].id == id)
-    {
-      alarms[i].enabled = en;
-      alarms[i].pending = false;
-      lastMessage = String("id=") + id + " enabled=" + (en ? "1" : "0");
-      saveAll();
-      return true;
-    }
+    lastMessage = String("id=") + id + " not found";
+    return false;
   }
-  lastMessage = String("id=") + id + " not found";
-  return false;
+  a->enabled = en;
+  a->pending = false;
+  tableChanged();
+  lastMessage = String("id=") + id + " enabled=" + (en ? "1" : "0");
+  Persistence::markDirty(PERSIST_ALARMS);
+  return true;
 }
 
 bool Alarm::remove(uint16_t id)
 {
-  for (uint8_t i = 0; i < alarmCount; i++)
+  if (!table.remove(id))
   {
-    if (alarms[i].id == id)
-    {
-      // Shift semua elemen ke kiri
-      for (uint8_t j = i; j < alarmCount - 1; j++)
-      {
-        alarms[j] = alarms[j + 1];
-      }
-      alarmCount--;
-      lastMessage = String("id=") + id + " deleted";
-      saveAll();
-      return true;
-    }
+    lastMessage = String("id=") + id + " not found";
+    return false;
   }
-  lastMessage = String("id=") + id + " not found";
-  return false;
+  tableChanged();
+  lastMessage = String("id=") + id + " deleted";
+  Persistence::markDirty(PERSIST_ALARMS);
+  return true;
+}
+
+bool Alarm::confirmId(uint16_t tempId, uint16_t id)
+{
+  if (!table.rekey(tempId, id))
+    return false;
+  AlarmData *a = find(id);
+  a->isTemporary = false;
+  a->pending = false;
+  uint16_t candidate = uint16_t(id) + 1;
+  nextAlarmId = (nextAlarmId > candidate) ? nextAlarmId : candidate;
+  Persistence::markDirty(PERSIST_ALARMS);
+  return true;
+}
+
+void Alarm::touch()
+{
+  table.invalidateTime();
+  tableChanged();
+}
+
+uint32_t Alarm::revision()
+{
+  return revisionCount;
 }
 
 void Alarm::list()
 {
   Serial.println("[ALARM] LIST:");
-  if (alarmCount == 0)
+  if (table.size() == 0)
   {
     Serial.println("  (kosong)");
     return;
   }
-  for (uint8_t i = 0; i < alarmCount; i++)
+  const uint16_t *order = table.byTime();
+  for (uint16_t k = 0; k < table.size(); k++)
   {
-    auto &a = alarms[i];
+    auto &a = table.data()[order[k]];
     Serial.printf(
-        "id=%u  %02u:%02u  dur=%ds  en=%d  pend=%d  temp=%d  idx=%d\n",
-        a.id, a.hour, a.minute, a.duration,
+        "id=%u  %02u:%02u  days=%02x  dur=%ds  en=%d  pend=%d  temp=%d  idx=%d\n",
+        a.id, a.hour, a.minute, a.days, a.duration,
         a.enabled ? 1 : 0,
         a.pending ? 1 : 0,
         a.isTemporary ? 1 : 0,
@@ -201,73 +284,168 @@ void Alarm::list()
   }
 }
 
-void Alarm::checkAll()
+static bool activeOn(const AlarmData &a, uint32_t dayStart)
 {
-  if (isEditing)
-    return;
-  DateTime now = rtc.now();
-  int curH = now.hour();
-  int curM = now.minute();
-  int curS = now.second();
-  int curD = now.day();
-
-  // Cek trigger
-  for (uint8_t i = 0; i < alarmCount; i++)
+  return a.enabled && (a.days & (1 << DateTime(dayStart).dayOfTheWeek()));
+}
+
+// Kejadian alarm aktif terdekat yang > now: lanjutkan dari posisi menit
+// sekarang di indeks waktu, lalu hari-hari berikutnya (maks 7 hari)
+static bool findNext(uint32_t now, uint32_t &at)
+{
+  const uint16_t n = table.size();
+  const AlarmData *alarms = table.data();
+  const uint16_t *order = table.byTime();
+  uint32_t day = now - now % 86400UL;
+  uint16_t start = table.lowerBound((now - day) / 60 + 1);
+  for (uint8_t d = 0; d <= 7; d++, day += 86400UL)
   {
-    auto &a = alarms[i];
-    if (!a.enabled)
-      continue;
-    if (a.lastDayTrig == curD && a.lastMinTrig == curM)
-      continue;
-    if (a.hour == curH && a.minute == curM && curS < 5)
+    for (uint16_t k = d ? 0 : start; k < n; k++)
     {
-      a.lastDayTrig = curD;
-      a.lastMinTrig = curM;
-      feeding = true;
-      feedingEnd = millis() + (uint32_t)a.duration * 1000UL;
-      digitalWrite(LED_PIN, LED_ON);
-      saveAll();
+      const AlarmData &a = alarms[order[k]];
+      if (activeOn(a, day))
+      {
+        at = day + AlarmTable::minuteOfDay(a) * 60UL;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+static void rebuildSchedule(uint32_t now)
+{
+  armed = findNext(now, nextAt);
+  scheduleValid = true;
+}
+
+// Jalankan alarm dengan waktu di [from, to] (dalam satu hari) lewat indeks
+// waktu: O(log n + jumlah alarm di jendela)
+static bool fireWindow(uint32_t from, uint32_t to, uint32_t now)
+{
+  uint32_t day = to - to % 86400UL;
+  uint16_t lo = (from - day + 59) / 60;
+  uint16_t hi = (to - day) / 60;
+  AlarmData *alarms = table.data();
+  const uint16_t *order = table.byTime();
+  bool fired = false;
+  for (uint16_t k = table.lowerBound(lo); k < table.size(); k++)
+  {
+    AlarmData &a = alarms[order[k]];
+    uint16_t minute = AlarmTable::minuteOfDay(a);
+    if (minute > hi)
       break;
+    DateTime at(day + minute * 60UL);
+    if (!activeOn(a, day) || (a.lastDayTrig == at.day() && a.lastMinTrig == a.minute))
+      continue;
+    uint32_t late = now - at.unixtime();
+    a.lastDayTrig = at.day();
+    a.lastMinTrig = a.minute;
+    fired = true;
+    if (late > ALARM_FIRE_GRACE_SEC && ALARM_MISSED_POLICY == ALARM_MISSED_SKIP)
+    {
+      Serial.printf("[ALARM] id=%u missed %02u:%02u (+%lus), skipped\n", a.id, a.hour, a.minute,
+                    (unsigned long)late);
+      continue;
     }
+    Actuator::run(a.channel, uint32_t(a.duration) * 1000UL, a.id);
+    Serial.printf("[ALARM] id=%u fired %02u:%02u ch%u dur=%ds (+%lus)\n", a.id, a.hour, a.minute,
+                  a.channel, a.duration, (unsigned long)late);
   }
-  // Matikan feeding jika durasi habis
-  if (feeding && millis() >= feedingEnd)
+  return fired;
+}
+
+// Semua kejadian sejak cek terakhir (maks ALARM_CATCHUP_WINDOW_SEC) dijalankan,
+// tidak berhenti di yang pertama. Dihitung dari isi tabel saat ini, bukan
+// jadwal lama; lastDayTrig/lastMinTrig (ikut disimpan) mencegah trigger
+// ganda, juga setelah reboot.
+static void fireDue(uint32_t now)
+{
+  uint32_t from = lastScan ? lastScan + 1 : now - ALARM_CATCHUP_WINDOW_SEC;
+  if (now - from > ALARM_CATCHUP_WINDOW_SEC)
+    from = now - ALARM_CATCHUP_WINDOW_SEC;
+  if (from > now)
+    return; // jam RTC mundur: tidak ada yang terlewat
+  uint32_t today = now - now % 86400UL;
+  bool fired = false;
+  if (from < today)
   {
-    feeding = false;
-    digitalWrite(LED_PIN, LED_OFF);
+    fired = fireWindow(from, today - 1, now);
+    from = today;
   }
+  fired |= fireWindow(from, now, now);
+  if (fired)
+    Persistence::markDirty(PERSIST_ALARMS);
 }
 
-AlarmData *Alarm::getAll(uint8_t &outCount)
+void Alarm::reschedule()
 {
-  outCount = alarmCount;
-  return alarms;
+  scheduleValid = false;
+}
+
+void Alarm::checkAll()
+{
+  // Alarm yang jatuh tempo saat edit dijalankan setelah edit selesai
+  if (isEditing)
+    return;
+
+  uint32_t now = Clock::now();
+  bool due = armed && now >= nextAt;
+  if (!due && scheduleValid)
+    return;
+
+  // Cek pertama setelah boot juga mengejar alarm selama perangkat mati.
+  // Perubahan jadwal tanpa jatuh tempo tidak memicu alarm: lastScan dimajukan
+  // agar alarm yang baru dibuat untuk jam yang sudah lewat tidak berbunyi.
+  if (due || !lastScan)
+    fireDue(now);
+  lastScan = now;
+  rebuildSchedule(now);
+}
+
+AlarmData *Alarm::getAll(uint16_t &outCount)
+{
+  outCount = table.size();
+  return table.data();
 }
 
 void Alarm::setEditing(bool editing)
 {
+  // Selesai edit lewat display: jam/menit mungkin diubah langsung di array
+  if (isEditing && !editing)
+    touch();
   isEditing = editing;
 }
 
-void Alarm::addAlarmOffline(uint8_t h, uint8_t m, int durSec, bool en)
+void Alarm::addAlarmOffline(uint8_t h, uint8_t m, int durSec, bool en, uint8_t days)
 {
-  if (alarmCount >= MAX_ALARMS)
+  if (table.size() >= MAX_ALARMS)
   {
     lastMessage = "capacity full (offline)";
     return;
   }
-  AlarmData a;
-  a.id = uint16_t(0xFF00 | tempCounter); // ID sementara: 0xFF00, 0xFF01, …
+  // ID sementara: 0xFF00, 0xFF01, … (lewati yang masih dipakai)
+  uint16_t tries = 0;
+  while (exists(uint16_t(0xFF00 | tempCounter)) && ++tries < 256)
+    tempCounter++;
+  AlarmData a{}; // channel dst. nol: alarm offline selalu di kanal 0
+  a.id = uint16_t(0xFF00 | tempCounter);
   a.hour = h;
   a.minute = m;
   a.duration = durSec;
   a.enabled = en;
+  a.days = days;
   a.lastDayTrig = -1;
   a.lastMinTrig = -1;
   a.pending = true;     // tandai nanti perlu di‐sync
   a.isTemporary = true; // tandai ini ID offline
   a.tempIndex = int8_t(tempCounter++);
-  alarms[alarmCount++] = a;
+  if (!table.insert(a))
+  {
+    lastMessage = "no free temporary id (offline)";
+    return;
+  }
+  tableChanged();
   lastMessage = "Offline add: tempIndex=" + String(a.tempIndex);
-  saveAll(); // langsung simpan ke LittleFS
+  Persistence::markDirty(PERSIST_ALARMS); // disimpan oleh Persistence::loop()
 }
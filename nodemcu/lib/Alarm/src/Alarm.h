@@ -2,8 +2,27 @@
 #define ALARM_H
 
 #include <Arduino.h>
+#include "RecordLog.h"
 
-static const uint8_t MAX_ALARMS = 10;
+// Kapasitas tetap (RAM statis ±40 B per alarm); ubah lewat build_flags,
+// mis. -DALARM_CAPACITY=512
+#ifndef ALARM_CAPACITY
+#define ALARM_CAPACITY 128
+#endif
+static const uint16_t MAX_ALARMS = ALARM_CAPACITY;
+// Bitmask hari: bit0 = Minggu ... bit6 = Sabtu (DateTime::dayOfTheWeek())
+#define ALARM_EVERY_DAY 0x7F
+// Alarm terlewat (loop tertahan portal WiFi/MQTT, mode edit, reboot, mati
+// listrik) dihitung dari waktu cek terakhir. Keterlambatan <= grace selalu
+// dijalankan; lebih dari itu tergantung ALARM_MISSED_POLICY, paling jauh
+// ALARM_CATCHUP_WINDOW_SEC ke belakang (< 1 hari).
+#define ALARM_FIRE_GRACE_SEC 60
+#define ALARM_MISSED_SKIP      0 // lewati
+#define ALARM_MISSED_FIRE_LATE 1 // tetap jalankan sekali, terlambat
+#ifndef ALARM_MISSED_POLICY
+#define ALARM_MISSED_POLICY ALARM_MISSED_FIRE_LATE
+#endif
+#define ALARM_CATCHUP_WINDOW_SEC (2 * 3600UL)
 
 struct AlarmData
 {
@@ -17,6 +36,8 @@ struct AlarmData
   bool pending;     // perlu disinkron ke backend?
   bool isTemporary; // ID sementara jika offline
   int8_t tempIndex; // indeks for matching ACK
+  uint8_t days;     // ALARM_EVERY_DAY = setiap hari
+  uint8_t channel;  // kanal Actuator (0..7)
 };
 
 class Alarm
@@ -25,23 +46,39 @@ public:
   // Load & save dari LittleFS
   static void loadAll();
   static void saveAll();
+  static const RecordLogStats &storageStats();
 
   // Akses data alarm
-  static AlarmData *getAll(uint8_t &outCount);
+  // Array rapat, urutan tidak tetap (remove memindahkan elemen terakhir).
+  // Setelah mengubah hour/minute/enabled/days langsung, panggil touch().
+  static AlarmData *getAll(uint16_t &outCount);
+  static AlarmData *find(uint16_t id);
   static bool exists(uint16_t id);
-  static bool add(uint16_t id, uint8_t h, uint8_t m, int durSec, bool en);
-  static bool edit(uint16_t id, uint8_t h, uint8_t m, int durSec, bool en);
+  static bool add(uint16_t id, uint8_t h, uint8_t m, int durSec, bool en,
+                  uint8_t days = ALARM_EVERY_DAY, uint8_t channel = 0);
+  static bool edit(uint16_t id, uint8_t h, uint8_t m, int durSec, bool en,
+                   uint8_t days = ALARM_EVERY_DAY, uint8_t channel = 0);
   static bool enable(uint16_t id, bool en);
   static bool remove(uint16_t id);
+  // ID sementara (offline) diganti ID dari backend setelah ACK
+  static bool confirmId(uint16_t tempId, uint16_t id);
+  static void touch();
+  // Berubah setiap kali isi tabel berubah (untuk invalidasi tampilan)
+  static uint32_t revision();
   static void list();
 
   // Tambah alarm saat offline (ID sementara)
-  static void addAlarmOffline(uint8_t h, uint8_t m, int durSec, bool en);
+  static void addAlarmOffline(uint8_t h, uint8_t m, int durSec, bool en, uint8_t days = ALARM_EVERY_DAY);
 
   // Tandai sedang edit via display, agar checkAll() menunda trig
   static void setEditing(bool editing);
 
-  // Periksa dan trigger alarm
+  // Hitung ulang jadwal (mis. setelah jam RTC diubah)
+  static void reschedule();
+
+  // Dipanggil tiap loop: bandingkan Clock::now() dengan alarm terdekat dan
+  // trigger semua alarm yang jatuh tempo sejak cek terakhir (run diteruskan
+  // ke Actuator). Tanpa akses I2C.
   static void checkAll();
 
   // Ambil pesan terakhir (dipakai untuk ACK MQTT, dsb.)
@@ -0,0 +1,128 @@
+#include "AlarmTable.h"
+#include <algorithm>
+
+void AlarmTable::clear()
+{
+  count = 0;
+  memset(buckets, 0, sizeof(buckets));
+  timeValid = false;
+}
+
+// Hash multiplikatif (Fibonacci): bit atas hasil kali paling teracak
+uint32_t AlarmTable::bucketOf(uint16_t id) const
+{
+  return (uint32_t(id) * 2654435761u) >> (32 - ALARM_BUCKET_BITS);
+}
+
+uint32_t AlarmTable::slotOf(uint16_t id) const
+{
+  uint32_t b = bucketOf(id);
+  while (buckets[b] && items[buckets[b] - 1].id != id)
+    b = (b + 1) & (ALARM_BUCKETS - 1);
+  return b;
+}
+
+int32_t AlarmTable::find(uint16_t id) const
+{
+  uint16_t v = buckets[slotOf(id)];
+  return v ? int32_t(v) - 1 : -1;
+}
+
+AlarmData *AlarmTable::insert(const AlarmData &a)
+{
+  if (count >= MAX_ALARMS)
+    return nullptr;
+  uint32_t b = slotOf(a.id);
+  if (buckets[b])
+    return nullptr;
+  items[count] = a;
+  buckets[b] = ++count;
+  timeValid = false;
+  return &items[count - 1];
+}
+
+// Backward shift: geser entri berikutnya dalam cluster yang bucket asalnya
+// tidak berada di antara lubang dan posisinya, supaya probing tetap benar
+void AlarmTable::eraseBucket(uint32_t hole)
+{
+  const uint32_t mask = ALARM_BUCKETS - 1;
+  uint32_t j = hole;
+  for (;;)
+  {
+    j = (j + 1) & mask;
+    if (!buckets[j])
+      break;
+    uint32_t home = bucketOf(items[buckets[j] - 1].id);
+    if (((j - home) & mask) >= ((j - hole) & mask))
+    {
+      buckets[hole] = buckets[j];
+      hole = j;
+    }
+  }
+  buckets[hole] = 0;
+}
+
+bool AlarmTable::remove(uint16_t id)
+{
+  uint32_t b = slotOf(id);
+  if (!buckets[b])
+    return false;
+  uint16_t idx = buckets[b] - 1;
+  eraseBucket(b);
+  uint16_t last = count - 1;
+  if (idx != last)
+  {
+    items[idx] = items[last];
+    buckets[slotOf(items[idx].id)] = idx + 1;
+  }
+  count--;
+  timeValid = false;
+  return true;
+}
+
+bool AlarmTable::rekey(uint16_t oldId, uint16_t newId)
+{
+  if (oldId == newId)
+    return find(oldId) >= 0;
+  uint32_t b = slotOf(oldId);
+  if (!buckets[b] || buckets[slotOf(newId)])
+    return false;
+  uint16_t idx = buckets[b] - 1;
+  eraseBucket(b);
+  items[idx].id = newId;
+  buckets[slotOf(newId)] = idx + 1;
+  timeValid = false;
+  return true;
+}
+
+const uint16_t *AlarmTable::byTime()
+{
+  if (!timeValid)
+  {
+    for (uint16_t i = 0; i < count; i++)
+      timeOrder[i] = i;
+    const AlarmData *it = items;
+    std::sort(timeOrder, timeOrder + count, [it](uint16_t x, uint16_t y)
+              {
+                uint16_t mx = minuteOfDay(it[x]), my = minuteOfDay(it[y]);
+                return mx != my ? mx < my : it[x].id < it[y].id;
+              });
+    timeValid = true;
+  }
+  return timeOrder;
+}
+
+uint16_t AlarmTable::lowerBound(uint16_t minute)
+{
+  const uint16_t *order = byTime();
+  uint16_t lo = 0, hi = count;
+  while (lo < hi)
+  {
+    uint16_t mid = (lo + hi) / 2;
+    if (minuteOfDay(items[order[mid]]) < minute)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
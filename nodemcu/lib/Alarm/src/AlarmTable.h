@@ -0,0 +1,56 @@
+// AlarmTable.h
+#ifndef ALARM_TABLE_H
+#define ALARM_TABLE_H
+
+#include <Arduino.h>
+#include "Alarm.h"
+
+// Bucket hash id: pangkat dua >= 2 × kapasitas (load factor <= 0.5)
+constexpr uint8_t alarmBucketBits(uint32_t cap, uint8_t bits = 4)
+{
+  return (1UL << bits) >= 2 * cap ? bits : alarmBucketBits(cap, bits + 1);
+}
+static const uint8_t ALARM_BUCKET_BITS = alarmBucketBits(MAX_ALARMS);
+static const uint32_t ALARM_BUCKETS = 1UL << ALARM_BUCKET_BITS;
+
+// Wadah alarm berkapasitas tetap (MAX_ALARMS, tanpa alokasi heap):
+// - items[] rapat (indeks 0..size-1) agar Alarm::getAll() tetap berupa array;
+//   remove() memindahkan elemen terakhir ke lubang (O(1)), urutan tidak dijaga
+// - id → indeks lewat hash open addressing (linear probing, hapus dengan
+//   backward shift, tanpa tombstone): find/insert/remove O(1) rata-rata
+// - indeks urut menit-dalam-hari untuk scheduler: dibangun ulang (O(n log n))
+//   hanya saat dibaca setelah ada perubahan, pencarian O(log n)
+class AlarmTable
+{
+public:
+  void clear();
+  uint16_t size() const { return count; }
+  AlarmData *data() { return items; }
+
+  int32_t find(uint16_t id) const; // indeks di data() atau -1
+  AlarmData *insert(const AlarmData &a); // nullptr jika penuh / id sudah ada
+  bool remove(uint16_t id);
+  bool rekey(uint16_t oldId, uint16_t newId);
+
+  // Wajib dipanggil setelah hour/minute diubah langsung lewat data()
+  void invalidateTime() { timeValid = false; }
+  // Indeks ke data(), urut hour*60+minute (lalu id)
+  const uint16_t *byTime();
+  // Posisi pertama di byTime() dengan menit-dalam-hari >= minuteOfDay
+  uint16_t lowerBound(uint16_t minuteOfDay);
+
+  static uint16_t minuteOfDay(const AlarmData &a) { return a.hour * 60 + a.minute; }
+
+private:
+  uint32_t bucketOf(uint16_t id) const;
+  uint32_t slotOf(uint16_t id) const; // bucket berisi id atau bucket kosong tujuan
+  void eraseBucket(uint32_t b);
+
+  AlarmData items[MAX_ALARMS];
+  uint16_t buckets[ALARM_BUCKETS] = {}; // indeks + 1, 0 = kosong
+  uint16_t timeOrder[MAX_ALARMS];
+  uint16_t count = 0;
+  bool timeValid = false;
+};
+
+#endif // ALARM_TABLE_H
@@ -0,0 +1,223 @@
+#include "BatteryMode.h"
+#include "Config.h"
+#include "I2CBus.h"
+#include "MQTT.h"
+#include "Outbox.h"
+#include "Persistence.h"
+#include "ReadSensor.h"
+#include "TelemetryLog.h"
+#include <WiFi.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+
+#define BATTERY_MAGIC 0x42415431 // "BAT1"
+
+extern char deviceId[];
+
+struct BatterySample
+{
+  uint32_t ts; // unix time UTC, 0 = DS3231 gagal dibaca
+  SensorSnapshot v;
+};
+
+// Bertahan selama deep sleep; diinisialisasi ulang saat cold boot
+struct BatteryState
+{
+  uint32_t magic;
+  uint32_t wakes;
+  uint32_t dropped;    // snapshot tertimpa karena ring penuh
+  uint8_t head;
+  uint8_t count;
+  uint8_t breachMask;  // setting yang di luar batas pada wake terakhir
+  uint8_t limitCount;
+  float vmax;          // baseline turbidity, tidak diukur ulang tiap wake
+  SensorSetting limits[MAX_SENSOR_SETTINGS];
+  BatteryTiming last;
+  uint64_t awakeUs[2]; // total per jenis wake: 0 = sampel, 1 = publish
+  uint32_t cycles[2];
+};
+
+RTC_DATA_ATTR static BatteryState state;
+RTC_DATA_ATTR static BatterySample ring[BATTERY_RING_LEN];
+
+static uint32_t lap(int64_t &mark)
+{
+  int64_t now = esp_timer_get_time();
+  uint32_t us = uint32_t(now - mark);
+  mark = now;
+  return us;
+}
+
+static void push(const BatterySample &s)
+{
+  if (state.count == BATTERY_RING_LEN)
+  {
+    state.head = (state.head + 1) % BATTERY_RING_LEN;
+    state.count--;
+    state.dropped++;
+  }
+  ring[(state.head + state.count) % BATTERY_RING_LEN] = s;
+  state.count++;
+}
+
+// Bit per setting (urut state.limits) yang nilainya di luar batas
+static uint8_t breaches(const SensorSnapshot &v)
+{
+  uint8_t mask = 0;
+  for (uint8_t i = 0; i < state.limitCount && i < 8; i++)
+  {
+    if (Sensor::outOfRange(state.limits[i], v))
+      mask |= 1 << i;
+  }
+  return mask;
+}
+
+// Ring → TelemetryLog (flash): setelah ini data aman walau publish gagal
+static void flushRing()
+{
+  for (uint8_t i = 0; i < state.count; i++)
+  {
+    const BatterySample &s = ring[(state.head + i) % BATTERY_RING_LEN];
+    if (s.ts)
+      TelemetryLog::append(s.ts, s.v.tds, s.v.ph, s.v.turbidity, s.v.temperature);
+  }
+  state.head = 0;
+  state.count = 0;
+}
+
+static bool waitUntil(bool (*ready)(), uint32_t timeoutMs, bool pumpMqtt)
+{
+  unsigned long start = millis();
+  while (!ready())
+  {
+    if (millis() - start >= timeoutMs)
+      return false;
+    if (pumpMqtt)
+    {
+      loopMQTT();
+      Persistence::loop();
+    }
+    delay(10);
+  }
+  return true;
+}
+
+static bool wifiReady()
+{
+  return WiFi.status() == WL_CONNECTED;
+}
+
+static bool drained()
+{
+  OutboxStats o = Outbox::stats();
+  return TelemetryLog::pending() == 0 && o.controlDepth == 0 && o.telemetryDepth == 0;
+}
+
+// Wake publish: muat data flash, pindahkan ring, lalu kirim via backfill
+static void publish(BatteryTiming &t, int64_t &mark, void (*beginStorage)())
+{
+  beginStorage();
+  flushRing();
+  // Setting bisa berubah lewat MQTT; salinan di RTC diperbarui di akhir
+  t.storeUs = lap(mark);
+
+  if (wifiEnabled)
+  {
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(); // kredensial tersimpan dari WiFiManager (mode normal)
+    bool up = waitUntil(wifiReady, BATTERY_CONNECT_TIMEOUT_MS, false);
+    if (up)
+    {
+      setupMQTT(deviceId);
+      up = waitUntil(isMQTTConnected, BATTERY_CONNECT_TIMEOUT_MS, false);
+    }
+    t.netUs = lap(mark);
+    if (up)
+    {
+      if (!waitUntil(drained, BATTERY_PUBLISH_TIMEOUT_MS, true))
+        Serial.printf("[BAT] Publish timeout, %u records left in log\n", (unsigned)TelemetryLog::pending());
+    }
+    else
+    {
+      Serial.println("[BAT] No connection, samples kept in TelemetryLog");
+    }
+    t.publishUs = lap(mark);
+  }
+
+  Persistence::barrier();
+  uint8_t n;
+  const SensorSetting *s = Sensor::getAllSettings(n);
+  state.limitCount = n;
+  memcpy(state.limits, s, n * sizeof(SensorSetting));
+}
+
+void BatteryMode::run(RTCHandler &rtc, void (*beginStorage)())
+{
+  int64_t mark = esp_timer_get_time();
+  BatteryTiming t = {};
+  t.bootUs = uint32_t(mark);
+
+  // Reset selain power-on (tombol EN, watchdog) tidak menghapus RTC memory:
+  // isi ring tetap dipakai dan ikut dipindah oleh wake publish ini
+  bool cold = esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_TIMER;
+  if (state.magic != BATTERY_MAGIC)
+  {
+    memset(&state, 0, sizeof(state));
+    state.magic = BATTERY_MAGIC;
+  }
+  state.wakes++;
+
+  setupPins();
+  wifiEnabled = digitalRead(WIFI_MODE_PIN) != LOW;
+  state.vmax = Sensor::initBurst(state.vmax, BATTERY_TEMP_RESOLUTION);
+  t.initUs = lap(mark);
+
+  Sensor::burst(BATTERY_TEMP_RESOLUTION);
+  BatterySample s;
+  s.v.temperature = Sensor::readTemperatureC();
+  s.v.tds = Sensor::readTDS();
+  s.v.ph = Sensor::readPH();
+  s.v.turbidity = Sensor::readTDBT();
+  t.sampleUs = lap(mark);
+
+  I2CBus::begin();
+  s.ts = rtc.readUnixtime();
+  t.rtcUs = lap(mark);
+  push(s);
+
+  // Cold boot selalu publish: batas sensor belum ada di RTC memory
+  uint8_t breach = breaches(s.v);
+  bool newBreach = breach & ~state.breachMask;
+  state.breachMask = breach;
+  bool publishWake = cold || newBreach || state.wakes % BATTERY_PUBLISH_EVERY == 0;
+  if (publishWake)
+    publish(t, mark, beginStorage);
+
+  int64_t awake = esp_timer_get_time();
+  t.totalUs = uint32_t(awake);
+  state.last = t;
+  state.awakeUs[publishWake] += t.totalUs;
+  state.cycles[publishWake]++;
+
+  Serial.printf("[BAT] wake=%u %s%s boot=%u init=%u sample=%u rtc=%u store=%u net=%u pub=%u total=%ums\n",
+                (unsigned)state.wakes, publishWake ? "publish" : "sample", newBreach ? " (breach)" : "",
+                (unsigned)(t.bootUs / 1000), (unsigned)(t.initUs / 1000), (unsigned)(t.sampleUs / 1000),
+                (unsigned)(t.rtcUs / 1000), (unsigned)(t.storeUs / 1000), (unsigned)(t.netUs / 1000),
+                (unsigned)(t.publishUs / 1000), (unsigned)(t.totalUs / 1000));
+  Serial.printf("[BAT] avg awake sample=%ums publish=%ums ring=%u/%u dropped=%u\n",
+                state.cycles[0] ? (unsigned)(state.awakeUs[0] / state.cycles[0] / 1000) : 0,
+                state.cycles[1] ? (unsigned)(state.awakeUs[1] / state.cycles[1] / 1000) : 0,
+                state.count, BATTERY_RING_LEN, (unsigned)state.dropped);
+  Serial.flush();
+
+  // Jadwal tetap: waktu bangun dikurangkan dari interval
+  uint64_t intervalUs = uint64_t(BATTERY_WAKE_INTERVAL_S) * 1000000ULL;
+  uint64_t sleepUs = uint64_t(awake) + 1000000ULL < intervalUs ? intervalUs - awake : 1000000ULL;
+  esp_sleep_enable_timer_wakeup(sleepUs);
+  esp_deep_sleep_start();
+}
+
+const BatteryTiming &BatteryMode::lastTiming()
+{
+  return state.last;
+}
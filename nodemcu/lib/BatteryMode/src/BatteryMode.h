@@ -0,0 +1,50 @@
+// BatteryMode.h
+#ifndef BATTERY_MODE_H
+#define BATTERY_MODE_H
+
+#include <Arduino.h>
+#include "RTC.h"
+
+// Aktifkan lewat build_flags: -DBATTERY_MODE=1
+#ifndef BATTERY_MODE
+#define BATTERY_MODE 0
+#endif
+#ifndef BATTERY_WAKE_INTERVAL_S
+#define BATTERY_WAKE_INTERVAL_S 60 // jarak antar sampel
+#endif
+#ifndef BATTERY_PUBLISH_EVERY
+#define BATTERY_PUBLISH_EVERY 10 // wake ke-N menyambung & publish
+#endif
+#define BATTERY_RING_LEN 64            // snapshot di RTC slow memory
+#define BATTERY_TEMP_RESOLUTION 9      // DS18B20 0,5 °C, konversi 94 ms
+#define BATTERY_CONNECT_TIMEOUT_MS 15000
+#define BATTERY_PUBLISH_TIMEOUT_MS 10000
+
+// Rincian waktu satu wake (µs), disimpan di RTC memory
+struct BatteryTiming
+{
+  uint32_t bootUs;    // start aplikasi → run() (ROM/bootloader tidak terukur)
+  uint32_t initUs;    // pin, ADC, DS18B20, kalibrasi
+  uint32_t sampleUs;  // burst ADC + tunggu konversi suhu
+  uint32_t rtcUs;     // baca DS3231
+  uint32_t storeUs;   // mount FS + ring → TelemetryLog (wake publish)
+  uint32_t netUs;     // WiFi + MQTT tersambung
+  uint32_t publishUs; // sampai TelemetryLog & Outbox kosong
+  uint32_t totalUs;
+};
+
+// Mode baterai: tiap wake timer hanya burst sampel, snapshot ditambahkan ke
+// ring di RTC slow memory, lalu deep sleep lagi (tanpa LCD, UI, Clock).
+// Setiap BATTERY_PUBLISH_EVERY wake, saat cold boot, atau saat ada sensor
+// yang baru melewati batas SensorSetting, ring dipindah ke TelemetryLog lalu
+// (jika WiFi ON) tersambung dan dikirim lewat jalur backfill biasa.
+class BatteryMode
+{
+public:
+  // Tidak kembali. beginStorage: mount FS & muat alarm, deviceId, setting
+  // sensor, Persistence, TelemetryLog (sama dengan setup() biasa).
+  [[noreturn]] static void run(RTCHandler &rtc, void (*beginStorage)());
+  static const BatteryTiming &lastTiming();
+};
+
+#endif // BATTERY_MODE_H
@@ -1,25 +1,207 @@
 // ButtonHandler.cpp
 #include "ButtonHandler.h"
 #include "Config.h"
+#include "Power.h"
+#include <driver/gpio.h>
+#include <freertos/FreeRTOS.h>
+
+ButtonHandler buttonHandler;
+
+static const uint8_t BUTTON_PINS[BUTTON_COUNT] = {BTN_UP, BTN_DOWN, BTN_LEFT, BTN_RIGHT, BTN_SELECT};
+// Tombol yang auto-repeat (SELECT tidak: repeat akan keluar-masuk mode edit)
+static const uint8_t REPEAT_MASK = (1 << BUTTON_UP) | (1 << BUTTON_DOWN) |
+                                   (1 << BUTTON_LEFT) | (1 << BUTTON_RIGHT);
+
+static portMUX_TYPE buttonMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint8_t edgeMask = 0; // tombol yang levelnya belum stabil
+static volatile uint32_t edgeMs[BUTTON_COUNT];
+
+static void IRAM_ATTR onEdge(void *arg)
+{
+  uint8_t i = uint8_t(uintptr_t(arg));
+  portENTER_CRITICAL_ISR(&buttonMux);
+  edgeMs[i] = millis();
+  edgeMask |= 1 << i;
+  portEXIT_CRITICAL_ISR(&buttonMux);
+  Power::wakeFromISR();
+}
 
 ButtonHandler::ButtonHandler() {}
 
-ButtonState ButtonHandler::read()
+void ButtonHandler::begin()
+{
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+  {
+    // Tombol yang sudah ditekan saat boot tidak dianggap tekan
+    down[i] = digitalRead(BUTTON_PINS[i]) == LOW;
+    attachInterruptArg(digitalPinToInterrupt(BUTTON_PINS[i]), onEdge, (void *)uintptr_t(i), CHANGE);
+  }
+}
+
+void ButtonHandler::push(ButtonId b, ButtonEventType t, uint16_t repeat)
+{
+  if (count >= BUTTON_QUEUE_LEN)
+  {
+    droppedCount++;
+    return;
+  }
+  queue[(head + count) % BUTTON_QUEUE_LEN] = {b, t, repeat};
+  count++;
+}
+
+void ButtonHandler::update()
+{
+  if (!edgeMask && !heldMask)
+    return;
+  uint32_t now = millis();
+
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+  {
+    const uint8_t bit = 1 << i;
+    bool settled = false;
+    portENTER_CRITICAL(&buttonMux);
+    if ((edgeMask & bit) && now - edgeMs[i] >= BUTTON_DEBOUNCE_MS)
+    {
+      edgeMask &= ~bit;
+      settled = true;
+    }
+    portEXIT_CRITICAL(&buttonMux);
+
+    if (settled)
+    {
+      bool level = digitalRead(BUTTON_PINS[i]) == LOW;
+      if (level != down[i])
+      {
+        down[i] = level;
+        if (level)
+        {
+          heldMask |= bit;
+          pressedAt[i] = now;
+          longSent[i] = false;
+          nextRepeatAt[i] = now + BUTTON_REPEAT_DELAY_MS;
+          repeatInterval[i] = BUTTON_REPEAT_START_MS;
+          repeatCount[i] = 0;
+          push(ButtonId(i), BTN_EV_PRESS);
+        }
+        else
+        {
+          heldMask &= ~bit;
+          push(ButtonId(i), BTN_EV_RELEASE);
+        }
+      }
+    }
+
+    if (!(heldMask & bit))
+      continue;
+    if (!longSent[i] && now - pressedAt[i] >= BUTTON_LONG_MS)
+    {
+      longSent[i] = true;
+      push(ButtonId(i), BTN_EV_LONG);
+    }
+    if ((REPEAT_MASK & bit) && int32_t(now - nextRepeatAt[i]) >= 0)
+    {
+      push(ButtonId(i), BTN_EV_REPEAT, ++repeatCount[i]);
+      nextRepeatAt[i] = now + repeatInterval[i];
+      uint16_t faster = repeatInterval[i] * 4 / 5;
+      repeatInterval[i] = faster > BUTTON_REPEAT_MIN_MS ? faster : BUTTON_REPEAT_MIN_MS;
+    }
+  }
+}
+
+bool ButtonHandler::next(ButtonEvent &e)
 {
-  ButtonState state = {false, false, false, false, false, false};
+  update();
+  if (!count)
+    return false;
+  e = queue[head];
+  head = (head + 1) % BUTTON_QUEUE_LEN;
+  count--;
+  return true;
+}
 
-  if (millis() - lastDebounce < debounceDelay)
-    return state;
+uint32_t ButtonHandler::idleMs() const
+{
+  if (count)
+    return 0;
+  uint32_t now = millis();
+  uint32_t wait = UINT32_MAX;
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+  {
+    const uint8_t bit = 1 << i;
+    uint32_t at;
+    portENTER_CRITICAL(&buttonMux);
+    bool edge = edgeMask & bit;
+    at = edgeMs[i] + BUTTON_DEBOUNCE_MS;
+    portEXIT_CRITICAL(&buttonMux);
+    if (!edge)
+    {
+      bool repeats = REPEAT_MASK & bit;
+      if (!(heldMask & bit) || (longSent[i] && !repeats))
+        continue;
+      at = longSent[i] ? nextRepeatAt[i] : pressedAt[i] + BUTTON_LONG_MS;
+      if (repeats && int32_t(nextRepeatAt[i] - at) < 0)
+        at = nextRepeatAt[i];
+    }
+    int32_t left = int32_t(at - now);
+    if (left <= 0)
+      return 0;
+    if (uint32_t(left) < wait)
+      wait = left;
+  }
+  return wait;
+}
 
-  state.up = !digitalRead(BTN_UP);
-  state.down = !digitalRead(BTN_DOWN);
-  state.left = !digitalRead(BTN_LEFT);
-  state.right = !digitalRead(BTN_RIGHT);
-  state.select = !digitalRead(BTN_SELECT);
-  state.anyPressed = state.up || state.down || state.left || state.right || state.select;
+void ButtonHandler::armWake()
+{
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+  {
+    gpio_num_t pin = gpio_num_t(BUTTON_PINS[i]);
+    armedLow[i] = digitalRead(BUTTON_PINS[i]) == HIGH;
+    gpio_intr_disable(pin);
+    gpio_wakeup_enable(pin, armedLow[i] ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+  }
+}
 
-  if (state.anyPressed)
-    lastDebounce = millis();
+void ButtonHandler::disarmWake()
+{
+  uint32_t now = millis();
+  for (uint8_t i = 0; i < BUTTON_COUNT; i++)
+  {
+    gpio_num_t pin = gpio_num_t(BUTTON_PINS[i]);
+    gpio_wakeup_disable(pin);
+    gpio_set_intr_type(pin, GPIO_INTR_ANYEDGE);
+    // Level berubah selama tidur: perlakukan seperti tepi (tetap didebounce)
+    if ((digitalRead(BUTTON_PINS[i]) == LOW) == armedLow[i])
+    {
+      portENTER_CRITICAL(&buttonMux);
+      edgeMs[i] = now;
+      edgeMask |= 1 << i;
+      portEXIT_CRITICAL(&buttonMux);
+    }
+    gpio_intr_enable(pin);
+  }
+}
 
-  return state;
+ButtonState ButtonHandler::toState(const ButtonEvent &e)
+{
+  ButtonState s = {false, false, false, false, false, true};
+  switch (e.button)
+  {
+  case BUTTON_UP:
+    s.up = true;
+    break;
+  case BUTTON_DOWN:
+    s.down = true;
+    break;
+  case BUTTON_LEFT:
+    s.left = true;
+    break;
+  case BUTTON_RIGHT:
+    s.right = true;
+    break;
+  default:
+    s.select = true;
+    break;
+  }
+  return s;
 }
@@ -4,6 +4,38 @@
 
 #include <Arduino.h>
 
+#define BUTTON_DEBOUNCE_MS 20       // level harus stabil selama ini
+#define BUTTON_LONG_MS 800          // tahan >= ini → BTN_EV_LONG
+#define BUTTON_REPEAT_DELAY_MS 400  // repeat pertama setelah ditahan ini
+#define BUTTON_REPEAT_START_MS 250  // jarak repeat awal...
+#define BUTTON_REPEAT_MIN_MS 40     // ...dipercepat 20% per repeat sampai ini
+#define BUTTON_QUEUE_LEN 16
+
+enum ButtonId : uint8_t
+{
+  BUTTON_UP,
+  BUTTON_DOWN,
+  BUTTON_LEFT,
+  BUTTON_RIGHT,
+  BUTTON_SELECT,
+  BUTTON_COUNT
+};
+
+enum ButtonEventType : uint8_t
+{
+  BTN_EV_PRESS,
+  BTN_EV_RELEASE,
+  BTN_EV_LONG,  // sekali per tekan
+  BTN_EV_REPEAT // hanya tombol arah, makin cepat selama ditahan
+};
+
+struct ButtonEvent
+{
+  ButtonId button;
+  ButtonEventType type;
+  uint16_t repeat; // urutan repeat (1, 2, ...) untuk BTN_EV_REPEAT
+};
+
 struct ButtonState
 {
   bool up;
@@ -14,15 +46,47 @@ struct ButtonState
   bool anyPressed;
 };
 
+// Interrupt CHANGE per tombol hanya mencatat waktu tepi; debounce per
+// tombol, long-press dan auto-repeat diproses di next() (loop), hasilnya
+// antrian event. Tanpa tepi dan tanpa tombol ditahan, next() O(1).
 class ButtonHandler
 {
 public:
   ButtonHandler();
-  ButtonState read();
+  // Pasang interrupt; panggil setelah setupPins()
+  void begin();
+  // Ambil event berikutnya; false jika antrian kosong
+  bool next(ButtonEvent &e);
+  // Satu tombol sebagai ButtonState (untuk handler menu)
+  static ButtonState toState(const ButtonEvent &e);
+  uint32_t dropped() const { return droppedCount; }
+  // ms sampai next() punya pekerjaan (debounce, long, repeat); 0 = ada
+  // event di antrian, UINT32_MAX = tidak ada tombol aktif
+  uint32_t idleMs() const;
+  // Light sleep: tiap pin bangun pada level kebalikan saat ini; tepi yang
+  // terlewat ISR dicatat ulang setelah bangun
+  void armWake();
+  void disarmWake();
 
 private:
-  unsigned long lastDebounce = 0;
-  const unsigned long debounceDelay = 200;
+  void update();
+  void push(ButtonId b, ButtonEventType t, uint16_t repeat = 0);
+
+  bool down[BUTTON_COUNT] = {};
+  bool longSent[BUTTON_COUNT] = {};
+  uint32_t pressedAt[BUTTON_COUNT] = {};
+  uint32_t nextRepeatAt[BUTTON_COUNT] = {};
+  uint16_t repeatInterval[BUTTON_COUNT] = {};
+  uint16_t repeatCount[BUTTON_COUNT] = {};
+  uint8_t heldMask = 0;
+  bool armedLow[BUTTON_COUNT] = {};
+
+  ButtonEvent queue[BUTTON_QUEUE_LEN];
+  uint8_t head = 0;
+  uint8_t count = 0;
+  uint32_t droppedCount = 0;
 };
 
+extern ButtonHandler buttonHandler;
+
 #endif
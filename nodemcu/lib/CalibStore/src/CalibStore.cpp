@@ -0,0 +1,183 @@
+#include "CalibStore.h"
+#include <esp_partition.h>
+#include <rom/crc.h>
+
+static const CalibTables DEFAULT_TABLES = {
+    1.0f,  // tdsSlope
+    0.0f,  // tdsIntercept
+    0.019f,
+    2.51f, // phVoltage7
+    3.11f, // phVoltage4
+    0.50f, // turbidityVmin
+    0.0f,  // turbidityVmax: ukur saat boot
+    3.3f,  // adcVref
+    0,
+    0};
+
+int8_t CalibStore::activeSlot = -1;
+uint32_t CalibStore::activeGen = 0;
+
+static const esp_partition_t *part = nullptr;
+static const uint8_t *mapped = nullptr; // seluruh partisi, read-only
+static esp_partition_mmap_handle_t mapHandle;
+static const CalibTables *active = &DEFAULT_TABLES;
+static const uint16_t *activeLut = nullptr;
+
+static void putU16(uint8_t *p, uint16_t v)
+{
+  p[0] = uint8_t(v);
+  p[1] = uint8_t(v >> 8);
+}
+
+static void putU32(uint8_t *p, uint32_t v)
+{
+  for (uint8_t i = 0; i < 4; i++)
+    p[i] = uint8_t(v >> (8 * i));
+}
+
+static uint16_t getU16(const uint8_t *p)
+{
+  return uint16_t(p[0] | (p[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t *p)
+{
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+static size_t payloadSize(uint16_t lutLen)
+{
+  return sizeof(CalibTables) + size_t(lutLen) * sizeof(uint16_t);
+}
+
+// Generation slot jika header & payload valid, 0 jika tidak
+static uint32_t validSlot(uint8_t slot)
+{
+  const uint8_t *h = mapped + slot * CALIB_SLOT_SIZE;
+  if (getU32(h) != CALIB_MAGIC || getU16(h + 4) != CALIB_VERSION ||
+      crc32_le(0, h, 16) != getU32(h + 16))
+    return 0;
+  const CalibTables *t = reinterpret_cast<const CalibTables *>(h + CALIB_HEADER_SIZE);
+  size_t len = getU16(h + 6);
+  if (len != payloadSize(t->adcLutLen) || CALIB_HEADER_SIZE + len > CALIB_SLOT_SIZE ||
+      (t->adcLutLen && t->adcLutLen != CALIB_ADC_LUT_LEN) ||
+      crc32_le(0, h + CALIB_HEADER_SIZE, len) != getU32(h + 12))
+    return 0;
+  return getU32(h + 8);
+}
+
+static void selectSlot(int8_t slot)
+{
+  if (slot < 0)
+  {
+    active = &DEFAULT_TABLES;
+    activeLut = nullptr;
+    return;
+  }
+  const uint8_t *base = mapped + slot * CALIB_SLOT_SIZE + CALIB_HEADER_SIZE;
+  active = reinterpret_cast<const CalibTables *>(base);
+  activeLut = active->adcLutLen ? reinterpret_cast<const uint16_t *>(base + sizeof(CalibTables)) : nullptr;
+}
+
+bool CalibStore::begin()
+{
+  if (mapped)
+    return true;
+  part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                  (esp_partition_subtype_t)CALIB_PARTITION_SUBTYPE,
+                                  CALIB_PARTITION_LABEL);
+  if (!part || part->size < 2 * CALIB_SLOT_SIZE)
+  {
+    Serial.println("[CALIB] No calib partition, using compiled defaults");
+    part = nullptr;
+    return false;
+  }
+  const void *ptr;
+  if (esp_partition_mmap(part, 0, 2 * CALIB_SLOT_SIZE, ESP_PARTITION_MMAP_DATA, &ptr, &mapHandle) != ESP_OK)
+  {
+    Serial.println("[CALIB] mmap failed, using compiled defaults");
+    part = nullptr;
+    return false;
+  }
+  mapped = static_cast<const uint8_t *>(ptr);
+
+  uint32_t gen[2] = {validSlot(0), validSlot(1)};
+  // Perbandingan modulo 2^32, generation 0 = slot tidak valid
+  if (gen[0] && (!gen[1] || int32_t(gen[0] - gen[1]) > 0))
+    activeSlot = 0;
+  else if (gen[1])
+    activeSlot = 1;
+  activeGen = activeSlot >= 0 ? gen[activeSlot] : 0;
+  selectSlot(activeSlot);
+  Serial.printf("[CALIB] slot %d gen %u lut %u\n", activeSlot, (unsigned)activeGen,
+                (unsigned)active->adcLutLen);
+  return true;
+}
+
+const CalibTables &CalibStore::tables()
+{
+  return *active;
+}
+
+float CalibStore::adcVolts(int raw)
+{
+  if (raw < 0)
+    raw = 0;
+  if (raw > 4095)
+    raw = 4095;
+  if (activeLut)
+    return activeLut[raw] * 0.001f;
+  return raw * (active->adcVref / 4095.0f);
+}
+
+bool CalibStore::update(const CalibTables &t)
+{
+  if (!part)
+    return false;
+  uint8_t target = activeSlot == 0 ? 1 : 0;
+  size_t base = target * CALIB_SLOT_SIZE;
+  uint16_t lutLen = activeLut ? active->adcLutLen : 0;
+
+  CalibTables next = t;
+  next.adcLutLen = lutLen;
+  next.reserved = 0;
+
+  if (esp_partition_erase_range(part, base, CALIB_SLOT_SIZE) != ESP_OK ||
+      esp_partition_write(part, base + CALIB_HEADER_SIZE, &next, sizeof(next)) != ESP_OK)
+    return false;
+  uint32_t crc = crc32_le(0, reinterpret_cast<const uint8_t *>(&next), sizeof(next));
+
+  // LUT disalin lewat buffer kecil: sumbernya flash ter-mmap yang tidak
+  // boleh dibaca selama operasi tulis flash (cache dimatikan)
+  const uint8_t *lut = reinterpret_cast<const uint8_t *>(activeLut);
+  size_t lutBytes = size_t(lutLen) * sizeof(uint16_t);
+  uint8_t chunk[256];
+  for (size_t off = 0; off < lutBytes; off += sizeof(chunk))
+  {
+    size_t n = lutBytes - off < sizeof(chunk) ? lutBytes - off : sizeof(chunk);
+    memcpy(chunk, lut + off, n);
+    crc = crc32_le(crc, chunk, n);
+    if (esp_partition_write(part, base + CALIB_HEADER_SIZE + sizeof(next) + off, chunk, n) != ESP_OK)
+      return false;
+  }
+
+  // Header terakhir: slot baru baru valid setelah seluruh payload tertulis
+  uint32_t gen = activeGen + 1 ? activeGen + 1 : 1;
+  uint8_t h[CALIB_HEADER_SIZE] = {};
+  putU32(h, CALIB_MAGIC);
+  putU16(h + 4, CALIB_VERSION);
+  putU16(h + 6, uint16_t(payloadSize(lutLen)));
+  putU32(h + 8, gen);
+  putU32(h + 12, crc);
+  putU32(h + 16, crc32_le(0, h, 16));
+  if (esp_partition_write(part, base, h, sizeof(h)) != ESP_OK || validSlot(target) != gen)
+  {
+    Serial.println("[CALIB] Slot write failed, keeping previous tables");
+    return false;
+  }
+  activeSlot = target;
+  activeGen = gen;
+  selectSlot(activeSlot);
+  Serial.printf("[CALIB] Switched to slot %u gen %u\n", target, (unsigned)gen);
+  return true;
+}
@@ -0,0 +1,61 @@
+// CalibStore.h
+#ifndef CALIB_STORE_H
+#define CALIB_STORE_H
+
+#include <Arduino.h>
+
+// Partisi "calib" (data, subtype 0x40, lihat partitions.csv) dibagi dua slot
+// A/B. Slot aktif = slot valid dengan generation terbesar. Layout slot
+// (little-endian, offset tetap agar bisa dibaca langsung dari flash):
+//   0x00 magic 'CALB' | u16 version | u16 payloadLen | u32 generation |
+//        u32 crc32 payload | u32 crc32 header (byte 0x00..0x0F) | pad s/d 0x20
+//   0x20 CalibTables
+//   0x44 u16 adcLut[adcLutLen] (opsional)
+#define CALIB_PARTITION_LABEL   "calib"
+#define CALIB_PARTITION_SUBTYPE 0x40
+#define CALIB_SLOT_SIZE         0x8000
+#define CALIB_HEADER_SIZE       0x20
+#define CALIB_MAGIC             0x424C4143 // "CALB"
+#define CALIB_VERSION           1
+#define CALIB_ADC_LUT_LEN       4096       // satu entri per nilai raw ADC 12 bit
+
+struct CalibTables
+{
+  float tdsSlope;
+  float tdsIntercept;
+  float tdsTempCoeff;  // kompensasi suhu per °C (larutan KCl 0.019)
+  float phVoltage7;    // tegangan probe pada buffer pH 7
+  float phVoltage4;    // tegangan probe pada buffer pH 4
+  float turbidityVmin; // tegangan pada 100% keruh
+  float turbidityVmax; // tegangan air jernih; 0 = ukur saat boot
+  float adcVref;       // tanpa LUT: volt = raw * adcVref / 4095
+  uint16_t adcLutLen;  // 0 atau CALIB_ADC_LUT_LEN (mV terkoreksi per raw)
+  uint16_t reserved;
+};
+static_assert(sizeof(CalibTables) == 36, "CalibTables layout berubah, naikkan CALIB_VERSION");
+
+// Tabel kalibrasi read-only lewat esp_partition_mmap: tables() dan LUT
+// menunjuk langsung ke flash (cache MMU), tidak ada salinan di heap/RAM.
+// Jika partisi kosong/tidak ada, tables() berisi default hasil kompilasi.
+class CalibStore
+{
+public:
+  static bool begin();
+  static const CalibTables &tables();
+  static float adcVolts(int raw);
+
+  // Tulis slot tidak aktif (erase → payload → header terakhir) lalu pindah
+  // ke slot itu. LUT dibawa dari slot aktif; listrik putus di tengah jalan
+  // meninggalkan slot lama tetap aktif. Erase 32 KB: panggil di luar jalur
+  // waktu-kritis (mis. lewat Persistence).
+  static bool update(const CalibTables &t);
+
+  static bool stored() { return activeSlot >= 0; } // false = masih default
+  static uint32_t generation() { return activeGen; }
+
+private:
+  static int8_t activeSlot;
+  static uint32_t activeGen;
+};
+
+#endif // CALIB_STORE_H
@@ -16,9 +16,12 @@ void setupPins()
   // Config button
   pinMode(CONFIG_PIN, INPUT_PULLUP);
 
-  // RTC interrupt
+  // Switch mode WiFi
   pinMode(WIFI_MODE_PIN, INPUT_PULLUP);
 
+  // RTC interrupt (open-drain, butuh pull-up)
+  pinMode(RTC_INT_PIN, INPUT_PULLUP);
+
   // I2C pins (Wire.begin will configure SDA/SCL)
   // Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
   pinMode(BTN_UP, INPUT_PULLUP);
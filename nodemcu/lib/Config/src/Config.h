@@ -8,7 +8,8 @@
 // Pin definitions
 static const uint8_t LED_PIN = 2;       // On-board LED
 static const uint8_t CONFIG_PIN = 13;   // Config button
-static const uint8_t WIFI_MODE_PIN = 4; // RTC SQW interrupt
+static const uint8_t WIFI_MODE_PIN = 16; // Switch mode WiFi (LOW = offline)
+static const uint8_t RTC_INT_PIN = 4;    // RTC SQW/INT (1 Hz DS3231, open drain)
 static const uint8_t I2C_SDA_PIN = 21;
 static const uint8_t I2C_SCL_PIN = 22;
 static const uint8_t TDS_PIN = 32;         // ADC1_CH0
@@ -1,27 +1,180 @@
 #include "Display.h"
+#include "I2CBus.h"
 
 Display lcd(0x27, 20, 4);
 
 Display::Display(uint8_t address, uint8_t cols, uint8_t rows)
-    : lcd(address, cols, rows), columns(cols) {}
+    : lcd(address, cols, rows),
+      columns(cols < DISPLAY_MAX_COLS ? cols : DISPLAY_MAX_COLS),
+      rows(rows < DISPLAY_MAX_ROWS ? rows : DISPLAY_MAX_ROWS) {}
 
 void Display::begin()
 {
-  lcd.init();
-  lcd.backlight();
+  I2CBus::run(I2C_DEV_LCD, [this] {
+    lcd.init();
+    lcd.backlight();
+    return true;
+  });
+  // init() mengosongkan LCD: shadow = spasi
+  memset(frame, ' ', sizeof(frame));
+  memset(shadow, ' ', sizeof(shadow));
+  cursor = -1;
+  dirty = false;
 }
 
+// Tidak langsung dikirim: isi berikutnya (printLine / endFrame) biasanya
+// menimpa sebagian besar layar, jadi hanya sisa selnya yang dikosongkan
 void Display::clear()
 {
-  lcd.clear();
+  memset(frame, ' ', sizeof(frame));
+  dirty = true;
 }
 
 void Display::printLine(uint8_t row, const String &text)
 {
-  lcd.setCursor(0, row);
-  lcd.print(text);
-  for (uint8_t i = text.length(); i < columns; i++)
+  if (row >= rows)
+    return;
+  uint8_t n = text.length() < columns ? text.length() : columns;
+  memcpy(frame[row], text.c_str(), n);
+  memset(frame[row] + n, ' ', columns - n);
+  dirty = true;
+  if (!inFrame)
+    flush();
+}
+
+bool Display::beginFrame()
+{
+  if (millis() - lastFrameMs < DISPLAY_FRAME_MS)
+    return false;
+  lastFrameMs = millis();
+  inFrame = true;
+  return true;
+}
+
+void Display::endFrame()
+{
+  inFrame = false;
+  send(false);
+}
+
+void Display::flush()
+{
+  send(true);
+}
+
+void Display::loop()
+{
+  if (dirty && !busy && !inFrame)
+    send(false);
+}
+
+// Alamat DDRAM HD44780 (sama dengan offset baris LiquidCrystal_I2C)
+uint8_t Display::address(uint8_t row, uint8_t col) const
+{
+  return (row & 1 ? 0x40 : 0x00) + (row & 2 ? columns : 0) + col;
+}
+
+void Display::writeCell(uint8_t row, uint8_t col, char c)
+{
+  uint8_t addr = address(row, col);
+  if (cursor != addr)
+  {
+    lcd.setCursor(col, row);
+    counters.moves++;
+  }
+  lcd.write(uint8_t(c));
+  shadow[row][col] = c;
+  counters.cells++;
+  cursor = addr + 1;
+}
+
+uint32_t Display::idleMs() const
+{
+  if (dirty)
+    return 1;
+  uint32_t since = millis() - lastFrameMs;
+  return since >= DISPLAY_FRAME_MS ? 0 : DISPLAY_FRAME_MS - since;
+}
+
+// wait=false: antrikan ke task I2C; jika kiriman sebelumnya masih jalan,
+// frame ini tetap dirty dan dikirim oleh loop()
+void Display::send(bool wait)
+{
+  if (!dirty)
+    return;
+  if (busy)
+  {
+    if (!wait)
+      return;
+    while (busy)
+      delay(1);
+  }
+  memcpy(sending, frame, sizeof(frame));
+  dirty = false;
+  scanPos = 0;
+  sendStart = counters.cells + counters.moves;
+  busy = true;
+  if (wait)
+  {
+    I2CBus::run(I2C_DEV_LCD, [this] {
+      sendCells(0xFFFF);
+      return true;
+    });
+    finishSend();
+  }
+  else if (!I2CBus::post(I2C_DEV_LCD, sliceJob, this))
+  {
+    busy = false;
+    dirty = true;
+  }
+}
+
+// Kirim sel `sending` yang beda dari shadow mulai scanPos, maksimal budget
+// tulisan LCD. true jika seluruh frame sudah terkirim.
+bool Display::sendCells(uint16_t budget)
+{
+  // Urut DDRAM: 0, 2, 1, 3 (baris 2 melanjutkan baris 0, baris 3 baris 1)
+  static const uint8_t ORDER[DISPLAY_MAX_ROWS] = {0, 2, 1, 3};
+  while (scanPos < DISPLAY_MAX_ROWS * columns)
+  {
+    uint8_t r = ORDER[scanPos / columns];
+    uint8_t c = scanPos % columns;
+    // setCursor sama mahalnya dengan satu karakter, jadi sel yang sama
+    // cukup dilewati (celah berapa pun tidak lebih mahal)
+    if (r < rows && sending[r][c] != shadow[r][c])
+    {
+      uint16_t cost = cursor == address(r, c) ? 1 : 2;
+      if (cost > budget)
+        return false;
+      budget -= cost;
+      writeCell(r, c, sending[r][c]);
+    }
+    scanPos++;
+  }
+  return true;
+}
+
+void Display::finishSend()
+{
+  uint32_t writes = counters.cells + counters.moves - sendStart;
+  if (writes)
+  {
+    counters.frames++;
+    counters.i2cBytes += writes * DISPLAY_I2C_BYTES_PER_WRITE;
+  }
+  busy = false;
+}
+
+// Job di task I2C: satu potong frame, lalu sisanya diantrikan lagi
+bool Display::sliceJob(void *ctx)
+{
+  Display *d = static_cast<Display *>(ctx);
+  if (!d->sendCells(DISPLAY_SLICE_WRITES))
   {
-    lcd.print(' ');
+    if (I2CBus::post(I2C_DEV_LCD, sliceJob, d))
+      return true;
+    d->sendCells(0xFFFF); // antrian penuh: selesaikan di sini
   }
+  d->finishSend();
+  return true;
 }
@@ -3,6 +3,33 @@
 
 #include <LiquidCrystal_I2C.h>
 
+#define DISPLAY_MAX_COLS 20
+#define DISPLAY_MAX_ROWS 4
+// Batas frame rate render loop (ms per frame)
+#define DISPLAY_FRAME_MS 50
+// Backpack PCF8574 mode 4-bit: tiap byte LCD = 2 nibble × 3 transaksi
+// (data, EN naik, EN turun) × (alamat + data)
+#define DISPLAY_I2C_BYTES_PER_WRITE 12
+// Tulisan LCD per job I2C (±9 ms pada 100 kHz); sisanya diantrikan ulang
+// supaya job RTC tidak menunggu satu frame penuh
+#define DISPLAY_SLICE_WRITES 8
+
+struct DisplayStats
+{
+  uint32_t frames;  // flush yang mengirim sesuatu
+  uint32_t cells;   // karakter yang ditulis ke LCD
+  uint32_t moves;   // perintah setCursor
+  uint32_t i2cBytes; // perkiraan byte di bus I2C
+};
+
+// printLine()/clear() hanya menulis ke framebuffer; flush() membandingkan
+// dengan salinan isi LCD (shadow) dan mengirim sel yang berubah saja, urut
+// alamat DDRAM supaya baris 0→2 dan 1→3 bersambung tanpa setCursor. Di
+// antara beginFrame()/endFrame() flush ditunda sampai endFrame(); di luar
+// itu (setup, portal WiFi) printLine() langsung dikirim. clear() selalu
+// ikut terkirim bersama tulisan berikutnya. Frame dari endFrame() dikirim
+// async oleh task I2CBus (snapshot di `sending`); frame yang selesai
+// dirender selagi kiriman sebelumnya berjalan dikirim oleh loop().
 class Display
 {
 public:
@@ -11,9 +38,38 @@ public:
   void clear();
   void printLine(uint8_t row, const String &text);
 
+  // false jika DISPLAY_FRAME_MS belum lewat sejak frame terakhir
+  bool beginFrame();
+  void endFrame();
+  void flush();
+  // Panggil tiap loop(): kirim frame yang tertahan kiriman sebelumnya
+  void loop();
+  // ms sampai beginFrame() berhasil; frame tertahan (dirty) = 1
+  uint32_t idleMs() const;
+  const DisplayStats &stats() const { return counters; }
+
 private:
+  uint8_t address(uint8_t row, uint8_t col) const;
+  void writeCell(uint8_t row, uint8_t col, char c);
+  void send(bool wait);
+  bool sendCells(uint16_t budget);
+  void finishSend();
+  static bool sliceJob(void *ctx);
+
   LiquidCrystal_I2C lcd;
   uint8_t columns;
+  uint8_t rows;
+  char frame[DISPLAY_MAX_ROWS][DISPLAY_MAX_COLS];
+  char shadow[DISPLAY_MAX_ROWS][DISPLAY_MAX_COLS];
+  char sending[DISPLAY_MAX_ROWS][DISPLAY_MAX_COLS]; // milik task I2C saat busy
+  bool dirty = false;
+  volatile bool busy = false; // kiriman async sedang berjalan
+  uint8_t scanPos = 0;        // posisi sel berikutnya (urut DDRAM)
+  uint32_t sendStart = 0;     // cells + moves saat kiriman dimulai
+  bool inFrame = false;
+  unsigned long lastFrameMs = 0;
+  int16_t cursor = -1; // alamat DDRAM kursor LCD, -1 = tidak diketahui
+  DisplayStats counters = {};
 };
 
 extern Display lcd;
@@ -3,41 +3,98 @@
 #include "MQTT.h"
 #include "ReadSensor.h"
 #include "ButtonHandler.h"
+#include "Persistence.h"
+#include "Clock.h"
 #include <Arduino.h>
 
-ButtonHandler buttonHandler;
-
 extern Display lcd;
-extern RTC_DS3231 rtc;
 
 DisplayAlarm::DisplayAlarm()
 {
-  // Inisialisasi semua state sudah di‐set default di header (.h)
+  // Inisialisasi semua state sudah di‐set default di header (.h);
+  // array setting sensor statis, pointer-nya langsung bisa dipakai
+  sensors = Sensor::getAllSettings(sensorCount);
 }
 
+// Halaman (indeks = currentView()) dan event yang membuatnya basi
+const DisplayAlarm::View DisplayAlarm::VIEWS[4] = {
+    {&DisplayAlarm::renderAlarmPage, UI_EV_INPUT | UI_EV_SECOND | UI_EV_ALARMS},
+    {&DisplayAlarm::renderSensorPage, UI_EV_INPUT | UI_EV_SENSOR},
+    {&DisplayAlarm::renderEdit, UI_EV_INPUT | UI_EV_ALARMS},
+    {&DisplayAlarm::renderEdit, UI_EV_INPUT},
+};
+
 void DisplayAlarm::loop()
 {
-  readButtons();
-  // 1) Ambil data alarm tiap loop
-  alarms = Alarm::getAll(alarmCount);
+  // 1) Kumpulkan event: perubahan tabel alarm, detik baru, tombol
+  uint32_t rev = Alarm::revision();
+  if (rev != alarmRevision)
+  {
+    alarmRevision = rev;
+    alarms = Alarm::getAll(alarmCount);
+    pendingEvents |= UI_EV_ALARMS;
+  }
+  uint32_t sec = Clock::now();
+  if (sec != lastSecond)
+  {
+    lastSecond = sec;
+    pendingEvents |= UI_EV_SECOND;
+  }
+  // Tekan & auto-repeat (makin cepat selama ditahan) dijalankan sebagai satu
+  // langkah; release & long-press belum dipakai menu
+  ButtonEvent ev;
+  while (buttonHandler.next(ev))
+  {
+    if (ev.type != BTN_EV_PRESS && ev.type != BTN_EV_REPEAT)
+      continue;
+    // Kiri/kanan di luar edit = pindah halaman: tidak diulang
+    if (ev.type == BTN_EV_REPEAT && !inEdit && (ev.button == BUTTON_LEFT || ev.button == BUTTON_RIGHT))
+      continue;
+    readButtons(ButtonHandler::toState(ev));
+    pendingEvents |= UI_EV_INPUT;
+  }
+
+  // 2) Render hanya jika halaman aktif terkena event, maks
+  //    1000/DISPLAY_FRAME_MS fps (event tetap tersimpan sampai frame
+  //    berikutnya); hanya sel yang berubah dikirim ke LCD
+  if (!(pendingEvents & VIEWS[currentView()].invalidatedBy) || !lcd.beginFrame())
+    return;
+  pendingEvents = 0;
+  renderMenu();
+  lcd.endFrame();
+}
 
-  // 2) Ambil data sensor HANYA jika BUKAN sedang edit sensor
+uint32_t DisplayAlarm::idleMs() const
+{
+  uint32_t ms = buttonHandler.idleMs();
+  // Event yang menunggu jatah frame: tunggu sampai frame boleh dimulai
+  if (pendingEvents & VIEWS[currentView()].invalidatedBy)
+  {
+    uint32_t frame = lcd.idleMs();
+    if (frame < ms)
+      ms = frame;
+  }
+  return ms;
+}
+
+void DisplayAlarm::onSensorSnapshot(const SensorSnapshot &s)
+{
+  snapshot = s;
+  // Batas sensor tidak dicek selama setting-nya sedang diedit
   if (!(inEdit && currentPage == PAGE_SENSOR))
   {
-    Sensor::checkSensorLimits();
     sensors = Sensor::getAllSettings(sensorCount);
+    Sensor::checkSensorLimits(s);
   }
+  pendingEvents |= UI_EV_SENSOR;
+}
 
-  // 3) Ambil current time
-  DateTime now = rtc.now();
-
-  // 4) Baca semua tombol, mungkin ubah state
-
-  // 5) Render sesuai state (alarm/sensor & inEdit/outEdit)
-  renderMenu(now);
+uint8_t DisplayAlarm::currentView() const
+{
+  return (inEdit ? 2 : 0) + (currentPage == PAGE_SENSOR ? 1 : 0);
 }
 
-void DisplayAlarm::renderMenu(const DateTime &now)
+void DisplayAlarm::renderMenu()
 {
   // Clear LCD jika entry/exit edit
   if (inEdit != lastInEdit)
@@ -47,214 +104,78 @@ void DisplayAlarm::renderMenu(const DateTime &now)
     Alarm::setEditing(inEdit); // memberi tahu ke Alarm subsystem kalau sedang di‐edit
   }
 
-  if (inEdit)
-  {
-    if (currentPage == PAGE_ALARM)
-      renderSetAlarm(now);
-    else
-      renderSetSensor();
-  }
-  else
-  {
-    if (currentPage == PAGE_ALARM)
-      renderAlarmPage(now);
-    else
-      renderSensorPage();
-  }
+  (this->*VIEWS[currentView()].render)();
 }
 
 // ================================================
-// renderEditPage: satu fungsi untuk edit Alarm/ Sensor
+// Halaman edit dari EDIT_PAGES: judul, satu baris per field, baris aksi
 // ================================================
-void DisplayAlarm::renderEditPage(
-    const char * /*titleFmt*/,
-    uint8_t totalFields,
-    uint8_t fieldCursor,
-    bool valueEditing,
-    bool isSensor)
+void DisplayAlarm::renderEdit()
 {
+  const EditPage &page = EDIT_PAGES[currentPage];
+  const uint8_t *rec = record();
   char line[21];
 
-  // -------- Baris 0: JUDUL --------
-  if (isSensor)
-  {
-    // Pilih nama sensor menurut editIndex (0=Turbidity,1=TDS,2=pH)
-    const char *sensorName;
-    switch (editIndex)
-    {
-    case 0:
-      sensorName = "Temperature";
-      break;
-    case 1:
-      sensorName = "Turbidity";
-      break;
-    case 2:
-      sensorName = "TDS";
-      break;
-    case 3:
-      sensorName = "pH";
-      break;
-    default:
-      sensorName = "Sensor";
-      break;
-    }
-    snprintf(line, 21, "Edit %s", sensorName);
-  }
+  if (page.record == REC_ALARM)
+    snprintf(line, sizeof(line), page.title, editIndex + 1);
   else
-  {
-    // Edit Alarm <nomor>
-    snprintf(line, 21, "Edit Alarm %d", editIndex + 1);
-  }
+    snprintf(line, sizeof(line), page.title, SENSOR_INFO[editIndex].title);
   lcd.printLine(0, line);
 
-  // -------- Baris 1 & 2: Konten utama --------
-  for (uint8_t f = 0; f < 2; f++)
+  for (uint8_t row = 0; row < page.count; row++)
   {
-    // Prefix “> ” jika ini fieldCursor (dan bukan sedang valueEditing)
-    const char *pfx = (!valueEditing && f == fieldCursor) ? "> " : "  ";
-
-    if (isSensor)
-    {
-      // Get setting sensor
-      auto &s = sensors[editIndex];
-
-      if (f == 0)
-      {
-        // Baris pertama: Min|Max: xx.x|yy.y  (ditandai [ ] jika valueEditing)
-        char minStr[8], maxStr[8];
-
-        // Pertama: siapkan string normal (tanpa tanda "[ ]")
-        if (s.type == S_PH)
-        {
-          // Jika pH, tampilkan satu digit di belakang koma
-          snprintf(minStr, sizeof(minStr), "%.1f", s.minValue);
-          snprintf(maxStr, sizeof(maxStr), "%.1f", s.maxValue);
-        }
-        else
-        {
-          // Sensor lain tetap integer
-          snprintf(minStr, sizeof(minStr), "%2.0f", s.minValue);
-          snprintf(maxStr, sizeof(maxStr), "%2.0f", s.maxValue);
-        }
-
-        // Jika sedang edit angka, bungkus dengan "[ ]" menggunakan format yang tepat
-        if (valueEditing)
-        {
-          if (s.type == S_PH)
-          {
-            // Untuk pH gunakan satu digit di belakang koma
-            switch (sensorCursor)
-            {
-            case 0:
-              snprintf(minStr, sizeof(minStr), "[%.1f]", s.minValue);
-              break;
-            case 1:
-              snprintf(maxStr, sizeof(maxStr), "[%.1f]", s.maxValue);
-              break;
-            }
-          }
-          else
-          {
-            // Untuk sensor non-pH (tanpa desimal)
-            switch (sensorCursor)
-            {
-            case 0:
-              snprintf(minStr, sizeof(minStr), "[%2.0f]", s.minValue);
-              break;
-            case 1:
-              snprintf(maxStr, sizeof(maxStr), "[%2.0f]", s.maxValue);
-              break;
-            }
-          }
-        }
-
-        // Gabungkan "Min|Max:…"
-        snprintf(line + 2, 19, "Min|Max:%s|%s", minStr, maxStr);
-      }
-      else
-      {
-        // Baris kedua: “Stat:ON” atau “Stat:OFF”
-        snprintf(line + 2, 19, "Stat:%s", s.enabled ? "ON" : "OFF");
-      }
-    }
-    else
+    const MenuField &f = MENU_FIELDS[page.first + row];
+    bool here = row == editRow;
+    int len = snprintf(line, sizeof(line), "%s%s", here && !valueEditing ? "> " : "  ", f.label);
+    for (uint8_t i = 0; i < f.count && len < int(sizeof(line)) - 2; i++)
     {
-      // Jika edit Alarm
-      auto &a = alarms[editIndex];
-      if (f == 0 && valueEditing)
-      {
-        // Mode edit waktu: tampil [HH], [MM], [ON]
-        char hourStr[8], minStr[8], onStr[8];
-        snprintf(hourStr, sizeof(hourStr), "%02d", a.hour);
-        snprintf(minStr, sizeof(minStr), "%02d", a.minute);
-        snprintf(onStr, sizeof(onStr), "%s", a.enabled ? "ON" : "OFF");
-        switch (timeCursor)
-        {
-        case 0:
-          snprintf(hourStr, sizeof(hourStr), "[%02d]", a.hour);
-          break;
-        case 1:
-          snprintf(minStr, sizeof(minStr), "[%02d]", a.minute);
-          break;
-        case 2:
-          snprintf(onStr, sizeof(onStr), "[%s]", a.enabled ? "ON" : "OFF");
-          break;
-        }
-        snprintf(line + 2, 19, "Time:%s:%s %s", hourStr, minStr, onStr);
-      }
-      else if (f == 0)
-      {
-        // Non‐edit: tampilkan “Time:HH:MM ON/OFF”
-        snprintf(line + 2, 19, "Time:%02d:%02d %s",
-                 a.hour, a.minute, a.enabled ? "ON" : "OFF");
-      }
-      else
-      {
-        // Baris kedua non‐edit: “Dur: xx s”
-        snprintf(line + 2, 19, "Dur:%2ds", a.duration);
-      }
+      const MenuValue &v = MENU_VALUES[f.first + i];
+      char val[10];
+      formatValue(v, rec, val, sizeof(val));
+      bool boxed = here && valueEditing && i == valueCursor;
+      if (v.sep)
+        line[len++] = v.sep;
+      len += snprintf(line + len, sizeof(line) - len, boxed ? "[%s]" : "%s", val);
     }
-
-    // Tulis prefix (“> ”) dan konten mulai di kolom 2
-    memcpy(line, pfx, 2);
-    lcd.printLine(f + 1, line);
+    lcd.printLine(row + 1, line);
   }
 
-  // -------- Baris 3: Footer --------
-  // fieldCursor == totalFields ⇒ “> Save”
-  // fieldCursor == totalFields+1 ⇒ “> Back” (sensor) atau “> Del” (alarm)
-  bool selSave = (fieldCursor == totalFields);
-  bool selBackOrDel = (fieldCursor == totalFields + 1);
+  uint8_t action = editRow - page.count; // >= 2 jika kursor di field
+  snprintf(line, sizeof(line), "%s%-9s%s%s", action == 0 ? "> " : "  ", page.actionLabel[0],
+           action == 1 ? "> " : "  ", page.actionLabel[1]);
+  lcd.printLine(3, line);
+}
 
-  String foot = selSave ? "> Save     " : "  Save     ";
-  if (isSensor)
+void DisplayAlarm::formatValue(const MenuValue &v, const uint8_t *rec, char *out, size_t n) const
+{
+  const uint8_t *p = rec + v.offset;
+  switch (v.type)
   {
-    foot += selBackOrDel ? "> Back" : "  Back";
-  }
-  else
+  case MV_U8:
+    snprintf(out, n, v.fmt, *p);
+    break;
+  case MV_INT:
+    snprintf(out, n, v.fmt, *(const int *)p);
+    break;
+  case MV_BOOL:
+    snprintf(out, n, "%s", *(const bool *)p ? "ON" : "OFF");
+    break;
+  case MV_FLOAT:
   {
-    foot += selBackOrDel ? "> Del" : "  Del";
+    // Tanpa desimal: lebar 2 supaya angka satuan tidak menggeser tampilan
+    uint8_t d = decimals();
+    snprintf(out, n, "%*.*f", d ? 0 : 2, d, *(const float *)p);
+    break;
+  }
   }
-  lcd.printLine(3, foot);
-}
-
-void DisplayAlarm::renderSetAlarm(const DateTime &now)
-{
-  // Saat edit alarm, isSensor=false, totalFields=2 (Time,Duration, lalu Save,Delete)
-  renderEditPage(nullptr, 2, editField, timeEditing, false);
-}
-
-void DisplayAlarm::renderSetSensor()
-{
-  // Saat edit sensor, isSensor=true, totalFields=2 (MinMax,Status, lalu Save,Back)
-  renderEditPage(nullptr, 2, editSensorField, sensorEditing, true);
 }
 
 // ================================================
 // Fungsi untuk menampilkan halaman Daftar Alarm
 // ================================================
-void DisplayAlarm::renderAlarmPage(const DateTime &now)
+void DisplayAlarm::renderAlarmPage()
 {
+  const DateTime &now = Clock::local();
   char buf[21];
   snprintf(buf, 21, "Time: %02d:%02d:%02d",
            now.hour(), now.minute(), now.second());
@@ -263,7 +184,7 @@ void DisplayAlarm::renderAlarmPage(const DateTime &now)
   // Dua baris daftar alarm (maks 2 baris per halaman)
   for (uint8_t row = 0; row < 2; row++)
   {
-    uint8_t idx = pageStart + row;
+    uint16_t idx = pageStart + row;
     if (idx < alarmCount)
     {
       auto &a = alarms[idx];
@@ -293,299 +214,40 @@ void DisplayAlarm::renderAlarmPage(const DateTime &now)
 // ================================================
 void DisplayAlarm::renderSensorPage()
 {
+  // Satu baris per entri SENSOR_INFO; digulir jika lebih dari 4
+  uint8_t top = cursorPos > 3 ? cursorPos - 3 : 0;
   char buf[21];
-  float turbidity = Sensor::readTDBT();
-  float tds = Sensor::readTDS();
-  float ph = Sensor::readPH();
-  float temperature = Sensor::readTemperatureC();
-
-  // Baris 0: Temperature (bisa ditandai cursorPos=0)
-  const char *pTemp = (cursorPos == 0) ? ">" : " ";
-  snprintf(buf, 21, "%sSuhu     :%5.1fC    ", pTemp, temperature);
-  lcd.printLine(0, buf);
-
-  // Baris 1: Turbidity (cursorPos=1)
-  const char *p0 = (cursorPos == 1) ? ">" : " ";
-  snprintf(buf, 21, "%sTurbidity:%5.1f%%", p0, turbidity);
-  lcd.printLine(1, buf);
-
-  // Baris 2: TDS (cursorPos=2)
-  const char *p1 = (cursorPos == 2) ? ">" : " ";
-  snprintf(buf, 21, "%sTDS      :%5.1fppm", p1, tds);
-  lcd.printLine(2, buf);
-
-  // Baris 3: pH (cursorPos=3)
-  const char *p2 = (cursorPos == 3) ? ">" : " ";
-  snprintf(buf, 21, "%spH       :%5.1f   ", p2, ph);
-  lcd.printLine(3, buf);
+  for (uint8_t row = 0; row < 4; row++)
+  {
+    uint8_t i = top + row;
+    if (i >= SENSOR_INFO_COUNT)
+    {
+      lcd.printLine(row, "");
+      continue;
+    }
+    const SensorInfo &info = SENSOR_INFO[i];
+    float value = *(const float *)((const uint8_t *)&snapshot + info.snapshotOffset);
+    snprintf(buf, sizeof(buf), "%c%-9s:%5.1f%s", cursorPos == i ? '>' : ' ', info.label, value, info.unit);
+    lcd.printLine(row, buf);
+  }
 }
 
 // ================================================
 // Baca tombol dan sesuaikan state (alarm / sensor / edit / navigasi)
 // ================================================
-void DisplayAlarm::readButtons()
+void DisplayAlarm::readButtons(const ButtonState &btn)
 {
-  ButtonState btn = buttonHandler.read();
-  if (!btn.anyPressed)
-    return;
-
   // -------------------------
-  // 1) Editing Mode: Alarm
+  // 1) Editing Mode: ditafsirkan dari EDIT_PAGES
   // -------------------------
-  if (inEdit && currentPage == PAGE_ALARM)
-  {
-    // -- Field TIME --
-    if (editField == F_TIME)
-    {
-      if (btn.select && !timeEditing)
-      {
-        timeEditing = true;
-        timeCursor = 0;
-        return;
-      }
-      if (timeEditing)
-      {
-        if (btn.up)
-        {
-          switch (timeCursor)
-          {
-          case 0:
-            alarms[editIndex].hour = (alarms[editIndex].hour + 1) % 24;
-            break;
-          case 1:
-            alarms[editIndex].minute = (alarms[editIndex].minute + 1) % 60;
-            break;
-          case 2:
-            alarms[editIndex].enabled = !alarms[editIndex].enabled;
-            break;
-          }
-        }
-        if (btn.down)
-        {
-          switch (timeCursor)
-          {
-          case 0:
-            alarms[editIndex].hour = (alarms[editIndex].hour + 23) % 24;
-            break;
-          case 1:
-            alarms[editIndex].minute = (alarms[editIndex].minute + 59) % 60;
-            break;
-          case 2:
-            alarms[editIndex].enabled = !alarms[editIndex].enabled;
-            break;
-          }
-        }
-        if (btn.left && timeCursor > 0)
-          timeCursor--;
-        if (btn.right && timeCursor < 2)
-          timeCursor++;
-        if (btn.select)
-        {
-          timeEditing = false;
-          return;
-        }
-        return;
-      }
-      if (btn.up)
-        editField = F_DELETE;
-      if (btn.down)
-        editField = F_DURATION;
-      if (btn.select)
-        editField = F_DURATION;
-      return;
-    }
-
-    // -- Field DURATION --
-    else if (editField == F_DURATION)
-    {
-      if (btn.up)
-        editField = F_TIME;
-      if (btn.down)
-        editField = F_SAVE;
-      if (btn.left)
-        alarms[editIndex].duration = (alarms[editIndex].duration + 99) % 100;
-      if (btn.right)
-        alarms[editIndex].duration = (alarms[editIndex].duration + 1) % 100;
-      return;
-    }
-    // -- Field SAVE Alarm --
-    else if (editField == F_SAVE)
-    {
-      if (btn.up)
-        editField = F_DURATION;
-      if (btn.right)
-        editField = F_DELETE;
-      if (btn.select)
-      {
-        // keluar mode edit…
-        inEdit = false;
-        timeEditing = false;
-        editField = F_TIME;
-
-        // ambil data terbaru
-        uint16_t id = alarms[editIndex].id;
-        uint8_t h = alarms[editIndex].hour;
-        uint8_t m = alarms[editIndex].minute;
-        int d = alarms[editIndex].duration;
-        bool en = alarms[editIndex].enabled;
-
-        // ← GANTI BAGIAN INI:
-        if (editingIsAdd)
-        {
-          // benar‐benar ADD
-          publishAlarmFromESP("ADD", 0, h, m, d, en);
-        }
-        else
-        {
-          // EDIT entri existing
-          publishAlarmFromESP("EDIT", id, h, m, d, en);
-        }
-        // reset flag supaya edit selanjutnya normal
-        editingIsAdd = false;
-      }
-      return;
-    }
-
-    // -- Field DELETE Alarm --
-    // -- Field DELETE Alarm --
-    else if (editField == F_DELETE)
-    {
-      if (btn.left)
-        editField = F_SAVE;
-      if (btn.down)
-        editField = F_TIME;
-      if (btn.select)
-      {
-        // Alih‐alih manual shift, panggil by‐index deletion:
-        deleteAlarmFromESPByIndex(editIndex);
-
-        // Muat ulang daftar alarm dari LittleFS
-        alarms = Alarm::getAll(alarmCount);
-
-        // Reset UI state
-        inEdit = false;
-        timeEditing = false;
-        editField = F_TIME;
-        pageStart = 0;
-        cursorPos = 0;
-        return;
-      }
-      return;
-    }
-  }
-
-  // -------------------------
-  // 2) Editing Mode: Sensor
-  // -------------------------
-  if (inEdit && currentPage == PAGE_SENSOR)
+  if (inEdit)
   {
-    // Field Min|Max
-    if (editSensorField == F_S_MINMAX)
-    {
-      // Jika tekan SELECT dan belum editing angka → masuk mode angka
-      if (btn.select && !sensorEditing)
-      {
-        sensorEditing = true;
-        // sensorCursor  = 0;
-        return;
-      }
-
-      // Jika dalam mode angka editing
-      if (sensorEditing)
-      {
-        float &v = (sensorCursor == 0)
-                       ? sensors[editIndex].minValue
-                       : sensors[editIndex].maxValue;
-
-        //  • GANTI dari “+= 1.0f” / “-= 1.0f” menjadi:
-        float step = (sensors[editIndex].type == S_PH) ? 0.1f : 1.0f;
-
-        if (btn.up)
-          v += step;
-        if (btn.down)
-          v -= step;
-        // Pastikan tidak melewati batas bawah (misal, jangan jadi negatif):
-        if (v < 0.0f)
-          v = 0.0f;
-
-        if (btn.left && sensorCursor > 0)
-          sensorCursor--;
-        if (btn.right && sensorCursor < 1)
-          sensorCursor++;
-        if (btn.select)
-        {
-          sensorEditing = false;
-          return;
-        }
-        return;
-      }
-
-      // Bukan mode angka → navigasi field‐nya
-      if (btn.up)
-        editSensorField = F_S_BACK; // pindah ke “Back”
-      if (btn.down)
-        editSensorField = F_S_STATUS; // pindah ke “Status”
-      if (btn.select)
-        editSensorField = F_S_SAVE; // pindah ke “Save”
-      return;
-    }
-
-    // Field Status (ON/OFF)
-    else if (editSensorField == F_S_STATUS)
-    {
-      if (btn.left || btn.right)
-      {
-        sensors[editIndex].enabled = !sensors[editIndex].enabled;
-      }
-      if (btn.up)
-        editSensorField = F_S_MINMAX;
-      if (btn.down)
-        editSensorField = F_S_SAVE;
-      return;
-    }
-
-    // Field Save (commit ke LittleFS)
-    else if (editSensorField == F_S_SAVE)
-    {
-      if (btn.up)
-        editSensorField = F_S_STATUS;
-      if (btn.right)
-        editSensorField = F_S_BACK;
-      if (btn.select)
-      {
-        // …
-        publishSensorFromESP(sensors[editIndex]);
-        // ← Tambahkan:
-        sensors[editIndex].pending = true;
-        sensors[editIndex].isTemporary = false; // atau false jika edit existing
-        Sensor::saveAllSettings();
-        inEdit = false;
-        sensorEditing = false;
-        editSensorField = F_S_MINMAX;
-      }
-      return;
-    }
-
-    // Field Back (cancel)
-    else if (editSensorField == F_S_BACK)
-    {
-      if (btn.left)
-        editSensorField = F_S_SAVE;
-      if (btn.down)
-        editSensorField = F_S_MINMAX;
-      if (btn.select)
-      {
-        // Keluar tanpa simpan
-        inEdit = false;
-        sensorEditing = false;
-        editSensorField = F_S_MINMAX;
-      }
-      return;
-    }
+    editInput(btn);
+    return;
   }
 
   // -------------------------
-  // 3) Navigasi Antar‐halaman
+  // 2) Navigasi Antar‐halaman
   // -------------------------
   if (btn.left || btn.right)
   {
@@ -596,7 +258,7 @@ void DisplayAlarm::readButtons()
   }
 
   // -------------------------
-  // 4) Navigasi & Entri EDIT di Alarm Page
+  // 3) Navigasi & Entri EDIT di Alarm Page
   // -------------------------
   if (currentPage == PAGE_ALARM && !inEdit)
   {
@@ -624,11 +286,7 @@ void DisplayAlarm::readButtons()
     {
       if (cursorPos < 2 && pageStart + cursorPos < alarmCount)
       {
-        inEdit = true;
-        editIndex = pageStart + cursorPos;
-        editField = F_TIME;
-        timeEditing = false;
-        timeCursor = 0;
+        enterEdit(pageStart + cursorPos);
       }
       else if (cursorPos == 3 && alarmCount < MAX_ALARMS)
       {
@@ -642,33 +300,179 @@ void DisplayAlarm::readButtons()
         alarms = Alarm::getAll(alarmCount);
 
         // 3) Masuk mode edit di entry terakhir
-        inEdit = true;
-        editIndex = alarmCount - 1;
-        editField = F_TIME;
-        timeEditing = false;
-        timeCursor = 0;
+        enterEdit(alarmCount - 1);
       }
     }
     return;
   }
 
   // -------------------------
-  // 5) Navigasi & Entri EDIT di Sensor Page
+  // 4) Navigasi & Entri EDIT di Sensor Page
   // -------------------------
   if (currentPage == PAGE_SENSOR && !inEdit)
   {
     if (btn.up && cursorPos > 0)
       cursorPos--;
-    if (btn.down && cursorPos < 3)
+    if (btn.down && cursorPos + 1u < SENSOR_INFO_COUNT)
       cursorPos++;
-    if (btn.select)
+    if (btn.select && cursorPos < sensorCount)
+      enterEdit(cursorPos); // indeks = SensorType
+    return;
+  }
+}
+
+// ================================================
+// Engine menu edit: baris 0..count-1 = field, count & count+1 = aksi
+// ================================================
+void DisplayAlarm::editInput(const ButtonState &btn)
+{
+  const EditPage &page = EDIT_PAGES[currentPage];
+  uint8_t *rec = record();
+
+  if (editRow < page.count)
+  {
+    const MenuField &f = MENU_FIELDS[page.first + editRow];
+    if (valueEditing)
+    {
+      // Atas/bawah ubah nilai, kiri/kanan pindah nilai, SELECT selesai
+      const MenuValue &v = MENU_VALUES[f.first + valueCursor];
+      if (btn.up)
+        stepValue(v, rec, 1);
+      if (btn.down)
+        stepValue(v, rec, -1);
+      if (btn.left && valueCursor > 0)
+        valueCursor--;
+      if (btn.right && valueCursor + 1 < f.count)
+        valueCursor++;
+      if (btn.select)
+        valueEditing = false;
+      return;
+    }
+    if (f.direct)
     {
-      inEdit = true;
-      editIndex = cursorPos; // 0=Turbidity,1=TDS,2=pH
-      editSensorField = F_S_MINMAX;
-      sensorEditing = false;
-      sensorCursor = 0;
+      if (btn.left)
+        stepValue(MENU_VALUES[f.first], rec, -1);
+      if (btn.right)
+        stepValue(MENU_VALUES[f.first], rec, 1);
+    }
+    else if (btn.select)
+    {
+      valueEditing = true;
+      valueCursor = 0;
+      return;
     }
+    // Atas dari field pertama melompat ke aksi terakhir
+    if (btn.up)
+      editRow = editRow ? editRow - 1 : page.count + 1;
+    if (btn.down)
+      editRow++;
     return;
   }
+
+  // Baris aksi: dua tombol berdampingan
+  uint8_t a = editRow - page.count;
+  if (btn.up && a == 0)
+    editRow = page.count - 1;
+  if (btn.down && a == 1)
+    editRow = 0;
+  if (btn.left && a == 1)
+    editRow = page.count;
+  if (btn.right && a == 0)
+    editRow = page.count + 1;
+  if (btn.select)
+    runAction(page.action[a]);
+}
+
+void DisplayAlarm::stepValue(const MenuValue &v, uint8_t *rec, int8_t dir)
+{
+  uint8_t *p = rec + v.offset;
+  switch (v.type)
+  {
+  case MV_U8:
+  case MV_INT:
+  {
+    int x = (v.type == MV_U8 ? *p : *(int *)p) + dir;
+    x = x > v.hi ? v.lo : x < v.lo ? v.hi : x;
+    if (v.type == MV_U8)
+      *p = uint8_t(x);
+    else
+      *(int *)p = x;
+    break;
+  }
+  case MV_BOOL:
+    *(bool *)p = !*(bool *)p;
+    break;
+  case MV_FLOAT:
+  {
+    float &f = *(float *)p;
+    f += dir * (decimals() ? 0.1f : 1.0f);
+    f = f < v.lo ? v.lo : f > v.hi ? v.hi : f;
+    break;
+  }
+  }
+}
+
+void DisplayAlarm::runAction(MenuAction action)
+{
+  switch (action)
+  {
+  case ACT_SAVE_ALARM:
+  {
+    const AlarmData &a = alarms[editIndex];
+    // Alarm baru dari "ADD Alarm" dikirim sebagai ADD (backend yang beri ID)
+    publishAlarmFromESP(editingIsAdd ? "ADD" : "EDIT", editingIsAdd ? 0 : a.id,
+                        a.hour, a.minute, a.duration, a.enabled);
+    editingIsAdd = false;
+    exitEdit();
+    break;
+  }
+  case ACT_DELETE_ALARM:
+    deleteAlarmFromESPByIndex(editIndex);
+    alarms = Alarm::getAll(alarmCount);
+    exitEdit();
+    pageStart = 0;
+    cursorPos = 0;
+    break;
+  case ACT_SAVE_SENSOR:
+    publishSensorFromESP(sensors[editIndex]);
+    sensors[editIndex].pending = true;
+    sensors[editIndex].isTemporary = false;
+    Persistence::markDirty(PERSIST_SENSORS);
+    exitEdit();
+    break;
+  case ACT_CANCEL:
+    exitEdit();
+    break;
+  }
+}
+
+void DisplayAlarm::enterEdit(uint16_t index)
+{
+  inEdit = true;
+  editIndex = index;
+  editRow = 0;
+  valueEditing = false;
+  valueCursor = 0;
+}
+
+void DisplayAlarm::exitEdit()
+{
+  inEdit = false;
+  valueEditing = false;
+  editRow = 0;
+}
+
+uint8_t *DisplayAlarm::record() const
+{
+  if (EDIT_PAGES[currentPage].record == REC_ALARM)
+    return (uint8_t *)&alarms[editIndex];
+  return (uint8_t *)&sensors[editIndex];
+}
+
+// Desimal nilai MV_FLOAT: dari jenis sensor yang sedang diedit
+uint8_t DisplayAlarm::decimals() const
+{
+  if (EDIT_PAGES[currentPage].record != REC_SENSOR)
+    return 0;
+  return SENSOR_INFO[sensors[editIndex].type].decimals;
 }
@@ -7,82 +7,91 @@
 #include "Config.h"
 #include "Alarm.h"
 #include "ReadSensor.h"
+#include "ButtonHandler.h"
+#include "MenuTable.h"
 #include <RTClib.h>
 
-#define MAX_ALARMS 10
-#define DEBOUNCE_MS 200
-
-enum EditField
-{
-  F_TIME,
-  F_DURATION,
-  F_SAVE,
-  F_DELETE
-};
-enum EditSensorField
-{
-  F_S_MINMAX,
-  F_S_STATUS,
-  F_S_SAVE,
-  F_S_BACK
-};
 enum Page
 {
   PAGE_ALARM,
   PAGE_SENSOR
 };
+// Event yang membuat tampilan basi; tiap halaman mendaftarkan miliknya
+enum UiEvent : uint8_t
+{
+  UI_EV_INPUT = 1 << 0,  // tombol ditekan
+  UI_EV_SENSOR = 1 << 1, // snapshot sensor baru
+  UI_EV_SECOND = 1 << 2, // detik Clock berganti
+  UI_EV_ALARMS = 1 << 3, // isi tabel alarm berubah
+  UI_EV_ALL = 0xFF
+};
 
 class DisplayAlarm
 {
 public:
   DisplayAlarm();
+  // Render hanya jika ada event yang membuat halaman aktif basi
   void loop();
   void reloadAlarms();
+  // Dipanggil tiap compute sensor (1 detik): cek batas + UI_EV_SENSOR
+  void onSensorSnapshot(const SensorSnapshot &s);
+  // ms sampai loop() perlu dipanggil lagi (tombol, frame tertunda)
+  uint32_t idleMs() const;
 
 private:
+  struct View
+  {
+    void (DisplayAlarm::*render)();
+    uint8_t invalidatedBy; // gabungan UiEvent
+  };
+  static const View VIEWS[4];
+
   // core
-  void renderMenu(const DateTime &now);
-  void readButtons();
+  uint8_t currentView() const;
+  void renderMenu();
+  void readButtons(const ButtonState &btn);
 
   // rendering
-  void renderAlarmPage(const DateTime &now);
+  void renderAlarmPage();
   void renderSensorPage();
-  void renderSetAlarm(const DateTime &now);
-  void renderSetSensor();
-  void renderEditPage(
-      const char *titleFmt,
-      uint8_t totalFields,
-      uint8_t fieldCursor,
-      bool valueEditing,
-      bool isSensor);
+  void renderEdit();
+  void formatValue(const MenuValue &v, const uint8_t *rec, char *out, size_t n) const;
+
+  // engine menu edit (MenuTable.h)
+  void editInput(const ButtonState &btn);
+  void stepValue(const MenuValue &v, uint8_t *rec, int8_t dir);
+  void runAction(MenuAction action);
+  void enterEdit(uint16_t index);
+  void exitEdit();
+  uint8_t *record() const;
+  uint8_t decimals() const;
 
   // data
   AlarmData *alarms = nullptr;
-  uint8_t alarmCount = 0;
+  uint16_t alarmCount = 0;
   SensorSetting *sensors = nullptr;
   uint8_t sensorCount = 4;
 
-  // edit state alarm
+  // edit state: baris field/aksi, lalu nilai di dalam field
   bool inEdit = false;
-  uint8_t editIndex = 0;
-  EditField editField = F_TIME;
-  bool timeEditing = false;
-  uint8_t timeCursor = 0;
+  uint16_t editIndex = 0;
+  uint8_t editRow = 0;
+  bool valueEditing = false;
+  uint8_t valueCursor = 0;
   bool editingIsAdd = false;
 
-  // edit state sensor
-  EditSensorField editSensorField = F_S_MINMAX;
-  bool sensorEditing = false;
-  uint8_t sensorCursor = 0;
-
   // navigation
   Page currentPage = PAGE_SENSOR; // default to sensor page
-  uint8_t pageStart = 0;
+  uint16_t pageStart = 0;
   uint8_t cursorPos = 0;
 
-  // debounce
-  unsigned long lastDebounce = 0;
   bool lastInEdit = false;
+
+  // event
+  uint8_t pendingEvents = UI_EV_ALL;
+  uint32_t lastSecond = 0;
+  uint32_t alarmRevision = 0;
+  SensorSnapshot snapshot = {};
 };
 
 #endif // DISPLAY_ALARM_H
@@ -0,0 +1,108 @@
+// MenuTable.h
+#ifndef MENU_TABLE_H
+#define MENU_TABLE_H
+
+#include <stddef.h>
+#include "Alarm.h"
+#include "ReadSensor.h"
+
+// Deskripsi menu edit: halaman → baris field → nilai. Semua konstan
+// (flash); DisplayAlarm hanya menafsirkannya. Menambah field/sensor cukup
+// dengan menambah entri di sini.
+
+enum MenuValueType : uint8_t
+{
+  MV_U8,    // uint8_t, wrap lo..hi
+  MV_INT,   // int, wrap lo..hi
+  MV_BOOL,  // ON/OFF, naik/turun = toggle
+  MV_FLOAT  // float, clamp lo..hi; desimal & step dari SENSOR_INFO
+};
+
+struct MenuValue
+{
+  MenuValueType type;
+  uint8_t offset;  // offsetof di record (AlarmData / SensorSetting)
+  char sep;        // ditulis sebelum nilai, 0 = tidak ada
+  int16_t lo, hi;
+  const char *fmt; // MV_U8 / MV_INT
+};
+
+struct MenuField
+{
+  const char *label;
+  uint8_t first, count; // nilai di MENU_VALUES
+  bool direct;          // kiri/kanan langsung mengubah nilai pertama
+                        // (tanpa SELECT masuk mode edit)
+};
+
+enum MenuRecord : uint8_t
+{
+  REC_ALARM,
+  REC_SENSOR
+};
+
+enum MenuAction : uint8_t
+{
+  ACT_SAVE_ALARM,
+  ACT_DELETE_ALARM,
+  ACT_SAVE_SENSOR,
+  ACT_CANCEL
+};
+
+// Halaman edit: baris field lalu satu baris berisi dua aksi berdampingan
+struct EditPage
+{
+  MenuRecord record;
+  const char *title; // printf: nomor alarm / nama sensor
+  uint8_t first, count; // field di MENU_FIELDS
+  const char *actionLabel[2];
+  MenuAction action[2];
+};
+
+struct SensorInfo
+{
+  const char *label; // halaman monitor (maks 9 karakter)
+  const char *title; // judul halaman edit
+  const char *unit;
+  uint8_t snapshotOffset; // offsetof di SensorSnapshot
+  uint8_t decimals;       // tampilan & step batas min/max
+};
+
+// Indeks = SensorType = urutan Sensor::getAllSettings()
+static constexpr SensorInfo SENSOR_INFO[] = {
+    {"Suhu", "Temperature", "C", offsetof(SensorSnapshot, temperature), 0},
+    {"Turbidity", "Turbidity", "%", offsetof(SensorSnapshot, turbidity), 0},
+    {"TDS", "TDS", "ppm", offsetof(SensorSnapshot, tds), 0},
+    {"pH", "pH", "", offsetof(SensorSnapshot, ph), 1},
+};
+#define SENSOR_INFO_COUNT (sizeof(SENSOR_INFO) / sizeof(SENSOR_INFO[0]))
+static_assert(SENSOR_INFO_COUNT == S_PH + 1, "SENSOR_INFO harus mencakup semua SensorType");
+
+static constexpr MenuValue MENU_VALUES[] = {
+    // 0..2: Time:HH:MM ON
+    {MV_U8, offsetof(AlarmData, hour), 0, 0, 23, "%02d"},
+    {MV_U8, offsetof(AlarmData, minute), ':', 0, 59, "%02d"},
+    {MV_BOOL, offsetof(AlarmData, enabled), ' ', 0, 1, nullptr},
+    // 3: Dur:xxs
+    {MV_INT, offsetof(AlarmData, duration), 0, 0, 99, "%2ds"},
+    // 4..5: Min|Max:min|max
+    {MV_FLOAT, offsetof(SensorSetting, minValue), 0, 0, 9999, nullptr},
+    {MV_FLOAT, offsetof(SensorSetting, maxValue), '|', 0, 9999, nullptr},
+    // 6: Stat:ON
+    {MV_BOOL, offsetof(SensorSetting, enabled), 0, 0, 1, nullptr},
+};
+
+static constexpr MenuField MENU_FIELDS[] = {
+    {"Time:", 0, 3, false},
+    {"Dur:", 3, 1, true},
+    {"Min|Max:", 4, 2, false},
+    {"Stat:", 6, 1, true},
+};
+
+// Indeks = Page
+static constexpr EditPage EDIT_PAGES[] = {
+    {REC_ALARM, "Edit Alarm %d", 0, 2, {"Save", "Del"}, {ACT_SAVE_ALARM, ACT_DELETE_ALARM}},
+    {REC_SENSOR, "Edit %s", 2, 2, {"Save", "Back"}, {ACT_SAVE_SENSOR, ACT_CANCEL}},
+};
+
+#endif // MENU_TABLE_H
@@ -1,44 +1,27 @@
 #include "FileStorage.h"
-#include <LittleFS.h>
+#include "Storage.h"
 #include "Alarm.h"
 #include <Arduino.h>
 #include "Config.h"
 #include "ReadSensor.h"
-
-static const char *ALARM_FILE = "/alarms.bin";
-static const char *SENSOR_SETTINGS_FILE = "/sensor_settings.bin";
-static const char *DEVICEID_FILE = "/deviceid.txt";
-
-void initFS()
-{
-    if (!LittleFS.begin(true))
-    {
-        Serial.println("[FS] Mount failed");
-        while (1)
-            delay(1000);
-    }
-    Serial.println("[FS] Mounted successfully.");
-}
+#include "RecordLog.h"
+#include "Schema.h"
+#include "CalibStore.h"
 
 void saveAlarmsToFS() { Alarm::saveAll(); }
 void loadAlarmsFromFS() { Alarm::loadAll(); }
 
 void saveDeviceId(const char *id)
 {
-    File f = LittleFS.open(DEVICEID_FILE, "w");
-    if (f)
-    {
-        f.print(id);
-        f.close();
-    }
+    Storage::write(STORAGE_DEVICEID_FILE, (const uint8_t *)id, strlen(id));
 }
 
 void loadDeviceId(char *id, size_t len)
 {
     // id sudah berisi default
-    if (!LittleFS.exists(DEVICEID_FILE))
+    if (!Storage::mounted() || !Storage::fs().exists(STORAGE_DEVICEID_FILE))
         return;
-    File f = LittleFS.open(DEVICEID_FILE, "r");
+    File f = Storage::fs().open(STORAGE_DEVICEID_FILE, "r");
     if (!f)
         return;
 
@@ -71,19 +54,66 @@ void loadDeviceId(char *id, size_t len)
 // ================ KALIBRASI TDS ================ //
 TDSConfig Sensor::tdsConfig;
 
+// Kalibrasi disimpan di partisi "calib" (CalibStore). Log LittleFS hanya
+// sumber migrasi & cadangan untuk tabel partisi lama tanpa partisi calib
+// (mis. perangkat yang diperbarui lewat OTA). Satu record (key 0).
+static RecordLog calibLog(STORAGE_CALIB_LOG, 1, LEGACY_CALIB_SIZE, SCHEMA_CALIB, CALIB_RECORD_SIZE);
+
+static bool storeTDSConfig(const TDSConfig &c) {
+    CalibTables t = CalibStore::tables();
+    t.tdsSlope = c.slope;
+    t.tdsIntercept = c.intercept;
+    return CalibStore::update(t);
+}
+
+// Baca dari log / file lama; true jika ada kalibrasi tersimpan
+static bool loadTDSConfigFromFS(TDSConfig &out) {
+    if (!calibLog.begin()) return false;
+    uint8_t len;
+    uint8_t rec[CALIB_RECORD_SIZE];
+    const uint8_t *stored = calibLog.find(0, len);
+    if (stored) {
+        if (!decodeTDSConfig(calibLog.schema(), stored, len, out)) {
+            Serial.println("[FS] TDS calibration invalid, using defaults");
+            out = TDSConfig();
+        }
+        if (calibLog.schema() != SCHEMA_CALIB) {
+            calibLog.clear();
+            calibLog.stage(0, rec, encodeTDSConfig(out, rec));
+            calibLog.compact();
+        }
+        return true;
+    }
+    if (!Storage::fs().exists(STORAGE_LEGACY_CALIB)) return false;
+    File f = Storage::fs().open(STORAGE_LEGACY_CALIB, "r");
+    if (!f) return false;
+    uint8_t legacy[LEGACY_CALIB_SIZE];
+    size_t n = f.read(legacy, sizeof(legacy));
+    f.close();
+    if (n != sizeof(legacy) || !decodeTDSConfig(SCHEMA_LEGACY, legacy, sizeof(legacy), out))
+        out = TDSConfig();
+    if (calibLog.put(0, rec, encodeTDSConfig(out, rec)))
+        Storage::fs().remove(STORAGE_LEGACY_CALIB);
+    return true;
+}
+
 void Sensor::loadTDSConfig() {
-    if (!LittleFS.exists("/tds_calib.bin")) return;
-    File f = LittleFS.open("/tds_calib.bin", "r");
-    if (f) {
-        f.read((uint8_t*)&tdsConfig, sizeof(TDSConfig));
-        f.close();
+    CalibStore::begin();
+    if (CalibStore::stored()) {
+        tdsConfig.slope = CalibStore::tables().tdsSlope;
+        tdsConfig.intercept = CalibStore::tables().tdsIntercept;
+        return;
+    }
+    if (!loadTDSConfigFromFS(tdsConfig)) return;
+    // Migrasi sekali ke partisi; log dihapus agar tidak ada dua sumber
+    if (storeTDSConfig(tdsConfig)) {
+        Storage::fs().remove(STORAGE_CALIB_LOG);
+        Serial.println("[FS] TDS calibration migrated to calib partition");
     }
 }
 
 void Sensor::saveTDSConfig() {
-    File f = LittleFS.open("/tds_calib.bin", "w");
-    if (f) {
-        f.write((uint8_t*)&tdsConfig, sizeof(TDSConfig));
-        f.close();
-    }
+    if (storeTDSConfig(tdsConfig)) return;
+    uint8_t rec[CALIB_RECORD_SIZE];
+    calibLog.put(0, rec, encodeTDSConfig(tdsConfig, rec));
 }
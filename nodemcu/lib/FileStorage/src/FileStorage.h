@@ -3,7 +3,6 @@
 
 #include <Arduino.h>
 
-void initFS();
 void saveAlarmsToFS();
 void loadAlarmsFromFS();
 void saveDeviceId(const char* id);
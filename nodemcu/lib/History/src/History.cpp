@@ -0,0 +1,289 @@
+#include "History.h"
+#include <math.h>
+#include <rom/crc.h>
+
+// ts u32 | count u16 | (avg, min, max) i16 berskala × TS_CHANNELS | crc32
+static const uint8_t AGG_RECORD_SIZE = 6 + TS_CHANNELS * 6 + 4;
+static const int16_t AGG_NAN = INT16_MIN;
+
+struct Accum
+{
+  uint32_t bucket;
+  uint16_t n;
+  uint16_t nc[TS_CHANNELS]; // sampel finite per kanal
+  float sum[TS_CHANNELS];
+  float min[TS_CHANNELS];
+  float max[TS_CHANNELS];
+};
+
+struct Tier
+{
+  const char *path;
+  uint16_t seconds;
+  uint16_t slots;
+  uint32_t *writes;
+  Accum acc;
+};
+
+static HistoryStats counters = {};
+static uint32_t lastTs = 0;
+static Tier tiers[] = {
+    {STORAGE_HISTORY_MINUTE, HISTORY_1MIN, HISTORY_MINUTE_SLOTS, &counters.minuteWrites, {}},
+    {STORAGE_HISTORY_QUARTER, HISTORY_15MIN, HISTORY_QUARTER_SLOTS, &counters.quarterWrites, {}},
+};
+
+static uint8_t rawBuf[HISTORY_RAW_BLOCKS][HISTORY_RAW_BLOCK_SIZE];
+static uint32_t rawFirstTs[HISTORY_RAW_BLOCKS];
+static uint16_t rawCount[HISTORY_RAW_BLOCKS];
+static uint16_t rawBytes[HISTORY_RAW_BLOCKS];
+static uint8_t rawHead = 0;
+static bool rawStarted = false;
+static TimeSeriesEncoder rawEncoder;
+
+static void putU16(uint8_t *p, uint16_t v)
+{
+  p[0] = uint8_t(v);
+  p[1] = uint8_t(v >> 8);
+}
+
+static void putU32(uint8_t *p, uint32_t v)
+{
+  for (uint8_t i = 0; i < 4; i++)
+    p[i] = uint8_t(v >> (8 * i));
+}
+
+static uint16_t getU16(const uint8_t *p)
+{
+  return uint16_t(p[0] | (p[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t *p)
+{
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+static int16_t quantize16(float v, float scale)
+{
+  if (!isfinite(v))
+    return AGG_NAN;
+  long q = lroundf(v * scale);
+  return int16_t(q > 32767 ? 32767 : (q < -32767 ? -32767 : q));
+}
+
+static float dequantize16(int16_t q, float scale)
+{
+  return q == AGG_NAN ? NAN : float(q) / scale;
+}
+
+// ─── Agregat ─────────────────────────────────────────────────
+static void encodeAgg(const Accum &a, uint8_t *out)
+{
+  putU32(out, a.bucket);
+  putU16(out + 4, a.n);
+  for (uint8_t c = 0; c < TS_CHANNELS; c++)
+  {
+    uint8_t *p = out + 6 + c * 6;
+    float avg = a.nc[c] ? a.sum[c] / a.nc[c] : NAN;
+    putU16(p, uint16_t(quantize16(avg, TS_SENSOR_SCALE[c])));
+    putU16(p + 2, uint16_t(quantize16(a.nc[c] ? a.min[c] : NAN, TS_SENSOR_SCALE[c])));
+    putU16(p + 4, uint16_t(quantize16(a.nc[c] ? a.max[c] : NAN, TS_SENSOR_SCALE[c])));
+  }
+  putU32(out + AGG_RECORD_SIZE - 4, crc32_le(0, out, AGG_RECORD_SIZE - 4));
+}
+
+// Slot berisi bucket lain (sudah tertimpa / belum pernah ditulis) ditolak
+static bool decodeAgg(const uint8_t *in, uint32_t bucket, HistoryRow &row)
+{
+  if (crc32_le(0, in, AGG_RECORD_SIZE - 4) != getU32(in + AGG_RECORD_SIZE - 4) ||
+      getU32(in) != bucket)
+    return false;
+  row.ts = bucket;
+  row.count = getU16(in + 4);
+  for (uint8_t c = 0; c < TS_CHANNELS; c++)
+  {
+    const uint8_t *p = in + 6 + c * 6;
+    row.avg[c] = dequantize16(int16_t(getU16(p)), TS_SENSOR_SCALE[c]);
+    row.min[c] = dequantize16(int16_t(getU16(p + 2)), TS_SENSOR_SCALE[c]);
+    row.max[c] = dequantize16(int16_t(getU16(p + 4)), TS_SENSOR_SCALE[c]);
+  }
+  return true;
+}
+
+// Bucket yang masih berjalan dibaca langsung dari akumulator
+static void accumToRow(const Accum &a, HistoryRow &row)
+{
+  row.ts = a.bucket;
+  row.count = a.n;
+  for (uint8_t c = 0; c < TS_CHANNELS; c++)
+  {
+    row.avg[c] = a.nc[c] ? a.sum[c] / a.nc[c] : NAN;
+    row.min[c] = a.nc[c] ? a.min[c] : NAN;
+    row.max[c] = a.nc[c] ? a.max[c] : NAN;
+  }
+}
+
+static void flushTier(Tier &t)
+{
+  if (!t.acc.n)
+    return;
+  uint8_t buf[AGG_RECORD_SIZE];
+  encodeAgg(t.acc, buf);
+  uint32_t slot = (t.acc.bucket / t.seconds) % t.slots;
+  if (Storage::writeAt(t.path, slot * AGG_RECORD_SIZE, buf, sizeof(buf)))
+    (*t.writes)++;
+  t.acc.n = 0;
+}
+
+static void accumulate(Tier &t, uint32_t ts, const float *v)
+{
+  uint32_t bucket = ts - ts % t.seconds;
+  if (t.acc.n && t.acc.bucket != bucket)
+    flushTier(t);
+  Accum &a = t.acc;
+  if (!a.n)
+  {
+    a = Accum{};
+    a.bucket = bucket;
+  }
+  a.n++;
+  for (uint8_t c = 0; c < TS_CHANNELS; c++)
+  {
+    if (!isfinite(v[c]))
+      continue;
+    if (!a.nc[c] || v[c] < a.min[c])
+      a.min[c] = v[c];
+    if (!a.nc[c] || v[c] > a.max[c])
+      a.max[c] = v[c];
+    a.sum[c] += v[c];
+    a.nc[c]++;
+  }
+}
+
+static uint8_t queryAgg(Tier &t, uint32_t &cursor, uint32_t end, HistoryRow *out, uint8_t max)
+{
+  // Lewati bucket di luar retensi tier dan yang belum terjadi
+  uint32_t span = uint32_t(t.slots - 1) * t.seconds;
+  if (lastTs > span && cursor < lastTs - span)
+    cursor = lastTs - span;
+  uint32_t stop = end;
+  uint32_t newest = lastTs - lastTs % t.seconds + t.seconds;
+  if (stop > newest)
+    stop = newest;
+
+  uint32_t b = cursor - cursor % t.seconds;
+  if (b < cursor)
+    b += t.seconds;
+
+  // Bucket yang baru ditutup mungkin masih antre di task storage
+  Storage::sync();
+  fs::File f = Storage::fs().open(t.path, "r");
+  uint8_t n = 0;
+  uint16_t scanned = 0;
+  uint8_t buf[AGG_RECORD_SIZE];
+  while (b < stop && n < max && scanned++ < HISTORY_SCAN_LIMIT)
+  {
+    if (t.acc.n && b == t.acc.bucket)
+      accumToRow(t.acc, out[n++]);
+    else if (f && f.seek(((b / t.seconds) % t.slots) * AGG_RECORD_SIZE) &&
+             f.read(buf, sizeof(buf)) == sizeof(buf) && decodeAgg(buf, b, out[n]))
+      n++;
+    b += t.seconds;
+  }
+  if (f)
+    f.close();
+  cursor = b >= stop ? end : b;
+  return n;
+}
+
+// ─── Raw ─────────────────────────────────────────────────────
+static void addRaw(uint32_t ts, const float *v)
+{
+  TimeSeriesSample s{ts, {v[0], v[1], v[2], v[3]}};
+  if (!rawStarted || !rawEncoder.append(s))
+  {
+    if (rawStarted)
+      rawHead = (rawHead + 1) % HISTORY_RAW_BLOCKS;
+    if (rawCount[rawHead])
+      counters.rawBlocksEvicted++;
+    rawEncoder.begin(rawBuf[rawHead], HISTORY_RAW_BLOCK_SIZE, TS_SENSOR_SCALE);
+    rawFirstTs[rawHead] = ts;
+    rawStarted = true;
+    rawEncoder.append(s);
+  }
+  rawCount[rawHead] = rawEncoder.count();
+  rawBytes[rawHead] = uint16_t(rawEncoder.bytes());
+}
+
+static uint8_t queryRaw(uint32_t &cursor, uint32_t end, HistoryRow *out, uint8_t max)
+{
+  uint8_t n = 0;
+  // Dari blok tertua (setelah head) sampai blok yang sedang diisi
+  for (uint8_t k = 1; k <= HISTORY_RAW_BLOCKS; k++)
+  {
+    uint8_t i = (rawHead + k) % HISTORY_RAW_BLOCKS;
+    if (!rawCount[i])
+      continue;
+    if (rawFirstTs[i] >= end)
+      break;
+    uint8_t next = (i + 1) % HISTORY_RAW_BLOCKS;
+    // Seluruh blok sebelum cursor jika blok berikutnya juga dimulai sebelum cursor
+    if (i != rawHead && rawCount[next] && rawFirstTs[next] <= cursor)
+      continue;
+
+    TimeSeriesDecoder dec;
+    dec.begin(rawBuf[i], rawBytes[i], TS_SENSOR_SCALE);
+    TimeSeriesSample s;
+    for (uint16_t q = 0; q < rawCount[i] && dec.next(s); q++)
+    {
+      if (s.ts < cursor)
+        continue;
+      if (s.ts >= end)
+      {
+        cursor = end;
+        return n;
+      }
+      if (n >= max)
+        return n;
+      HistoryRow &row = out[n++];
+      row.ts = s.ts;
+      row.count = 1;
+      for (uint8_t c = 0; c < TS_CHANNELS; c++)
+        row.avg[c] = row.min[c] = row.max[c] = s.v[c];
+      cursor = s.ts + 1;
+    }
+  }
+  cursor = end;
+  return n;
+}
+
+// ─── API ─────────────────────────────────────────────────────
+void History::add(uint32_t ts, float tds, float ph, float turbidity, float temperature)
+{
+  const float v[TS_CHANNELS] = {tds, ph, turbidity, temperature};
+  counters.samples++;
+  lastTs = ts;
+  addRaw(ts, v);
+  for (Tier &t : tiers)
+    accumulate(t, ts, v);
+}
+
+uint8_t History::query(uint16_t resolution, uint32_t &cursor, uint32_t end,
+                       HistoryRow *out, uint8_t max)
+{
+  if (!max || cursor >= end)
+    return 0;
+  if (resolution == HISTORY_RAW)
+    return queryRaw(cursor, end, out, max);
+  for (Tier &t : tiers)
+  {
+    if (t.seconds == resolution && Storage::mounted())
+      return queryAgg(t, cursor, end, out, max);
+  }
+  cursor = end; // resolusi tidak dikenal / tanpa storage
+  return 0;
+}
+
+const HistoryStats &History::stats()
+{
+  return counters;
+}
@@ -0,0 +1,61 @@
+// History.h
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <Arduino.h>
+#include "Storage.h"
+#include "TimeSeries.h"
+
+// Tier raw: sampel 1 Hz terkompresi di RAM (80 × 256 B ≈ 20 KB, ±1 jam),
+// hilang saat reboot. Tier agregat di LittleFS, slot = (ts / detik) % jumlah
+// slot, jadi rentang waktu langsung dipetakan ke offset file tanpa indeks.
+#define HISTORY_RAW_BLOCKS      80
+#define HISTORY_RAW_BLOCK_SIZE  256
+#define HISTORY_MINUTE_SLOTS    1440 // 1 menit × 24 jam
+#define HISTORY_QUARTER_SLOTS   2880 // 15 menit × 30 hari
+#define HISTORY_PAGE_ROWS       8    // baris per HISTORY_PAGE (muat di MQTT_MAX_PACKET_SIZE)
+#define HISTORY_SCAN_LIMIT      96   // slot agregat yang diperiksa per query() agar loop() tetap responsif
+
+enum HistoryResolution : uint16_t
+{
+  HISTORY_RAW = 0,
+  HISTORY_1MIN = 60,
+  HISTORY_15MIN = 900
+};
+
+// Raw: count = 1 dan min = max = avg
+struct HistoryRow
+{
+  uint32_t ts; // awal bucket (UTC)
+  uint16_t count;
+  float avg[TS_CHANNELS];
+  float min[TS_CHANNELS];
+  float max[TS_CHANNELS];
+};
+
+struct HistoryStats
+{
+  uint32_t samples;
+  uint32_t minuteWrites;
+  uint32_t quarterWrites;
+  uint32_t rawBlocksEvicted;
+};
+
+// Riwayat multi-resolusi di perangkat. Agregat 1 menit dan 15 menit
+// dihitung bertahap dari setiap sampel (sum/min/max berjalan) dan ditulis
+// satu kali saat bucket berganti.
+class History
+{
+public:
+  static void add(uint32_t ts, float tds, float ph, float turbidity, float temperature);
+
+  // Baca baris dengan ts di [cursor, end) pada resolusi tsb, maks max baris.
+  // cursor maju melewati yang sudah dibaca/diperiksa; query selesai jika
+  // cursor >= end. Bisa mengembalikan 0 baris sebelum selesai (batas scan).
+  static uint8_t query(uint16_t resolution, uint32_t &cursor, uint32_t end,
+                       HistoryRow *out, uint8_t max);
+
+  static const HistoryStats &stats();
+};
+
+#endif // HISTORY_H
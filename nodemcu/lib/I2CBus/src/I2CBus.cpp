@@ -0,0 +1,150 @@
+#include "I2CBus.h"
+#include "Config.h"
+#include <Wire.h>
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#endif
+
+struct I2cJob
+{
+  I2cJobFn fn;
+  void *ctx;
+  uint32_t submitUs;
+  bool *result;         // job sinkron: hasil untuk pemanggil
+  void *waiter;         // TaskHandle_t pemanggil run(), nullptr = post()
+};
+
+static const uint32_t DEVICE_HZ[I2C_DEVICES] = {I2C_RTC_HZ, I2C_LCD_HZ};
+static uint32_t busHz = 0;
+static I2cBusStats counters = {};
+
+static bool execute(I2cDevice dev, const I2cJob &job)
+{
+  uint32_t start = micros();
+  if (start - job.submitUs > counters.maxWaitUs[dev])
+    counters.maxWaitUs[dev] = start - job.submitUs;
+  if (busHz != DEVICE_HZ[dev])
+  {
+    Wire.setClock(DEVICE_HZ[dev]);
+    busHz = DEVICE_HZ[dev];
+    counters.clockSwitches++;
+  }
+  bool ok = job.fn(job.ctx);
+  for (uint8_t i = 0; !ok && i < I2C_RETRIES; i++)
+  {
+    counters.retries++;
+    ok = job.fn(job.ctx);
+  }
+  if (!ok)
+    counters.errors++;
+  counters.jobs[dev]++;
+  counters.busyUs += micros() - start;
+  return ok;
+}
+
+#ifdef ARDUINO
+static QueueHandle_t queues[I2C_DEVICES] = {};
+static TaskHandle_t busTaskHandle = nullptr;
+static volatile bool executing = false;
+
+static void busTask(void *)
+{
+  I2cJob job;
+  for (;;)
+  {
+    // Antrian diperiksa urut prioritas setiap kali, jadi job RTC yang masuk
+    // selagi LCD mengirim langsung dapat giliran berikutnya
+    executing = true; // sebelum antrian kosong terlihat oleh idle()
+    uint8_t dev = 0;
+    while (dev < I2C_DEVICES && xQueueReceive(queues[dev], &job, 0) != pdTRUE)
+      dev++;
+    if (dev == I2C_DEVICES)
+    {
+      executing = false;
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      continue;
+    }
+    bool ok = execute(I2cDevice(dev), job);
+    if (job.waiter)
+    {
+      *job.result = ok;
+      xTaskNotifyGive((TaskHandle_t)job.waiter);
+    }
+  }
+}
+#endif
+
+void I2CBus::begin()
+{
+  // Mulai di clock LCD: RTC hanya dibaca sesekali (lihat Clock)
+  Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN, I2C_LCD_HZ);
+  busHz = I2C_LCD_HZ;
+#ifdef ARDUINO
+  if (busTaskHandle)
+    return;
+  for (uint8_t i = 0; i < I2C_DEVICES; i++)
+    queues[i] = xQueueCreate(I2C_QUEUE_LEN, sizeof(I2cJob));
+  // Core 1 bersama loop(); prioritas lebih tinggi supaya transaksi yang
+  // sudah diantrikan tidak tertahan oleh loop()
+  xTaskCreatePinnedToCore(busTask, "i2c", 3072, nullptr, 2, &busTaskHandle, 1);
+#endif
+}
+
+bool I2CBus::run(I2cDevice dev, I2cJobFn fn, void *ctx)
+{
+  bool ok = false;
+  I2cJob job{fn, ctx, uint32_t(micros()), &ok, nullptr};
+#ifdef ARDUINO
+  // Dari task bus sendiri (job memanggil run) langsung dijalankan
+  if (busTaskHandle && xTaskGetCurrentTaskHandle() != busTaskHandle)
+  {
+    job.waiter = xTaskGetCurrentTaskHandle();
+    xQueueSend(queues[dev], &job, portMAX_DELAY);
+    xTaskNotifyGive(busTaskHandle);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return ok;
+  }
+#endif
+  return execute(dev, job);
+}
+
+bool I2CBus::post(I2cDevice dev, I2cJobFn fn, void *ctx)
+{
+  I2cJob job{fn, ctx, uint32_t(micros()), nullptr, nullptr};
+#ifdef ARDUINO
+  if (busTaskHandle)
+  {
+    if (xQueueSend(queues[dev], &job, 0) != pdTRUE)
+      return false;
+    xTaskNotifyGive(busTaskHandle);
+    return true;
+  }
+#endif
+  execute(dev, job);
+  return true;
+}
+
+bool I2CBus::idle()
+{
+#ifdef ARDUINO
+  if (busTaskHandle)
+  {
+    if (executing)
+      return false;
+    for (uint8_t i = 0; i < I2C_DEVICES; i++)
+    {
+      if (uxQueueMessagesWaiting(queues[i]))
+        return false;
+    }
+  }
+#endif
+  return true;
+}
+
+const I2cBusStats &I2CBus::stats()
+{
+  return counters;
+}
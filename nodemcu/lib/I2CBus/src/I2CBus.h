@@ -0,0 +1,57 @@
+// I2CBus.h
+#ifndef I2CBUS_H
+#define I2CBUS_H
+
+#include <Arduino.h>
+
+// Perangkat di bus, urut prioritas: job RTC selalu didahulukan dari LCD
+enum I2cDevice : uint8_t
+{
+  I2C_DEV_RTC, // DS3231, fast mode 400 kHz
+  I2C_DEV_LCD, // backpack PCF8574, maks 100 kHz (datasheet)
+  I2C_DEVICES
+};
+
+#define I2C_RTC_HZ 400000UL
+#define I2C_LCD_HZ 100000UL
+#define I2C_QUEUE_LEN 4 // job yang menunggu per perangkat
+#define I2C_RETRIES 2   // percobaan ulang jika job mengembalikan false
+
+// Satu transaksi (atau beberapa yang harus berurutan). false = gagal,
+// job diulang maksimal I2C_RETRIES kali.
+typedef bool (*I2cJobFn)(void *ctx);
+
+struct I2cBusStats
+{
+  uint32_t jobs[I2C_DEVICES];
+  uint32_t retries;
+  uint32_t errors;        // gagal setelah semua percobaan
+  uint32_t clockSwitches; // Wire.setClock saat ganti perangkat
+  uint32_t maxWaitUs[I2C_DEVICES]; // antre sebelum job mulai
+  uint64_t busyUs;        // total waktu bus dipakai (utilisasi)
+};
+
+// Satu-satunya pemilik Wire: semua akses I2C dijalankan task "i2c" dari
+// dua antrian (RTC lalu LCD), dengan clock bus disesuaikan per perangkat.
+// Sebelum begin() dan di host (tanpa ARDUINO) job dijalankan langsung.
+class I2CBus
+{
+public:
+  static void begin();
+  // Jalankan job dan tunggu hasilnya
+  static bool run(I2cDevice dev, I2cJobFn fn, void *ctx);
+  // Versi lambda (boleh capture): I2CBus::run(I2C_DEV_RTC, [&] { ... });
+  template <typename F>
+  static bool run(I2cDevice dev, F fn)
+  {
+    return run(dev, [](void *ctx) { return (*static_cast<F *>(ctx))(); }, &fn);
+  }
+  // Antrikan tanpa menunggu; ctx harus tetap hidup sampai job jalan.
+  // false jika antrian penuh.
+  static bool post(I2cDevice dev, I2cJobFn fn, void *ctx);
+  // Tidak ada job antre / berjalan (aman untuk light sleep)
+  static bool idle();
+  static const I2cBusStats &stats();
+};
+
+#endif // I2CBUS_H
@@ -6,15 +6,61 @@
 #include "MQTT.h"
 #include <PubSubClient.h>
 #include <WiFi.h>
-#include <WiFiClientSecure.h>
+#include "TlsClient.h"
 #include <ArduinoJson.h>
 #include "Alarm.h"
 #include "ReadSensor.h"
 #include "Config.h"
-
-static WiFiClientSecure secureClient;
+#include "Outbox.h"
+#include "Persistence.h"
+#include "Storage.h"
+#include "TelemetryLog.h"
+#include "History.h"
+#include "Actuator.h"
+#include "Clock.h"
+#include "Power.h"
+#include "MQTTCommands.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+
+// secureClient & mqttClient hanya boleh disentuh oleh mqttTask()
+static TlsClient secureClient;
 static PubSubClient mqttClient(secureClient);
 static String deviceId;
+
+// ─── Connection manager (FreeRTOS task) ─────────────────────
+// Task ini memegang socket: DNS, TCP, TLS handshake, mqttClient.loop() dan
+// publish dari Outbox. Pesan masuk di-parse di task ini lalu diantrikan;
+// loop() menjalankan handler lewat loopMQTT() dengan batas waktu per iterasi,
+// jadi broker yang mati tidak pernah memblokir tombol, LCD maupun alarm.
+enum MqttConnState : uint8_t
+{
+  MQ_WAIT_WIFI,
+  MQ_CONNECTING,
+  MQ_CONNECTED,
+  MQ_BACKOFF
+};
+
+static const uint8_t INBOUND_QUEUE_LEN = 8;
+static const unsigned long INBOUND_BUDGET_US = 4000;   // waktu handler per loop()
+static const unsigned long BACKOFF_MIN_MS = 1000;
+static const unsigned long BACKOFF_MAX_MS = 60000;
+static const unsigned long BACKOFF_STABLE_MS = 60000; // koneksi sepanjang ini dianggap pulih
+
+// Antrian perintah inbound (ring + mutex, bukan xQueue, supaya perintah
+// untuk record yang sama bisa di-coalesce di tempat)
+static SemaphoreHandle_t inboundMutex = nullptr;
+static InboundCommand inboundRing[INBOUND_QUEUE_LEN];
+static uint8_t inboundHead = 0;
+static uint8_t inboundCount = 0;
+static volatile uint32_t inboundCoalesced = 0;
+static TaskHandle_t mqttTaskHandle = nullptr;
+static volatile MqttConnState connState = MQ_WAIT_WIFI;
+static volatile bool connectedEvent = false;   // task → loop(): baru saja connect
+static volatile bool sensorBlinkEvent = false; // task → loop(): sensordata terkirim
+static volatile uint32_t inboundDropped = 0;
 static bool blinkActive = false;
 static uint8_t blinkTimes = 0;            // jumlah blink (nyala+mati = 1 blink)
 static uint8_t blinkCompleted = 0;        // jumlah blink yang sudah selesai
@@ -72,6 +118,10 @@ enum MessageId {
   SENSOR_SET,
   SENSOR_ACK,
   CALIBRATE,
+  MSG_ACK,
+  SENSOR_BATCH,
+  HISTORY,
+  CLOCK_STATUS,
   MESSAGE_COUNT
 };
 static const char* MESSAGE_NAMES[MESSAGE_COUNT] = {
@@ -80,7 +130,11 @@ static const char* MESSAGE_NAMES[MESSAGE_COUNT] = {
   "alarmack",
   "sensorset",
   "sensorack",
-  "calibrate"
+  "calibrate",
+  "msgack",
+  "sensorbatch",
+  "history",
+  "clockstatus"
 };
 
 // Helpers
@@ -90,74 +144,73 @@ bool sensorExists(SensorType t) {
   return false;
 }
 
-bool publishMessage(MessageId mid, const String& payload, bool retain) {
+// FNV-1a: kunci coalescing untuk pesan yang boleh saling menggantikan di Outbox
+static uint32_t outboxKey(const char* cmd, uint32_t id) {
+  uint32_t h = 2166136261u;
+  for (const char* p = cmd; *p; ++p) { h ^= uint8_t(*p); h *= 16777619u; }
+  for (uint8_t i = 0; i < 4; ++i) { h ^= uint8_t(id >> (8 * i)); h *= 16777619u; }
+  return h ? h : 1;
+}
+
+// Tulis satu entry Outbox ke broker (dipanggil dari Outbox::pump)
+static bool sendEntry(const OutboxEntry& e) {
   if (!mqttClient.connected()) return false;
-  String topic = String(TOPIC_PREFIX) + "/" + MESSAGE_NAMES[mid] + "/" + TOPIC_SUFFIX;
-  return mqttClient.publish(topic.c_str(),
-                            (const uint8_t*)payload.c_str(),
-                            payload.length(), retain);
-}
-
-// Forward declarations—all take JsonDocument&
-void handleAck(JsonDocument& doc);
-void handleCommands(JsonDocument& doc);
-void handleBackendAlarm(JsonDocument& doc);
-void handleSensorCommands(JsonDocument& doc);
-void handleTDSCalibration(JsonDocument& doc);
-// Central MQTT callback
-void mqttCallback(char* topic, byte* payload, unsigned int length) {
-  JsonDocument doc;  // uses -DMQTT_MAX_PACKET_SIZE for buffer
-  auto err = deserializeJson(doc, payload, length);
-  if (err) {
-    Serial.printf("[MQTT] JSON parse error: %s\n", err.c_str());
-    return;
+  String topic = String(TOPIC_PREFIX) + "/" + MESSAGE_NAMES[e.topic] + "/" + TOPIC_SUFFIX;
+  bool ok = mqttClient.publish(topic.c_str(),
+                               (const uint8_t*)e.payload.c_str(),
+                               e.payload.length(), e.retain);
+  if (ok && e.topic == SENSOR_DATA) {
+    Serial.print("[MQTT] Published sensor: ");
+    Serial.println(e.payload);
+    sensorBlinkEvent = true; // LED dikendalikan dari loop(), bukan dari task
   }
+  return ok;
+}
 
-  String cmd      = doc["cmd"].as<const char*>();
-  String from     = doc["from"].as<const char*>();
-  String incoming = doc["deviceId"].as<const char*>();
-  if (from != "BACKEND" || incoming != deviceId) return;
-
-  // ─── Bulk ALARM sync ─────────────────────────────────────
-if (cmd == "SYNC_ALARM") {
-  // 1) Parse backend array
-  JsonArray backendArr = doc["alarms"].as<JsonArray>();
+// Beri msgId, serialisasi, lalu antrikan. Pesan control ditahan di Outbox
+// sampai backend membalas ACK_MSG; telemetry cukup terkirim sekali.
+bool publishMessage(MessageId mid, JsonDocument& doc, bool retain, uint32_t key = 0) {
+  uint32_t msgId = Outbox::nextMsgId();
+  doc["msgId"] = msgId;
+  String out;
+  serializeJson(doc, out);
+  OutboxPriority prio = (mid == SENSOR_DATA || mid == CLOCK_STATUS) ? OUTBOX_TELEMETRY : OUTBOX_CONTROL;
+  return Outbox::push(mid, out, retain, prio, msgId, key);
+}
 
-  // 2) First: upsert everything the backend sent
-  for (JsonObject o : backendArr) {
-    uint16_t id   = o["id"].as<uint16_t>();
-    uint8_t h     = o["hour"].as<uint8_t>();
-    uint8_t m     = o["minute"].as<uint8_t>();
-    int dur       = o["duration"].as<int>();
-    bool en       = o["enabled"].as<bool>();
+// ────────── Handler definitions ───────────────────────────
 
-    if (Alarm::exists(id)) {
-      Alarm::edit(id, h, m, dur, en);
+// Bulk ALARM sync
+void handleSyncAlarm(const InboundCommand& cmd) {
+  // 1) First: upsert everything the backend sent
+  for (uint16_t k = 0; k < cmd.alarmListCount; ++k) {
+    const AlarmFields& o = cmd.alarmList[k];
+    if (Alarm::exists(o.id)) {
+      Alarm::edit(o.id, o.hour, o.minute, o.duration, o.enabled, o.days, o.channel);
     } else {
-      Alarm::add(id, h, m, dur, en);
+      Alarm::add(o.id, o.hour, o.minute, o.duration, o.enabled, o.days, o.channel);
     }
   }
-  Alarm::saveAll();
+  Persistence::markDirty(PERSIST_ALARMS);
 
-  // 3) For each local alarm, check if it was in the backend list
-  uint8_t localCnt;
+  // 2) For each local alarm, check if it was in the backend list
+  uint16_t localCnt;
   uint16_t nextTempIndex = 0;
 
   AlarmData* localArr = Alarm::getAll(localCnt);
-  for (uint8_t i = 0; i < localCnt; ++i) {
+  for (uint16_t i = 0; i < localCnt; ++i) {
     uint16_t localId = localArr[i].id;
     if (localId == 0) continue;              // skip temporaries
 
     bool found = false;
-    // scan backendArr for this id
-    for (JsonObject o : backendArr) {
-      if (o["id"].as<uint16_t>() == localId) {
+    for (uint16_t k = 0; k < cmd.alarmListCount; ++k) {
+      if (cmd.alarmList[k].id == localId) {
         found = true;
         break;
       }
     }
 
-    // 4) if not found: request add to backend
+    // 3) if not found: request add to backend
     if (!found) {
       JsonDocument req;
       req["cmd"]      = "REQUEST_ADD_ALARM";
@@ -168,256 +221,241 @@ if (cmd == "SYNC_ALARM") {
       a["minute"]     = localArr[i].minute;
       a["duration"]   = localArr[i].duration;
       a["enabled"]    = localArr[i].enabled;
+      a["days"]       = localArr[i].days;
+      a["channel"]    = localArr[i].channel;
       req["tempIndex"] = nextTempIndex++;
 
-      String out;
-      serializeJson(req, out);
-      publishMessage(ALARM_SET, out, false);
+      publishMessage(ALARM_SET, req, false);
       Serial.printf("[MQTT] REQUEST_ADD_ALARM for id=%u\n", localId);
     }
   }
 
-  // 5) Finally, send ACK_SYNC_ALARM
+  // 4) Finally, send ACK_SYNC_ALARM
   JsonDocument ack;
   ack["cmd"]      = "ACK_SYNC_ALARM";
   ack["from"]     = "ESP";
   ack["deviceId"] = deviceId;
   ack["status"]  = "OK";
-  {
-    String out;
-    serializeJson(ack, out);
-    publishMessage(ALARM_ACK, out, false);
-  }
-  return;
-}
-
-  // ─── Bulk SENSOR sync ───────────────────────────────────
-  if (cmd == "SYNC_SENSOR") {
-    auto arr = doc["sensors"].as<JsonArray>();
-    for (JsonObject o : arr) {
-      SensorSetting s{};
-      s.id          = o["id"].as<uint16_t>();
-      s.type        = SensorType(o["type"].as<uint8_t>());
-      s.minValue    = o["minValue"].as<float>();
-      s.maxValue    = o["maxValue"].as<float>();
-      s.enabled     = o["enabled"].as<bool>();
-      s.pending     = false;
-      s.isTemporary = false;
-
-      if (sensorExists(s.type)) {
-        uint8_t cnt; auto set = Sensor::getAllSettings(cnt);
-        for (uint8_t i = 0; i < cnt; ++i) {
-          if (set[i].type == s.type) {
-            set[i].minValue = s.minValue;
-            set[i].maxValue = s.maxValue;
-            set[i].enabled  = s.enabled;
-            break;
-          }
+  publishMessage(ALARM_ACK, ack, false);
+}
+
+// Bulk SENSOR sync
+void handleSyncSensor(const InboundCommand& cmd) {
+  for (uint8_t k = 0; k < cmd.sensorListCount; ++k) {
+    const SensorFields& o = cmd.sensorList[k];
+    SensorSetting s{};
+    s.id          = o.id;
+    s.type        = o.type;
+    s.minValue    = o.minValue;
+    s.maxValue    = o.maxValue;
+    s.enabled     = o.enabled;
+    s.pending     = false;
+    s.isTemporary = false;
+
+    if (sensorExists(s.type)) {
+      uint8_t cnt; auto set = Sensor::getAllSettings(cnt);
+      for (uint8_t i = 0; i < cnt; ++i) {
+        if (set[i].type == s.type) {
+          set[i].minValue = s.minValue;
+          set[i].maxValue = s.maxValue;
+          set[i].enabled  = s.enabled;
+          break;
         }
-      } else {
-        Sensor::addSetting(s);
       }
+    } else {
+      Sensor::addSetting(s);
     }
-    Sensor::saveAllSettings();
-    // send ACK_SYNC_SENSOR
-    JsonDocument ack;
-    ack["cmd"]      = "ACK_SYNC_SENSOR";
-    ack["from"]     = "ESP";
-    ack["deviceId"] = deviceId;
-    ack["status"]  = "OK";
-    String out; serializeJson(ack,out);
-    publishMessage(SENSOR_ACK,out,false);
-    return;
   }
+  Persistence::markDirty(PERSIST_SENSORS);
+  // send ACK_SYNC_SENSOR
+  JsonDocument ack;
+  ack["cmd"]      = "ACK_SYNC_SENSOR";
+  ack["from"]     = "ESP";
+  ack["deviceId"] = deviceId;
+  ack["status"]  = "OK";
+  publishMessage(SENSOR_ACK, ack, false);
+}
 
-  // ─── ACK_* handlers ─────────────────────────────────────
-  if (cmd.startsWith("ACK_")) {
-    handleAck(doc);
-    return;
-  }
+// Delivery ACK untuk pesan dari Outbox
+static uint32_t backfillMsgId = 0;   // batch telemetry offline yang menunggu ACK_MSG
+static unsigned long backfillSentMs = 0;
+
+// Query riwayat yang sedang dialirkan (satu aktif; query baru menggantikan)
+struct HistoryQuery {
+  bool active;
+  uint32_t queryId;
+  uint16_t resolution;
+  uint32_t cursor;
+  uint32_t end;
+  uint16_t page;
+  uint32_t msgId;            // HISTORY_PAGE yang menunggu ACK_MSG
+  unsigned long sentMs;
+};
+static HistoryQuery historyQuery = {};
 
-    if (cmd == "CALIBRATE_TDS") {
-    handleTDSCalibration(doc);
-    return;
+void handleAckMsg(const InboundCommand& cmd) {
+  Outbox::ack(cmd.msgId);
+  if (backfillMsgId && cmd.msgId == backfillMsgId) {
+    backfillMsgId = 0;
+    TelemetryLog::commit();
+  }
+  if (historyQuery.msgId && cmd.msgId == historyQuery.msgId) {
+    historyQuery.msgId = 0;
+    historyQuery.page++;
   }
-  // ─── Single‐item BACKEND commands ───────────────────────
-  handleCommands(doc);
 }
 
-// ────────── Handler definitions ───────────────────────────
-
-// ACK handler (alarms & sensors)
-void handleAck(JsonDocument& doc) {
-  String cmd = doc["cmd"].as<const char*>();
-
-  // Alarm ACKs: clear pending, then trySyncPending()
-  if (cmd.endsWith("ALARM")) {
-    uint8_t cnt; auto arr = Alarm::getAll(cnt);
-    if (cmd == "ACK_ADD_ALARM") {
-      auto newId    = doc["alarm"]["id"].as<uint16_t>();
-      auto tempIdx  = doc["tempIndex"].as<int>();
-      for (uint8_t i = 0; i < cnt; ++i) {
-        if (arr[i].isTemporary && arr[i].tempIndex == tempIdx) {
-          arr[i].id        = newId;
-          arr[i].isTemporary = false;
-          arr[i].pending   = false;
-          break;
-        }
-      }
-    } else if (cmd == "ACK_EDIT_ALARM" || cmd == "ACK_ENABLE_ALARM" || cmd == "ACK_DISABLE_ALARM") {
-      auto id = doc["alarm"]["id"].as<uint16_t>();
-      for (uint8_t i = 0; i < cnt; ++i) {
-        if (arr[i].id == id && arr[i].pending) {
-          arr[i].pending = false;
-                    arr[i].isTemporary = false;
-
-          break;
-        }
-      }
-    } else if (cmd == "ACK_DELETE_ALARM") {
-      auto id = doc["alarm"]["id"].as<uint16_t>();
-      for (uint8_t i = 0; i < cnt; ++i) {
-        if (arr[i].id == id && arr[i].pending) {
-          // shift left
-          for (uint8_t j = i; j + 1 < cnt; ++j) arr[j] = arr[j+1];
-          break;
-        }
-      }
-    }
-    Alarm::saveAll();
-    trySyncPending();
-  }
+void handleQueryHistory(const InboundCommand& cmd) {
+  if (historyQuery.active)
+    Serial.printf("[MQTT] History query %u replaced by %u\n",
+                  (unsigned)historyQuery.queryId, (unsigned)cmd.queryId);
+  // Halaman query lama yang belum di-ACK tidak perlu dikirim ulang lagi
+  if (historyQuery.msgId) Outbox::cancel(historyQuery.msgId);
+  historyQuery = HistoryQuery{};
+  historyQuery.active = cmd.rangeEnd > cmd.rangeStart;
+  historyQuery.queryId = cmd.queryId;
+  historyQuery.resolution = cmd.resolution;
+  historyQuery.cursor = cmd.rangeStart;
+  historyQuery.end = cmd.rangeEnd;
+}
 
-  // Sensor ACKs: clear pending, then trySyncSensorPending()
-  if (cmd.endsWith("SENSOR")) {
-    Serial.println("ACK_SENSOR GAESSSSSSSSSSSSSSSSSSSSSSSSSSSSSSSSSSSSS");
-    auto t = doc["sensor"]["type"].as<uint8_t>();
-    uint8_t cnt; auto arr = Sensor::getAllSettings(cnt);
-    for (uint8_t i = 0; i < cnt; ++i) {
-      if (arr[i].type == SensorType(t)) {
-        arr[i].pending = false;
-        arr[i].isTemporary = false;
+// Alarm ACKs: clear pending, then trySyncPending()
+void handleAlarmAck(const InboundCommand& cmd) {
+  uint16_t cnt; auto arr = Alarm::getAll(cnt);
+  AlarmData* a = nullptr;
+  switch (cmd.spec->id) {
+  case CMD_ACK_ADD_ALARM:
+    for (uint16_t i = 0; i < cnt; ++i) {
+      if (arr[i].isTemporary && arr[i].tempIndex == cmd.tempIndex) {
+        // ID sementara → ID backend (indeks id ikut diperbarui)
+        Alarm::confirmId(arr[i].id, cmd.alarm.id);
         break;
       }
     }
-    Sensor::saveAllSettings();
-    trySyncSensorPending();
+    break;
+  case CMD_ACK_EDIT_ALARM:
+  case CMD_ACK_ENABLE_ALARM:
+  case CMD_ACK_DISABLE_ALARM:
+    a = Alarm::find(cmd.alarm.id);
+    if (a && a->pending) {
+      a->pending     = false;
+      a->isTemporary = false;
+    }
+    break;
+  case CMD_ACK_DELETE_ALARM:
+    a = Alarm::find(cmd.alarm.id);
+    if (a && a->pending) Alarm::remove(cmd.alarm.id);
+    break;
+  default:
+    break;
   }
+  Persistence::markDirty(PERSIST_ALARMS);
+  trySyncPending();
 }
 
-// Single‐item BACKEND commands
-void handleCommands(JsonDocument& doc) {
-  String cmd = doc["cmd"].as<const char*>();
-
-  // ALARM commands
-  if (cmd.endsWith("ALARM")) {
-    handleBackendAlarm(doc);
-  }
-  // SET_SENSOR
-  else if (cmd == "SET_SENSOR") {
-    handleSensorCommands(doc);
+// Sensor ACKs: clear pending, then trySyncSensorPending()
+void handleSensorAck(const InboundCommand& cmd) {
+  uint8_t cnt; auto arr = Sensor::getAllSettings(cnt);
+  for (uint8_t i = 0; i < cnt; ++i) {
+    if (arr[i].type == cmd.sensor.type) {
+      arr[i].pending = false;
+      arr[i].isTemporary = false;
+      break;
+    }
   }
+  Persistence::markDirty(PERSIST_SENSORS);
+  trySyncSensorPending();
 }
 
 // ADD/EDIT/ENABLE/DISABLE/DELETE alarm
-void handleBackendAlarm(JsonDocument& doc) {
-  auto id      = doc["alarm"]["id"].as<uint16_t>();
-  auto hour    = doc["alarm"]["hour"].as<uint8_t>();
-  auto minute  = doc["alarm"]["minute"].as<uint8_t>();
-  auto duration= doc["alarm"]["duration"].as<int>();
-  auto enabled = doc["alarm"]["enabled"].as<bool>();
-
+void handleBackendAlarm(const InboundCommand& cmd) {
+  const AlarmFields& a = cmd.alarm;
   bool ok = false;
-  String ackCmd;
+  const char* ackCmd = "";
 
-  if (doc["cmd"] == "ADD_ALARM") {
-    ok     = Alarm::add(id,hour,minute,duration,enabled);
+  switch (cmd.spec->id) {
+  case CMD_ADD_ALARM:
+    ok     = Alarm::add(a.id, a.hour, a.minute, a.duration, a.enabled, a.days, a.channel);
     ackCmd = "ACK_ADD_ALARM";
-  }
-  else if (doc["cmd"] == "EDIT_ALARM") {
-    ok     = Alarm::edit(id,hour,minute,duration,enabled);
+    break;
+  case CMD_EDIT_ALARM:
+    ok     = Alarm::edit(a.id, a.hour, a.minute, a.duration, a.enabled, a.days, a.channel);
     ackCmd = "ACK_EDIT_ALARM";
-  }
-  else if (doc["cmd"] == "ENABLE_ALARM" || doc["cmd"] == "DISABLE_ALARM") {
-    if (!Alarm::exists(id)) {
+    break;
+  case CMD_ENABLE_ALARM:
+  case CMD_DISABLE_ALARM:
+    if (!Alarm::exists(a.id)) {
       ok = true;  // pretend
-      Serial.printf("[WARN] ENABLE_ALARM id=%u not found, but ACKing OK\n", id);
+      Serial.printf("[WARN] ENABLE_ALARM id=%u not found, but ACKing OK\n", a.id);
     } else {
-      ok = Alarm::enable(id,enabled);
+      ok = Alarm::enable(a.id, a.enabled);
     }
-    ackCmd = enabled ? "ACK_ENABLE_ALARM" : "ACK_DISABLE_ALARM";
-  }
-  else if (doc["cmd"] == "DELETE_ALARM") {
-    if (!Alarm::exists(id)) {
-      Serial.printf("[MQTT] Delete failed, alarm ID %u not found\n", id);
+    ackCmd = a.enabled ? "ACK_ENABLE_ALARM" : "ACK_DISABLE_ALARM";
+    break;
+  case CMD_DELETE_ALARM:
+    if (!Alarm::exists(a.id)) {
+      Serial.printf("[MQTT] Delete failed, alarm ID %u not found\n", a.id);
       return;
     }
-    ok     = Alarm::remove(id);
+    ok     = Alarm::remove(a.id);
     ackCmd = "ACK_DELETE_ALARM";
+    break;
+  default:
+    return;
   }
 
-  Alarm::saveAll();
+  Persistence::markDirty(PERSIST_ALARMS);
 
   // send alarm‐ACK
   JsonDocument ack;
   ack["cmd"]      = ackCmd;
   ack["from"]     = "ESP";
   ack["deviceId"] = deviceId;
-  ack["alarm"]["id"] = id;
+  ack["alarm"]["id"] = a.id;
   ack["status"]   = ok ? "OK" : "ERROR";
 
-  String out; serializeJson(ack,out);
-  publishMessage(ALARM_ACK,out,false);
+  publishMessage(ALARM_ACK, ack, false);
 
-  if (doc["cmd"] != "ADD_ALARM") {
+  if (cmd.spec->id != CMD_ADD_ALARM) {
     trySyncPending();
   }
 }
 
 // SET_SENSOR from backend
-void handleSensorCommands(JsonDocument& doc) {
-  auto type    = SensorType(doc["sensor"]["type"].as<uint8_t>());
-  auto minV    = doc["sensor"]["minValue"].as<float>();
-  auto maxV    = doc["sensor"]["maxValue"].as<float>();
-  auto enabled = doc["sensor"]["enabled"].as<bool>();
-
+void handleSetSensor(const InboundCommand& cmd) {
+  const SensorFields& in = cmd.sensor;
   uint8_t cnt; auto arr = Sensor::getAllSettings(cnt);
   bool applied = false;
   for (uint8_t i = 0; i < cnt; ++i) {
-    if (arr[i].type == type) {
-      arr[i].minValue = minV;
-      arr[i].maxValue = maxV;
-      arr[i].enabled  = enabled;
+    if (arr[i].type == in.type) {
+      arr[i].minValue = in.minValue;
+      arr[i].maxValue = in.maxValue;
+      arr[i].enabled  = in.enabled;
       arr[i].pending  = false;
       arr[i].isTemporary = false;
       applied = true;
       break;
     }
   }
-  Sensor::saveAllSettings();
-  Serial.printf("[MQTT] SET_SENSOR %s type=%u\n", applied?"applied":"not found", (uint8_t)type);
+  Persistence::markDirty(PERSIST_SENSORS);
+  Serial.printf("[MQTT] SET_SENSOR %s type=%u\n", applied?"applied":"not found", (uint8_t)in.type);
 
   // send sensor‐ACK
   JsonDocument ack;
   ack["cmd"]      = "ACK_SET_SENSOR";
   ack["from"]     = "ESP";
   ack["deviceId"] = deviceId;
-  ack["sensor"]["type"] = (uint8_t)type;
+  ack["sensor"]["type"] = (uint8_t)in.type;
   ack["status"]   = applied ? "OK" : "ERROR";
   ack["message"]  = applied ? "Applied" : "NotFound";
 
-  String out; serializeJson(ack,out);
-  publishMessage(SENSOR_ACK,out,false);
+  publishMessage(SENSOR_ACK, ack, false);
 }
 
 // ================ HANDLER KALIBRASI TDS ================
-void handleTDSCalibration(JsonDocument& doc) {
-
-    float knownTDS = doc["knownTDS"].as<float>();
-    float temperature = doc["temperature"].as<float>();
-    
+void handleTDSCalibration(const InboundCommand& cmd) {
     // Lakukan kalibrasi
-    Sensor::calibrateTDS(knownTDS, temperature);
+    Sensor::calibrateTDS(cmd.knownTDS, cmd.temperature);
     
     // Kirim konfirmasi
     JsonDocument ack;
@@ -431,61 +469,466 @@ void handleTDSCalibration(JsonDocument& doc) {
     ack["slope"] = config.slope;
     ack["intercept"] = config.intercept;
     
-    String out;
-    serializeJson(ack, out);
-    publishMessage(SENSOR_ACK, out, true);
+    publishMessage(SENSOR_ACK, ack, true);
     
     Serial.printf("[MQTT] TDS Calibrated: knownTDS=%.1f, temp=%.1f, new slope=%.2f\n", 
-                 knownTDS, temperature, config.slope);
+                 cmd.knownTDS, cmd.temperature, config.slope);
+}
+
+static void extractAlarm(JsonObject o, AlarmFields& a) {
+  a.id       = o["id"].as<uint16_t>();
+  a.hour     = o["hour"].as<uint8_t>();
+  a.minute   = o["minute"].as<uint8_t>();
+  a.duration = o["duration"].as<int>();
+  a.enabled  = o["enabled"].as<bool>();
+  a.days     = o["days"] | ALARM_EVERY_DAY;
+  a.channel  = o["channel"] | 0;
+}
+
+static void extractSensor(JsonObject o, SensorFields& s) {
+  s.id       = o["id"].as<uint16_t>();
+  s.type     = SensorType(o["type"].as<uint8_t>());
+  s.minValue = o["minValue"].as<float>();
+  s.maxValue = o["maxValue"].as<float>();
+  s.enabled  = o["enabled"].as<bool>();
+}
+
+bool parseCommand(const uint8_t* payload, unsigned int length, InboundCommand& out) {
+  out = InboundCommand{};
+  JsonDocument doc;  // uses -DMQTT_MAX_PACKET_SIZE for buffer
+  auto err = deserializeJson(doc, payload, length);
+  if (err) {
+    Serial.printf("[MQTT] JSON parse error: %s\n", err.c_str());
+    return false;
+  }
+
+  const char* from     = doc["from"] | "";
+  const char* incoming = doc["deviceId"] | "";
+  if (strcmp(from, "BACKEND") != 0 || strcmp(incoming, deviceId.c_str()) != 0) return false;
+
+  const char* name = doc["cmd"] | "";
+  const CommandSpec* spec = findCommand(COMMANDS, name);
+  if (!spec) {
+    Serial.printf("[MQTT] Unknown command '%s'\n", name);
+    return false;
+  }
+  out.spec = spec;
+
+  if (spec->fields & CF_ALARM)       extractAlarm(doc["alarm"].as<JsonObject>(), out.alarm);
+  if (spec->fields & CF_SENSOR)      extractSensor(doc["sensor"].as<JsonObject>(), out.sensor);
+  if (spec->fields & CF_TEMP_INDEX)  out.tempIndex = doc["tempIndex"].as<int>();
+  if (spec->fields & CF_MSG_ID)      out.msgId = doc["msgId"].as<uint32_t>();
+  if (spec->fields & CF_CALIBRATION) {
+    out.knownTDS    = doc["knownTDS"].as<float>();
+    out.temperature = doc["temperature"].as<float>();
+  }
+  if (spec->fields & CF_HISTORY) {
+    out.queryId    = doc["queryId"].as<uint32_t>();
+    out.rangeStart = doc["start"].as<uint32_t>();
+    out.rangeEnd   = doc["end"].as<uint32_t>();
+    out.resolution = doc["resolution"].as<uint16_t>();
+  }
+  if (spec->fields & CF_ALARM_LIST) {
+    JsonArray arr = doc["alarms"].as<JsonArray>();
+    if (arr.size() > 0) {
+      out.alarmList = (AlarmFields*)malloc(arr.size() * sizeof(AlarmFields));
+      if (!out.alarmList) return false;
+      for (JsonObject o : arr) extractAlarm(o, out.alarmList[out.alarmListCount++]);
+    }
+  }
+  if (spec->fields & CF_SENSOR_LIST) {
+    JsonArray arr = doc["sensors"].as<JsonArray>();
+    size_t n = arr.size() < MAX_SENSOR_SETTINGS ? arr.size() : MAX_SENSOR_SETTINGS;
+    if (n > 0) {
+      out.sensorList = (SensorFields*)malloc(n * sizeof(SensorFields));
+      if (!out.sensorList) return false;
+      for (JsonObject o : arr) {
+        if (out.sensorListCount >= n) break;
+        extractSensor(o, out.sensorList[out.sensorListCount++]);
+      }
+    }
+  }
+  return true;
+}
+
+void freeCommand(InboundCommand& cmd) {
+  free(cmd.alarmList);
+  free(cmd.sensorList);
+  cmd.alarmList = nullptr;
+  cmd.sensorList = nullptr;
+  cmd.alarmListCount = cmd.sensorListCount = 0;
+}
+
+// Kunci record yang disentuh perintah: domain (1 = alarm, 2 = sensor) di
+// byte atas, id/type di bawah. List (SYNC_*) menyentuh seluruh domain.
+static uint32_t recordKey(const InboundCommand& cmd, bool& wholeDomain) {
+  uint8_t f = cmd.spec->fields;
+  wholeDomain = f & (CF_ALARM_LIST | CF_SENSOR_LIST);
+  if (f & (CF_ALARM | CF_ALARM_LIST))   return (1u << 24) | (wholeDomain ? 0 : cmd.alarm.id);
+  if (f & (CF_SENSOR | CF_SENSOR_LIST)) return (2u << 24) | (wholeDomain ? 0 : uint8_t(cmd.sensor.type));
+  return 0;
+}
+
+// Konteks mqttTask. Perintah coalesce menggantikan entry antri terbaru yang
+// menyentuh record sama, asalkan entry itu perintah yang sama (urutan terhadap
+// perintah lain untuk record tsb tetap terjaga).
+static bool enqueueCommand(InboundCommand& cmd) {
+  xSemaphoreTake(inboundMutex, portMAX_DELAY);
+  bool whole;
+  uint32_t key = recordKey(cmd, whole);
+  if (key) {
+    for (int8_t n = int8_t(inboundCount) - 1; n >= 0; n--) {
+      InboundCommand& q = inboundRing[(inboundHead + n) % INBOUND_QUEUE_LEN];
+      bool qWhole;
+      uint32_t qKey = recordKey(q, qWhole);
+      if (!qKey || (qKey >> 24) != (key >> 24)) continue;
+      if (qKey != key && !whole && !qWhole) continue;
+      if (cmd.spec->coalesce && q.spec == cmd.spec && qKey == key) {
+        freeCommand(q);
+        q = cmd;
+        inboundCoalesced++;
+        xSemaphoreGive(inboundMutex);
+        return true;
+      }
+      break;
+    }
+  }
+  bool ok = inboundCount < INBOUND_QUEUE_LEN;
+  if (ok) {
+    inboundRing[(inboundHead + inboundCount) % INBOUND_QUEUE_LEN] = cmd;
+    inboundCount++;
+  }
+  xSemaphoreGive(inboundMutex);
+  // loop() mungkin sedang menunggu jadwal berikutnya
+  if (ok) Power::wake();
+  return ok;
+}
+
+static bool dequeueCommand(InboundCommand& out) {
+  xSemaphoreTake(inboundMutex, portMAX_DELAY);
+  bool ok = inboundCount > 0;
+  if (ok) {
+    out = inboundRing[inboundHead];
+    inboundHead = (inboundHead + 1) % INBOUND_QUEUE_LEN;
+    inboundCount--;
+  }
+  xSemaphoreGive(inboundMutex);
+  return ok;
+}
+
+// Callback PubSubClient (konteks mqttTask): parse lalu antrikan saja.
+// Handler dijalankan di loop() oleh processInbound().
+void mqttCallback(char* topic, byte* payload, unsigned int length) {
+  InboundCommand cmd;
+  if (!parseCommand(payload, length, cmd)) {
+    freeCommand(cmd);
+    return;
+  }
+  if (!enqueueCommand(cmd)) {
+    freeCommand(cmd);
+    inboundDropped++;
+  }
+}
+
+// Worker (konteks loop()): jalankan perintah sampai budget habis (minimal
+// satu). Handler hanya menandai dirty; Persistence yang menulis ke flash.
+static void processInbound() {
+  unsigned long start = micros();
+  InboundCommand cmd;
+  while (dequeueCommand(cmd)) {
+    cmd.spec->handler(cmd);
+    freeCommand(cmd);
+    if (micros() - start >= INBOUND_BUDGET_US) break;
+  }
+}
+
+// Kirim isi TelemetryLog (snapshot selama offline) satu batch per
+// TELEMETRY_BATCH_INTERVAL_MS; batch berikutnya baru diambil setelah ACK_MSG.
+// Outbox mengirim ulang batch sampai di-ACK; pengambilan ulang setelah
+// TELEMETRY_ACK_TIMEOUT_MS memakai key yang sama (ts record pertama) sehingga
+// menggantikan entry yang masih antri, bukan menambah salinan baru.
+static void drainTelemetryLog() {
+  if (connState != MQ_CONNECTED) return;
+  unsigned long now = millis();
+  if (backfillMsgId) {
+    if (now - backfillSentMs < TELEMETRY_ACK_TIMEOUT_MS) return;
+    backfillMsgId = 0; // belum di-ACK: bangun ulang batch yang sama
+  }
+  if (now - backfillSentMs < TELEMETRY_BATCH_INTERVAL_MS) return;
+
+  TelemetryRecord recs[TELEMETRY_BATCH_SIZE];
+  uint8_t n = TelemetryLog::peekBatch(recs, TELEMETRY_BATCH_SIZE);
+  if (!n) return;
+
+  JsonDocument doc;
+  doc["cmd"] = "SENSOR_BATCH";
+  doc["from"] = "ESP";
+  doc["deviceId"] = deviceId;
+  // [ts, tds, ph, turbidity, temperature] per baris
+  JsonArray rows = doc.createNestedArray("rows");
+  for (uint8_t i = 0; i < n; ++i) {
+    JsonArray row = rows.createNestedArray();
+    row.add(recs[i].ts);
+    row.add(recs[i].tds);
+    row.add(recs[i].ph);
+    row.add(recs[i].turbidity);
+    row.add(recs[i].temperature);
+  }
+  if (publishMessage(SENSOR_BATCH, doc, false, outboxKey("SENSOR_BATCH", recs[0].ts))) {
+    backfillMsgId = doc["msgId"].as<uint32_t>();
+    backfillSentMs = now;
+  }
+}
+
+// Alirkan query QUERY_HISTORY sebagai HISTORY_PAGE; halaman berikutnya baru
+// dibaca setelah ACK_MSG halaman sebelumnya. Baris raw: [ts, tds, ph,
+// turbidity, temperature]; agregat: [ts, count, lalu avg/min/max per kanal].
+static void streamHistory() {
+  HistoryQuery& q = historyQuery;
+  if (connState != MQ_CONNECTED) return;
+  unsigned long now = millis();
+  if (q.msgId) {
+    if (now - q.sentMs < TELEMETRY_ACK_TIMEOUT_MS) return;
+    // Outbox mengirim ulang control sampai di-ACK: batalkan halamannya,
+    // termasuk halaman terakhir (done) yang query-nya sudah tidak aktif
+    Serial.printf("[MQTT] History query %u timed out\n", (unsigned)q.queryId);
+    Outbox::cancel(q.msgId);
+    q.msgId = 0;
+    q.active = false;
+    return;
+  }
+  if (!q.active) return;
+
+  HistoryRow rows[HISTORY_PAGE_ROWS];
+  // Satu halaman per loop(); query() dibatasi HISTORY_SCAN_LIMIT slot
+  uint8_t n = History::query(q.resolution, q.cursor, q.end, rows, HISTORY_PAGE_ROWS);
+  bool done = q.cursor >= q.end;
+  if (!n && !done) return;
+
+  JsonDocument doc;
+  doc["cmd"] = "HISTORY_PAGE";
+  doc["from"] = "ESP";
+  doc["deviceId"] = deviceId;
+  doc["queryId"] = q.queryId;
+  doc["resolution"] = q.resolution;
+  doc["page"] = q.page;
+  doc["done"] = done;
+  JsonArray arr = doc.createNestedArray("rows");
+  for (uint8_t i = 0; i < n; ++i) {
+    JsonArray row = arr.createNestedArray();
+    row.add(rows[i].ts);
+    if (q.resolution == HISTORY_RAW) {
+      for (uint8_t c = 0; c < TS_CHANNELS; ++c) row.add(rows[i].avg[c]);
+    } else {
+      row.add(rows[i].count);
+      for (uint8_t c = 0; c < TS_CHANNELS; ++c) {
+        row.add(rows[i].avg[c]);
+        row.add(rows[i].min[c]);
+        row.add(rows[i].max[c]);
+      }
+    }
+  }
+  if (!publishMessage(HISTORY, doc, false)) return;
+  q.msgId = doc["msgId"].as<uint32_t>();
+  q.sentMs = now;
+  if (done) q.active = false;
+}
+
+static unsigned long nextBackoff(unsigned long current)
+{
+  unsigned long next = current ? current * 2 : BACKOFF_MIN_MS;
+  if (next > BACKOFF_MAX_MS)
+    next = BACKOFF_MAX_MS;
+  // jitter ±25% supaya banyak device tidak reconnect serempak
+  long jitter = long(esp_random() % (next / 2 + 1)) - long(next / 4);
+  return next + jitter;
+}
+
+static void mqttTask(void *)
+{
+  unsigned long backoffMs = 0;
+  unsigned long retryAt = 0;
+  unsigned long connectedAt = 0;
+
+  for (;;)
+  {
+    switch (connState)
+    {
+    case MQ_WAIT_WIFI:
+      if (WiFi.status() == WL_CONNECTED)
+        connState = MQ_CONNECTING;
+      else
+        vTaskDelay(pdMS_TO_TICKS(500));
+      break;
+
+    case MQ_BACKOFF:
+      if (WiFi.status() != WL_CONNECTED)
+        connState = MQ_WAIT_WIFI;
+      else if ((long)(millis() - retryAt) >= 0)
+        connState = MQ_CONNECTING;
+      else
+        vTaskDelay(pdMS_TO_TICKS(100));
+      break;
+
+    case MQ_CONNECTING:
+    {
+      String clientId = "ESP32Client-" + String(millis());
+      unsigned long t0 = millis();
+      if (mqttClient.connect(clientId.c_str(), MQTT_USERNAME, MQTT_PASSWORD))
+      {
+        Serial.printf("[MQTT] Connected in %lums, subscribing...\n", millis() - t0);
+        for (auto name : MESSAGE_NAMES)
+        {
+          String topic = String(TOPIC_PREFIX) + "/" + name + "/" + TOPIC_SUFFIX;
+          mqttClient.subscribe(topic.c_str());
+        }
+        connectedAt = millis();
+        Outbox::onReconnect();
+        connectedEvent = true;
+        connState = MQ_CONNECTED;
+      }
+      else
+      {
+        backoffMs = nextBackoff(backoffMs);
+        retryAt = millis() + backoffMs;
+        Serial.printf("[MQTT] Connect failed, rc=%d, retry in %lums\n",
+                      mqttClient.state(), backoffMs);
+        connState = MQ_BACKOFF;
+      }
+      break;
+    }
+
+    case MQ_CONNECTED:
+      if (WiFi.status() != WL_CONNECTED || !mqttClient.connected())
+      {
+        mqttClient.disconnect();
+        // Broker yang putus-sambung tetap melewati backoff; jedanya baru
+        // di-reset kalau koneksi sebelumnya sempat stabil
+        if (millis() - connectedAt >= BACKOFF_STABLE_MS)
+          backoffMs = 0;
+        backoffMs = nextBackoff(backoffMs);
+        retryAt = millis() + backoffMs;
+        Serial.printf("[MQTT] Connection lost after %lums, retry in %lums\n",
+                      millis() - connectedAt, backoffMs);
+        connState = MQ_BACKOFF; // WiFi putus: BACKOFF langsung ke WAIT_WIFI
+        break;
+      }
+      mqttClient.loop();
+      Outbox::pump(sendEntry);
+      vTaskDelay(pdMS_TO_TICKS(10));
+      break;
+    }
+  }
 }
 
 void setupMQTT(const char *devId)
 {
   deviceId = String(devId);
-  secureClient.setInsecure();
+
+  // Verifikasi broker: CA yang dipin dan/atau SHA-256 public key (lihat secrets.h)
+  // CA/pin yang gagal di-parse membuat TlsClient menolak connect (fail closed)
+  bool configured = false;
+  bool verified = true;
+#ifdef MQTT_ROOT_CA
+  configured = true;
+  verified = secureClient.setCACert(MQTT_ROOT_CA) && verified;
+#endif
+#ifdef MQTT_PUBKEY_SHA256
+  configured = true;
+  verified = secureClient.setPublicKeyPinHex(MQTT_PUBKEY_SHA256) && verified;
+#endif
+  if (!configured)
+    Serial.println("[MQTT] WARNING: no CA/pin configured, broker identity not verified");
+  else if (!verified)
+    Serial.println("[MQTT] ERROR: CA/pin in secrets.h is invalid, broker connection disabled");
+  // Sesi TLS disalin ke RTC memory: reconnect setelah soft reset tetap resumed
+  secureClient.setRtcSessionCache(true);
   mqttClient.setServer(MQTT_HOST, MQTT_PORT);
   mqttClient.setCallback(mqttCallback);
+  Outbox::begin();
+
+  inboundMutex = xSemaphoreCreateMutex();
+  // Core 0 (bersama stack WiFi); loop() Arduino berjalan di core 1
+  xTaskCreatePinnedToCore(mqttTask, "mqtt", 8192, nullptr, 1, &mqttTaskHandle, 0);
 }
 
 void loopMQTT()
 {
-  handleBlink();
-  if (WiFi.status() != WL_CONNECTED)
+  if (sensorBlinkEvent)
   {
-    Serial.println("[MQTT] WiFi not connected, retrying...");
-    return;
+    sensorBlinkEvent = false;
+    // Non-blocking blink: panggil startBlink, jangan delay()
+    startBlink(1, 50); // 1 kali berkedip, durasi 50ms
   }
-  if (!mqttClient.connected())
+  handleBlink();
+
+  // Resync setelah (re)connect dijalankan di sini karena menyentuh data Alarm/Sensor
+  if (connectedEvent)
   {
-    static unsigned long lastRetry = 0;
-    unsigned long now = millis();
-    if (now - lastRetry < 5000)
-      return;
-    lastRetry = now;
-    String clientId = "ESP32Client-" + String(now);
-    if (mqttClient.connect(clientId.c_str(), MQTT_USERNAME, MQTT_PASSWORD))
-    {
-      Serial.println("[MQTT] Connected, subscribing...");
-      for (auto name : MESSAGE_NAMES)
-      {
-        String topic = String(TOPIC_PREFIX) + "/" + name + "/" + TOPIC_SUFFIX;
-        mqttClient.subscribe(topic.c_str());
-      }
-      publishAllSensorSettings();
-      trySyncSensorPending();
-      trySyncPending();
-    }
-    else
-    {
-      Serial.printf("[MQTT] Connect failed, rc=%d\n", mqttClient.state());
-    }
+    connectedEvent = false;
+    publishAllSensorSettings();
+    trySyncSensorPending();
+    trySyncPending();
   }
-  else
+
+  processInbound();
+  drainTelemetryLog();
+  streamHistory();
+
+  static unsigned long lastStats = 0;
+  if (millis() - lastStats >= 60000)
   {
-    mqttClient.loop();
+    lastStats = millis();
+    OutboxStats s = Outbox::stats();
+    Serial.printf("[OUTBOX] ctl=%u tel=%u spill=%u sent=%u retry=%u ack=%u cancel=%u drop=%u stall=%u\n",
+                  s.controlDepth, s.telemetryDepth, (unsigned)s.spilledDepth,
+                  (unsigned)s.sent, (unsigned)s.retried, (unsigned)s.acked,
+                  (unsigned)s.cancelled, (unsigned)s.dropped, (unsigned)s.stalled);
+    Serial.printf("[MQTT] state=%u inboundDropped=%u coalesced=%u\n",
+                  (unsigned)connState, (unsigned)inboundDropped, (unsigned)inboundCoalesced);
+    const TlsStats &t = secureClient.stats();
+    Serial.printf("[TLS] handshakes=%u resumed=%u fail=%u last=%ums peak=%uB\n",
+                  (unsigned)t.handshakes, (unsigned)t.resumed, (unsigned)t.failures,
+                  (unsigned)t.lastHandshakeMs, (unsigned)t.lastHeapPeak);
+    const RecordLogStats &al = Alarm::storageStats();
+    const RecordLogStats &ss = Sensor::storageStats();
+    Serial.printf("[FS] alarms w=%u/%uB skip=%u cmp=%u life=%uB | sensors w=%u/%uB skip=%u cmp=%u life=%uB\n",
+                  (unsigned)al.appends, (unsigned)al.appendBytes, (unsigned)al.skipped,
+                  (unsigned)al.compactions, (unsigned)al.lifetimeBytes,
+                  (unsigned)ss.appends, (unsigned)ss.appendBytes, (unsigned)ss.skipped,
+                  (unsigned)ss.compactions, (unsigned)ss.lifetimeBytes);
+    const PersistStats &ps = Persistence::stats();
+    Serial.printf("[PERSIST] alarms %u/%u sensors %u/%u calib %u/%u (performed/requested) barriers=%u\n",
+                  (unsigned)ps.performed[PERSIST_ALARMS], (unsigned)ps.requested[PERSIST_ALARMS],
+                  (unsigned)ps.performed[PERSIST_SENSORS], (unsigned)ps.requested[PERSIST_SENSORS],
+                  (unsigned)ps.performed[PERSIST_CALIB], (unsigned)ps.requested[PERSIST_CALIB],
+                  (unsigned)ps.barriers);
+    const StorageStats &st = Storage::stats();
+    Serial.printf("[STORAGE] jobs=%u/%u fail=%u inline=%u sync=%u write max=%uus avg=%uus latency max=%uus depth max=%u\n",
+                  (unsigned)st.completed, (unsigned)st.submitted, (unsigned)st.failed,
+                  (unsigned)st.inlineRuns, (unsigned)st.syncs, (unsigned)st.maxWriteUs,
+                  (unsigned)(st.completed ? st.totalWriteUs / st.completed : 0),
+                  (unsigned)st.maxLatencyUs, (unsigned)st.maxDepth);
+    const TelemetryLogStats &tl = TelemetryLog::stats();
+    Serial.printf("[TLOG] pending=%u (%u%%) oldest=%u logged=%u sent=%u batches=%u overwritten=%u corrupt=%u\n",
+                  (unsigned)TelemetryLog::pending(), (unsigned)TelemetryLog::fillPercent(),
+                  (unsigned)TelemetryLog::oldestUnsentTs(), (unsigned)tl.logged, (unsigned)tl.sent,
+                  (unsigned)tl.batches, (unsigned)tl.overwritten, (unsigned)tl.corrupt);
+    const HistoryStats &hs = History::stats();
+    Serial.printf("[HIST] samples=%u 1m=%u 15m=%u rawEvicted=%u\n",
+                  (unsigned)hs.samples, (unsigned)hs.minuteWrites,
+                  (unsigned)hs.quarterWrites, (unsigned)hs.rawBlocksEvicted);
+    const ActuatorStats &as = Actuator::stats();
+    Serial.printf("[ACT] runs=%u queued=%u dropped=%u maxLate=%ums\n",
+                  (unsigned)as.runs, (unsigned)as.queued, (unsigned)as.dropped, (unsigned)as.maxLateMs);
   }
 }
 
+bool isMQTTConnected()
+{
+  return connState == MQ_CONNECTED;
+}
+
 void publishSensor(float tds, float ph, float turbidity, float temperature)
 {
   JsonDocument doc;
@@ -494,20 +937,26 @@ void publishSensor(float tds, float ph, float turbidity, float temperature)
   doc["ph"] = ph;
   doc["turbidity"] = turbidity;
   doc["temperature"] = temperature;
-  String out;
-  serializeJson(doc, out);
-  
-  bool success = publishMessage(SENSOR_DATA, out, false);
-  
-  if (success)
-  {
-    Serial.print("[MQTT] Published sensor: ");
-    Serial.println(out);
-    
-    // Non-blocking blink: panggil startBlink, jangan delay()
-    startBlink(1, 50); // 1 kali berkedip, durasi 50ms
-  }
 
+  // Log & blink dilakukan di sendEntry() saat benar-benar terkirim
+  publishMessage(SENSOR_DATA, doc, false);
+}
+
+// Hasil tiap sinkron SNTP: offset RTC, estimasi drift & register aging
+void publishClockStatus(const ClockSyncStats &s)
+{
+  JsonDocument doc;
+  doc["cmd"] = "CLOCK_STATUS";
+  doc["from"] = "ESP";
+  doc["deviceId"] = deviceId;
+  doc["offsetMs"] = s.lastOffsetMs;
+  doc["driftPpm"] = s.driftPpm;
+  doc["aging"] = s.aging;
+  doc["syncs"] = s.syncs;
+  doc["steps"] = s.steps;
+  doc["syncedAt"] = s.lastSyncAt;
+  doc["sqw"] = Clock::sqwActive();
+  publishMessage(CLOCK_STATUS, doc, false);
 }
 
 // --------------------------------------------------
@@ -520,7 +969,7 @@ void publishAlarmFromESP(const char *action, uint16_t id, uint8_t hour, uint8_t
   if ((strcmp(action, "ADD") == 0) && (id == 0))
   {
     // Entry sudah dibuat oleh UI, cukup tandai pending dan sinkronkan
-    uint8_t cnt;
+    uint16_t cnt;
     AlarmData *arr = Alarm::getAll(cnt);
     // cari entry isTemporary paling terakhir
     for (int i = cnt - 1; i >= 0; i--)
@@ -531,7 +980,7 @@ void publishAlarmFromESP(const char *action, uint16_t id, uint8_t hour, uint8_t
         break;
       }
     }
-    Alarm::saveAll();
+    Persistence::markDirty(PERSIST_ALARMS);
     trySyncPending();
     return;
   }
@@ -539,22 +988,18 @@ void publishAlarmFromESP(const char *action, uint16_t id, uint8_t hour, uint8_t
   // 2) Jika action="EDIT" (id != 0), tandai entry sebagai pending edit
   if ((strcmp(action, "EDIT") == 0) && (id != 0))
   {
-    uint8_t cnt;
-    AlarmData *arr = Alarm::getAll(cnt);
-    for (uint8_t i = 0; i < cnt; i++)
+    AlarmData *a = Alarm::find(id);
+    if (a)
     {
-      if (arr[i].id == id)
-      {
-        arr[i].hour = hour;
-        arr[i].minute = minute;
-        arr[i].duration = duration;
-        arr[i].enabled = enabled;
-        arr[i].pending = true;
-        arr[i].isTemporary = false;
-        break;
-      }
+      a->hour = hour;
+      a->minute = minute;
+      a->duration = duration;
+      a->enabled = enabled;
+      a->pending = true;
+      a->isTemporary = false;
+      Alarm::touch();
     }
-    Alarm::saveAll();
+    Persistence::markDirty(PERSIST_ALARMS);
     trySyncPending();
     return;
   }
@@ -562,18 +1007,13 @@ void publishAlarmFromESP(const char *action, uint16_t id, uint8_t hour, uint8_t
   // 3) Jika action="DEL" (id != 0), tandai entry sebagai pending delete
   if ((strcmp(action, "DEL") == 0) && (id != 0))
   {
-    uint8_t cnt;
-    AlarmData *arr = Alarm::getAll(cnt);
-    for (uint8_t i = 0; i < cnt; i++)
+    AlarmData *a = Alarm::find(id);
+    if (a)
     {
-      if (arr[i].id == id)
-      {
-        arr[i].pending = true;
-        arr[i].isTemporary = false;
-        break;
-      }
+      a->pending = true;
+      a->isTemporary = false;
     }
-    Alarm::saveAll();
+    Persistence::markDirty(PERSIST_ALARMS);
     trySyncPending();
     return;
   }
@@ -581,9 +1021,9 @@ void publishAlarmFromESP(const char *action, uint16_t id, uint8_t hour, uint8_t
 // --------------------------------------------------
 // Menghapus alarm secara lokal dan memberitahu backend
 // --------------------------------------------------
-void deleteAlarmFromESPByIndex(uint8_t index)
+void deleteAlarmFromESPByIndex(uint16_t index)
 {
-  uint8_t cnt;
+  uint16_t cnt;
   AlarmData *arr = Alarm::getAll(cnt);
   if (index >= cnt)
   {
@@ -592,9 +1032,8 @@ void deleteAlarmFromESPByIndex(uint8_t index)
   }
   uint16_t id = arr[index].id;
 
-  // Hapus di LittleFS & simpan
+  // Hapus lokal (disimpan oleh Persistence)
   bool ok = Alarm::remove(id);
-  Alarm::saveAll();
   Serial.printf("[MQTT] Removed alarm index=%u id=%u: %s\n",
                 index, id, ok ? "OK" : "ERROR");
 
@@ -605,10 +1044,8 @@ void deleteAlarmFromESPByIndex(uint8_t index)
   doc["deviceId"] = deviceId;
   JsonObject a = doc.createNestedObject("alarm");
   a["id"] = id;
-  String out;
-  serializeJson(doc, out);
-  publishMessage(ALARM_SET, out, false); // alarmset
-  Serial.printf("[MQTT] Sent delete to backend: %s\n", out.c_str());
+  publishMessage(ALARM_SET, doc, false, outboxKey("REQUEST_DELETE_ALARM", id)); // alarmset
+  Serial.printf("[MQTT] Queued delete to backend: id=%u\n", id);
 }
 void publishSensorFromESP(const SensorSetting &s)
 {
@@ -622,22 +1059,19 @@ void publishSensorFromESP(const SensorSetting &s)
   ss["maxValue"] = s.maxValue;
   ss["enabled"] = s.enabled;
 
-  String out;
-  serializeJson(doc, out);
-  publishMessage(SENSOR_SET, out, false); // mids[3] == "sensorset"
+  publishMessage(SENSOR_SET, doc, false, outboxKey("SET_SENSOR", s.type)); // mids[3] == "sensorset"
 
-  Serial.print("[MQTT] Sent ESP->backend (sensor): ");
-  Serial.println(out);
+  Serial.printf("[MQTT] Queued ESP->backend (sensor): type=%u\n", (uint8_t)s.type);
 }
 // --------------------------------------------------
 // Coba sinkron entry yang masih pending (ADD/EDIT/DELETE)
 // --------------------------------------------------
 void trySyncPending()
 {
-  uint8_t cnt;
+  uint16_t cnt;
   AlarmData *arr = Alarm::getAll(cnt);
 
-  for (uint8_t i = 0; i < cnt; i++)
+  for (uint16_t i = 0; i < cnt; i++)
   {
     if (!arr[i].pending)
       continue;
@@ -653,11 +1087,12 @@ void trySyncPending()
       o["minute"] = arr[i].minute;
       o["duration"] = arr[i].duration;
       o["enabled"] = arr[i].enabled;
+      o["days"] = arr[i].days;
+      o["channel"] = arr[i].channel;
       doc["tempIndex"] = arr[i].tempIndex;
 
-      String out;
-      serializeJson(doc, out);
-      publishMessage(ALARM_SET, out, false); // mids[1] == "alarmset"
+      publishMessage(ALARM_SET, doc, false,
+                     outboxKey("REQUEST_ADD_ALARM", uint8_t(arr[i].tempIndex))); // mids[1] == "alarmset"
     }
     // 2) Jika isTemporary==false → kirim REQUEST_EDIT
     else
@@ -672,10 +1107,11 @@ void trySyncPending()
       o["minute"] = arr[i].minute;
       o["duration"] = arr[i].duration;
       o["enabled"] = arr[i].enabled;
+      o["days"] = arr[i].days;
+      o["channel"] = arr[i].channel;
 
-      String out;
-      serializeJson(doc, out);
-      publishMessage(ALARM_SET, out, false); // mids[1] == "alarmset"
+      publishMessage(ALARM_SET, doc, false,
+                     outboxKey("REQUEST_EDIT_ALARM", arr[i].id)); // mids[1] == "alarmset"
     }
     break;
   }
@@ -706,9 +1142,7 @@ void trySyncSensorPending()
     o["maxValue"] = s.maxValue;
     o["enabled"] = s.enabled;
 
-    String out;
-    serializeJson(doc, out);
-    publishMessage(SENSOR_SET, out, false); // mids[3] == "sensorset"
+    publishMessage(SENSOR_SET, doc, false, outboxKey("SET_SENSOR", s.type)); // mids[3] == "sensorset"
     break;
   }
 }
@@ -735,14 +1169,9 @@ void publishAllSensorSettings()
     o["enabled"] = ss[i].enabled;
   }
 
-  String out;
-  serializeJson(doc, out);
-
-  bool ok = publishMessage(SENSOR_SET, out, true); // mids[3]=="sensorset"
-  Serial.printf("[MQTT] Sent INIT_SENSOR (all): %s, success=%s\n",
-                out.c_str(), ok ? "true" : "false");
-
-  Sensor::saveAllSettings();
+  bool ok = publishMessage(SENSOR_SET, doc, true, outboxKey("INIT_SENSOR", 0)); // mids[3]=="sensorset"
+  Serial.printf("[MQTT] Queued INIT_SENSOR (all): %u sensors, success=%s\n",
+                cnt, ok ? "true" : "false");
 }
 
 
@@ -755,11 +1184,8 @@ void calibrateTDSViaMQTT(float knownTDS, float temperature) {
   doc["knownTDS"] = knownTDS;
   doc["temperature"] = temperature;
   
-  String out;
-  serializeJson(doc, out);
-  
-  if (publishMessage(SENSOR_SET, out, false)) {
-    Serial.printf("[MQTT] Sent TDS calibration request: %.1fppm @ %.1f°C\n", 
+  if (publishMessage(SENSOR_SET, doc, false)) {
+    Serial.printf("[MQTT] Queued TDS calibration request: %.1fppm @ %.1f°C\n", 
                  knownTDS, temperature);
   }
 }
\ No newline at end of file
@@ -4,13 +4,16 @@
 #pragma once
 #include <Arduino.h>
 #include "ReadSensor.h"
+#include "RTC.h"
 
 void setupMQTT(const char *deviceId);
 void loopMQTT();
+bool isMQTTConnected();
 void publishSensor(float tds, float ph, float turbidity, float temperature);
+void publishClockStatus(const ClockSyncStats &s);
 void publishAlarmFromESP(const char *cmd, uint16_t id, uint8_t hour, uint8_t minute, int duration, bool enabled);
 void publishSensorFromESP(const SensorSetting &s);
-void deleteAlarmFromESPByIndex(uint8_t index);
+void deleteAlarmFromESPByIndex(uint16_t index);
 void trySyncPending();
 void trySyncSensorPending();
 void publishAllSensorSettings();
@@ -0,0 +1,171 @@
+// MQTTCommands.h
+// Tabel perintah inbound MQTT: nama perintah → handler, diurutkan saat compile
+// dan dicari dengan binary search atas std::string_view (tanpa String di heap).
+// Perintah baru cukup ditambahkan sebagai satu baris di COMMANDS; handler
+// didefinisikan di MQTT.cpp. Tabel ada di header supaya test native memakai
+// tabel yang sama dengan firmware.
+#ifndef MQTT_COMMANDS_H
+#define MQTT_COMMANDS_H
+
+#include <Arduino.h>
+#include <string_view>
+#include "ReadSensor.h"
+
+enum CommandId : uint8_t
+{
+  CMD_ACK_ADD_ALARM,
+  CMD_ACK_DELETE_ALARM,
+  CMD_ACK_DISABLE_ALARM,
+  CMD_ACK_EDIT_ALARM,
+  CMD_ACK_ENABLE_ALARM,
+  CMD_ACK_MSG,
+  CMD_ACK_SET_SENSOR,
+  CMD_ADD_ALARM,
+  CMD_CALIBRATE_TDS,
+  CMD_DELETE_ALARM,
+  CMD_DISABLE_ALARM,
+  CMD_EDIT_ALARM,
+  CMD_ENABLE_ALARM,
+  CMD_QUERY_HISTORY,
+  CMD_SET_SENSOR,
+  CMD_SYNC_ALARM,
+  CMD_SYNC_SENSOR,
+  CMD_COUNT
+};
+
+// Field yang diekstrak parser dari JSON sebelum handler dipanggil
+enum CommandFields : uint8_t
+{
+  CF_NONE = 0,
+  CF_ALARM = 1 << 0,       // "alarm": {id, hour, minute, duration, enabled, days?, channel?}
+  CF_TEMP_INDEX = 1 << 1,  // "tempIndex"
+  CF_SENSOR = 1 << 2,      // "sensor": {type, minValue, maxValue, enabled}
+  CF_MSG_ID = 1 << 3,      // "msgId"
+  CF_CALIBRATION = 1 << 4, // "knownTDS", "temperature"
+  CF_ALARM_LIST = 1 << 5,  // "alarms": [...]
+  CF_SENSOR_LIST = 1 << 6, // "sensors": [...]
+  CF_HISTORY = 1 << 7      // "queryId", "start", "end", "resolution"
+};
+
+struct AlarmFields
+{
+  uint16_t id;
+  uint8_t hour;
+  uint8_t minute;
+  int duration;
+  bool enabled;
+  uint8_t days;    // tidak ada di JSON = ALARM_EVERY_DAY
+  uint8_t channel; // kanal Actuator, default 0
+};
+
+struct SensorFields
+{
+  uint16_t id;
+  SensorType type;
+  float minValue;
+  float maxValue;
+  bool enabled;
+};
+
+struct CommandSpec;
+
+// Perintah yang sudah di-parse. alarmList/sensorList dialokasikan di heap
+// oleh parseCommand() dan dibebaskan oleh freeCommand() setelah handler
+// dijalankan worker di loop().
+struct InboundCommand
+{
+  const CommandSpec *spec;
+  uint32_t msgId;
+  int tempIndex;
+  AlarmFields alarm;
+  SensorFields sensor;
+  float knownTDS;
+  float temperature;
+  AlarmFields *alarmList;
+  uint16_t alarmListCount;
+  SensorFields *sensorList;
+  uint8_t sensorListCount;
+  uint32_t queryId;
+  uint32_t rangeStart;
+  uint32_t rangeEnd;
+  uint16_t resolution;
+};
+
+typedef void (*CommandHandler)(const InboundCommand &cmd);
+
+struct CommandSpec
+{
+  std::string_view name;
+  CommandId id;
+  uint8_t fields;
+  bool coalesce;           // boleh menggantikan perintah sama (record sama) yang masih antri
+  CommandHandler handler;
+};
+
+template <size_t N>
+constexpr bool commandsSorted(const CommandSpec (&table)[N])
+{
+  for (size_t i = 1; i < N; i++)
+  {
+    if (!(table[i - 1].name < table[i].name))
+      return false;
+  }
+  return true;
+}
+
+template <size_t N>
+constexpr const CommandSpec *findCommand(const CommandSpec (&table)[N], std::string_view name)
+{
+  size_t lo = 0, hi = N;
+  while (lo < hi)
+  {
+    size_t mid = (lo + hi) / 2;
+    if (table[mid].name < name)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return (lo < N && table[lo].name == name) ? &table[lo] : nullptr;
+}
+
+// Handler (MQTT.cpp), dijalankan worker di loop()
+void handleAlarmAck(const InboundCommand &cmd);
+void handleAckMsg(const InboundCommand &cmd);
+void handleSensorAck(const InboundCommand &cmd);
+void handleBackendAlarm(const InboundCommand &cmd);
+void handleTDSCalibration(const InboundCommand &cmd);
+void handleQueryHistory(const InboundCommand &cmd);
+void handleSetSensor(const InboundCommand &cmd);
+void handleSyncAlarm(const InboundCommand &cmd);
+void handleSyncSensor(const InboundCommand &cmd);
+
+// Harus urut berdasarkan nama (binary search)
+inline constexpr CommandSpec COMMANDS[] = {
+    {"ACK_ADD_ALARM", CMD_ACK_ADD_ALARM, CF_ALARM | CF_TEMP_INDEX, false, handleAlarmAck},
+    {"ACK_DELETE_ALARM", CMD_ACK_DELETE_ALARM, CF_ALARM, false, handleAlarmAck},
+    {"ACK_DISABLE_ALARM", CMD_ACK_DISABLE_ALARM, CF_ALARM, false, handleAlarmAck},
+    {"ACK_EDIT_ALARM", CMD_ACK_EDIT_ALARM, CF_ALARM, false, handleAlarmAck},
+    {"ACK_ENABLE_ALARM", CMD_ACK_ENABLE_ALARM, CF_ALARM, false, handleAlarmAck},
+    {"ACK_MSG", CMD_ACK_MSG, CF_MSG_ID, false, handleAckMsg},
+    {"ACK_SET_SENSOR", CMD_ACK_SET_SENSOR, CF_SENSOR, false, handleSensorAck},
+    {"ADD_ALARM", CMD_ADD_ALARM, CF_ALARM, false, handleBackendAlarm},
+    {"CALIBRATE_TDS", CMD_CALIBRATE_TDS, CF_CALIBRATION, false, handleTDSCalibration},
+    {"DELETE_ALARM", CMD_DELETE_ALARM, CF_ALARM, false, handleBackendAlarm},
+    {"DISABLE_ALARM", CMD_DISABLE_ALARM, CF_ALARM, true, handleBackendAlarm},
+    {"EDIT_ALARM", CMD_EDIT_ALARM, CF_ALARM, true, handleBackendAlarm},
+    {"ENABLE_ALARM", CMD_ENABLE_ALARM, CF_ALARM, true, handleBackendAlarm},
+    {"QUERY_HISTORY", CMD_QUERY_HISTORY, CF_HISTORY, false, handleQueryHistory},
+    {"SET_SENSOR", CMD_SET_SENSOR, CF_SENSOR, true, handleSetSensor},
+    {"SYNC_ALARM", CMD_SYNC_ALARM, CF_ALARM_LIST, true, handleSyncAlarm},
+    {"SYNC_SENSOR", CMD_SYNC_SENSOR, CF_SENSOR_LIST, true, handleSyncSensor},
+};
+static_assert(commandsSorted(COMMANDS), "COMMANDS must be sorted by name");
+static_assert(sizeof(COMMANDS) / sizeof(COMMANDS[0]) == CMD_COUNT, "COMMANDS must cover every CommandId");
+static_assert(findCommand(COMMANDS, "SET_SENSOR")->id == CMD_SET_SENSOR, "lookup broken");
+
+// Parse payload JSON: cek "from"/"deviceId", cari perintah di tabel dan isi
+// field sesuai spec. Return false jika pesan bukan untuk device ini / tidak dikenal.
+bool parseCommand(const uint8_t *payload, unsigned int length, InboundCommand &out);
+void freeCommand(InboundCommand &cmd);
+
+#endif // MQTT_COMMANDS_H
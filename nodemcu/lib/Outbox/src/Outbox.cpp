@@ -0,0 +1,360 @@
+// Outbox.cpp
+#include "Outbox.h"
+#include "Storage.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+// Interval retry control: 2s, 4s, 8s, 16s, 32s, 32s, ... sampai di-ACK.
+// Control tidak pernah dibuang; selama belum di-ACK tetap dikirim ulang.
+static const unsigned long RETRY_BASE_MS = 2000;
+
+static OutboxEntry controlQ[OUTBOX_CONTROL_CAPACITY];
+static uint8_t controlCount = 0;
+static OutboxEntry telemetryQ[OUTBOX_TELEMETRY_CAPACITY];
+static uint8_t telemetryCount = 0;
+
+static uint16_t bootPrefix = 0;
+static uint16_t msgCounter = 0;
+static OutboxStats counters = {};
+
+// Outbox dipakai bersama oleh loop() (push) dan task MQTT (pump/ack).
+// Lock tidak pernah ditahan selama publish ke socket.
+static SemaphoreHandle_t outboxMutex = nullptr;
+
+struct OutboxLock
+{
+  OutboxLock()
+  {
+    if (outboxMutex)
+      xSemaphoreTake(outboxMutex, portMAX_DELAY);
+  }
+  ~OutboxLock()
+  {
+    if (outboxMutex)
+      xSemaphoreGive(outboxMutex);
+  }
+};
+
+// Hapus entry index i dari antrian (geser ke kiri, urutan FIFO tetap)
+static void eraseAt(OutboxEntry *q, uint8_t &count, uint8_t i)
+{
+  for (uint8_t j = i; j + 1 < count; j++)
+    q[j] = std::move(q[j + 1]);
+  count--;
+  q[count].payload = String();
+}
+
+static unsigned long retryDelay(uint8_t attempts)
+{
+  unsigned long delayMs = RETRY_BASE_MS;
+  for (uint8_t i = 1; i < attempts && delayMs < OUTBOX_RETRY_MAX_MS; i++)
+    delayMs <<= 1;
+  return delayMs < OUTBOX_RETRY_MAX_MS ? delayMs : OUTBOX_RETRY_MAX_MS;
+}
+
+void Outbox::begin()
+{
+  if (!outboxMutex)
+    outboxMutex = xSemaphoreCreateMutex();
+  OutboxLock guard;
+  bootPrefix = uint16_t(esp_random());
+  msgCounter = 0;
+  controlCount = telemetryCount = 0;
+  counters = {};
+
+  // Hitung entry yang masih tersimpan di file spill
+  File f = Storage::fs().open(STORAGE_OUTBOX_SPILL, "r");
+  if (!f)
+    return;
+  while (f.available())
+  {
+    uint8_t hdr[12];
+    if (f.read(hdr, sizeof(hdr)) != sizeof(hdr))
+      break;
+    uint16_t len = uint16_t(hdr[10]) | (uint16_t(hdr[11]) << 8);
+    if (!f.seek(f.position() + len))
+      break;
+    counters.spilledDepth++;
+  }
+  f.close();
+  if (counters.spilledDepth)
+    Serial.printf("[OUTBOX] %u spilled entries pending\n", (unsigned)counters.spilledDepth);
+  refillFromSpill();
+}
+
+uint32_t Outbox::nextMsgId()
+{
+  OutboxLock guard;
+  return (uint32_t(bootPrefix) << 16) | ++msgCounter;
+}
+
+bool Outbox::push(uint8_t topic, const String &payload, bool retain,
+                  OutboxPriority prio, uint32_t msgId, uint32_t key)
+{
+  OutboxLock guard;
+  if (prio == OUTBOX_TELEMETRY)
+  {
+    if (telemetryCount >= OUTBOX_TELEMETRY_CAPACITY)
+    {
+      // Buang telemetry paling lama, data baru lebih berguna
+      eraseAt(telemetryQ, telemetryCount, 0);
+      counters.dropped++;
+    }
+    OutboxEntry &e = telemetryQ[telemetryCount++];
+    e = OutboxEntry{msgId, key, topic, retain, 0, 0, payload};
+    return true;
+  }
+
+  if (key != 0)
+  {
+    for (uint8_t i = 0; i < controlCount; i++)
+    {
+      OutboxEntry &e = controlQ[i];
+      if (e.key != key)
+        continue;
+      e.msgId = msgId;
+      e.topic = topic;
+      e.retain = retain;
+      e.attempts = 0;
+      e.payload = payload;
+      counters.coalesced++;
+      return true;
+    }
+  }
+
+  OutboxEntry e{msgId, key, topic, retain, 0, 0, payload};
+  if (controlCount >= OUTBOX_CONTROL_CAPACITY || counters.spilledDepth > 0)
+  {
+    // RAM penuh (atau masih ada antrian di file): jaga urutan dengan spill
+    return spill(e);
+  }
+  controlQ[controlCount++] = std::move(e);
+  return true;
+}
+
+// Salin entry berikutnya yang jatuh tempo (control dulu, lalu telemetry).
+bool Outbox::takeDue(OutboxEntry &out, bool &isTelemetry)
+{
+  OutboxLock guard;
+  unsigned long now = millis();
+  for (uint8_t i = 0; i < controlCount;)
+  {
+    OutboxEntry &e = controlQ[i];
+    if (e.attempts > 0 && now - e.lastSendMs < retryDelay(e.attempts))
+    {
+      i++;
+      continue;
+    }
+    out = e;
+    isTelemetry = false;
+    return true;
+  }
+  if (telemetryCount > 0)
+  {
+    out = telemetryQ[0];
+    isTelemetry = true;
+    return true;
+  }
+  return false;
+}
+
+void Outbox::markSent(uint32_t msgId, bool isTelemetry)
+{
+  OutboxLock guard;
+  counters.sent++;
+  if (isTelemetry)
+  {
+    for (uint8_t i = 0; i < telemetryCount; i++)
+    {
+      if (telemetryQ[i].msgId == msgId)
+      {
+        eraseAt(telemetryQ, telemetryCount, i);
+        break;
+      }
+    }
+    return;
+  }
+  // Entry bisa saja sudah di-ACK atau di-coalesce selama publish berlangsung
+  for (uint8_t i = 0; i < controlCount; i++)
+  {
+    OutboxEntry &e = controlQ[i];
+    if (e.msgId != msgId)
+      continue;
+    if (e.attempts > 0)
+      counters.retried++;
+    bool capped = retryDelay(e.attempts) >= OUTBOX_RETRY_MAX_MS;
+    if (e.attempts < UINT8_MAX)
+      e.attempts++;
+    if (!capped && retryDelay(e.attempts) >= OUTBOX_RETRY_MAX_MS)
+    {
+      Serial.printf("[OUTBOX] msgId=%08x still unacked after %u attempts\n",
+                    (unsigned)e.msgId, e.attempts);
+      counters.stalled++;
+    }
+    e.lastSendMs = millis();
+    break;
+  }
+}
+
+void Outbox::pump(OutboxSendFn send, uint8_t maxPerCall)
+{
+  OutboxEntry e;
+  bool isTelemetry = false;
+  for (uint8_t n = 0; n < maxPerCall; n++)
+  {
+    if (!takeDue(e, isTelemetry))
+      break;
+    if (!send(e))
+      return; // koneksi putus, coba lagi di pump berikutnya
+    markSent(e.msgId, isTelemetry);
+  }
+
+  OutboxLock guard;
+  if (controlCount < OUTBOX_CONTROL_CAPACITY / 2 && counters.spilledDepth > 0)
+    refillFromSpill();
+}
+
+bool Outbox::ack(uint32_t msgId)
+{
+  OutboxLock guard;
+  for (uint8_t i = 0; i < controlCount; i++)
+  {
+    if (controlQ[i].msgId == msgId)
+    {
+      eraseAt(controlQ, controlCount, i);
+      counters.acked++;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Outbox::cancel(uint32_t msgId)
+{
+  OutboxLock guard;
+  for (uint8_t i = 0; i < controlCount; i++)
+  {
+    if (controlQ[i].msgId == msgId)
+    {
+      eraseAt(controlQ, controlCount, i);
+      counters.cancelled++;
+      return true;
+    }
+  }
+  return false;
+}
+
+void Outbox::onReconnect()
+{
+  OutboxLock guard;
+  for (uint8_t i = 0; i < controlCount; i++)
+  {
+    if (controlQ[i].attempts > 0)
+      controlQ[i].lastSendMs = millis() - retryDelay(controlQ[i].attempts);
+  }
+}
+
+OutboxStats Outbox::stats()
+{
+  OutboxLock guard;
+  OutboxStats s = counters;
+  s.controlDepth = controlCount;
+  s.telemetryDepth = telemetryCount;
+  return s;
+}
+
+// Format record spill: msgId(4) key(4) topic(1) retain(1) len(2) payload(len), little-endian
+bool Outbox::spill(const OutboxEntry &e)
+{
+  File f = Storage::fs().open(STORAGE_OUTBOX_SPILL, "a");
+  if (!f)
+  {
+    counters.dropped++;
+    return false;
+  }
+  uint16_t len = uint16_t(e.payload.length());
+  uint8_t hdr[12] = {
+      uint8_t(e.msgId), uint8_t(e.msgId >> 8), uint8_t(e.msgId >> 16), uint8_t(e.msgId >> 24),
+      uint8_t(e.key), uint8_t(e.key >> 8), uint8_t(e.key >> 16), uint8_t(e.key >> 24),
+      e.topic, uint8_t(e.retain ? 1 : 0), uint8_t(len), uint8_t(len >> 8)};
+  bool ok = f.write(hdr, sizeof(hdr)) == sizeof(hdr) &&
+            f.write((const uint8_t *)e.payload.c_str(), len) == len;
+  f.close();
+  if (!ok)
+  {
+    counters.dropped++;
+    return false;
+  }
+  counters.spilledDepth++;
+  return true;
+}
+
+void Outbox::refillFromSpill()
+{
+  File f = Storage::fs().open(STORAGE_OUTBOX_SPILL, "r");
+  if (!f)
+  {
+    counters.spilledDepth = 0;
+    return;
+  }
+
+  File rest;
+  uint32_t remaining = 0;
+  while (f.available())
+  {
+    uint8_t hdr[12];
+    if (f.read(hdr, sizeof(hdr)) != sizeof(hdr))
+      break;
+    uint16_t len = uint16_t(hdr[10]) | (uint16_t(hdr[11]) << 8);
+    String payload;
+    payload.reserve(len);
+    char chunk[64];
+    uint16_t left = len;
+    while (left > 0)
+    {
+      size_t n = f.readBytes(chunk, left < sizeof(chunk) ? left : sizeof(chunk));
+      if (n == 0)
+        break;
+      payload.concat(chunk, n);
+      left -= n;
+    }
+    if (left > 0)
+      break; // record terpotong (mati listrik saat spill), abaikan sisanya
+
+    if (controlCount < OUTBOX_CONTROL_CAPACITY)
+    {
+      OutboxEntry &e = controlQ[controlCount++];
+      e.msgId = uint32_t(hdr[0]) | uint32_t(hdr[1]) << 8 | uint32_t(hdr[2]) << 16 | uint32_t(hdr[3]) << 24;
+      e.key = uint32_t(hdr[4]) | uint32_t(hdr[5]) << 8 | uint32_t(hdr[6]) << 16 | uint32_t(hdr[7]) << 24;
+      e.topic = hdr[8];
+      e.retain = hdr[9] != 0;
+      e.attempts = 0;
+      e.lastSendMs = 0;
+      e.payload = std::move(payload);
+      continue;
+    }
+
+    // RAM penuh lagi: sisa record disalin ke file baru
+    if (!rest)
+      rest = Storage::fs().open(STORAGE_OUTBOX_TMP, "w");
+    if (rest)
+    {
+      rest.write(hdr, sizeof(hdr));
+      rest.write((const uint8_t *)payload.c_str(), len);
+      remaining++;
+    }
+  }
+  f.close();
+
+  if (rest)
+  {
+    rest.close();
+    Storage::fs().remove(STORAGE_OUTBOX_SPILL);
+    Storage::fs().rename(STORAGE_OUTBOX_TMP, STORAGE_OUTBOX_SPILL);
+  }
+  else
+  {
+    Storage::fs().remove(STORAGE_OUTBOX_SPILL);
+  }
+  counters.spilledDepth = remaining;
+}
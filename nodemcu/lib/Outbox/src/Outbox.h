@@ -0,0 +1,85 @@
+// Outbox.h
+#ifndef OUTBOX_H
+#define OUTBOX_H
+
+#include <Arduino.h>
+
+// Kapasitas antrian di RAM. Entry control yang tidak muat di-spill ke LittleFS,
+// telemetry yang tidak muat dibuang (yang paling lama).
+#define OUTBOX_CONTROL_CAPACITY   16
+#define OUTBOX_TELEMETRY_CAPACITY 8
+#define OUTBOX_RETRY_MAX_MS       32000 // backoff control berhenti naik di sini
+
+enum OutboxPriority : uint8_t
+{
+  OUTBOX_CONTROL = 0,   // ACK_*, REQUEST_*, SET_SENSOR, INIT_SENSOR, ...
+  OUTBOX_TELEMETRY = 1  // sensordata
+};
+
+struct OutboxEntry
+{
+  uint32_t msgId;          // ID unik, dipakai backend untuk dedupe + ACK_MSG
+  uint32_t key;            // kunci coalescing (0 = tidak di-coalesce)
+  uint8_t topic;           // index MESSAGE_NAMES di MQTT.cpp
+  bool retain;
+  uint8_t attempts;        // jumlah kirim yang sudah dilakukan
+  unsigned long lastSendMs;
+  String payload;          // JSON lengkap, sudah berisi "msgId"
+};
+
+struct OutboxStats
+{
+  uint16_t controlDepth;
+  uint16_t telemetryDepth;
+  uint32_t spilledDepth;   // entry control yang menunggu di file spill
+  uint32_t sent;
+  uint32_t retried;
+  uint32_t acked;
+  uint32_t cancelled;      // control yang dibatalkan pemanggilnya
+  uint32_t dropped;        // telemetry dibuang karena antrian penuh
+  uint32_t stalled;        // control yang sudah mencapai OUTBOX_RETRY_MAX_MS
+  uint32_t coalesced;
+};
+
+// Fungsi pengirim: return true kalau paket berhasil ditulis ke broker.
+typedef bool (*OutboxSendFn)(const OutboxEntry &entry);
+
+class Outbox
+{
+public:
+  // Muat ulang entry yang sempat di-spill sebelum reboot
+  static void begin();
+
+  // ID berikutnya: 16 bit acak per boot + 16 bit counter
+  static uint32_t nextMsgId();
+
+  // Masukkan pesan ke antrian. Jika key != 0 dan ada entry dengan key sama
+  // yang belum di-ACK, payload entry tersebut diganti (coalescing).
+  static bool push(uint8_t topic, const String &payload, bool retain,
+                   OutboxPriority prio, uint32_t msgId, uint32_t key = 0);
+
+  // Kirim entry yang sudah jatuh tempo. Control didahulukan dari telemetry.
+  // Aman dipanggil dari task lain; lock dilepas selama send() berjalan.
+  static void pump(OutboxSendFn send, uint8_t maxPerCall = 4);
+
+  // ACK_MSG dari backend: hapus entry control dengan msgId tsb.
+  static bool ack(uint32_t msgId);
+
+  // Pemanggil berhenti menunggu ACK (mis. query riwayat timeout): hapus
+  // entry control tanpa menghitungnya sebagai acked. Seperti coalescing,
+  // hanya antrian RAM yang dicari; false jika tidak ada di sana.
+  static bool cancel(uint32_t msgId);
+
+  // Dipanggil setelah reconnect: entry yang belum di-ACK dikirim ulang segera
+  static void onReconnect();
+
+  static OutboxStats stats();
+
+private:
+  static bool takeDue(OutboxEntry &out, bool &isTelemetry);
+  static void markSent(uint32_t msgId, bool isTelemetry);
+  static bool spill(const OutboxEntry &e);
+  static void refillFromSpill();
+};
+
+#endif // OUTBOX_H
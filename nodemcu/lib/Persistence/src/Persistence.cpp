@@ -0,0 +1,116 @@
+#include "Persistence.h"
+#include <esp_system.h>
+#include "Storage.h"
+
+static PersistFlushFn flushFns[PERSIST_COUNT] = {};
+static bool dirty[PERSIST_COUNT] = {};
+static unsigned long firstDirtyMs[PERSIST_COUNT] = {};
+static unsigned long lastMarkMs[PERSIST_COUNT] = {};
+static unsigned long lastFlushMs[PERSIST_COUNT] = {};
+static PersistStats counters = {};
+
+// esp_restart() (ESP.restart, WiFiManager reset, panic handler tidak termasuk)
+// menjalankan shutdown handler sebelum reset. Brown-out langsung me-reset chip
+// tanpa memberi kesempatan menulis flash, jadi tidak bisa di-hook; jendela
+// debounce yang pendek membatasi data yang hilang.
+static void onShutdown()
+{
+  Persistence::barrier();
+}
+
+void Persistence::begin(PersistFlushFn alarms, PersistFlushFn sensors, PersistFlushFn calib)
+{
+  flushFns[PERSIST_ALARMS] = alarms;
+  flushFns[PERSIST_SENSORS] = sensors;
+  flushFns[PERSIST_CALIB] = calib;
+  esp_register_shutdown_handler(onShutdown);
+}
+
+void Persistence::markDirty(PersistCollection c)
+{
+  unsigned long now = millis();
+  counters.requested[c]++;
+  if (!dirty[c])
+  {
+    dirty[c] = true;
+    firstDirtyMs[c] = now;
+  }
+  lastMarkMs[c] = now;
+}
+
+void Persistence::loop()
+{
+  unsigned long now = millis();
+  for (uint8_t c = 0; c < PERSIST_COUNT; c++)
+  {
+    if (!dirty[c])
+      continue;
+    if (now - lastFlushMs[c] < PERSIST_MIN_INTERVAL_MS)
+      continue;
+    if (now - lastMarkMs[c] >= PERSIST_QUIET_MS || now - firstDirtyMs[c] >= PERSIST_MAX_DELAY_MS)
+      flush(c);
+  }
+}
+
+void Persistence::barrier()
+{
+  counters.barriers++;
+  for (uint8_t c = 0; c < PERSIST_COUNT; c++)
+  {
+    if (dirty[c])
+      flush(c);
+  }
+  // Pastikan append yang masih antre di task storage sudah di flash
+  Storage::sync();
+}
+
+bool Persistence::isDirty()
+{
+  for (uint8_t c = 0; c < PERSIST_COUNT; c++)
+  {
+    if (dirty[c])
+      return true;
+  }
+  return false;
+}
+
+uint32_t Persistence::idleMs()
+{
+  unsigned long now = millis();
+  uint32_t wait = UINT32_MAX;
+  for (uint8_t c = 0; c < PERSIST_COUNT; c++)
+  {
+    if (!dirty[c])
+      continue;
+    // Sama dengan syarat di loop(): debounce/maks tunda, dibatasi interval minimum
+    unsigned long quiet = lastMarkMs[c] + PERSIST_QUIET_MS;
+    unsigned long latest = firstDirtyMs[c] + PERSIST_MAX_DELAY_MS;
+    unsigned long at = long(quiet - latest) < 0 ? quiet : latest;
+    unsigned long earliest = lastFlushMs[c] + PERSIST_MIN_INTERVAL_MS;
+    if (long(at - earliest) < 0)
+      at = earliest;
+    long left = long(at - now);
+    if (left <= 0)
+      return 0;
+    if (uint32_t(left) < wait)
+      wait = left;
+  }
+  return wait;
+}
+
+const PersistStats &Persistence::stats()
+{
+  return counters;
+}
+
+void Persistence::flush(uint8_t c)
+{
+  // Bersihkan flag dulu: markDirty() selama flush berjalan tetap tercatat
+  dirty[c] = false;
+  lastFlushMs[c] = millis();
+  if (flushFns[c])
+  {
+    flushFns[c]();
+    counters.performed[c]++;
+  }
+}
@@ -0,0 +1,55 @@
+// Persistence.h
+#ifndef PERSISTENCE_H
+#define PERSISTENCE_H
+
+#include <Arduino.h>
+
+// Simpan ditunda: koleksi yang dirty ditulis setelah PERSIST_QUIET_MS tanpa
+// perubahan baru, paling lambat PERSIST_MAX_DELAY_MS sejak dirty pertama, dan
+// paling sering sekali per PERSIST_MIN_INTERVAL_MS.
+#define PERSIST_QUIET_MS        300
+#define PERSIST_MAX_DELAY_MS    3000
+#define PERSIST_MIN_INTERVAL_MS 1000
+
+enum PersistCollection : uint8_t
+{
+  PERSIST_ALARMS,
+  PERSIST_SENSORS,
+  PERSIST_CALIB,
+  PERSIST_COUNT
+};
+
+struct PersistStats
+{
+  uint32_t requested[PERSIST_COUNT]; // markDirty()
+  uint32_t performed[PERSIST_COUNT]; // flush yang benar-benar dijalankan
+  uint32_t barriers;
+};
+
+typedef void (*PersistFlushFn)();
+
+class Persistence
+{
+public:
+  // Daftarkan fungsi simpan per koleksi dan hook esp_restart()
+  static void begin(PersistFlushFn alarms, PersistFlushFn sensors, PersistFlushFn calib);
+
+  // Tandai koleksi berubah; penulisan dilakukan oleh loop()
+  static void markDirty(PersistCollection c);
+
+  // Panggil dari loop(): flush koleksi yang debounce-nya sudah lewat
+  static void loop();
+
+  // Tulis semua yang dirty sekarang juga (sebelum restart, sleep, dsb.)
+  static void barrier();
+
+  static bool isDirty();
+  // ms sampai loop() akan menulis; UINT32_MAX jika tidak ada yang dirty
+  static uint32_t idleMs();
+  static const PersistStats &stats();
+
+private:
+  static void flush(uint8_t c);
+};
+
+#endif // PERSISTENCE_H
@@ -0,0 +1,127 @@
+#include "Power.h"
+#include "ButtonHandler.h"
+#include "Clock.h"
+#include "I2CBus.h"
+#include <WiFi.h>
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+static SemaphoreHandle_t wakeSem = nullptr;
+static bool lightSleep = false;
+static uint32_t dueUs = POWER_MAX_SLEEP_MS * 1000UL;
+static int64_t awakeSince = 0;
+static PowerStats counters = {};
+
+void Power::begin(bool wifi)
+{
+  if (!wakeSem)
+    wakeSem = xSemaphoreCreateBinary();
+  lightSleep = !wifi;
+  if (wifi)
+  {
+    // Radio mati di antara beacon DTIM, koneksi AP & MQTT tetap
+    WiFi.setSleep(true);
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    esp_pm_config_esp32_t pm = {240, 80, true};
+    if (esp_pm_configure(&pm) == ESP_OK)
+      Serial.println("[PWR] Auto light sleep enabled");
+#endif
+  }
+  else
+  {
+    esp_sleep_enable_gpio_wakeup();
+  }
+  Serial.printf("[PWR] %s between deadlines\n", wifi ? "Modem sleep + idle wait" : "Light sleep");
+  awakeSince = esp_timer_get_time();
+}
+
+void Power::due(uint32_t ms)
+{
+  uint32_t us = ms >= POWER_MAX_SLEEP_MS ? POWER_MAX_SLEEP_MS * 1000UL : ms * 1000UL;
+  if (us < dueUs)
+    dueUs = us;
+}
+
+// Tepi GPIO selama light sleep tidak memicu ISR: tombol & SQW dipasang
+// sebagai wake level, lalu tepi yang terlewat disusulkan setelah bangun
+static void sleepFor(uint32_t us)
+{
+  buttonHandler.armWake();
+  Clock::armWake();
+  esp_sleep_enable_timer_wakeup(us);
+  esp_light_sleep_start();
+  Clock::disarmWake();
+  buttonHandler.disarmWake();
+
+  counters.sleeps++;
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO)
+    counters.wakeGpio++;
+  else
+    counters.wakeTimer++;
+}
+
+void Power::idle()
+{
+  int64_t start = esp_timer_get_time();
+  counters.activeUs += start - awakeSince;
+  uint32_t us = dueUs;
+  dueUs = POWER_MAX_SLEEP_MS * 1000UL;
+  bool slept = false;
+
+  if (wakeSem && us >= POWER_MIN_SLEEP_US)
+  {
+    // Job I2C yang sedang jalan akan terpotong oleh light sleep
+    bool canSleep = lightSleep && I2CBus::idle();
+    if (lightSleep && !canSleep)
+      counters.busBusy++;
+    if (canSleep)
+    {
+      sleepFor(us);
+      slept = true;
+    }
+    else // wake yang datang saat loop() bekerja: satu pass ekstra saja
+      xSemaphoreTake(wakeSem, pdMS_TO_TICKS(us / 1000));
+  }
+
+  awakeSince = esp_timer_get_time();
+  (slept ? counters.sleepUs : counters.idleUs) += awakeSince - start;
+}
+
+void Power::wake()
+{
+  if (wakeSem)
+    xSemaphoreGive(wakeSem);
+}
+
+void IRAM_ATTR Power::wakeFromISR()
+{
+  if (!wakeSem)
+    return;
+  BaseType_t woken = pdFALSE;
+  xSemaphoreGiveFromISR(wakeSem, &woken);
+  if (woken)
+    portYIELD_FROM_ISR();
+}
+
+const PowerStats &Power::stats()
+{
+  return counters;
+}
+
+void Power::report()
+{
+  uint64_t total = counters.activeUs + counters.idleUs + counters.sleepUs;
+  if (!total)
+    return;
+  float active = 100.0f * counters.activeUs / total;
+  float idle = 100.0f * counters.idleUs / total;
+  float sleep = 100.0f * counters.sleepUs / total;
+  float mA = (active * POWER_ACTIVE_MA + idle * POWER_IDLE_MA + sleep * POWER_LIGHT_SLEEP_MA) / 100.0f;
+  Serial.printf("[PWR] duty=%.1f%% idle=%.1f%% sleep=%.1f%% sleeps=%u wake t/g=%u/%u i2c=%u est=%.1fmA\n",
+                active, idle, sleep, (unsigned)counters.sleeps, (unsigned)counters.wakeTimer,
+                (unsigned)counters.wakeGpio, (unsigned)counters.busBusy, mA);
+  counters = {};
+}
@@ -0,0 +1,48 @@
+// Power.h
+#ifndef POWER_H
+#define POWER_H
+
+#include <Arduino.h>
+
+#define POWER_MIN_SLEEP_US 2000  // jendela lebih pendek: loop() jalan terus
+#define POWER_MAX_SLEEP_MS 1000  // tanpa jadwal sama sekali
+// Perkiraan arus modul ESP32 saja (datasheet; LCD/sensor tidak termasuk)
+#define POWER_ACTIVE_MA 50.0f      // CPU 240 MHz jalan
+#define POWER_IDLE_MA 25.0f        // CPU menunggu, WiFi modem-sleep (rata-rata DTIM)
+#define POWER_LIGHT_SLEEP_MA 0.8f
+
+struct PowerStats
+{
+  uint64_t activeUs; // loop() bekerja
+  uint64_t idleUs;   // loop() menunggu (task lain & WiFi tetap jalan)
+  uint64_t sleepUs;  // light sleep
+  uint32_t sleeps;
+  uint32_t wakeTimer;
+  uint32_t wakeGpio; // tombol / SQW DS3231
+  uint32_t busBusy;  // light sleep ditunda karena I2C masih jalan
+};
+
+// Di akhir loop() CPU ditidurkan sampai jadwal terdekat yang dilaporkan
+// lewat due(): sampling, compute/publish, UI, aktuator, persistence.
+// WiFi ON: modem-sleep dan loop() menunggu semaphore (bangun oleh timeout,
+// tombol, detak SQW, SNTP atau perintah MQTT); auto light sleep jika
+// sdkconfig mendukung tickless idle. WiFi OFF: light sleep eksplisit,
+// bangun oleh timer atau level GPIO tombol / SQW.
+class Power
+{
+public:
+  // Panggil di akhir setup() dari task loop()
+  static void begin(bool wifi);
+  // Pekerjaan berikutnya paling lambat ms lagi (0 = jangan tidur)
+  static void due(uint32_t ms);
+  // Tidur/menunggu sampai due() terdekat, lalu reset jadwal
+  static void idle();
+  // Bangunkan loop() lebih awal (task lain / ISR)
+  static void wake();
+  static void wakeFromISR();
+  static const PowerStats &stats();
+  // Cetak duty cycle & perkiraan arus sejak laporan terakhir, lalu reset
+  static void report();
+};
+
+#endif // POWER_H
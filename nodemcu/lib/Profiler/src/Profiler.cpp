@@ -0,0 +1,32 @@
+#include "Profiler.h"
+
+static const char *const SECTION_NAMES[PROF_SECTIONS] = {"ui", "sensor", "alarm", "mqtt", "persist"};
+static ProfileSlot slots[PROF_SECTIONS];
+
+void Profiler::add(ProfileSection s, uint32_t us)
+{
+  ProfileSlot &p = slots[s];
+  p.totalUs += us;
+  if (us > p.maxUs)
+    p.maxUs = us;
+}
+
+const ProfileSlot &Profiler::slot(ProfileSection s)
+{
+  return slots[s];
+}
+
+void Profiler::report(uint32_t passes)
+{
+  if (!passes)
+    return;
+  char line[160];
+  int n = snprintf(line, sizeof(line), "[PROF]");
+  for (uint8_t i = 0; i < PROF_SECTIONS && n < (int)sizeof(line); i++)
+  {
+    n += snprintf(line + n, sizeof(line) - n, " %s=%u/%uus", SECTION_NAMES[i],
+                  (unsigned)(slots[i].totalUs / passes), (unsigned)slots[i].maxUs);
+    slots[i] = {};
+  }
+  Serial.println(line);
+}
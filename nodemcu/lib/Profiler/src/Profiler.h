@@ -0,0 +1,46 @@
+// Profiler.h
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+// Bagian loop() yang diukur
+enum ProfileSection : uint8_t
+{
+  PROF_UI,      // tombol + render LCD
+  PROF_SENSOR,  // sampling & compute sensor
+  PROF_ALARM,   // jam, alarm, aktuator
+  PROF_MQTT,    // antrian MQTT
+  PROF_PERSIST, // flush tertunda ke flash
+  PROF_SECTIONS
+};
+
+struct ProfileSlot
+{
+  uint64_t totalUs;
+  uint32_t maxUs;
+};
+
+// Waktu CPU per bagian loop(), dilaporkan bersama [LOOP] lalu di-reset
+class Profiler
+{
+public:
+  static void add(ProfileSection s, uint32_t us);
+  static const ProfileSlot &slot(ProfileSection s);
+  // Cetak rata-rata per pass loop() & maksimum, lalu reset
+  static void report(uint32_t passes);
+};
+
+// Ukur satu blok: { ProfileScope p(PROF_UI); ... }
+class ProfileScope
+{
+public:
+  explicit ProfileScope(ProfileSection s) : section(s), startUs(micros()) {}
+  ~ProfileScope() { Profiler::add(section, micros() - startUs); }
+
+private:
+  ProfileSection section;
+  uint32_t startUs;
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,144 @@
+#include "Clock.h"
+#include "Config.h"
+#include "Power.h"
+#include <driver/gpio.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+
+static portMUX_TYPE clockMux = portMUX_INITIALIZER_UNLOCKED;
+static int64_t epoch = 0;   // detik lokal
+static int64_t epochUs = 0; // esp_timer saat epoch terakhir maju / diset
+static volatile uint32_t tickCount = 0;
+static bool attached = false;
+static bool wakeArmed = false;
+
+static DateTime cached;
+static uint32_t cachedAt = 0;
+
+// Tepi palsu (< 0,5 s dari detak/set terakhir) diabaikan
+static void IRAM_ATTR tick(int64_t t)
+{
+  if (t - epochUs >= 500000)
+  {
+    epoch++;
+    epochUs = t;
+    tickCount++;
+  }
+}
+
+static void IRAM_ATTR onSqw()
+{
+  int64_t t = esp_timer_get_time();
+  portENTER_CRITICAL_ISR(&clockMux);
+  tick(t);
+  portEXIT_CRITICAL_ISR(&clockMux);
+  Power::wakeFromISR();
+}
+
+void Clock::begin()
+{
+  if (attached)
+    return;
+  attachInterrupt(digitalPinToInterrupt(RTC_INT_PIN), onSqw, FALLING);
+  attached = true;
+}
+
+bool Clock::waitTick(uint32_t timeoutMs)
+{
+  uint32_t t0 = tickCount;
+  unsigned long start = millis();
+  while (tickCount == t0)
+  {
+    if (millis() - start >= timeoutMs)
+      return false;
+    delay(1);
+  }
+  return true;
+}
+
+void Clock::set(uint32_t localEpoch)
+{
+  int64_t t = esp_timer_get_time();
+  portENTER_CRITICAL(&clockMux);
+  epoch = localEpoch;
+  epochUs = t;
+  portEXIT_CRITICAL(&clockMux);
+}
+
+uint32_t Clock::now()
+{
+  portENTER_CRITICAL(&clockMux);
+  int64_t e = epoch;
+  int64_t at = epochUs;
+  portEXIT_CRITICAL(&clockMux);
+  int64_t elapsed = esp_timer_get_time() - at;
+  if (elapsed >= CLOCK_SQW_TIMEOUT_US)
+    e += elapsed / 1000000;
+  return uint32_t(e);
+}
+
+int64_t Clock::nowUs()
+{
+  portENTER_CRITICAL(&clockMux);
+  int64_t e = epoch;
+  int64_t at = epochUs;
+  portEXIT_CRITICAL(&clockMux);
+  int64_t elapsed = esp_timer_get_time() - at;
+  // Detak yang terlambat datang: tahan di akhir detik ini, sama seperti now()
+  if (elapsed >= 1000000 && elapsed < CLOCK_SQW_TIMEOUT_US)
+    elapsed = 999999;
+  return e * 1000000 + elapsed;
+}
+
+const DateTime &Clock::local()
+{
+  uint32_t t = now();
+  if (t != cachedAt)
+  {
+    cached = DateTime(t);
+    cachedAt = t;
+  }
+  return cached;
+}
+
+bool Clock::sqwActive()
+{
+  portENTER_CRITICAL(&clockMux);
+  int64_t at = epochUs;
+  portEXIT_CRITICAL(&clockMux);
+  return tickCount && esp_timer_get_time() - at < CLOCK_SQW_TIMEOUT_US;
+}
+
+uint32_t Clock::ticks()
+{
+  return tickCount;
+}
+
+void Clock::armWake()
+{
+  wakeArmed = attached && digitalRead(RTC_INT_PIN) == HIGH;
+  if (!wakeArmed)
+    return;
+  gpio_intr_disable(gpio_num_t(RTC_INT_PIN));
+  gpio_wakeup_enable(gpio_num_t(RTC_INT_PIN), GPIO_INTR_LOW_LEVEL);
+}
+
+void Clock::disarmWake()
+{
+  if (!wakeArmed)
+    return;
+  wakeArmed = false;
+  gpio_num_t pin = gpio_num_t(RTC_INT_PIN);
+  gpio_wakeup_disable(pin);
+  gpio_set_intr_type(pin, GPIO_INTR_NEGEDGE);
+  // Tepi turun terjadi selama tidur: waktu bangun ≈ waktu detak. ISR yang
+  // mungkin masih tertunda setelah enable ditolak oleh filter 0,5 s.
+  if (digitalRead(RTC_INT_PIN) == LOW)
+  {
+    int64_t t = esp_timer_get_time();
+    portENTER_CRITICAL(&clockMux);
+    tick(t);
+    portEXIT_CRITICAL(&clockMux);
+  }
+  gpio_intr_enable(pin);
+}
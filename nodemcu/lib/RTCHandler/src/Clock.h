@@ -0,0 +1,39 @@
+// Clock.h
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <Arduino.h>
+#include <RTClib.h>
+
+// Tanpa detak SQW selama ini, waktu diteruskan dari esp_timer
+#define CLOCK_SQW_TIMEOUT_US 1500000LL
+// Batas tunggu detak pertama saat sinkron dari DS3231
+#define CLOCK_TICK_WAIT_MS 1100
+
+// Jam perangkat tanpa I2C: DS3231 dibaca sekali (boot / setelah SNTP),
+// selanjutnya epoch 64-bit dimajukan oleh tepi turun SQW 1 Hz (saat register
+// detik DS3231 bertambah) pada RTC_INT_PIN. Jika SQW tidak berdetak, waktu
+// diteruskan dari esp_timer. Satuan: detik "unixtime lokal" (WIB), sama
+// dengan isi DS3231.
+class Clock
+{
+public:
+  // Pasang interrupt SQW; panggil setelah DS3231 dikonfigurasi 1 Hz
+  static void begin();
+  // Tunggu detak SQW berikutnya; false jika tidak datang dalam timeoutMs
+  static bool waitTick(uint32_t timeoutMs);
+  // Set epoch tepat setelah detak SQW / setelah register detik ditulis
+  static void set(uint32_t localEpoch);
+
+  static uint32_t now();         // O(1), tanpa I2C
+  static int64_t nowUs();        // dengan fase sub-detik sejak detak terakhir
+  static const DateTime &local(); // di-cache per detik
+  static bool sqwActive();
+  static uint32_t ticks();
+  // Light sleep: bangun pada tepi turun SQW (hanya jika SQW sedang HIGH);
+  // detak yang terjadi selama tidur disusulkan saat disarm
+  static void armWake();
+  static void disarmWake();
+};
+
+#endif // CLOCK_H
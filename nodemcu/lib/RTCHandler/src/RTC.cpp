@@ -1,18 +1,64 @@
 // RTC.cpp
 #include "RTC.h"
+#include "Clock.h"
 #include "Config.h"
+#include "I2CBus.h"
+#include "Power.h"
 #include <Wire.h>
 #include <Arduino.h>
 #include <WiFi.h>
 #include <time.h>
+#include <sys/time.h>
+#include <math.h>
+#include <esp_sntp.h>
+
+#define DS3231_ADDR 0x68
+#define DS3231_REG_CONTROL 0x0E
+#define DS3231_REG_STATUS 0x0F
+#define DS3231_REG_AGING 0x10
+
+static volatile bool sntpSynced = false;
+
+// Dipanggil dari task lwIP: hanya set flag, I2C dikerjakan di loop()
+static void onSntpSync(struct timeval *)
+{
+    sntpSynced = true;
+    Power::wake();
+}
+
+// Dijalankan di dalam job I2CBus
+static bool readReg(uint8_t reg, uint8_t &val)
+{
+    Wire.beginTransmission(DS3231_ADDR);
+    Wire.write(reg);
+    if (Wire.endTransmission() != 0 || Wire.requestFrom(DS3231_ADDR, 1) != 1)
+        return false;
+    val = Wire.read();
+    return true;
+}
+
+static bool writeReg(uint8_t reg, uint8_t val)
+{
+    Wire.beginTransmission(DS3231_ADDR);
+    Wire.write(reg);
+    Wire.write(val);
+    return Wire.endTransmission() == 0;
+}
+
+// Waktu sistem (hasil SNTP) dalam mikrodetik "unixtime lokal"
+static int64_t systemLocalUs()
+{
+    struct timeval tv;
+    gettimeofday(&tv, nullptr);
+    return (int64_t(tv.tv_sec) + RTC_GMT_OFFSET_SEC) * 1000000LL + tv.tv_usec;
+}
 
 RTCHandler::RTCHandler() {}
 
 void RTCHandler::setupRTC()
 {
-    // 1) Inisialisasi I2C dan modul DS3231
-    Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN); // sesuaikan SDA/SCL
-    if (!rtc.begin())
+    // 1) Modul DS3231 (Wire sudah dibuka I2CBus::begin())
+    if (!I2CBus::run(I2C_DEV_RTC, [this] { return rtc.begin(); }))
     {
         Serial.println("[RTC] DS3231 not found!");
         while (1)
@@ -20,71 +66,174 @@ void RTCHandler::setupRTC()
             delay(1000);
         }
     }
-    rtc.clearAlarm(1);
-    rtc.clearAlarm(2);
-    rtc.disable32K();
+    uint8_t aging = 0;
+    bool agingOk = false;
+    I2CBus::run(I2C_DEV_RTC, [&] {
+        rtc.clearAlarm(1);
+        rtc.clearAlarm(2);
+        rtc.disableAlarm(1);
+        rtc.disableAlarm(2);
+        rtc.disable32K();
+        // INTCN=0: pin SQW mengeluarkan 1 Hz untuk Clock
+        rtc.writeSqwPinMode(DS3231_SquareWave1Hz);
+        agingOk = readReg(DS3231_REG_AGING, aging);
+        return true;
+    });
+    if (agingOk)
+        stats.aging = int8_t(aging);
+
+    // 2) Jam langsung dari DS3231; SNTP berjalan di background (tanpa
+    //    menunggu jaringan) dan hasilnya diterapkan lewat loop()
+    sntpSynced = false;
+    Clock::begin();
+    syncClock();
 
-    // 2) Sinkronisasi waktu via SNTP—hanya kalau WiFi aktif
     if (wifiEnabled)
     {
-        const char *ntpServer = "pool.ntp.org";
-        const long gmtOffset_sec = 7 * 3600; // WIB (UTC+7)
-        const int daylightOffset = 0;
+        sntp_set_time_sync_notification_cb(onSntpSync);
+        sntp_set_sync_interval(RTC_SNTP_INTERVAL_MS);
+        configTime(RTC_GMT_OFFSET_SEC, 0, "pool.ntp.org");
+        Serial.println("[RTC] SNTP started in background");
+    }
+    else
+    {
+        Serial.println("[RTC] WiFi OFF, skip SNTP sync");
+    }
+}
 
-        configTime(gmtOffset_sec, daylightOffset, ntpServer);
-        Serial.print("[RTC] Waiting for SNTP sync");
+// Baca DS3231 tepat setelah detak SQW: register detik baru saja bertambah,
+// jadi epoch Clock sefase dengan RTC
+void RTCHandler::syncClock()
+{
+    bool sqw = Clock::waitTick(CLOCK_TICK_WAIT_MS);
+    uint32_t t = 0;
+    I2CBus::run(I2C_DEV_RTC, [&] {
+        t = rtc.now().unixtime();
+        return true;
+    });
+    Clock::set(t);
+    Serial.printf("[RTC] Clock synced (%s)\n", sqw ? "SQW 1 Hz" : "no SQW, esp_timer");
+}
 
-        struct tm timeinfo;
-        unsigned long start = millis();
-        bool synced = false;
+bool RTCHandler::loop()
+{
+    if (stepPending)
+        return stepAligned();
+    if (!sntpSynced)
+        return false;
+    sntpSynced = false;
+    onSntp(systemLocalUs() - Clock::nowUs());
+    return true;
+}
 
-        // Tunggu hingga getLocalTime() berhasil atau timeout 5 detik
-        while (millis() - start < 5000)
-        {
-            if (getLocalTime(&timeinfo))
-            {
-                synced = true;
-                break;
-            }
-            Serial.print(".");
-            delay(500);
-        }
+// offsetUs = SNTP − Clock (positif = RTC lambat). Drift diukur dari
+// perubahan offset sejak titik referensi; register aging diubah agar drift
+// hilang sekaligus menarik sisa offset ke nol dalam RTC_SLEW_SPAN_SEC.
+// Offset besar dikoreksi langsung (step) pada batas detik SNTP.
+void RTCHandler::onSntp(int64_t offsetUs)
+{
+    int64_t nowUs = systemLocalUs();
+    stats.syncs++;
+    stats.lastOffsetMs = int32_t(offsetUs / 1000);
+    stats.lastSyncAt = uint32_t(nowUs / 1000000LL) - RTC_GMT_OFFSET_SEC;
 
-        if (synced)
-        {
-            Serial.println("\n[RTC] SNTP sync OK");
-            // Set waktu ke RTC modul DS3231
-            DateTime now(
-                timeinfo.tm_year + 1900,
-                timeinfo.tm_mon + 1,
-                timeinfo.tm_mday,
-                timeinfo.tm_hour,
-                timeinfo.tm_min,
-                timeinfo.tm_sec);
-            rtc.adjust(now);
-            Serial.printf(
-                "[RTC] Time set: %04d-%02d-%02d %02d:%02d:%02d\n",
-                timeinfo.tm_year + 1900,
-                timeinfo.tm_mon + 1,
-                timeinfo.tm_mday,
-                timeinfo.tm_hour,
-                timeinfo.tm_min,
-                timeinfo.tm_sec);
-        }
-        else
+    if (!haveRef)
+    {
+        haveRef = true;
+        refUs = nowUs;
+        refOffsetUs = offsetUs;
+    }
+    else if (nowUs - refUs >= int64_t(RTC_DRIFT_MIN_SPAN_SEC) * 1000000LL)
+    {
+        // ppm = µs per detik
+        float measured = float(offsetUs - refOffsetUs) / float((nowUs - refUs) / 1000000LL);
+        stats.driftPpm = measured;
+        // Tiap LSB aging memperlambat osilator ±RTC_AGING_PPM_PER_LSB;
+        // target laju: negatif dari offset yang tersisa, dibagi jendela slew
+        float target = -float(offsetUs) / float(RTC_SLEW_SPAN_SEC);
+        if (offsetUs >= RTC_STEP_THRESHOLD_US || offsetUs <= -RTC_STEP_THRESHOLD_US)
+            target = 0; // offset dihapus step, cukup hilangkan drift
+        long next = lroundf(stats.aging + (target - measured) / RTC_AGING_PPM_PER_LSB);
+        next = next > 127 ? 127 : next < -128 ? -128 : next;
+        if (next != stats.aging && setAging(int8_t(next)))
         {
-            Serial.println("\n[RTC] SNTP sync timeout, skip");
+            Serial.printf("[RTC] Aging %d -> %ld (drift %+.2f ppm)\n", stats.aging, next, measured);
+            stats.aging = int8_t(next);
         }
+        refUs = nowUs;
+        refOffsetUs = offsetUs;
     }
-    else
+
+    if (offsetUs >= RTC_STEP_THRESHOLD_US || offsetUs <= -RTC_STEP_THRESHOLD_US)
     {
-        Serial.println("[RTC] WiFi OFF, skip SNTP sync");
+        stepPending = true;
+        stepOffsetUs = offsetUs;
     }
+    Serial.printf("[RTC] SNTP offset %+ldms drift %+.2fppm aging %d%s\n", (long)stats.lastOffsetMs,
+                  stats.driftPpm, stats.aging, stepPending ? " (step)" : "");
+}
+
+// Tulis detik berikutnya tepat saat batas detik SNTP: menulis register
+// detik mereset pembagi DS3231, jadi detak SQW berikutnya tepat 1 s setelah
+// ini dan Clock bisa langsung diset tanpa membaca ulang. Dicoba tiap loop
+// sampai batas detik jatuh dalam RTC_STEP_WINDOW_US. Penantian ke batas
+// detik dilakukan di dalam job, jadi antrean bus tidak menggeser fasenya.
+bool RTCHandler::stepAligned()
+{
+    int64_t nowUs = systemLocalUs();
+    if (1000000UL - uint32_t(nowUs % 1000000LL) > RTC_STEP_WINDOW_US)
+        return false;
+    uint32_t sec = 0;
+    I2CBus::run(I2C_DEV_RTC, [&] {
+        int64_t t = systemLocalUs();
+        uint32_t toNext = 1000000UL - uint32_t(t % 1000000LL);
+        if (toNext > RTC_STEP_WINDOW_US)
+            return true; // batas detik terlewat selama antre, coba lagi
+        delayMicroseconds(toNext);
+        sec = uint32_t(t / 1000000LL) + 1;
+        rtc.adjust(DateTime(sec));
+        return true;
+    });
+    if (!sec)
+        return false;
+    Clock::set(sec);
+    stepPending = false;
+    stats.steps++;
+    // Step bukan drift: geser referensi agar estimasi berikutnya tidak ikut
+    refOffsetUs -= stepOffsetUs;
+    Serial.printf("[RTC] Stepped %+ldms\n", (long)(stepOffsetUs / 1000));
+    return true;
+}
+
+uint32_t RTCHandler::idleMs() const
+{
+    if (!stepPending)
+        return UINT32_MAX;
+    uint32_t toNext = 1000000UL - uint32_t(systemLocalUs() % 1000000LL);
+    return toNext > RTC_STEP_WINDOW_US ? (toNext - RTC_STEP_WINDOW_US) / 1000 : 0;
+}
+
+// Nilai baru berlaku setelah konversi suhu berikutnya; dipaksa lewat CONV
+bool RTCHandler::setAging(int8_t value)
+{
+    return I2CBus::run(I2C_DEV_RTC, [value] {
+        if (!writeReg(DS3231_REG_AGING, uint8_t(value)))
+            return false;
+        uint8_t ctrl, status;
+        if (readReg(DS3231_REG_STATUS, status) && !(status & 0x04) && readReg(DS3231_REG_CONTROL, ctrl))
+            writeReg(DS3231_REG_CONTROL, ctrl | 0x20);
+        return true;
+    });
+}
+
+const ClockSyncStats &RTCHandler::syncStats()
+{
+    return stats;
 }
 
 String RTCHandler::getTime()
 {
-    DateTime now = rtc.now();
+    const DateTime &now = Clock::local();
     char buffer[9];
     sprintf(buffer, "%02d:%02d:%02d", now.hour(), now.minute(), now.second());
     return String(buffer);
@@ -92,6 +241,23 @@ String RTCHandler::getTime()
 
 String RTCHandler::getDate()
 {
-    DateTime now = rtc.now();
+    const DateTime &now = Clock::local();
     return String(now.day()) + "/" + String(now.month()) + "/" + String(now.year());
-}
\ No newline at end of file
+}
+
+uint32_t RTCHandler::readUnixtime()
+{
+    uint32_t t = 0;
+    bool ok = I2CBus::run(I2C_DEV_RTC, [&] {
+        if (!rtc.begin())
+            return false;
+        t = rtc.now().unixtime();
+        return true;
+    });
+    return ok ? t - RTC_GMT_OFFSET_SEC : 0;
+}
+
+uint32_t RTCHandler::unixtime()
+{
+    return Clock::now() - RTC_GMT_OFFSET_SEC;
+}
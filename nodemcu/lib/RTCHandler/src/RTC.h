@@ -4,6 +4,27 @@
 
 #include <RTClib.h>
 
+// DS3231 menyimpan waktu lokal WIB (UTC+7)
+#define RTC_GMT_OFFSET_SEC (7 * 3600)
+
+// Disiplin SNTP (berjalan di background, boot tidak menunggu jaringan)
+#define RTC_SNTP_INTERVAL_MS (3600UL * 1000)
+#define RTC_STEP_THRESHOLD_US 250000LL     // offset >= ini dikoreksi step
+#define RTC_STEP_WINDOW_US 20000UL         // tunggu maks sebelum batas detik
+#define RTC_DRIFT_MIN_SPAN_SEC (12 * 3600UL) // jarak minimum antar estimasi drift
+#define RTC_SLEW_SPAN_SEC (24 * 3600L)     // sisa offset ditarik ke nol dalam ini
+#define RTC_AGING_PPM_PER_LSB 0.1f         // DS3231 pada 25 °C
+
+struct ClockSyncStats
+{
+  uint32_t syncs;      // sinkron SNTP yang diproses
+  uint32_t steps;      // koreksi langsung (offset besar)
+  int32_t lastOffsetMs; // SNTP − RTC sebelum koreksi (+ = RTC lambat)
+  float driftPpm;      // laju offset terukur dengan aging sekarang
+  int8_t aging;        // isi register aging DS3231
+  uint32_t lastSyncAt; // unixtime UTC sinkron terakhir
+};
+
 class RTCHandler
 {
 public:
@@ -11,9 +32,31 @@ public:
   void setupRTC();
   String getTime();
   String getDate();
+  // Unix time UTC (untuk timestamp telemetry offline)
+  uint32_t unixtime();
+  // Baca DS3231 langsung tanpa Clock/SQW/SNTP (mode baterai); 0 jika gagal
+  uint32_t readUnixtime();
+  // Dipanggil tiap loop: proses sinkron SNTP (offset, drift, aging) dan
+  // step yang tertunda. true jika ada hasil baru (jadwal alarm dihitung
+  // ulang, status jam dipublikasikan).
+  bool loop();
+  const ClockSyncStats &syncStats();
+  // ms sampai loop() harus dipanggil (jendela step); UINT32_MAX jika tidak ada
+  uint32_t idleMs() const;
 
 private:
+  void syncClock();
+  void onSntp(int64_t offsetUs);
+  bool stepAligned();
+  bool setAging(int8_t value);
+
   RTC_DS3231 rtc;
+  ClockSyncStats stats = {};
+  bool haveRef = false;
+  int64_t refUs = 0;       // waktu SNTP titik referensi drift
+  int64_t refOffsetUs = 0; // offset pada titik referensi
+  bool stepPending = false;
+  int64_t stepOffsetUs = 0;
 };
 
 #endif
\ No newline at end of file
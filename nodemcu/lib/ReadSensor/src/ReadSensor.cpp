@@ -1,15 +1,16 @@
 // Sensor.cpp
 #include "ReadSensor.h"
 #include <Arduino.h>
-#include <LittleFS.h>
+#include "Storage.h"
 #include "Config.h"
+#include "Schema.h"
+#include "Persistence.h"
+#include "CalibStore.h"
 
 // ======================================================
 // (1) Konstanta & buffer ADC
 // ======================================================
 #define SCOUNT 30
-#define VREF 3.3f
-#define BASELINE_OFFSET 4.3f
 static OneWire oneWire(TEMPERATURE_PIN);
 static DallasTemperature dsSensor(&oneWire);
 extern char deviceId[]; // pastikan dideklarasikan di main.cpp
@@ -18,10 +19,10 @@ static int buf[SCOUNT];
 static uint8_t bufIndex = 0;
 unsigned long Sensor::lastTempRequestMs = 0;
 
-const float voltage7 = 2.51f, voltage4 = 3.11f;
+// Konstanta pH, baseline turbidity & koreksi ADC dibaca langsung dari
+// partisi kalibrasi (CalibStore::tables()), bukan disalin ke sini
 static const int nCalibSamples = 50;
-static const float Vmin = 0.50f;
-static float Vmax = 3.30f;
+static float Vmax = 3.30f; // tegangan air jernih, diukur saat init() jika partisi tidak menyimpannya
 
 #define PH_SCOUNT 30
 static int phBuf[PH_SCOUNT];
@@ -44,8 +45,9 @@ TDSConfig Sensor::getTDSConfig()
   return tdsConfig;
 }
 
-// Nama file di LittleFS
-static const char *SENSOR_SETTINGS_FILE = "/sensor_settings.bin";
+// Log sensor settings (path di Storage.h)
+static RecordLog settingsLog(STORAGE_SENSORS_LOG, MAX_SENSOR_SETTINGS, LEGACY_SENSOR_SIZE,
+                             SCHEMA_SENSOR, SENSOR_RECORD_SIZE);
 void Sensor::initTemperatureSensor()
 {
   dsSensor.begin();
@@ -67,41 +69,70 @@ float Sensor::readTemperatureC()
 }
 void Sensor::initAllSettings()
 {
-  if (!LittleFS.begin(true))
+  if (!settingsLog.begin())
   {
-    Serial.println("⚠️ LittleFS.begin() gagal di initAllSettings()");
+    Serial.println("⚠️ Gagal buka log sensor settings");
     return;
   }
 
-  bool needWriteDefaults = false;
-
-  if (!LittleFS.exists(SENSOR_SETTINGS_FILE))
+  // Record yang gagal divalidasi dibuang satu per satu, sisanya tetap dipakai
+  settingCount = 0;
+  uint8_t dropped = 0;
+  bool migrate = settingsLog.schema() != SCHEMA_SENSOR;
+  if (settingsLog.count() > 0)
   {
-    // File belum pernah tercipta → wajib tulis default
-    needWriteDefaults = true;
+    for (uint8_t i = 0; i < settingsLog.count() && settingCount < MAX_SENSOR_SETTINGS; i++)
+    {
+      uint16_t key;
+      const uint8_t *rec;
+      uint8_t len;
+      settingsLog.at(i, key, rec, len);
+      if (decodeSensorSetting(settingsLog.schema(), rec, len, settings[settingCount]))
+        settingCount++;
+      else
+        dropped++;
+    }
   }
-  else
+  else if (Storage::fs().exists(STORAGE_LEGACY_SENSORS))
   {
-    // File sudah ada → baca header (jumlah record)
-    File f = LittleFS.open(SENSOR_SETTINGS_FILE, "r");
+    // Migrasi sekali dari format lama (byte jumlah + dump struct SensorSetting)
+    File f = Storage::fs().open(STORAGE_LEGACY_SENSORS, "r");
     if (!f)
     {
       Serial.println("⚠️ Gagal buka file sensor settings");
       return;
     }
-    uint8_t cnt = f.read(); // byte pertama: jumlah setting
-    f.close();
-
-    // Jika header cnt == 0 atau cnt > MAX_SENSOR_SETTINGS,
-    // artinya tidak ada setting valid di file → kita perlu overwrite default
-    if (cnt == 0 || cnt > MAX_SENSOR_SETTINGS)
+    uint8_t cnt = f.read();
+    uint8_t rec[LEGACY_SENSOR_SIZE];
+    for (uint8_t i = 0; i < cnt && settingCount < MAX_SENSOR_SETTINGS; i++)
     {
-      needWriteDefaults = true;
+      if (f.read(rec, sizeof(rec)) != sizeof(rec))
+        break;
+      if (decodeSensorSetting(SCHEMA_LEGACY, rec, sizeof(rec), settings[settingCount]))
+        settingCount++;
+      else
+        dropped++;
     }
+    f.close();
+    migrate = true;
+  }
+
+  if (settingCount > 0 && (migrate || dropped))
+  {
+    // Tulis ulang seluruh log dengan schema sekarang
+    uint8_t rec[SENSOR_RECORD_SIZE];
+    settingsLog.clear();
+    for (uint8_t i = 0; i < settingCount; i++)
+      settingsLog.stage(uint16_t(settings[i].type), rec, encodeSensorSetting(settings[i], rec));
+    if (settingsLog.compact())
+      Storage::fs().remove(STORAGE_LEGACY_SENSORS);
+    Serial.printf("ℹ️ Migrated %u sensor settings ke schema %u (%u invalid dibuang)\n",
+                  settingCount, SCHEMA_SENSOR, dropped);
   }
 
-  if (needWriteDefaults)
+  if (settingCount == 0)
   {
+    settingsLog.clear();
     // Buat tiga default setting (Turbidity, TDS, pH)
     settingCount = 4;
     nextSettingId = 4; // karena ID 1,2,3 sudah dipakai
@@ -141,40 +172,20 @@ void Sensor::initAllSettings()
       settings[i].tempIndex = 0;
     }
 
-    // Tulis default ke file
-    File f = LittleFS.open(SENSOR_SETTINGS_FILE, "w");
-    if (!f)
+    // Ditulis sebagai log baru (compaction) supaya sisa schema lama ikut hilang
+    uint8_t rec[SENSOR_RECORD_SIZE];
+    for (uint8_t i = 0; i < settingCount; i++)
+      settingsLog.stage(uint16_t(settings[i].type), rec, encodeSensorSetting(settings[i], rec));
+    if (!settingsLog.compact())
     {
       Serial.println("⚠️ Gagal tulis default sensor settings");
       return;
     }
-    f.write(settingCount);
-    for (uint8_t i = 0; i < settingCount; i++)
-    {
-      f.write((uint8_t *)&settings[i], sizeof(SensorSetting));
-    }
-    f.close();
+    Storage::fs().remove(STORAGE_LEGACY_SENSORS);
     Serial.println("✅ Default sensor settings ditulis ke LittleFS");
   }
   else
   {
-    // Baca array settings[] dari file
-    File f = LittleFS.open(SENSOR_SETTINGS_FILE, "r");
-    if (!f)
-    {
-      Serial.println("⚠️ Gagal buka file sensor settings");
-      return;
-    }
-    uint8_t cnt = f.read();
-    if (cnt > MAX_SENSOR_SETTINGS)
-      cnt = 0;
-    settingCount = cnt;
-    for (uint8_t i = 0; i < settingCount; i++)
-    {
-      f.read((uint8_t *)&settings[i], sizeof(SensorSetting));
-    }
-    f.close();
-
     // Hitung nextSettingId untuk mencegah duplikat
     nextSettingId = 1;
     for (uint8_t i = 0; i < settingCount; i++)
@@ -184,47 +195,55 @@ void Sensor::initAllSettings()
     Serial.printf("ℹ️ Loaded %u sensor settings dari file\n", settingCount);
   }
 }
+
+// Hanya setting yang berubah yang ditulis (satu record per type)
 void Sensor::saveAllSettings()
 {
-  if (!LittleFS.begin(true))
-  {
-    Serial.println("⚠️ LittleFS.begin() gagal di saveAllSettings()");
-    return;
-  }
-  File f = LittleFS.open(SENSOR_SETTINGS_FILE, "w");
-  if (!f)
-  {
-    Serial.println("⚠️ Gagal buka file untuk menulis sensor settings");
-    return;
-  }
-  f.write(settingCount); // tulis jumlah setting
+  uint16_t keys[MAX_SENSOR_SETTINGS];
+  uint8_t rec[SENSOR_RECORD_SIZE];
   for (uint8_t i = 0; i < settingCount; i++)
   {
-    f.write((uint8_t *)&settings[i], sizeof(SensorSetting));
+    keys[i] = uint16_t(settings[i].type);
+    if (!settingsLog.put(keys[i], rec, encodeSensorSetting(settings[i], rec)))
+    {
+      Serial.println("⚠️ Gagal menulis sensor settings");
+      return;
+    }
   }
-  f.close();
-  Serial.println("✅ Sensor settings berhasil disimpan ke LittleFS");
+  settingsLog.retainOnly(keys, settingCount);
 }
+
+const RecordLogStats &Sensor::storageStats()
+{
+  return settingsLog.stats();
+}
+
 SensorSetting *Sensor::getAllSettings(uint8_t &outCount)
 {
   outCount = settingCount;
   return settings;
 }
+// true jika setting ditemukan; ditandai dirty hanya jika isinya berubah
 bool Sensor::editSetting(const SensorSetting &s)
 {
   for (uint8_t i = 0; i < settingCount; i++)
   {
-    if (settings[i].id == s.id || (settings[i].isTemporary && settings[i].tempIndex == s.tempIndex))
+    SensorSetting &cur = settings[i];
+    if (cur.id == s.id || (cur.isTemporary && cur.tempIndex == s.tempIndex))
     {
-      settings[i].minValue = s.minValue;
-      settings[i].maxValue = s.maxValue;
-      settings[i].enabled = s.enabled;
-      settings[i].pending = true;
+      if (cur.minValue == s.minValue && cur.maxValue == s.maxValue &&
+          cur.enabled == s.enabled && cur.pending)
+        return true;
+      cur.minValue = s.minValue;
+      cur.maxValue = s.maxValue;
+      cur.enabled = s.enabled;
+      cur.pending = true;
       // jika id==0 (offline‐add), keep isTemporary=true dan atur tempIndex
-      break;
+      Persistence::markDirty(PERSIST_SENSORS);
+      return true;
     }
   }
-  saveAllSettings();
+  return false;
 }
 bool Sensor::addSetting(const SensorSetting &s)
 {
@@ -239,17 +258,30 @@ bool Sensor::addSetting(const SensorSetting &s)
   SensorSetting ns = s;
   ns.id = nextSettingId++;
   settings[settingCount++] = ns;
-  saveAllSettings();
+  Persistence::markDirty(PERSIST_SENSORS);
   return true;
 }
 
+// Tegangan air jernih: dari partisi kalibrasi, atau diukur (±2,5 detik)
+static float turbidityBaseline()
+{
+  if (CalibStore::tables().turbidityVmax > 0)
+    return CalibStore::tables().turbidityVmax;
+  float sumV = 0;
+  for (int i = 0; i < nCalibSamples; i++)
+  {
+    sumV += CalibStore::adcVolts(analogRead(TURBIDITY_PIN));
+    delay(50);
+  }
+  return sumV / nCalibSamples;
+}
+
 // ======================================================
 // (7) Fungsi init() (hardware‐related)
 //     — Hanya menginisialisasi ADC / buffer, TIDAK memanggil loadAllSettings()
 // ======================================================
 void Sensor::init()
 {
-  LittleFS.begin(true); // Mount LittleFS, tapi array sudah diisi di initAllSettings()
   analogSetWidth(12);
   analogSetPinAttenuation(TDS_PIN, ADC_11db);
   analogSetPinAttenuation(PH_PIN, ADC_11db); // <<< untuk pH probe
@@ -262,14 +294,7 @@ void Sensor::init()
   }
   bufIndex = 0;
 
-  float sumV = 0;
-  for (int i = 0; i < nCalibSamples; i++)
-  {
-    int raw = analogRead(TURBIDITY_PIN);
-    sumV += raw * (3.3f / 4095.0f);
-    delay(50);
-  }
-  Vmax = sumV / nCalibSamples;
+  Vmax = turbidityBaseline();
 
   for (int i = 0; i < PH_SCOUNT; i++)
   {
@@ -282,6 +307,59 @@ void Sensor::init()
 // ======================================================
 // (8) Fungsi‐fungsi baca sensor (seperti semula)
 // ======================================================
+float Sensor::initBurst(float vmax, uint8_t tempResolution)
+{
+  analogSetWidth(12);
+  analogSetPinAttenuation(TDS_PIN, ADC_11db);
+  analogSetPinAttenuation(PH_PIN, ADC_11db);
+  dsSensor.begin();
+  dsSensor.setWaitForConversion(false);
+  dsSensor.setResolution(tempResolution);
+  // Konversi suhu berjalan selama burst ADC
+  dsSensor.requestTemperatures();
+  lastTempRequestMs = millis();
+  loadTDSConfig();
+  Vmax = vmax > 0 ? vmax : turbidityBaseline();
+  return Vmax;
+}
+
+void Sensor::burst(uint8_t tempResolution)
+{
+  for (int i = 0; i < SCOUNT; i++)
+  {
+    sample();
+    delay(SENSOR_BURST_GAP_MS);
+  }
+  uint32_t waitMs = dsSensor.millisToWaitForConversion(tempResolution);
+  while (millis() - lastTempRequestMs < waitMs && !dsSensor.isConversionComplete())
+    delay(1);
+}
+
+bool Sensor::outOfRange(const SensorSetting &s, const SensorSnapshot &v)
+{
+  if (!s.enabled)
+    return false;
+  float value;
+  switch (s.type)
+  {
+  case S_TEMPERATURE:
+    value = v.temperature;
+    break;
+  case S_TURBIDITY:
+    value = v.turbidity;
+    break;
+  case S_TDS:
+    value = v.tds;
+    break;
+  case S_PH:
+    value = v.ph;
+    break;
+  default:
+    return false;
+  }
+  return value < s.minValue || value > s.maxValue;
+}
+
 void Sensor::sample()
 {
   buf[bufIndex++] = analogRead(TDS_PIN);
@@ -328,7 +406,7 @@ void Sensor::blinkAlertLED() {
   }
 }
 
-void Sensor::checkSensorLimits()
+void Sensor::checkSensorLimits(const SensorSnapshot &v)
 {
   bool currentAlert = false;  // Apakah ada alert saat ini?
 
@@ -346,27 +424,25 @@ void Sensor::checkSensorLimits()
     switch (s.type)
     {
     case S_TEMPERATURE:
-      value = readTemperatureC();
+      value = v.temperature;
       label = "Temperature";
       break;
     case S_TURBIDITY:
-      value = readTDBT();
+      value = v.turbidity;
       label = "Turbidity";
       break;
     case S_TDS:
-      value = readTDS();
+      value = v.tds;
       label = "TDS";
       break;
     case S_PH:
-      value = readPH();
+      value = v.ph;
       label = "pH";
       break;
     default:
       continue;
     }
 
-    yield(); // beri kesempatan scheduler
-
     char msg[128];
     if (value < s.minValue || value > s.maxValue)
     {
@@ -395,8 +471,6 @@ void Sensor::checkSensorLimits()
       }
       alerted[i] = false;
     }
-
-    yield();
   }
 
   // Kelola status alert global
@@ -408,9 +482,6 @@ void Sensor::checkSensorLimits()
       blinkCount = 0;
       digitalWrite(LED_THREE, LED_ON);  // Mulai dari mati
     }
-    
-    // Panggil fungsi untuk mengedipkan LED
-    blinkAlertLED();
   } else {
     if (alertActive) {
       // Alert berakhir
@@ -420,18 +491,25 @@ void Sensor::checkSensorLimits()
   }
 }
 
+// Pola kedip butuh dipanggil tiap loop, bukan hanya saat snapshot baru
+void Sensor::loopAlert()
+{
+  if (alertActive)
+    blinkAlertLED();
+}
+
 void Sensor::calibrateTDS(float knownTDS, float temperature)
 {
   int raw = analogRead(TDS_PIN);
-  float voltage = raw * (VREF / 4095.0f);
+  float voltage = CalibStore::adcVolts(raw);
 
   // Kompensasi suhu (standar larutan KCl)
-  float compV = voltage / (1.0f + 0.019f * (temperature - 25.0f));
+  float compV = voltage / (1.0f + CalibStore::tables().tdsTempCoeff * (temperature - 25.0f));
 
   // Hitung slope & intercept
   tdsConfig.slope = knownTDS / compV;
   tdsConfig.intercept = 0; // Biarkan 0 agar sederhana
-  saveTDSConfig();
+  Persistence::markDirty(PERSIST_CALIB);
 }
 
 float Sensor::readTDS()
@@ -451,10 +529,10 @@ float Sensor::readTDS()
   }
   int med = (SCOUNT & 1) ? tmp[SCOUNT / 2]
                         : (tmp[SCOUNT / 2] + tmp[SCOUNT / 2 - 1]) / 2;
-  float voltage = float(med) * VREF / 4095.0f;
+  float voltage = CalibStore::adcVolts(med);
 
   // FIX: Kompensasi suhu (koefisien 1.9%/°C untuk KCl)
-  float compV = voltage / (1.0f + 0.019f * (readTemperatureC() - 25.0f));
+  float compV = voltage / (1.0f + CalibStore::tables().tdsTempCoeff * (readTemperatureC() - 25.0f));
 
   // FIX: Rumus linear + kalibrasi
   float tds = tdsConfig.slope * compV + tdsConfig.intercept;
@@ -464,9 +542,10 @@ float Sensor::readTDS()
 float Sensor::readPH()
 {
   int analogValue = analogRead(PH_PIN);
-  float voltage = analogValue * (3.3f / 4095.0f);
-  float slope = (7.0 - 4.0) / (voltage7 - voltage4);
-  float intercept = 7.0 - slope * voltage7;
+  float voltage = CalibStore::adcVolts(analogValue);
+  const CalibTables &cal = CalibStore::tables();
+  float slope = (7.0 - 4.0) / (cal.phVoltage7 - cal.phVoltage4);
+  float intercept = 7.0 - slope * cal.phVoltage7;
   float phValue = slope * voltage + intercept;
   return phValue;
 }
@@ -474,7 +553,8 @@ float Sensor::readPH()
 float Sensor::readTDBT()
 {
   int rawADC = analogRead(TURBIDITY_PIN);
-  float voltage = rawADC * (3.3f / 4095.0f);
+  float voltage = CalibStore::adcVolts(rawADC);
+  float Vmin = CalibStore::tables().turbidityVmin;
   float turbPct;
   if (voltage >= Vmax)
   {
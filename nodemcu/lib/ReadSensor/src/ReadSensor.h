@@ -7,8 +7,10 @@
 #include <DallasTemperature.h>
 #include <OneWire.h>
 #include "Config.h"
+#include "RecordLog.h"
 
 #define MAX_SENSOR_SETTINGS  10
+#define SENSOR_BURST_GAP_MS  2   // jarak sampel ADC saat burst (mode baterai)
 
 // Jenis sensor
 enum SensorType {
@@ -32,6 +34,14 @@ struct SensorSetting {
     uint16_t   tempIndex;    // indeks sementara untuk matching ACK
 };
 
+// Hasil compute sensor terakhir (main loop, tiap 1 detik)
+struct SensorSnapshot {
+    float temperature;
+    float turbidity;
+    float tds;
+    float ph;
+};
+
 class Sensor {
 public:
     // Inisialisasi (panggil di setup())
@@ -41,6 +51,13 @@ public:
     static void loadTDSConfig();
     static void saveTDSConfig();
 
+    // Mode baterai: init tanpa pengisian buffer & kalibrasi yang memblokir.
+    // vmax > 0 = baseline turbidity dari wake sebelumnya; dikembalikan
+    // baseline yang dipakai. Konversi suhu langsung dimulai.
+    static float initBurst(float vmax, uint8_t tempResolution);
+    // Isi buffer median TDS/pH lalu tunggu konversi suhu selesai
+    static void burst(uint8_t tempResolution);
+
     // Sampling periodik (panggil di loop())
     static void sample();
     // Baca nilai
@@ -53,12 +70,17 @@ public:
     // Persistence dasar
     static void initAllSettings();
     static void saveAllSettings();
+    static const RecordLogStats &storageStats();
     // CRUD API untuk setting
     static SensorSetting* getAllSettings(uint8_t &outCount);
     static bool            addSetting(const SensorSetting &s);
     static bool            editSetting(const SensorSetting &s);
     static bool            removeSetting(uint16_t id);
-    static void checkSensorLimits();
+    // Bandingkan snapshot dengan batas; LED alert dikedipkan lewat loopAlert()
+    static void checkSensorLimits(const SensorSnapshot &v);
+    // true jika setting aktif dan nilai snapshot di luar [min, max]
+    static bool outOfRange(const SensorSetting &s, const SensorSnapshot &v);
+    static void loopAlert();
     static SensorSetting settings[MAX_SENSOR_SETTINGS];
     static uint8_t       settingCount;
     static TDSConfig getTDSConfig();
@@ -0,0 +1,365 @@
+#include "RecordLog.h"
+#include <rom/crc.h>
+
+static const uint8_t FRAME_SYNC = 0xA5;
+static const uint8_t FRAME_OVERHEAD = 9; // sync, op, key(2), len, crc(4)
+static const uint8_t HEADER_SIZE = 12;
+static const uint8_t HEADER_MAGIC[4] = {'R', 'L', 'O', 'G'};
+
+enum RecordOp : uint8_t
+{
+  OP_PUT = 1,
+  OP_DEL = 2,
+  OP_META = 3 // lifetimeBytes, lifetimeCompactions: ditulis di awal file hasil compaction
+};
+
+RecordLog::RecordLog(const char *path, uint16_t maxKeys, uint8_t maxLen,
+                     uint8_t schemaVersion, uint8_t recordSize)
+    : path(path), maxKeys(maxKeys), maxLen(maxLen),
+      schemaVersion(schemaVersion), recordSize(recordSize), loadedSchema(schemaVersion)
+{
+  snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+}
+
+bool RecordLog::begin()
+{
+  if (!Storage::mounted())
+    return false;
+  fs::FS *fs = &Storage::fs();
+  opened = true;
+  if (!keys)
+  {
+    keys = (uint16_t *)calloc(maxKeys, sizeof(uint16_t));
+    lens = (uint8_t *)calloc(maxKeys, 1);
+    data = (uint8_t *)calloc(size_t(maxKeys) * maxLen, 1);
+    if (!keys || !lens || !data)
+    {
+      Serial.printf("[LOG] %s: out of memory\n", path);
+      return false;
+    }
+  }
+  clear();
+  loadedSchema = schemaVersion;
+  counters.fileBytes = 0;
+
+  // Sisa compaction: rename bersifat atomik, jadi .tmp yang masih ada berarti
+  // rename belum terjadi (buang) atau log lama sudah terhapus (pakai .tmp).
+  if (fs->exists(tmpPath))
+  {
+    if (fs->exists(path))
+      fs->remove(tmpPath);
+    else
+      fs->rename(tmpPath, path);
+  }
+  if (!fs->exists(path))
+    return true;
+
+  fs::File f = fs->open(path, "r");
+  if (!f)
+    return false;
+
+  size_t fileSize = f.size();
+  size_t good = 0;
+  uint8_t buf[5 + 255 + 4];
+  int first = f.peek();
+  if (first == HEADER_MAGIC[0])
+  {
+    bool ok = f.read(buf, HEADER_SIZE) == HEADER_SIZE &&
+              memcmp(buf, HEADER_MAGIC, 4) == 0 &&
+              crc32_le(0, buf, 8) == (uint32_t(buf[8]) | (uint32_t(buf[9]) << 8) |
+                                      (uint32_t(buf[10]) << 16) | (uint32_t(buf[11]) << 24));
+    if (ok)
+      loadedSchema = buf[4];
+    else
+      // Header rusak: coba tetap baca frame, record divalidasi satu per satu oleh pemilik
+      Serial.printf("[LOG] %s: bad header, assuming schema %u\n", path, schemaVersion);
+    good = HEADER_SIZE;
+    counters.lifetimeBytes += HEADER_SIZE;
+    f.seek(good);
+  }
+  else if (first == FRAME_SYNC)
+  {
+    loadedSchema = RECORDLOG_SCHEMA_RAW;
+  }
+  while (good < fileSize)
+  {
+    if (f.read(buf, 5) != 5 || buf[0] != FRAME_SYNC)
+      break;
+    uint8_t op = buf[1];
+    uint16_t key = uint16_t(buf[2] | (buf[3] << 8));
+    uint8_t len = buf[4];
+    if (f.read(buf + 5, size_t(len) + 4) != size_t(len) + 4)
+      break;
+    uint32_t crc = uint32_t(buf[5 + len]) | (uint32_t(buf[6 + len]) << 8) |
+                   (uint32_t(buf[7 + len]) << 16) | (uint32_t(buf[8 + len]) << 24);
+    if (crc32_le(0, buf + 1, 4 + len) != crc)
+      break;
+
+    if (op == OP_PUT && len <= maxLen)
+      applyPut(key, buf + 5, len);
+    else if (op == OP_DEL)
+      applyDel(key);
+    else if (op == OP_META && len == 8)
+    {
+      memcpy(&counters.lifetimeBytes, buf + 5, 4);
+      memcpy(&counters.lifetimeCompactions, buf + 9, 4);
+    }
+    good += FRAME_OVERHEAD + len;
+    if (op != OP_META)
+      counters.lifetimeBytes += FRAME_OVERHEAD + len;
+  }
+  f.close();
+  counters.fileBytes = good;
+
+  if (good < fileSize && loadedSchema == schemaVersion)
+  {
+    // Ekor terpotong (listrik padam saat append) atau CRC salah: simpan yang valid
+    counters.tornRecords++;
+    Serial.printf("[LOG] %s: dropped %u corrupt bytes at %u\n",
+                  path, unsigned(fileSize - good), unsigned(good));
+    compact();
+  }
+  return true;
+}
+
+bool RecordLog::at(uint16_t i, uint16_t &key, const uint8_t *&out, uint8_t &len) const
+{
+  if (i >= liveCount)
+    return false;
+  key = keys[i];
+  out = data + size_t(i) * maxLen;
+  len = lens[i];
+  return true;
+}
+
+const uint8_t *RecordLog::find(uint16_t key, uint8_t &len) const
+{
+  int32_t i = indexOf(key);
+  if (i < 0)
+    return nullptr;
+  len = lens[i];
+  return data + size_t(i) * maxLen;
+}
+
+bool RecordLog::put(uint16_t key, const void *src, uint8_t len)
+{
+  if (!opened || len > maxLen)
+    return false;
+  int32_t i = indexOf(key);
+  if (i >= 0 && lens[i] == len && memcmp(data + size_t(i) * maxLen, src, len) == 0)
+  {
+    counters.skipped++;
+    return true;
+  }
+  if (i < 0 && liveCount >= maxKeys)
+    return false;
+  if (!appendFrame(OP_PUT, key, (const uint8_t *)src, len))
+    return false;
+  applyPut(key, (const uint8_t *)src, len);
+  maybeCompact();
+  return true;
+}
+
+bool RecordLog::remove(uint16_t key)
+{
+  if (!opened || indexOf(key) < 0)
+    return true;
+  if (!appendFrame(OP_DEL, key, nullptr, 0))
+    return false;
+  applyDel(key);
+  maybeCompact();
+  return true;
+}
+
+void RecordLog::retainOnly(const uint16_t *keep, uint8_t n)
+{
+  for (uint16_t i = 0; i < liveCount;)
+  {
+    bool found = false;
+    for (uint8_t k = 0; k < n; k++)
+    {
+      if (keep[k] == keys[i])
+      {
+        found = true;
+        break;
+      }
+    }
+    if (found)
+      i++;
+    else
+      remove(keys[i]); // applyDel menggeser, jangan naikkan i
+  }
+}
+
+void RecordLog::retainIf(bool (*keep)(uint16_t key))
+{
+  for (uint16_t i = 0; i < liveCount;)
+  {
+    if (keep(keys[i]))
+      i++;
+    else
+      remove(keys[i]);
+  }
+}
+
+bool RecordLog::compact()
+{
+  if (!opened)
+    return false;
+  // Append yang masih antre di task storage harus selesai sebelum rename
+  Storage::sync();
+  fs::FS *fs = &Storage::fs();
+  fs::File f = fs->open(tmpPath, "w");
+  if (!f)
+    return false;
+
+  // lifetimeBytes di META hanya sampai frame META itu sendiri; frame PUT
+  // sesudahnya dihitung lagi oleh begin() saat dibaca
+  uint32_t meta[2] = {counters.lifetimeBytes + HEADER_SIZE + FRAME_OVERHEAD + 8,
+                      counters.lifetimeCompactions + 1};
+
+  uint8_t hdr[HEADER_SIZE];
+  bool ok = f.write(hdr, buildHeader(hdr)) == HEADER_SIZE && writeFrame(f, OP_META, 0, (const uint8_t *)meta, sizeof(meta));
+  for (uint16_t i = 0; ok && i < liveCount; i++)
+    ok = writeFrame(f, OP_PUT, keys[i], data + size_t(i) * maxLen, lens[i]);
+  f.close();
+
+  if (!ok || !fs->rename(tmpPath, path))
+  {
+    fs->remove(tmpPath);
+    Serial.printf("[LOG] %s: compaction failed\n", path);
+    return false;
+  }
+  counters.lifetimeBytes = meta[0] + liveBytes;
+  counters.lifetimeCompactions = meta[1];
+  counters.compactions++;
+  tailDirty = false;
+  counters.fileBytes = HEADER_SIZE + FRAME_OVERHEAD + 8 + liveBytes;
+  loadedSchema = schemaVersion;
+  return true;
+}
+
+uint16_t RecordLog::lowerBound(uint16_t key) const
+{
+  uint16_t lo = 0, hi = liveCount;
+  while (lo < hi)
+  {
+    uint16_t mid = (lo + hi) / 2;
+    if (keys[mid] < key)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+int32_t RecordLog::indexOf(uint16_t key) const
+{
+  uint16_t i = lowerBound(key);
+  return i < liveCount && keys[i] == key ? i : -1;
+}
+
+size_t RecordLog::buildHeader(uint8_t *buf)
+{
+  memcpy(buf, HEADER_MAGIC, 4);
+  buf[4] = schemaVersion;
+  buf[5] = recordSize;
+  buf[6] = buf[7] = 0;
+  uint32_t crc = crc32_le(0, buf, 8);
+  for (uint8_t i = 0; i < 4; i++)
+    buf[8 + i] = uint8_t(crc >> (8 * i));
+  return HEADER_SIZE;
+}
+
+size_t RecordLog::buildFrame(uint8_t *buf, uint8_t op, uint16_t key, const uint8_t *src, uint8_t len)
+{
+  buf[0] = FRAME_SYNC;
+  buf[1] = op;
+  buf[2] = uint8_t(key);
+  buf[3] = uint8_t(key >> 8);
+  buf[4] = len;
+  if (len)
+    memcpy(buf + 5, src, len);
+  uint32_t crc = crc32_le(0, buf + 1, 4 + len);
+  for (uint8_t i = 0; i < 4; i++)
+    buf[5 + len + i] = uint8_t(crc >> (8 * i));
+  return FRAME_OVERHEAD + len;
+}
+
+bool RecordLog::writeFrame(fs::File &f, uint8_t op, uint16_t key, const uint8_t *src, uint8_t len)
+{
+  uint8_t buf[5 + 255 + 4];
+  size_t n = buildFrame(buf, op, key, src, len);
+  return f.write(buf, n) == n;
+}
+
+// Frame dibangun di sini lalu ditulis oleh task storage (async, FIFO)
+bool RecordLog::appendFrame(uint8_t op, uint16_t key, const uint8_t *src, uint8_t len)
+{
+  // Append sebelumnya gagal dan mungkin meninggalkan sebagian frame:
+  // tulis ulang dulu, kalau tidak frame ini jatuh di belakang ekor rusak
+  // dan ikut dibuang oleh begin()
+  if (tailDirty && !compact())
+    return false;
+  uint8_t buf[HEADER_SIZE + 5 + 255 + 4];
+  size_t n = 0;
+  if (counters.fileBytes == 0)
+    n = buildHeader(buf);
+  n += buildFrame(buf + n, op, key, src, len);
+  if (!Storage::append(path, buf, n))
+  {
+    tailDirty = true;
+    return false;
+  }
+  counters.appends++;
+  counters.appendBytes += n;
+  counters.lifetimeBytes += n;
+  counters.fileBytes += n;
+  return true;
+}
+
+void RecordLog::applyPut(uint16_t key, const uint8_t *src, uint8_t len)
+{
+  uint16_t i = lowerBound(key);
+  if (i < liveCount && keys[i] == key)
+  {
+    liveBytes -= lens[i];
+  }
+  else
+  {
+    if (liveCount >= maxKeys)
+      return;
+    // Sisipkan di posisi urut: geser sisa record satu slot
+    uint16_t tail = liveCount - i;
+    memmove(keys + i + 1, keys + i, tail * sizeof(uint16_t));
+    memmove(lens + i + 1, lens + i, tail);
+    memmove(data + size_t(i + 1) * maxLen, data + size_t(i) * maxLen, size_t(tail) * maxLen);
+    liveCount++;
+    keys[i] = key;
+    liveBytes += FRAME_OVERHEAD;
+  }
+  lens[i] = len;
+  liveBytes += len;
+  memcpy(data + size_t(i) * maxLen, src, len);
+}
+
+void RecordLog::applyDel(uint16_t key)
+{
+  int32_t i = indexOf(key);
+  if (i < 0)
+    return;
+  liveBytes -= FRAME_OVERHEAD + lens[i];
+  uint16_t tail = liveCount - i - 1;
+  memmove(keys + i, keys + i + 1, tail * sizeof(uint16_t));
+  memmove(lens + i, lens + i + 1, tail);
+  memmove(data + size_t(i) * maxLen, data + size_t(i + 1) * maxLen, size_t(tail) * maxLen);
+  liveCount--;
+}
+
+void RecordLog::maybeCompact()
+{
+  uint32_t minBytes = HEADER_SIZE + FRAME_OVERHEAD + 8 + liveBytes;
+  if (counters.fileBytes > RECORDLOG_COMPACT_MIN_BYTES &&
+      counters.fileBytes > minBytes * RECORDLOG_COMPACT_RATIO)
+    compact();
+}
@@ -0,0 +1,100 @@
+// RecordLog.h
+#ifndef RECORD_LOG_H
+#define RECORD_LOG_H
+
+#include <Arduino.h>
+#include <FS.h>
+#include "Storage.h"
+
+// Log dipadatkan (compaction) jika ukuran file melewati batas ini dan
+// sudah lebih dari RECORDLOG_COMPACT_RATIO kali ukuran data yang masih hidup.
+#define RECORDLOG_COMPACT_MIN_BYTES 4096
+#define RECORDLOG_COMPACT_RATIO     4
+#define RECORDLOG_SCHEMA_RAW        1
+
+struct RecordLogStats
+{
+  uint32_t appends;        // record yang ditulis sejak boot
+  uint32_t appendBytes;    // byte yang ditulis lewat append sejak boot
+  uint32_t skipped;        // put() yang tidak menulis karena data sama
+  uint32_t compactions;    // compaction sejak boot
+  uint32_t tornRecords;    // record rusak/terpotong yang dibuang saat begin()
+  uint32_t lifetimeBytes;  // total byte ditulis ke file ini (selamat dari reboot)
+  uint32_t lifetimeCompactions;
+  uint32_t fileBytes;      // ukuran log saat ini
+};
+
+// Log append-only di Storage dengan CRC per record. Setiap perubahan menulis
+// satu frame kecil (PUT key+data atau DEL key); isi terbaru per key disimpan
+// di RAM, urut key (cari dengan binary search, jadi put() tetap murah untuk
+// ratusan record). Compaction menulis ulang hanya record yang hidup ke file .tmp lalu
+// rename (atomik di LittleFS), jadi crash di tengah jalan tidak merusak log.
+//
+// Header: "RLOG" | schema | recordSize | 0 | 0 | crc32 (8 byte pertama)
+// Frame:  0xA5 | op | key (u16 LE) | len | data[len] | crc32 (op..data)
+// Log tanpa header (sebelum ada versi) dianggap schema RECORDLOG_SCHEMA_RAW.
+class RecordLog
+{
+public:
+  RecordLog(const char *path, uint16_t maxKeys, uint8_t maxLen,
+            uint8_t schemaVersion, uint8_t recordSize);
+
+  // Buka log, pulihkan sisa compaction yang terputus dan muat semua record.
+  // Ekor yang rusak dibuang dengan compaction langsung.
+  bool begin();
+
+  // Versi schema isi log yang dimuat. Jika != versi sekarang, pemilik
+  // men-decode record lama lalu memanggil clear() + stage() + compact().
+  uint8_t schema() const { return loadedSchema; }
+  void clear()
+  {
+    liveCount = 0;
+    liveBytes = 0;
+  }
+  void stage(uint16_t key, const void *data, uint8_t len) { applyPut(key, (const uint8_t *)data, len); }
+
+  uint16_t count() const { return liveCount; }
+  // Record ke-i dalam urutan key
+  bool at(uint16_t i, uint16_t &key, const uint8_t *&data, uint8_t &len) const;
+  const uint8_t *find(uint16_t key, uint8_t &len) const;
+
+  // Tulis/ubah record. Tidak menulis apa-apa jika isinya sama.
+  bool put(uint16_t key, const void *data, uint8_t len);
+  bool remove(uint16_t key);
+  // Hapus semua key yang tidak ada di daftar (sinkron dengan array pemilik)
+  void retainOnly(const uint16_t *keys, uint8_t n);
+  // Sama, tapi keanggotaan ditanya ke pemilik (mis. lewat indeks hash-nya)
+  void retainIf(bool (*keep)(uint16_t key));
+
+  bool compact();
+  const RecordLogStats &stats() const { return counters; }
+
+private:
+  uint16_t lowerBound(uint16_t key) const;
+  int32_t indexOf(uint16_t key) const;
+  bool appendFrame(uint8_t op, uint16_t key, const uint8_t *data, uint8_t len);
+  size_t buildHeader(uint8_t *buf);
+  size_t buildFrame(uint8_t *buf, uint8_t op, uint16_t key, const uint8_t *data, uint8_t len);
+  bool writeFrame(fs::File &f, uint8_t op, uint16_t key, const uint8_t *data, uint8_t len);
+  void applyPut(uint16_t key, const uint8_t *data, uint8_t len);
+  void applyDel(uint16_t key);
+  void maybeCompact();
+
+  const char *path;
+  char tmpPath[40];
+  bool opened = false;
+  bool tailDirty = false; // append terakhir gagal, compact sebelum append berikutnya
+  uint16_t maxKeys;
+  uint8_t maxLen;
+  uint8_t schemaVersion;
+  uint8_t recordSize;
+  uint8_t loadedSchema;
+  uint16_t liveCount = 0;
+  uint32_t liveBytes = 0; // jumlah frame record hidup (untuk maybeCompact)
+  uint16_t *keys = nullptr;
+  uint8_t *lens = nullptr;
+  uint8_t *data = nullptr;
+  RecordLogStats counters = {};
+};
+
+#endif // RECORD_LOG_H
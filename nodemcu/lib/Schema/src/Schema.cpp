@@ -0,0 +1,192 @@
+#include "Schema.h"
+#include <math.h>
+
+static void putU16(uint8_t *p, uint16_t v)
+{
+  p[0] = uint8_t(v);
+  p[1] = uint8_t(v >> 8);
+}
+
+static void putU32(uint8_t *p, uint32_t v)
+{
+  for (uint8_t i = 0; i < 4; i++)
+    p[i] = uint8_t(v >> (8 * i));
+}
+
+static void putF32(uint8_t *p, float v)
+{
+  uint32_t u;
+  memcpy(&u, &v, 4);
+  putU32(p, u);
+}
+
+static uint16_t getU16(const uint8_t *p)
+{
+  return uint16_t(p[0] | (p[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t *p)
+{
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+static float getF32(const uint8_t *p)
+{
+  uint32_t u = getU32(p);
+  float v;
+  memcpy(&v, &u, 4);
+  return v;
+}
+
+static bool validAlarm(const AlarmData &a)
+{
+  return a.hour < 24 && a.minute < 60 && a.duration >= 0 && a.duration <= 86400 &&
+         a.days && !(a.days & ~ALARM_EVERY_DAY) && a.channel < 8;
+}
+
+static bool validSensor(const SensorSetting &s)
+{
+  return uint32_t(s.type) <= S_PH && isfinite(s.minValue) && isfinite(s.maxValue);
+}
+
+// ─── Alarm ───────────────────────────────────────────────────
+// v3: id u16 | hour | minute | duration i32 | flags | tempIndex i8 |
+//     lastDayTrig i8 | lastMinTrig i8 | days
+// flags: bit0 enabled, bit1 pending, bit2 isTemporary, bit3-5 channel
+// v2 = v3 tanpa days (dibaca sebagai setiap hari, channel 0)
+uint8_t encodeAlarm(const AlarmData &a, uint8_t *out)
+{
+  putU16(out, a.id);
+  out[2] = a.hour;
+  out[3] = a.minute;
+  putU32(out + 4, uint32_t(a.duration));
+  out[8] = (a.enabled ? 1 : 0) | (a.pending ? 2 : 0) | (a.isTemporary ? 4 : 0) | ((a.channel & 7) << 3);
+  out[9] = uint8_t(a.tempIndex);
+  out[10] = uint8_t(int8_t(a.lastDayTrig));
+  out[11] = uint8_t(int8_t(a.lastMinTrig));
+  out[12] = a.days;
+  return ALARM_RECORD_SIZE;
+}
+
+bool decodeAlarm(uint8_t schema, const uint8_t *in, uint8_t len, AlarmData &out)
+{
+  AlarmData a{};
+  a.days = ALARM_EVERY_DAY;
+  if (schema == SCHEMA_LEGACY && len == LEGACY_ALARM_SIZE)
+  {
+    // struct AlarmData lama: id@0 hour@2 minute@3 duration@4 enabled@8
+    // lastDayTrig@12 lastMinTrig@16 pending@20 isTemporary@21 tempIndex@22
+    a.id = getU16(in);
+    a.hour = in[2];
+    a.minute = in[3];
+    a.duration = int(getU32(in + 4));
+    a.enabled = in[8] != 0;
+    a.lastDayTrig = int(getU32(in + 12));
+    a.lastMinTrig = int(getU32(in + 16));
+    a.pending = in[20] != 0;
+    a.isTemporary = in[21] != 0;
+    a.tempIndex = int8_t(in[22]);
+  }
+  else if ((schema == SCHEMA_ALARM && len == ALARM_RECORD_SIZE) ||
+           (schema == SCHEMA_ALARM_V2 && len == ALARM_V2_RECORD_SIZE))
+  {
+    a.id = getU16(in);
+    a.hour = in[2];
+    a.minute = in[3];
+    a.duration = int(getU32(in + 4));
+    a.enabled = in[8] & 1;
+    a.pending = in[8] & 2;
+    a.isTemporary = in[8] & 4;
+    a.tempIndex = int8_t(in[9]);
+    a.lastDayTrig = int8_t(in[10]);
+    a.lastMinTrig = int8_t(in[11]);
+    if (schema == SCHEMA_ALARM)
+    {
+      a.days = in[12];
+      a.channel = (in[8] >> 3) & 7;
+    }
+  }
+  else
+    return false;
+
+  if (!validAlarm(a))
+    return false;
+  out = a;
+  return true;
+}
+
+// ─── Sensor setting ──────────────────────────────────────────
+// v2: id u16 | type u8 | minValue f32 | maxValue f32 | flags | tempIndex u16
+uint8_t encodeSensorSetting(const SensorSetting &s, uint8_t *out)
+{
+  putU16(out, s.id);
+  out[2] = uint8_t(s.type);
+  putF32(out + 3, s.minValue);
+  putF32(out + 7, s.maxValue);
+  out[11] = (s.enabled ? 1 : 0) | (s.pending ? 2 : 0) | (s.isTemporary ? 4 : 0);
+  putU16(out + 12, s.tempIndex);
+  return SENSOR_RECORD_SIZE;
+}
+
+bool decodeSensorSetting(uint8_t schema, const uint8_t *in, uint8_t len, SensorSetting &out)
+{
+  SensorSetting s{};
+  if (schema == SCHEMA_LEGACY && len == LEGACY_SENSOR_SIZE)
+  {
+    // struct SensorSetting lama: id@0 type(enum 4 byte)@4 min@8 max@12
+    // enabled@16 pending@17 isTemporary@18 tempIndex@20
+    uint32_t type = getU32(in + 4);
+    if (type > S_PH)
+      return false;
+    s.id = getU16(in);
+    s.type = SensorType(type);
+    s.minValue = getF32(in + 8);
+    s.maxValue = getF32(in + 12);
+    s.enabled = in[16] != 0;
+    s.pending = in[17] != 0;
+    s.isTemporary = in[18] != 0;
+    s.tempIndex = getU16(in + 20);
+  }
+  else if (schema == SCHEMA_SENSOR && len == SENSOR_RECORD_SIZE)
+  {
+    if (in[2] > S_PH)
+      return false;
+    s.id = getU16(in);
+    s.type = SensorType(in[2]);
+    s.minValue = getF32(in + 3);
+    s.maxValue = getF32(in + 7);
+    s.enabled = in[11] & 1;
+    s.pending = in[11] & 2;
+    s.isTemporary = in[11] & 4;
+    s.tempIndex = getU16(in + 12);
+  }
+  else
+    return false;
+
+  if (!validSensor(s))
+    return false;
+  out = s;
+  return true;
+}
+
+// ─── Kalibrasi TDS ───────────────────────────────────────────
+// v1 dan v2 sama-sama slope f32 | intercept f32; v2 ditulis eksplisit LE
+uint8_t encodeTDSConfig(const TDSConfig &c, uint8_t *out)
+{
+  putF32(out, c.slope);
+  putF32(out + 4, c.intercept);
+  return CALIB_RECORD_SIZE;
+}
+
+bool decodeTDSConfig(uint8_t schema, const uint8_t *in, uint8_t len, TDSConfig &out)
+{
+  if ((schema != SCHEMA_LEGACY && schema != SCHEMA_CALIB) || len != CALIB_RECORD_SIZE)
+    return false;
+  TDSConfig c;
+  c.slope = getF32(in);
+  c.intercept = getF32(in + 4);
+  if (!isfinite(c.slope) || !isfinite(c.intercept) || c.slope <= 0)
+    return false;
+  out = c;
+  return true;
+}
@@ -0,0 +1,44 @@
+// Schema.h
+// Format on-disk record alarm, sensor setting & kalibrasi TDS.
+// Semua field diserialisasi eksplisit (little-endian, tanpa padding) sehingga
+// layout file tidak bergantung pada compiler, padding struct atau ukuran enum.
+// Versi 1 = dump struct mentah (firmware lama, layout GCC/ESP32), hanya dibaca
+// untuk migrasi.
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include <Arduino.h>
+#include "Alarm.h"
+#include "ReadSensor.h"
+#include "Config.h"
+
+#define SCHEMA_LEGACY 1
+#define SCHEMA_ALARM  3
+#define SCHEMA_SENSOR 2
+#define SCHEMA_CALIB  2
+
+// Ukuran record versi sekarang
+#define ALARM_RECORD_SIZE  13
+#define SENSOR_RECORD_SIZE 14
+#define CALIB_RECORD_SIZE  8
+
+// Versi lama yang masih dibaca
+#define SCHEMA_ALARM_V2    2
+#define ALARM_V2_RECORD_SIZE 12
+
+// Ukuran struct mentah versi 1
+#define LEGACY_ALARM_SIZE  24
+#define LEGACY_SENSOR_SIZE 24
+#define LEGACY_CALIB_SIZE  8
+
+uint8_t encodeAlarm(const AlarmData &a, uint8_t *out);
+// false jika panjang tidak cocok dengan versi atau isi tidak valid
+bool decodeAlarm(uint8_t schema, const uint8_t *in, uint8_t len, AlarmData &out);
+
+uint8_t encodeSensorSetting(const SensorSetting &s, uint8_t *out);
+bool decodeSensorSetting(uint8_t schema, const uint8_t *in, uint8_t len, SensorSetting &out);
+
+uint8_t encodeTDSConfig(const TDSConfig &c, uint8_t *out);
+bool decodeTDSConfig(uint8_t schema, const uint8_t *in, uint8_t len, TDSConfig &out);
+
+#endif // SCHEMA_H
@@ -0,0 +1,221 @@
+#include "Storage.h"
+
+#ifdef ARDUINO
+#include <LittleFS.h>
+#include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#endif
+
+enum StorageOp : uint8_t
+{
+  JOB_APPEND,
+  JOB_WRITE,
+  JOB_WRITE_AT,
+  JOB_SYNC
+};
+
+struct StorageJob
+{
+  StorageOp op;
+  const char *path;
+  uint8_t *data; // heap, dibebaskan setelah dijalankan
+  uint16_t len;
+  uint32_t offset; // JOB_WRITE_AT
+  uint32_t submitUs;
+  void *waiter;    // JOB_SYNC: TaskHandle_t pemanggil sync()
+};
+
+#ifdef ARDUINO
+// Sebelum/tanpa mount, operasi file ke LittleFS gagal dengan aman
+static fs::FS *activeFs = &LittleFS;
+#else
+static fs::FS *activeFs = nullptr;
+#endif
+static bool isMounted = false;
+static StorageStats counters = {};
+
+static bool runJob(const StorageJob &job)
+{
+  uint32_t start = micros();
+  fs::File f;
+  if (job.op == JOB_WRITE_AT)
+  {
+    f = activeFs->open(job.path, "r+");
+    if (!f)
+      f = activeFs->open(job.path, "w");
+  }
+  else
+    f = activeFs->open(job.path, job.op == JOB_APPEND ? "a" : "w");
+  bool ok = f && (job.op != JOB_WRITE_AT || f.seek(job.offset)) &&
+            f.write(job.data, job.len) == job.len;
+  if (f)
+    f.close();
+  uint32_t end = micros();
+
+  if (!ok)
+  {
+    counters.failed++;
+    Serial.printf("[STORAGE] write %s failed\n", job.path);
+  }
+  counters.completed++;
+  counters.totalWriteUs += end - start;
+  if (end - start > counters.maxWriteUs)
+    counters.maxWriteUs = end - start;
+  if (end - job.submitUs > counters.maxLatencyUs)
+    counters.maxLatencyUs = end - job.submitUs;
+  return ok;
+}
+
+#ifdef ARDUINO
+static QueueHandle_t jobQueue = nullptr;
+static TaskHandle_t storageTaskHandle = nullptr;
+
+static void storageTask(void *)
+{
+  StorageJob job;
+  for (;;)
+  {
+    if (xQueueReceive(jobQueue, &job, portMAX_DELAY) != pdTRUE)
+      continue;
+    if (job.op == JOB_SYNC)
+    {
+      // Notifikasi ke task yang menunggu, seperti I2CBus::run(): beberapa
+      // task boleh sync() bersamaan tanpa saling mencuri sinyal
+      xTaskNotifyGive((TaskHandle_t)job.waiter);
+      continue;
+    }
+    runJob(job);
+    free(job.data);
+  }
+}
+
+// Flash yang belum pernah dipakai berisi 0xFF di awal dua blok pertama
+// (lokasi superblock LittleFS)
+static bool partitionBlank()
+{
+  const esp_partition_t *p = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                      ESP_PARTITION_SUBTYPE_DATA_SPIFFS, nullptr);
+  if (!p)
+    return false;
+  uint8_t buf[64];
+  for (size_t off = 0; off <= 4096; off += 4096)
+  {
+    if (esp_partition_read(p, off, buf, sizeof(buf)) != ESP_OK)
+      return false;
+    for (uint8_t b : buf)
+    {
+      if (b != 0xFF)
+        return false;
+    }
+  }
+  return true;
+}
+
+bool Storage::begin()
+{
+  if (isMounted)
+    return true;
+  if (!LittleFS.begin(false))
+  {
+    if (!partitionBlank())
+    {
+      // Jangan format: data alarm/sensor lebih berharga daripada boot yang mulus
+      Serial.println("[FS] Mount failed, partition not blank - running without storage");
+      return false;
+    }
+    Serial.println("[FS] Blank partition, formatting");
+    if (!LittleFS.format() || !LittleFS.begin(false))
+    {
+      Serial.println("[FS] Format failed");
+      return false;
+    }
+  }
+  Serial.println("[FS] Mounted successfully.");
+  return begin(LittleFS);
+}
+#endif
+
+bool Storage::begin(fs::FS &filesystem)
+{
+  activeFs = &filesystem;
+  isMounted = true;
+#ifdef ARDUINO
+  if (!jobQueue)
+  {
+    jobQueue = xQueueCreate(STORAGE_QUEUE_LEN, sizeof(StorageJob));
+    // Core 1 bersama loop(); prioritas sama supaya tidak merebut tombol/LCD
+    xTaskCreatePinnedToCore(storageTask, "storage", 4096, nullptr, 1, &storageTaskHandle, 1);
+  }
+#endif
+  return true;
+}
+
+bool Storage::mounted()
+{
+  return isMounted;
+}
+
+fs::FS &Storage::fs()
+{
+  return *activeFs;
+}
+
+static bool submit(StorageOp op, const char *path, const uint8_t *data, size_t len, uint32_t offset = 0)
+{
+  if (!isMounted || len > 0xFFFF)
+    return false;
+  StorageJob job{op, path, (uint8_t *)malloc(len ? len : 1), uint16_t(len), offset, uint32_t(micros()), nullptr};
+  if (!job.data)
+    return false;
+  memcpy(job.data, data, len);
+  counters.submitted++;
+
+#ifdef ARDUINO
+  UBaseType_t depth = uxQueueMessagesWaiting(jobQueue) + 1;
+  if (depth > counters.maxDepth)
+    counters.maxDepth = uint8_t(depth);
+  // Job async: kegagalan tulis hanya tercatat di stats().failed
+  if (xQueueSend(jobQueue, &job, 0) == pdTRUE)
+    return true;
+  // Antrian penuh: tunggu job sebelumnya supaya urutan tetap, lalu tulis langsung
+  Storage::sync();
+  counters.inlineRuns++;
+#endif
+  bool ok = runJob(job);
+  free(job.data);
+  return ok;
+}
+
+bool Storage::append(const char *path, const uint8_t *data, size_t len)
+{
+  return submit(JOB_APPEND, path, data, len);
+}
+
+bool Storage::write(const char *path, const uint8_t *data, size_t len)
+{
+  return submit(JOB_WRITE, path, data, len);
+}
+
+bool Storage::writeAt(const char *path, uint32_t offset, const uint8_t *data, size_t len)
+{
+  return submit(JOB_WRITE_AT, path, data, len, offset);
+}
+
+void Storage::sync()
+{
+  counters.syncs++;
+#ifdef ARDUINO
+  if (!jobQueue || xTaskGetCurrentTaskHandle() == storageTaskHandle)
+    return;
+  StorageJob job{JOB_SYNC, nullptr, nullptr, 0, 0, 0, xTaskGetCurrentTaskHandle()};
+  xQueueSend(jobQueue, &job, portMAX_DELAY);
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#endif
+}
+
+const StorageStats &Storage::stats()
+{
+  return counters;
+}
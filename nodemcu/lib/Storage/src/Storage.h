@@ -0,0 +1,70 @@
+// Storage.h
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+// Semua path file di LittleFS ada di sini (jangan didefinisikan ulang di modul lain)
+static const char *const STORAGE_ALARMS_LOG = "/alarms.log";
+static const char *const STORAGE_SENSORS_LOG = "/sensor_settings.log";
+static const char *const STORAGE_CALIB_LOG = "/tds_calib.log";
+static const char *const STORAGE_DEVICEID_FILE = "/deviceid.txt";
+static const char *const STORAGE_OUTBOX_SPILL = "/outbox.bin";
+static const char *const STORAGE_OUTBOX_TMP = "/outbox.tmp";
+static const char *const STORAGE_TELEMETRY_RING = "/telemetry.bin";
+static const char *const STORAGE_TELEMETRY_CURSOR = "/telemetry.cur";
+static const char *const STORAGE_HISTORY_MINUTE = "/history_1m.bin";
+static const char *const STORAGE_HISTORY_QUARTER = "/history_15m.bin";
+// Format lama (dump struct), hanya dibaca sekali untuk migrasi
+static const char *const STORAGE_LEGACY_ALARMS = "/alarms.bin";
+static const char *const STORAGE_LEGACY_SENSORS = "/sensor_settings.bin";
+static const char *const STORAGE_LEGACY_CALIB = "/tds_calib.bin";
+
+#define STORAGE_QUEUE_LEN 16
+
+struct StorageStats
+{
+  uint32_t submitted;    // job async yang diterima
+  uint32_t completed;
+  uint32_t failed;       // open/write gagal
+  uint32_t inlineRuns;   // antrian penuh, dijalankan langsung oleh pemanggil
+  uint32_t syncs;
+  uint32_t maxLatencyUs; // submit → selesai (termasuk antre)
+  uint32_t maxWriteUs;   // durasi operasi file saja
+  uint64_t totalWriteUs;
+  uint8_t maxDepth;
+};
+
+// Satu-satunya pemilik filesystem: mount sekali saat boot, menyimpan semua
+// path, dan menjalankan penulisan di task "storage" agar loop() tidak
+// menunggu flash. Urutan job dijaga (FIFO), jadi append ke log yang sama
+// tetap berurutan. Di host (tanpa ARDUINO) semua job dijalankan sinkron.
+class Storage
+{
+public:
+  // Mount LittleFS tanpa auto-format. Partisi hanya diformat jika masih
+  // kosong (flash baru), bukan karena mount gagal pada data yang ada.
+  static bool begin();
+  // Pakai filesystem lain (mis. fake di RAM untuk pengujian di host)
+  static bool begin(fs::FS &fs);
+
+  static bool mounted();
+  static fs::FS &fs();
+
+  // Penulisan async. path harus berumur statis (konstanta di atas atau
+  // path milik RecordLog); data disalin. false jika tidak ter-mount atau
+  // job dijalankan langsung (antrian penuh / host) dan gagal; kegagalan
+  // job yang sudah antre hanya terlihat di stats().failed.
+  static bool append(const char *path, const uint8_t *data, size_t len);
+  static bool write(const char *path, const uint8_t *data, size_t len);
+  // Timpa sebagian file mulai offset (file dibuat jika belum ada)
+  static bool writeAt(const char *path, uint32_t offset, const uint8_t *data, size_t len);
+
+  // Tunggu semua job sebelumnya selesai (sebelum baca ulang, rename, restart)
+  static void sync();
+
+  static const StorageStats &stats();
+};
+
+#endif // STORAGE_H
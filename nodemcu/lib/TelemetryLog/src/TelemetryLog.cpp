@@ -0,0 +1,399 @@
+#include "TelemetryLog.h"
+#include <rom/crc.h>
+
+static const uint8_t CURSOR_SIZE = 8 + TELEMETRY_MAX_RANGES * 8 + 4;
+static const uint8_t BLOCK_HEADER = 12;
+static const uint16_t BLOCK_PAYLOAD = TELEMETRY_BLOCK_SIZE - BLOCK_HEADER;
+
+static bool ready = false;
+static uint32_t nextSeq = 1;
+static uint32_t rangeLo[TELEMETRY_MAX_RANGES];
+static uint32_t rangeHi[TELEMETRY_MAX_RANGES];
+static uint8_t rangeCount = 0;
+static bool batchOpen = false;
+static uint32_t batchLo = 0;
+static uint32_t batchHi = 0;
+static uint8_t batchRecords = 0;
+static TelemetryLogStats counters = {};
+// Indeks blok di RAM (blockCount 0 = slot kosong)
+static uint32_t blockFirst[TELEMETRY_BLOCKS];
+static uint16_t blockCount[TELEMETRY_BLOCKS];
+static uint16_t openSlot = 0;
+static bool blockOpen = false;
+static uint8_t openBuf[TELEMETRY_BLOCK_SIZE];
+static TimeSeriesEncoder encoder;
+
+static void putU32(uint8_t *p, uint32_t v)
+{
+  for (uint8_t i = 0; i < 4; i++)
+    p[i] = uint8_t(v >> (8 * i));
+}
+
+static uint32_t getU32(const uint8_t *p)
+{
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+// ─── Blok ────────────────────────────────────────────────────
+// Slot kosong / blok lama yang terpotong gagal di CRC
+static bool blockValid(const uint8_t *blk, uint32_t &first, uint16_t &count, uint16_t &bytes)
+{
+  first = getU32(blk);
+  count = uint16_t(blk[4] | (blk[5] << 8));
+  bytes = uint16_t(blk[6] | (blk[7] << 8));
+  if (!first || !count || bytes > BLOCK_PAYLOAD)
+    return false;
+  return crc32_le(crc32_le(0, blk, 8), blk + BLOCK_HEADER, bytes) == getU32(blk + 8);
+}
+
+static void sealOpenBlock()
+{
+  uint16_t count = encoder.count();
+  uint16_t bytes = uint16_t(encoder.bytes());
+  putU32(openBuf, blockFirst[openSlot]);
+  openBuf[4] = uint8_t(count);
+  openBuf[5] = uint8_t(count >> 8);
+  openBuf[6] = uint8_t(bytes);
+  openBuf[7] = uint8_t(bytes >> 8);
+  putU32(openBuf + 8, crc32_le(crc32_le(0, openBuf, 8), openBuf + BLOCK_HEADER, bytes));
+}
+
+// Blok di slot tsb: dari RAM jika sedang diisi, selain itu dibaca dan dicek
+static const uint8_t *loadBlock(fs::File &f, uint16_t slot, uint8_t *buf)
+{
+  if (blockOpen && slot == openSlot)
+    return openBuf;
+  uint32_t first;
+  uint16_t count, bytes;
+  if (!f || !f.seek(uint32_t(slot) * TELEMETRY_BLOCK_SIZE) ||
+      f.read(buf, TELEMETRY_BLOCK_SIZE) < BLOCK_HEADER ||
+      !blockValid(buf, first, count, bytes) || first != blockFirst[slot])
+    return nullptr;
+  return buf;
+}
+
+static int16_t findBlock(uint32_t seq)
+{
+  for (uint16_t i = 0; i < TELEMETRY_BLOCKS; i++)
+  {
+    if (blockCount[i] && seq >= blockFirst[i] && seq - blockFirst[i] < blockCount[i])
+      return int16_t(i);
+  }
+  return -1;
+}
+
+// Decode record seq [lo, hi) (maks max) ke out; yang tidak terbaca dihitung corrupt
+static uint8_t readSpan(fs::File &f, uint32_t lo, uint32_t hi, TelemetryRecord *out, uint8_t max)
+{
+  static uint8_t buf[TELEMETRY_BLOCK_SIZE];
+  uint8_t n = 0;
+  uint32_t s = lo;
+  while (s < hi && n < max)
+  {
+    int16_t slot = findBlock(s);
+    if (slot < 0)
+    {
+      counters.corrupt++;
+      s++;
+      continue;
+    }
+    uint32_t first = blockFirst[slot];
+    uint32_t end = first + blockCount[slot] < hi ? first + blockCount[slot] : hi;
+    const uint8_t *blk = loadBlock(f, slot, buf);
+    if (!blk)
+    {
+      counters.corrupt += end - s;
+      s = end;
+      continue;
+    }
+    TimeSeriesDecoder dec;
+    dec.begin(blk + BLOCK_HEADER, uint16_t(blk[6] | (blk[7] << 8)), TS_SENSOR_SCALE);
+    TimeSeriesSample ts;
+    for (uint32_t q = first; q < end && n < max; q++)
+    {
+      if (!dec.next(ts))
+      {
+        counters.corrupt += end - q;
+        break;
+      }
+      if (q < s)
+        continue;
+      out[n++] = TelemetryRecord{q, ts.ts, ts.v[0], ts.v[1], ts.v[2], ts.v[3]};
+    }
+    s = end;
+  }
+  return n;
+}
+
+static void addSeq(uint32_t seq)
+{
+  if (rangeCount && rangeHi[rangeCount - 1] == seq)
+  {
+    rangeHi[rangeCount - 1]++;
+    return;
+  }
+  if (rangeCount == TELEMETRY_MAX_RANGES)
+  {
+    // Gabungkan dua rentang tertua; celah di antaranya akan terkirim ulang
+    rangeHi[0] = rangeHi[1];
+    for (uint8_t i = 1; i + 1 < rangeCount; i++)
+    {
+      rangeLo[i] = rangeLo[i + 1];
+      rangeHi[i] = rangeHi[i + 1];
+    }
+    rangeCount--;
+  }
+  rangeLo[rangeCount] = seq;
+  rangeHi[rangeCount] = seq + 1;
+  rangeCount++;
+}
+
+static void removeSpan(uint32_t lo, uint32_t hi)
+{
+  uint8_t j = 0;
+  for (uint8_t i = 0; i < rangeCount; i++)
+  {
+    uint32_t rlo = rangeLo[i], rhi = rangeHi[i];
+    if (hi > rlo && lo < rhi)
+    {
+      if (lo <= rlo && hi >= rhi)
+        continue;
+      if (lo <= rlo)
+        rlo = hi;
+      else if (hi >= rhi)
+        rhi = lo;
+      // Batch selalu diambil dari ujung rentang, jadi tidak pernah membelah
+    }
+    rangeLo[j] = rlo;
+    rangeHi[j] = rhi;
+    j++;
+  }
+  rangeCount = j;
+}
+
+// Record [lo, hi) hilang (blok ditimpa): keluarkan dari daftar tertunda
+static void dropSpan(uint32_t lo, uint32_t hi)
+{
+  uint32_t before = TelemetryLog::pending();
+  removeSpan(lo, hi);
+  counters.overwritten += before - TelemetryLog::pending();
+}
+
+// Mulai blok baru di slot berikutnya, menimpa blok paling lama
+static void startBlock()
+{
+  if (blockOpen)
+    openSlot = (openSlot + 1) % TELEMETRY_BLOCKS;
+  if (blockCount[openSlot])
+    dropSpan(blockFirst[openSlot], blockFirst[openSlot] + blockCount[openSlot]);
+  blockFirst[openSlot] = nextSeq;
+  blockCount[openSlot] = 0;
+  encoder.begin(openBuf + BLOCK_HEADER, BLOCK_PAYLOAD, TS_SENSOR_SCALE);
+  blockOpen = true;
+}
+
+// nextSeq | rangeCount | 0 0 0 | (lo, hi) × TELEMETRY_MAX_RANGES | crc32
+static void saveCursor()
+{
+  uint8_t buf[CURSOR_SIZE] = {};
+  putU32(buf, nextSeq);
+  buf[4] = rangeCount;
+  for (uint8_t i = 0; i < rangeCount; i++)
+  {
+    putU32(buf + 8 + i * 8, rangeLo[i]);
+    putU32(buf + 12 + i * 8, rangeHi[i]);
+  }
+  putU32(buf + CURSOR_SIZE - 4, crc32_le(0, buf, CURSOR_SIZE - 4));
+  Storage::write(STORAGE_TELEMETRY_CURSOR, buf, sizeof(buf));
+}
+
+bool TelemetryLog::begin()
+{
+  if (!Storage::mounted())
+    return false;
+  fs::FS &fs = Storage::fs();
+
+  // Bangun indeks blok; blok terbaru menentukan seq berikutnya
+  uint32_t minSeq = 0;
+  int16_t newest = -1;
+  nextSeq = 1;
+  fs::File f = fs.open(STORAGE_TELEMETRY_RING, "r");
+  if (f)
+  {
+    static uint8_t buf[TELEMETRY_BLOCK_SIZE];
+    for (uint16_t i = 0; i < TELEMETRY_BLOCKS; i++)
+    {
+      uint32_t first;
+      uint16_t count, bytes;
+      if (f.read(buf, TELEMETRY_BLOCK_SIZE) < BLOCK_HEADER)
+        break;
+      if (!blockValid(buf, first, count, bytes))
+        continue;
+      blockFirst[i] = first;
+      blockCount[i] = count;
+      if (first + count > nextSeq)
+      {
+        nextSeq = first + count;
+        newest = int16_t(i);
+      }
+      if (!minSeq || first < minSeq)
+        minSeq = first;
+    }
+    f.close();
+  }
+  openSlot = newest < 0 ? 0 : uint16_t((newest + 1) % TELEMETRY_BLOCKS);
+  blockOpen = false; // append pertama membuka blok baru
+
+  // Tanpa cursor (belum pernah backfill) semua isi ring dianggap belum terkirim
+  uint32_t cursorSeq = minSeq ? minSeq : nextSeq;
+  rangeCount = 0;
+  f = fs.open(STORAGE_TELEMETRY_CURSOR, "r");
+  if (f)
+  {
+    uint8_t buf[CURSOR_SIZE];
+    if (f.read(buf, sizeof(buf)) == sizeof(buf) &&
+        crc32_le(0, buf, CURSOR_SIZE - 4) == getU32(buf + CURSOR_SIZE - 4) &&
+        buf[4] <= TELEMETRY_MAX_RANGES)
+    {
+      cursorSeq = getU32(buf);
+      rangeCount = buf[4];
+      for (uint8_t i = 0; i < rangeCount; i++)
+      {
+        rangeLo[i] = getU32(buf + 8 + i * 8);
+        rangeHi[i] = getU32(buf + 12 + i * 8);
+      }
+    }
+    else
+      Serial.println("[TLOG] bad cursor, resending whole ring");
+    f.close();
+  }
+  if (cursorSeq > nextSeq)
+    nextSeq = cursorSeq; // ring hilang, seq tetap naik
+  // Record yang ditulis setelah cursor terakhir disimpan
+  uint32_t floor = minSeq ? minSeq : nextSeq;
+  for (uint32_t s = cursorSeq > floor ? cursorSeq : floor; s < nextSeq; s++)
+    addSeq(s);
+  dropSpan(0, floor);
+
+  ready = true;
+  Serial.printf("[TLOG] %u pending, next seq %u\n", (unsigned)pending(), (unsigned)nextSeq);
+  return true;
+}
+
+bool TelemetryLog::append(uint32_t ts, float tds, float ph, float turbidity, float temperature)
+{
+  if (!ready)
+    return false;
+  TimeSeriesSample s{ts, {tds, ph, turbidity, temperature}};
+  if (!blockOpen || !encoder.append(s))
+  {
+    startBlock();
+    encoder.append(s);
+  }
+  blockCount[openSlot] = encoder.count();
+  sealOpenBlock();
+  addSeq(nextSeq++);
+  counters.logged++;
+  // Blok yang sedang diisi ditulis ulang utuh; hanya byte terpakai
+  return Storage::writeAt(STORAGE_TELEMETRY_RING, uint32_t(openSlot) * TELEMETRY_BLOCK_SIZE,
+                          openBuf, BLOCK_HEADER + encoder.bytes());
+}
+
+uint8_t TelemetryLog::peekBatch(TelemetryRecord *out, uint8_t max)
+{
+  batchOpen = false;
+  if (!ready || !rangeCount || !max)
+    return 0;
+  // Blok yang sudah ditutup mungkin masih antre di task storage
+  Storage::sync();
+  fs::File f = Storage::fs().open(STORAGE_TELEMETRY_RING, "r");
+
+  uint8_t n = 0;
+  while (rangeCount && !n)
+  {
+    uint32_t lo, hi;
+    if (TELEMETRY_DRAIN_ORDER == TELEMETRY_NEWEST_FIRST)
+    {
+      hi = rangeHi[rangeCount - 1];
+      lo = hi - rangeLo[rangeCount - 1] > max ? hi - max : rangeLo[rangeCount - 1];
+    }
+    else
+    {
+      lo = rangeLo[0];
+      hi = rangeHi[0] - lo > max ? lo + max : rangeHi[0];
+    }
+    n = readSpan(f, lo, hi, out, max);
+    if (!n)
+    {
+      // Seluruh rentang rusak: lewati supaya backfill tidak macet
+      removeSpan(lo, hi);
+      saveCursor();
+      continue;
+    }
+    batchLo = lo;
+    batchHi = hi;
+    batchRecords = n;
+    batchOpen = true;
+  }
+  if (f)
+    f.close();
+  return n;
+}
+
+void TelemetryLog::commit()
+{
+  if (!batchOpen)
+    return;
+  batchOpen = false;
+  removeSpan(batchLo, batchHi);
+  counters.sent += batchRecords;
+  counters.batches++;
+  saveCursor();
+}
+
+uint32_t TelemetryLog::pending()
+{
+  uint32_t n = 0;
+  for (uint8_t i = 0; i < rangeCount; i++)
+    n += rangeHi[i] - rangeLo[i];
+  return n;
+}
+
+// Persentase blok ring yang masih memuat record belum terkirim
+uint8_t TelemetryLog::fillPercent()
+{
+  uint16_t used = 0;
+  for (uint16_t i = 0; i < TELEMETRY_BLOCKS; i++)
+  {
+    if (!blockCount[i])
+      continue;
+    uint32_t lo = blockFirst[i], hi = lo + blockCount[i];
+    for (uint8_t r = 0; r < rangeCount; r++)
+    {
+      if (rangeLo[r] < hi && rangeHi[r] > lo)
+      {
+        used++;
+        break;
+      }
+    }
+  }
+  return uint8_t(uint32_t(used) * 100 / TELEMETRY_BLOCKS);
+}
+
+uint32_t TelemetryLog::oldestUnsentTs()
+{
+  if (!ready || !rangeCount)
+    return 0;
+  Storage::sync();
+  fs::File f = Storage::fs().open(STORAGE_TELEMETRY_RING, "r");
+  TelemetryRecord r;
+  bool ok = readSpan(f, rangeLo[0], rangeLo[0] + 1, &r, 1) == 1;
+  if (f)
+    f.close();
+  return ok ? r.ts : 0;
+}
+
+const TelemetryLogStats &TelemetryLog::stats()
+{
+  return counters;
+}
@@ -0,0 +1,81 @@
+// TelemetryLog.h
+#ifndef TELEMETRY_LOG_H
+#define TELEMETRY_LOG_H
+
+#include <Arduino.h>
+#include "Storage.h"
+#include "TimeSeries.h"
+
+// Ring berukuran tetap: TELEMETRY_BLOCKS blok × TELEMETRY_BLOCK_SIZE byte
+// (224 × 512 B = 112 KB). Satu blok terkompresi memuat ±110 snapshot, jadi
+// ring menampung ±3 hari pada interval 10 detik. Jika penuh, blok paling
+// lama ditimpa.
+#define TELEMETRY_BLOCKS            224
+#define TELEMETRY_BLOCK_SIZE        512
+#define TELEMETRY_LOG_INTERVAL_MS   10000 // jarak snapshot saat offline
+#define TELEMETRY_BATCH_SIZE        25    // record per pesan (muat di MQTT_MAX_PACKET_SIZE)
+#define TELEMETRY_BATCH_INTERVAL_MS 2000  // jeda minimum antar batch saat backfill
+// Tanpa ACK_MSG selama ini: batch backfill diambil ulang (key yang sama
+// menggantikan entry Outbox-nya), halaman riwayat dibatalkan (Outbox::cancel).
+// Outbox sendiri mengirim ulang control sampai di-ACK, jadi timeout ini milik
+// pemanggil, bukan umur entry Outbox.
+#define TELEMETRY_ACK_TIMEOUT_MS    90000
+#define TELEMETRY_MAX_RANGES        4
+
+enum TelemetryOrder : uint8_t
+{
+  TELEMETRY_OLDEST_FIRST,
+  TELEMETRY_NEWEST_FIRST
+};
+
+// Urutan backfill, bisa diganti lewat build_flags
+#ifndef TELEMETRY_DRAIN_ORDER
+#define TELEMETRY_DRAIN_ORDER TELEMETRY_OLDEST_FIRST
+#endif
+
+struct TelemetryRecord
+{
+  uint32_t seq;
+  uint32_t ts; // unix time (UTC) dari RTC
+  float tds;
+  float ph;
+  float turbidity;
+  float temperature;
+};
+
+struct TelemetryLogStats
+{
+  uint32_t logged;      // snapshot yang ditulis sejak boot
+  uint32_t sent;        // record yang sudah di-ACK backend
+  uint32_t batches;
+  uint32_t overwritten; // record belum terkirim yang tertimpa karena ring penuh
+  uint32_t corrupt;     // slot dengan CRC/seq salah saat dibaca
+};
+
+// Log time-series untuk snapshot sensor selama WiFi mati / broker putus.
+// Blok: firstSeq u32 | count u16 | bytes u16 | crc32 | stream TimeSeries
+// (tds ×10, ph ×100, turbidity ×10, temperature ×100). Blok yang sedang
+// diisi disimpan di RAM dan ditulis ulang utuh setiap append. Record yang
+// belum terkirim dicatat sebagai beberapa rentang seq [lo, hi) di file
+// cursor; record yang ditulis setelah cursor terakhir ditemukan lagi dengan
+// memindai header blok saat boot.
+class TelemetryLog
+{
+public:
+  static bool begin();
+
+  static bool append(uint32_t ts, float tds, float ph, float turbidity, float temperature);
+
+  // Ambil sampai max record berikutnya sesuai TELEMETRY_DRAIN_ORDER tanpa
+  // menghapusnya. commit() menandai batch terakhir sudah diterima backend.
+  static uint8_t peekBatch(TelemetryRecord *out, uint8_t max);
+  static void commit();
+
+  static uint32_t pending();
+  static uint8_t fillPercent();
+  // 0 jika tidak ada yang tertunda
+  static uint32_t oldestUnsentTs();
+  static const TelemetryLogStats &stats();
+};
+
+#endif // TELEMETRY_LOG_H
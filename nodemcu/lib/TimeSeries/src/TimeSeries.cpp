@@ -0,0 +1,234 @@
+#include "TimeSeries.h"
+#include <math.h>
+
+static const int32_t TS_NAN = INT32_MIN;
+
+static uint32_t zigzag(int32_t x)
+{
+  return (uint32_t(x) << 1) ^ uint32_t(x >> 31);
+}
+
+static int32_t unzigzag(uint32_t z)
+{
+  return int32_t((z >> 1) ^ (~(z & 1) + 1));
+}
+
+static int32_t quantize(float v, float scale)
+{
+  float q = v * scale;
+  if (!isfinite(q) || q >= 2.0e9f || q <= -2.0e9f)
+    return TS_NAN;
+  return int32_t(lroundf(q));
+}
+
+static float dequantize(int32_t q, float scale)
+{
+  return q == TS_NAN ? NAN : float(q) / scale;
+}
+
+// ─── Bit stream ──────────────────────────────────────────────
+void BitWriter::begin(uint8_t *b, size_t capBytes)
+{
+  buf = b;
+  cap = capBytes;
+  bits = 0;
+}
+
+bool BitWriter::write(uint32_t value, uint8_t nbits)
+{
+  if (nbits > bitsFree())
+    return false;
+  while (nbits--)
+  {
+    uint8_t mask = 0x80 >> (bits & 7);
+    if ((value >> nbits) & 1)
+      buf[bits >> 3] |= mask;
+    else
+      buf[bits >> 3] &= ~mask;
+    bits++;
+  }
+  return true;
+}
+
+void BitReader::begin(const uint8_t *b, size_t lenBytes)
+{
+  buf = b;
+  len = lenBytes;
+  pos = 0;
+}
+
+bool BitReader::read(uint8_t nbits, uint32_t &out)
+{
+  if (pos + nbits > len * 8)
+    return false;
+  out = 0;
+  while (nbits--)
+  {
+    out = (out << 1) | ((buf[pos >> 3] >> (7 - (pos & 7))) & 1);
+    pos++;
+  }
+  return true;
+}
+
+// ─── Encoder ─────────────────────────────────────────────────
+static void writeTsDod(BitWriter &w, int32_t dod)
+{
+  uint32_t z = zigzag(dod);
+  if (z == 0)
+    w.write(0, 1);
+  else if (z < (1u << 7))
+    w.write((0x2u << 7) | z, 9);
+  else if (z < (1u << 9))
+    w.write((0x6u << 9) | z, 12);
+  else if (z < (1u << 12))
+    w.write((0xEu << 12) | z, 16);
+  else
+  {
+    w.write(0xF, 4);
+    w.write(z, 32);
+  }
+}
+
+static void writeValueDelta(BitWriter &w, int32_t d)
+{
+  uint32_t z = zigzag(d);
+  if (z == 0)
+    w.write(0, 1);
+  else if (z < (1u << 6))
+    w.write((0x2u << 6) | z, 8);
+  else if (z < (1u << 13))
+    w.write((0x6u << 13) | z, 16);
+  else
+  {
+    w.write(0x7, 3);
+    w.write(z, 32);
+  }
+}
+
+void TimeSeriesEncoder::begin(uint8_t *buf, size_t capBytes, const float *sc)
+{
+  w.begin(buf, capBytes);
+  scale = sc;
+  n = 0;
+  prevTs = 0;
+  prevDelta = 0;
+  memset(prevQ, 0, sizeof(prevQ));
+}
+
+bool TimeSeriesEncoder::append(const TimeSeriesSample &s)
+{
+  if (w.bitsFree() < TS_MAX_SAMPLE_BITS || n == UINT16_MAX)
+    return false;
+
+  if (n == 0)
+  {
+    w.write(s.ts, 32);
+    for (uint8_t i = 0; i < TS_CHANNELS; i++)
+    {
+      prevQ[i] = quantize(s.v[i], scale[i]);
+      w.write(uint32_t(prevQ[i]), 32);
+    }
+  }
+  else
+  {
+    int32_t delta = int32_t(s.ts - prevTs);
+    writeTsDod(w, int32_t(uint32_t(delta) - uint32_t(prevDelta)));
+    prevDelta = delta;
+    for (uint8_t i = 0; i < TS_CHANNELS; i++)
+    {
+      int32_t q = quantize(s.v[i], scale[i]);
+      // Selisih modulo 2^32 supaya sentinel NAN tidak overflow
+      writeValueDelta(w, int32_t(uint32_t(q) - uint32_t(prevQ[i])));
+      prevQ[i] = q;
+    }
+  }
+  prevTs = s.ts;
+  n++;
+  return true;
+}
+
+// ─── Decoder ─────────────────────────────────────────────────
+// Baca prefix unary sampai '0' atau maxOnes bit '1'
+static bool readPrefix(BitReader &r, uint8_t maxOnes, uint8_t &ones)
+{
+  ones = 0;
+  uint32_t bit;
+  while (ones < maxOnes)
+  {
+    if (!r.read(1, bit))
+      return false;
+    if (!bit)
+      break;
+    ones++;
+  }
+  return true;
+}
+
+static bool readTsDod(BitReader &r, int32_t &dod)
+{
+  static const uint8_t WIDTH[] = {0, 7, 9, 12, 32};
+  uint8_t ones;
+  uint32_t z = 0;
+  if (!readPrefix(r, 4, ones) || (WIDTH[ones] && !r.read(WIDTH[ones], z)))
+    return false;
+  dod = unzigzag(z);
+  return true;
+}
+
+static bool readValueDelta(BitReader &r, int32_t &d)
+{
+  static const uint8_t WIDTH[] = {0, 6, 13, 32};
+  uint8_t ones;
+  uint32_t z = 0;
+  if (!readPrefix(r, 3, ones) || (WIDTH[ones] && !r.read(WIDTH[ones], z)))
+    return false;
+  d = unzigzag(z);
+  return true;
+}
+
+void TimeSeriesDecoder::begin(const uint8_t *buf, size_t lenBytes, const float *sc)
+{
+  r.begin(buf, lenBytes);
+  scale = sc;
+  n = 0;
+  prevTs = 0;
+  prevDelta = 0;
+  memset(prevQ, 0, sizeof(prevQ));
+}
+
+bool TimeSeriesDecoder::next(TimeSeriesSample &out)
+{
+  if (n == 0)
+  {
+    uint32_t v;
+    if (!r.read(32, v))
+      return false;
+    prevTs = v;
+    for (uint8_t i = 0; i < TS_CHANNELS; i++)
+    {
+      if (!r.read(32, v))
+        return false;
+      prevQ[i] = int32_t(v);
+    }
+  }
+  else
+  {
+    int32_t dod;
+    if (!readTsDod(r, dod))
+      return false;
+    prevDelta = int32_t(uint32_t(prevDelta) + uint32_t(dod));
+    prevTs += uint32_t(prevDelta);
+    for (uint8_t i = 0; i < TS_CHANNELS; i++)
+    {
+      int32_t d;
+      if (!readValueDelta(r, d))
+        return false;
+      prevQ[i] = int32_t(uint32_t(prevQ[i]) + uint32_t(d));
+    }
+  }
+  out.ts = prevTs;
+  for (uint8_t i = 0; i < TS_CHANNELS; i++)
+    out.v[i] = dequantize(prevQ[i], scale[i]);
+  n++;
+  return true;
+}
@@ -0,0 +1,90 @@
+// TimeSeries.h
+#ifndef TIME_SERIES_H
+#define TIME_SERIES_H
+
+#include <Arduino.h>
+
+#define TS_CHANNELS 4
+// Bit terbanyak untuk satu sampel: timestamp '1111'+32, nilai '111'+32 per kanal
+#define TS_MAX_SAMPLE_BITS (36 + TS_CHANNELS * 35)
+
+// Skala kanal sensor (tds, ph, turbidity, temperature): resolusi penyimpanan
+// 0.1 ppm, 0.01 pH, 0.1 NTU, 0.01 °C
+static const float TS_SENSOR_SCALE[TS_CHANNELS] = {10.0f, 100.0f, 10.0f, 100.0f};
+
+struct TimeSeriesSample
+{
+  uint32_t ts;
+  float v[TS_CHANNELS];
+};
+
+// Bit stream MSB-first di atas buffer milik pemanggil (tanpa alokasi)
+class BitWriter
+{
+public:
+  void begin(uint8_t *buf, size_t capBytes);
+  bool write(uint32_t value, uint8_t nbits);
+  size_t bitsUsed() const { return bits; }
+  size_t bitsFree() const { return cap * 8 - bits; }
+  size_t bytes() const { return (bits + 7) / 8; }
+
+private:
+  uint8_t *buf = nullptr;
+  size_t cap = 0;
+  size_t bits = 0;
+};
+
+class BitReader
+{
+public:
+  void begin(const uint8_t *buf, size_t lenBytes);
+  bool read(uint8_t nbits, uint32_t &out);
+
+private:
+  const uint8_t *buf = nullptr;
+  size_t len = 0;
+  size_t pos = 0;
+};
+
+// Encoder gaya Gorilla: timestamp sebagai delta-of-delta, nilai sebagai
+// bilangan bulat berskala (round(v * scale[i])) yang di-delta terhadap sampel
+// sebelumnya lalu zig-zag, dengan panjang bit bertingkat:
+//   ts : '0' | '10'+7 | '110'+9 | '1110'+12 | '1111'+32
+//   val: '0' | '10'+6 | '110'+13 | '111'+32
+// Sampel pertama di blok ditulis mentah (ts 32 bit, nilai 32 bit). Nilai
+// non-finite disimpan sebagai sentinel dan dibaca kembali sebagai NAN.
+// State hanya sampel sebelumnya, jadi memori tetap berapa pun panjang blok.
+class TimeSeriesEncoder
+{
+public:
+  void begin(uint8_t *buf, size_t capBytes, const float *scale);
+  // false jika sisa buffer tidak cukup untuk sampel terburuk (blok penuh)
+  bool append(const TimeSeriesSample &s);
+  uint16_t count() const { return n; }
+  size_t bytes() const { return w.bytes(); }
+
+private:
+  BitWriter w;
+  const float *scale = nullptr;
+  uint16_t n = 0;
+  uint32_t prevTs = 0;
+  int32_t prevDelta = 0;
+  int32_t prevQ[TS_CHANNELS] = {};
+};
+
+class TimeSeriesDecoder
+{
+public:
+  void begin(const uint8_t *buf, size_t lenBytes, const float *scale);
+  bool next(TimeSeriesSample &out);
+
+private:
+  BitReader r;
+  const float *scale = nullptr;
+  uint16_t n = 0;
+  uint32_t prevTs = 0;
+  int32_t prevDelta = 0;
+  int32_t prevQ[TS_CHANNELS] = {};
+};
+
+#endif // TIME_SERIES_H
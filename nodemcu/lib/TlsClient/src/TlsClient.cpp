@@ -0,0 +1,451 @@
+// TlsClient.cpp
+#include "TlsClient.h"
+#include <mbedtls/pk.h>
+#include <mbedtls/sha256.h>
+#include <mbedtls/error.h>
+#include <lwip/sockets.h>
+#include <lwip/netdb.h>
+#include <esp_heap_caps.h>
+#include <rom/crc.h>
+
+// Salinan sesi di RTC slow memory: bertahan saat soft reset / watchdog,
+// hilang saat power-on. Divalidasi dengan magic + CRC sebelum dipakai.
+struct RtcSessionBlob
+{
+  uint32_t magic;
+  uint32_t crc;
+  uint16_t len;
+  uint8_t data[TLS_RTC_SESSION_MAX];
+};
+static const uint32_t RTC_SESSION_MAGIC = 0x544C5331; // "TLS1"
+static RTC_NOINIT_ATTR RtcSessionBlob rtcSession;
+
+TlsClient::TlsClient()
+{
+  mbedtls_net_init(&net);
+  mbedtls_ssl_init(&ssl);
+  mbedtls_ssl_config_init(&conf);
+  mbedtls_ctr_drbg_init(&drbg);
+  mbedtls_entropy_init(&entropy);
+  mbedtls_x509_crt_init(&caChain);
+  mbedtls_ssl_session_init(&session);
+}
+
+TlsClient::~TlsClient()
+{
+  stop();
+  mbedtls_ssl_session_free(&session);
+  mbedtls_x509_crt_free(&caChain);
+  mbedtls_ctr_drbg_free(&drbg);
+  mbedtls_entropy_free(&entropy);
+}
+
+bool TlsClient::setCACert(const char *pem)
+{
+  mbedtls_x509_crt_free(&caChain);
+  mbedtls_x509_crt_init(&caChain);
+  int rc = mbedtls_x509_crt_parse(&caChain, (const unsigned char *)pem, strlen(pem) + 1);
+  hasCA = (rc == 0);
+  if (!hasCA)
+  {
+    Serial.printf("[TLS] CA parse failed: -0x%04x\n", -rc);
+    badConfig = true;
+  }
+  return hasCA;
+}
+
+void TlsClient::setPublicKeyPin(const uint8_t sha256[32])
+{
+  memcpy(pin, sha256, sizeof(pin));
+  hasPin = true;
+}
+
+bool TlsClient::setPublicKeyPinHex(const char *hex)
+{
+  uint8_t out[32];
+  bool ok = strlen(hex) == 64;
+  for (uint8_t i = 0; ok && i < 32; i++)
+  {
+    char byteStr[3] = {hex[2 * i], hex[2 * i + 1], 0};
+    char *end = nullptr;
+    out[i] = uint8_t(strtoul(byteStr, &end, 16));
+    ok = end == byteStr + 2;
+  }
+  if (!ok)
+  {
+    Serial.println("[TLS] public key pin is not 64 hex digits");
+    badConfig = true;
+    return false;
+  }
+  setPublicKeyPin(out);
+  return true;
+}
+
+void TlsClient::setRtcSessionCache(bool enable)
+{
+  useRtc = enable;
+  if (useRtc && !hasSession)
+    restoreRtcSession();
+}
+
+void TlsClient::clearSession()
+{
+  mbedtls_ssl_session_free(&session);
+  mbedtls_ssl_session_init(&session);
+  hasSession = false;
+  rtcSession.magic = 0;
+}
+
+int TlsClient::connect(IPAddress ip, uint16_t port)
+{
+  return connect(ip.toString().c_str(), port, int32_t(handshakeTimeoutMs));
+}
+
+int TlsClient::connect(const char *host, uint16_t port)
+{
+  return connect(host, port, int32_t(handshakeTimeoutMs));
+}
+
+int TlsClient::connect(IPAddress ip, uint16_t port, int32_t timeout)
+{
+  return connect(ip.toString().c_str(), port, timeout);
+}
+
+int TlsClient::connect(const char *host, uint16_t port, int32_t timeout)
+{
+  stop();
+  if (badConfig)
+  {
+    // Jangan turun ke VERIFY_NONE hanya karena CA/pin rusak
+    Serial.println("[TLS] refusing to connect: CA/pin configured but invalid");
+    tlsStats.failures++;
+    return 0;
+  }
+  int fd = openSocket(host, port, timeout);
+  if (fd < 0)
+  {
+    tlsStats.failures++;
+    return 0;
+  }
+  net.fd = fd;
+  if (!handshake(host))
+  {
+    tlsStats.failures++;
+    stop();
+    return 0;
+  }
+  ready = true;
+  return 1;
+}
+
+int TlsClient::openSocket(const char *host, uint16_t port, int32_t timeoutMs)
+{
+  struct addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo *res = nullptr;
+  char portStr[6];
+  snprintf(portStr, sizeof(portStr), "%u", port);
+  if (getaddrinfo(host, portStr, &hints, &res) != 0 || !res)
+  {
+    Serial.printf("[TLS] DNS failed for %s\n", host);
+    return -1;
+  }
+
+  int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+  if (fd < 0)
+  {
+    freeaddrinfo(res);
+    return -1;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+  int rc = ::connect(fd, res->ai_addr, res->ai_addrlen);
+  freeaddrinfo(res);
+  if (rc < 0 && errno != EINPROGRESS)
+  {
+    close(fd);
+    return -1;
+  }
+
+  fd_set wfds;
+  FD_ZERO(&wfds);
+  FD_SET(fd, &wfds);
+  struct timeval tv = {timeoutMs / 1000, (timeoutMs % 1000) * 1000};
+  int err = 0;
+  socklen_t errLen = sizeof(err);
+  if (select(fd + 1, nullptr, &wfds, nullptr, &tv) <= 0 ||
+      getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errLen) < 0 || err != 0)
+  {
+    Serial.printf("[TLS] TCP connect to %s:%u failed\n", host, port);
+    close(fd);
+    return -1;
+  }
+
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return fd;
+}
+
+bool TlsClient::handshake(const char *host)
+{
+  size_t heapBefore = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+  size_t heapLow = heapBefore;
+  unsigned long t0 = millis();
+
+  int rc = 0;
+  if (!seeded)
+  {
+    const char *pers = "iot-mqtt";
+    rc = mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy,
+                               (const unsigned char *)pers, strlen(pers));
+    seeded = (rc == 0);
+  }
+  if (rc == 0)
+    rc = mbedtls_ssl_config_defaults(&conf, MBEDTLS_SSL_IS_CLIENT,
+                                     MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT);
+  if (rc != 0)
+  {
+    Serial.printf("[TLS] setup failed: -0x%04x\n", -rc);
+    return false;
+  }
+
+  if (hasCA)
+  {
+    mbedtls_ssl_conf_authmode(&conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+    mbedtls_ssl_conf_ca_chain(&conf, &caChain, nullptr);
+  }
+  else
+  {
+    // Tanpa CA: rantai sertifikat tidak diverifikasi, hanya pin (jika ada)
+    mbedtls_ssl_conf_authmode(&conf, MBEDTLS_SSL_VERIFY_NONE);
+  }
+  mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, &drbg);
+  mbedtls_ssl_conf_session_tickets(&conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+
+  if ((rc = mbedtls_ssl_setup(&ssl, &conf)) != 0 ||
+      (rc = mbedtls_ssl_set_hostname(&ssl, host)) != 0)
+  {
+    Serial.printf("[TLS] ssl setup failed: -0x%04x\n", -rc);
+    return false;
+  }
+  mbedtls_net_set_nonblock(&net);
+  mbedtls_ssl_set_bio(&ssl, &net, mbedtls_net_send, mbedtls_net_recv, nullptr);
+
+  // Tawarkan sesi lama (session ID / ticket) → abbreviated handshake
+  if (hasSession)
+    mbedtls_ssl_set_session(&ssl, &session);
+
+  // Handshake dijalankan per langkah supaya flag resume mbedtls terbaca:
+  // di-set saat ServerHello menerima sesi/ticket, dan struct handshake
+  // sudah dibebaskan begitu mbedtls_ssl_handshake() selesai
+  bool resumed = false;
+  while (ssl.state != MBEDTLS_SSL_HANDSHAKE_OVER)
+  {
+    rc = mbedtls_ssl_handshake_step(&ssl);
+    if (ssl.handshake)
+      resumed = ssl.handshake->resume != 0;
+    if (rc == 0)
+      continue;
+    if (rc != MBEDTLS_ERR_SSL_WANT_READ && rc != MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+      char err[80];
+      mbedtls_strerror(rc, err, sizeof(err));
+      Serial.printf("[TLS] handshake failed: -0x%04x %s\n", -rc, err);
+      if (hasSession)
+        clearSession(); // sesi mungkin ditolak server, handshake berikutnya full
+      return false;
+    }
+    if (millis() - t0 > handshakeTimeoutMs)
+    {
+      Serial.println("[TLS] handshake timeout");
+      return false;
+    }
+    size_t freeNow = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    if (freeNow < heapLow)
+      heapLow = freeNow;
+    delay(2);
+  }
+
+  if (hasCA && mbedtls_ssl_get_verify_result(&ssl) != 0)
+  {
+    Serial.println("[TLS] certificate verification failed");
+    return false;
+  }
+  if (hasPin && !verifyPin())
+  {
+    Serial.println("[TLS] public key pin mismatch");
+    return false;
+  }
+
+  storeSession();
+
+  tlsStats.handshakes++;
+  if (resumed)
+    tlsStats.resumed++;
+  tlsStats.lastResumed = resumed;
+  tlsStats.lastHandshakeMs = millis() - t0;
+  tlsStats.lastHeapPeak = heapBefore - heapLow;
+  Serial.printf("[TLS] handshake %lums (%s), heap peak %u B, %s\n",
+                (unsigned long)tlsStats.lastHandshakeMs, resumed ? "resumed" : "full",
+                (unsigned)tlsStats.lastHeapPeak, mbedtls_ssl_get_ciphersuite(&ssl));
+  return true;
+}
+
+// Pin = SHA-256 dari SubjectPublicKeyInfo (DER) sertifikat server
+bool TlsClient::verifyPin()
+{
+  const mbedtls_x509_crt *peer = mbedtls_ssl_get_peer_cert(&ssl);
+  if (!peer)
+    return false;
+  unsigned char der[600];
+  int len = mbedtls_pk_write_pubkey_der(const_cast<mbedtls_pk_context *>(&peer->pk), der, sizeof(der));
+  if (len <= 0)
+    return false;
+  unsigned char hash[32];
+  // mbedtls_pk_write_pubkey_der menulis di akhir buffer
+  mbedtls_sha256_ret(der + sizeof(der) - len, len, hash, 0);
+  return memcmp(hash, pin, sizeof(pin)) == 0;
+}
+
+void TlsClient::storeSession()
+{
+  mbedtls_ssl_session_free(&session);
+  mbedtls_ssl_session_init(&session);
+  hasSession = mbedtls_ssl_get_session(&ssl, &session) == 0;
+  if (!hasSession || !useRtc)
+    return;
+
+  size_t olen = 0;
+  if (mbedtls_ssl_session_save(&session, rtcSession.data, sizeof(rtcSession.data), &olen) == 0)
+  {
+    rtcSession.len = uint16_t(olen);
+    rtcSession.crc = crc32_le(0, rtcSession.data, rtcSession.len);
+    rtcSession.magic = RTC_SESSION_MAGIC;
+  }
+  else
+  {
+    rtcSession.magic = 0; // sesi terlalu besar untuk RTC memory, cukup di RAM
+  }
+}
+
+void TlsClient::restoreRtcSession()
+{
+  if (rtcSession.magic != RTC_SESSION_MAGIC || rtcSession.len > sizeof(rtcSession.data) ||
+      crc32_le(0, rtcSession.data, rtcSession.len) != rtcSession.crc)
+    return;
+  if (mbedtls_ssl_session_load(&session, rtcSession.data, rtcSession.len) == 0)
+  {
+    hasSession = true;
+    Serial.println("[TLS] session restored from RTC memory");
+  }
+  else
+  {
+    mbedtls_ssl_session_free(&session);
+    mbedtls_ssl_session_init(&session);
+  }
+}
+
+size_t TlsClient::write(uint8_t b)
+{
+  return write(&b, 1);
+}
+
+size_t TlsClient::write(const uint8_t *buf, size_t size)
+{
+  if (!ready)
+    return 0;
+  size_t sent = 0;
+  unsigned long t0 = millis();
+  while (sent < size)
+  {
+    int rc = mbedtls_ssl_write(&ssl, buf + sent, size - sent);
+    if (rc > 0)
+    {
+      sent += rc;
+      continue;
+    }
+    if ((rc != MBEDTLS_ERR_SSL_WANT_READ && rc != MBEDTLS_ERR_SSL_WANT_WRITE) ||
+        millis() - t0 > handshakeTimeoutMs)
+    {
+      stop();
+      break;
+    }
+    delay(1);
+  }
+  return sent;
+}
+
+int TlsClient::available()
+{
+  if (!ready)
+    return 0;
+  int extra = peeked >= 0 ? 1 : 0;
+  int n = int(mbedtls_ssl_get_bytes_avail(&ssl));
+  if (n == 0)
+  {
+    // Baca record dari socket (non-blocking) supaya bytes_avail terisi
+    int rc = mbedtls_ssl_read(&ssl, nullptr, 0);
+    if (rc < 0 && rc != MBEDTLS_ERR_SSL_WANT_READ && rc != MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+      stop();
+      return extra;
+    }
+    n = int(mbedtls_ssl_get_bytes_avail(&ssl));
+  }
+  return n + extra;
+}
+
+int TlsClient::read()
+{
+  uint8_t b;
+  return read(&b, 1) == 1 ? b : -1;
+}
+
+int TlsClient::read(uint8_t *buf, size_t size)
+{
+  if (size == 0)
+    return 0;
+  size_t off = 0;
+  if (peeked >= 0)
+  {
+    buf[off++] = uint8_t(peeked);
+    peeked = -1;
+    if (off == size)
+      return int(off);
+  }
+  if (!ready)
+    return off ? int(off) : -1;
+  int rc = mbedtls_ssl_read(&ssl, buf + off, size - off);
+  if (rc > 0)
+    return int(off) + rc;
+  if (rc != MBEDTLS_ERR_SSL_WANT_READ && rc != MBEDTLS_ERR_SSL_WANT_WRITE)
+    stop();
+  return off ? int(off) : -1;
+}
+
+int TlsClient::peek()
+{
+  if (peeked < 0 && available() > 0)
+    peeked = read();
+  return peeked;
+}
+
+void TlsClient::flush() {}
+
+void TlsClient::stop()
+{
+  if (ready)
+    mbedtls_ssl_close_notify(&ssl);
+  ready = false;
+  peeked = -1;
+  mbedtls_net_free(&net); // tutup socket
+  mbedtls_ssl_free(&ssl);
+  mbedtls_ssl_config_free(&conf);
+  mbedtls_ssl_init(&ssl);
+  mbedtls_ssl_config_init(&conf);
+}
+
+uint8_t TlsClient::connected()
+{
+  return ready ? 1 : 0;
+}
@@ -0,0 +1,89 @@
+// TlsClient.h
+#ifndef TLS_CLIENT_H
+#define TLS_CLIENT_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/x509_crt.h>
+
+// Ukuran maksimum sesi TLS serial yang disalin ke RTC memory
+#define TLS_RTC_SESSION_MAX 1536
+
+struct TlsStats
+{
+  uint32_t handshakes;      // total handshake berhasil
+  uint32_t resumed;         // handshake yang memakai sesi lama (abbreviated)
+  uint32_t failures;
+  uint32_t lastHandshakeMs; // durasi handshake terakhir
+  uint32_t lastHeapPeak;    // byte heap yang terpakai paling banyak selama handshake
+  bool lastResumed;
+};
+
+// Client TLS (mbedtls + socket lwip) pengganti WiFiClientSecure:
+//  - menyimpan sesi TLS (session ID / ticket) antar reconnect di RAM,
+//    opsional disalin ke RTC memory agar selamat dari soft reset,
+//  - verifikasi server lewat CA yang dipin dan/atau SHA-256 public key.
+class TlsClient : public Client
+{
+public:
+  TlsClient();
+  ~TlsClient();
+
+  // false = PEM tidak valid; connect() lalu menolak tersambung (fail closed)
+  bool setCACert(const char *pem);
+  void setPublicKeyPin(const uint8_t sha256[32]);
+  bool setPublicKeyPinHex(const char *hex);
+  void setHandshakeTimeout(uint32_t ms) { handshakeTimeoutMs = ms; }
+  void setRtcSessionCache(bool enable);
+  void clearSession();
+
+  int connect(IPAddress ip, uint16_t port);
+  int connect(const char *host, uint16_t port);
+  int connect(IPAddress ip, uint16_t port, int32_t timeout);
+  int connect(const char *host, uint16_t port, int32_t timeout);
+  size_t write(uint8_t b);
+  size_t write(const uint8_t *buf, size_t size);
+  int available();
+  int read();
+  int read(uint8_t *buf, size_t size);
+  int peek();
+  void flush();
+  void stop();
+  uint8_t connected();
+  operator bool() { return connected(); }
+
+  const TlsStats &stats() const { return tlsStats; }
+
+private:
+  int openSocket(const char *host, uint16_t port, int32_t timeoutMs);
+  bool handshake(const char *host);
+  bool verifyPin();
+  void storeSession();
+  void restoreRtcSession();
+
+  mbedtls_net_context net;
+  mbedtls_ssl_context ssl;
+  mbedtls_ssl_config conf;
+  mbedtls_ctr_drbg_context drbg;
+  mbedtls_entropy_context entropy;
+  mbedtls_x509_crt caChain;
+  mbedtls_ssl_session session;
+
+  bool hasCA = false;
+  bool hasPin = false;
+  bool badConfig = false; // CA/pin diberikan tapi tidak bisa di-parse
+  bool hasSession = false;
+  bool useRtc = false;
+  bool ready = false;
+  bool seeded = false;
+  int peeked = -1;
+  uint8_t pin[32];
+  uint32_t handshakeTimeoutMs = 15000;
+  TlsStats tlsStats = {};
+};
+
+#endif // TLS_CLIENT_H
@@ -1,12 +1,22 @@
 #include <Arduino.h>
 #include "Config.h"
 #include "FileStorage.h"
+#include "Storage.h"
 #include "Network.h"
 #include "ReadSensor.h"
 #include "RTC.h"
 #include "MQTT.h"
 #include "Alarm.h"
+#include "Actuator.h"
+#include "Persistence.h"
+#include "TelemetryLog.h"
+#include "History.h"
+#include "Profiler.h"
+#include "I2CBus.h"
+#include "Power.h"
+#include "BatteryMode.h"
 #include "Display.h"
+#include "ButtonHandler.h"
 #include "DisplayAlarm.h" // ← Tambahkan ini
 
 RTCHandler rtc;
@@ -29,13 +39,29 @@ void printClippedLine(uint8_t line, const String &fullText) {
     lcd.printLine(line, clip);
 }
 
-void setup() {
-    Serial.begin(115200);
-    setupPins();
-    initFS();
+// Data flash: juga dipakai wake publish mode baterai
+static void beginStorage() {
+    Storage::begin();
     loadAlarmsFromFS();
     loadDeviceId(deviceId, sizeof(deviceId));
     Sensor::initAllSettings();
+    // Semua perubahan alarm/sensor/kalibrasi ditulis ke flash secara tertunda
+    Persistence::begin(Alarm::saveAll, Sensor::saveAllSettings, Sensor::saveTDSConfig);
+    TelemetryLog::begin();
+}
+
+void setup() {
+    Serial.begin(115200);
+#if BATTERY_MODE
+    // Wake timer → burst sampel → deep sleep; tidak kembali ke sini
+    BatteryMode::run(rtc, beginStorage);
+#endif
+    setupPins();
+    buttonHandler.begin();
+    Actuator::begin();
+    beginStorage();
+    // Task I2C memegang Wire; LCD dan DS3231 hanya lewat antriannya
+    I2CBus::begin();
     lcd.begin();
 
     // inisialisasi WiFi, RTC, MQTT, Sensor, dll.
@@ -54,6 +80,7 @@ void setup() {
         trySyncSensorPending();
     }
 
+    // DS3231 dibaca sekali di sini; selanjutnya waktu dari Clock (SQW 1 Hz)
     rtc.setupRTC();
     lcd.clear();
     printClippedLine(0, "Waktu: " + rtc.getTime());
@@ -61,42 +88,138 @@ void setup() {
     printClippedLine(2, "DevID: " + String(deviceId));
 
     Sensor::init();
+    // Di antara jadwal loop(): modem sleep (WiFi ON) / light sleep (WiFi OFF)
+    Power::begin(wifiEnabled);
+}
+
+// Sisa waktu sebuah jadwal periodik (0 = sudah jatuh tempo)
+static uint32_t untilMs(unsigned long last, uint32_t period) {
+    uint32_t elapsed = millis() - last;
+    return elapsed >= period ? 0 : period - elapsed;
+}
+
+// Latensi loop() terburuk & rata-rata, dilaporkan tiap 10 detik
+static void trackLoopLatency(unsigned long startUs) {
+    static uint32_t maxUs = 0;
+    static uint64_t sumUs = 0;
+    static uint32_t passes = 0;
+    static unsigned long lastReport = 0;
+
+    uint32_t dt = micros() - startUs;
+    if (dt > maxUs) maxUs = dt;
+    sumUs += dt;
+    passes++;
+
+    if (millis() - lastReport >= 10000) {
+        lastReport = millis();
+        Serial.printf("[LOOP] max=%uus avg=%uus passes=%u\n",
+                      (unsigned)maxUs, (unsigned)(sumUs / passes), (unsigned)passes);
+        static uint32_t lastLcdBytes = 0;
+        const DisplayStats &ds = lcd.stats();
+        Serial.printf("[LCD] frames=%u cells=%u moves=%u i2c=%uB/s\n",
+                      (unsigned)ds.frames, (unsigned)ds.cells, (unsigned)ds.moves,
+                      (unsigned)((ds.i2cBytes - lastLcdBytes) / 10));
+        lastLcdBytes = ds.i2cBytes;
+        static uint64_t lastBusyUs = 0;
+        const I2cBusStats &bs = I2CBus::stats();
+        Serial.printf("[I2C] util=%u%% rtc=%u lcd=%u retries=%u errors=%u clk=%u wait=%u/%uus\n",
+                      (unsigned)((bs.busyUs - lastBusyUs) / 100000), (unsigned)bs.jobs[I2C_DEV_RTC],
+                      (unsigned)bs.jobs[I2C_DEV_LCD], (unsigned)bs.retries, (unsigned)bs.errors,
+                      (unsigned)bs.clockSwitches, (unsigned)bs.maxWaitUs[I2C_DEV_RTC],
+                      (unsigned)bs.maxWaitUs[I2C_DEV_LCD]);
+        lastBusyUs = bs.busyUs;
+        Profiler::report(passes);
+        Power::report();
+        maxUs = 0;
+        sumUs = 0;
+        passes = 0;
+    }
 }
 
 void loop() {
+    unsigned long loopStartUs = micros();
     unsigned long nowMs = millis();
     static unsigned long lastSample = 0;
     static unsigned long lastCompute = 0;
+    static unsigned long lastLogged = 0;
     // static unsigned long lastButtonCheck = 0;
 
     // Periksa tombol lebih sering (setiap 20ms)
     // if (nowMs - lastButtonCheck >= 10) {
     //     lastButtonCheck = nowMs;
     // }
-    displayAlarm.loop();  // Berisi readButtons()
+    // UI: render hanya saat ada event (tombol, detik, sensor, alarm)
+    {
+        ProfileScope p(PROF_UI);
+        lcd.loop();
+        displayAlarm.loop();
+    }
 
-    // Sampling sensor (40ms)
-    if (nowMs - lastSample >= 40) {
-        lastSample = nowMs;
-        Sensor::sample();
+    {
+        ProfileScope p(PROF_SENSOR);
+        // Sampling sensor (40ms)
+        if (nowMs - lastSample >= 40) {
+            lastSample = nowMs;
+            Sensor::sample();
+        }
+
+        // Compute (1000ms): publish jika broker terhubung, selain itu simpan
+        // snapshot ke TelemetryLog untuk dikirim ulang setelah reconnect
+        if (nowMs - lastCompute >= 1000) {
+            lastCompute = nowMs;
+            TEMPERATURE = Sensor::readTemperatureC();
+            float tds = Sensor::readTDS();
+            float ph = Sensor::readPH();
+            float turbidity = Sensor::readTDBT();
+            uint32_t ts = rtc.unixtime();
+            History::add(ts, tds, ph, turbidity, TEMPERATURE);
+            if (isMQTTConnected()) {
+                publishSensor(tds, ph, turbidity, TEMPERATURE);
+            } else if (nowMs - lastLogged >= TELEMETRY_LOG_INTERVAL_MS) {
+                lastLogged = nowMs;
+                TelemetryLog::append(ts, tds, ph, turbidity, TEMPERATURE);
+            }
+            // Batas sensor & halaman sensor memakai snapshot yang sama
+            displayAlarm.onSensorSnapshot({TEMPERATURE, turbidity, tds, ph});
+        }
+        Sensor::loopAlert();
     }
 
-    // Compute & publish (1000ms)
-    if (wifiEnabled && (nowMs - lastCompute >= 1000)) {
-        lastCompute = nowMs;
-        TEMPERATURE = Sensor::readTemperatureC();
-        float tds = Sensor::readTDS();
-        float ph = Sensor::readPH();
-        float turbidity = Sensor::readTDBT();
-        publishSensor(tds, ph, turbidity, TEMPERATURE);
+    {
+        ProfileScope p(PROF_ALARM);
+        // Hasil SNTP berkala (offset/drift/aging) diterapkan ke DS3231; jadwal
+        // alarm ikut dihitung ulang dan status jam dipublikasikan
+        if (rtc.loop()) {
+            Alarm::reschedule();
+            if (wifiEnabled) publishClockStatus(rtc.syncStats());
+        }
+
+        // Cek alarm (tanpa I2C), lalu jalankan/selesaikan run aktuator
+        Alarm::checkAll();
+        Actuator::loop();
     }
 
-    // Cek alarm
-    Alarm::checkAll();
+    // MQTT (hanya menguras antrian; koneksi diurus task "mqtt")
+    if (wifiEnabled) {
+        ProfileScope p(PROF_MQTT);
+        loopMQTT();
+    }
 
-    // Sensor limits
-    // Sensor::checkSensorLimits();
+    // Flush perubahan yang sudah melewati jendela debounce
+    {
+        ProfileScope p(PROF_PERSIST);
+        Persistence::loop();
+    }
 
-    // MQTT
-    if (wifiEnabled) loopMQTT();
+    trackLoopLatency(loopStartUs);
+
+    // Tidur sampai jadwal terdekat; tombol, detak SQW, SNTP dan perintah
+    // MQTT membangunkan lebih awal
+    Power::due(untilMs(lastSample, 40));
+    Power::due(untilMs(lastCompute, 1000));
+    Power::due(displayAlarm.idleMs());
+    Power::due(Actuator::idleMs());
+    Power::due(Persistence::idleMs());
+    Power::due(rtc.idleMs());
+    Power::idle();
 }
\ No newline at end of file
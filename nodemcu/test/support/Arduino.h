@@ -0,0 +1,244 @@
+// Arduino.h (host)
+// Pengganti core Arduino untuk [env:native]: cukup untuk library yang diuji
+// di test/. Jam bisa dibekukan dan dimajukan manual (fake::manualClock),
+// pin digital disimulasikan di fake::pins, dan interrupt CHANGE dipanggil
+// langsung oleh fake::setPin().
+#ifndef FAKE_ARDUINO_H
+#define FAKE_ARDUINO_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define RISING 1
+#define FALLING 2
+#define CHANGE 3
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define PROGMEM
+
+using std::max;
+using std::min;
+
+template <class T, class L, class H>
+T constrain(T x, L lo, H hi) { return x < lo ? lo : (x > hi ? hi : x); }
+
+class String
+{
+public:
+  String() {}
+  String(const char *c) : s(c ? c : "") {}
+  String(const std::string &x) : s(x) {}
+  String(char c) : s(1, c) {}
+  String(int v) : s(std::to_string(v)) {}
+  String(unsigned v) : s(std::to_string(v)) {}
+  String(long v) : s(std::to_string(v)) {}
+  String(unsigned long v) : s(std::to_string(v)) {}
+  String(float v, int decimals = 2) : String(double(v), decimals) {}
+  String(double v, int decimals = 2)
+  {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+    s = buf;
+  }
+  size_t length() const { return s.size(); }
+  const char *c_str() const { return s.c_str(); }
+  bool reserve(size_t n) { s.reserve(n); return true; }
+  bool concat(const char *c, size_t n) { s.append(c, n); return true; }
+  String substring(size_t from) const { return from < s.size() ? s.substr(from) : std::string(); }
+  String substring(size_t from, size_t to) const { return from < to && from < s.size() ? s.substr(from, to - from) : std::string(); }
+  bool startsWith(const String &p) const { return s.rfind(p.s, 0) == 0; }
+  bool endsWith(const String &p) const { return s.size() >= p.s.size() && s.compare(s.size() - p.s.size(), p.s.size(), p.s) == 0; }
+  int indexOf(char c) const { size_t i = s.find(c); return i == std::string::npos ? -1 : int(i); }
+  char charAt(size_t i) const { return i < s.size() ? s[i] : 0; }
+  char operator[](size_t i) const { return charAt(i); }
+  int toInt() const { return atoi(s.c_str()); }
+  float toFloat() const { return float(atof(s.c_str())); }
+  bool isEmpty() const { return s.empty(); }
+  template <class T>
+  String &operator+=(const T &v) { s += String(v).s; return *this; }
+  bool operator==(const String &o) const { return s == o.s; }
+  bool operator!=(const String &o) const { return s != o.s; }
+  bool operator==(const char *o) const { return s == o; }
+  bool operator!=(const char *o) const { return s != o; }
+
+  std::string s;
+};
+
+template <class T>
+inline String operator+(const String &a, const T &b) { return String(a.s + String(b).s); }
+inline String operator+(const char *a, const String &b) { return String(std::string(a) + b.s); }
+
+class Print
+{
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, size_t n)
+  {
+    size_t done = 0;
+    while (done < n && write(buf[done]))
+      done++;
+    return done;
+  }
+  size_t write(const char *str) { return write((const uint8_t *)str, strlen(str)); }
+  size_t print(const char *str) { return write(str); }
+  size_t print(const String &str) { return write(str.c_str()); }
+  size_t print(char c) { return write(uint8_t(c)); }
+  size_t print(int v) { return print(String(v)); }
+  size_t print(unsigned v) { return print(String(v)); }
+  size_t print(long v) { return print(String(v)); }
+  size_t print(unsigned long v) { return print(String(v)); }
+  size_t print(double v, int decimals = 2) { return print(String(v, decimals)); }
+  template <class T>
+  size_t println(const T &v) { return print(v) + println(); }
+  size_t println() { return write("\r\n"); }
+  size_t printf(const char *fmt, ...)
+  {
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    return n > 0 ? write((const uint8_t *)buf, size_t(n) < sizeof(buf) ? size_t(n) : sizeof(buf) - 1) : 0;
+  }
+};
+
+class Stream : public Print
+{
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  virtual int peek() { return -1; }
+  virtual void flush() {}
+  void setTimeout(unsigned long) {}
+};
+
+// Log library ke stdout; set fake::quietSerial untuk benchmark,
+// fake::serialCapture untuk memeriksa isi log di test
+namespace fake
+{
+inline bool quietSerial = false;
+inline std::string *serialCapture = nullptr;
+}
+
+class HardwareSerial : public Stream
+{
+public:
+  void begin(unsigned long) {}
+  size_t write(uint8_t c) override
+  {
+    if (fake::serialCapture)
+      fake::serialCapture->push_back(char(c));
+    if (!fake::quietSerial)
+      fputc(c, stdout);
+    return 1;
+  }
+  using Print::write;
+};
+inline HardwareSerial Serial;
+
+// ─── Waktu ───────────────────────────────────────────────────
+namespace fake
+{
+inline bool manualClock = false;
+inline uint64_t clockUs = 0;
+
+inline uint64_t realUs()
+{
+  using namespace std::chrono;
+  static const steady_clock::time_point start = steady_clock::now();
+  return uint64_t(duration_cast<microseconds>(steady_clock::now() - start).count());
+}
+inline uint64_t nowUs() { return manualClock ? clockUs : realUs(); }
+inline void setMillis(uint32_t ms)
+{
+  manualClock = true;
+  clockUs = uint64_t(ms) * 1000;
+}
+inline void advanceMs(uint32_t ms) { clockUs += uint64_t(ms) * 1000; }
+} // namespace fake
+
+inline unsigned long millis() { return (unsigned long)uint32_t(fake::nowUs() / 1000); }
+inline unsigned long micros() { return (unsigned long)uint32_t(fake::nowUs()); }
+inline void delay(unsigned long ms)
+{
+  if (fake::manualClock)
+    fake::advanceMs(ms);
+  else
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+inline void delayMicroseconds(unsigned us)
+{
+  if (fake::manualClock)
+    fake::clockUs += us;
+}
+inline void yield() {}
+
+// ─── GPIO ────────────────────────────────────────────────────
+namespace fake
+{
+struct Pin
+{
+  uint8_t mode;
+  int level = HIGH; // pull-up: tombol dilepas
+  void (*isr)(void *) = nullptr;
+  void *arg = nullptr;
+  bool intrEnabled = true; // gpio_intr_disable() (driver/gpio.h)
+  int wakeType = 0;        // gpio_wakeup_enable(), 0 = tidak aktif
+};
+inline Pin pins[40];
+
+// Ubah level pin; ISR CHANGE yang terpasang dipanggil jika level berubah
+inline void setPin(uint8_t pin, int level)
+{
+  Pin &p = pins[pin];
+  bool changed = p.level != level;
+  p.level = level;
+  if (changed && p.isr && p.intrEnabled)
+    p.isr(p.arg);
+}
+} // namespace fake
+
+inline void pinMode(uint8_t pin, uint8_t mode) { fake::pins[pin].mode = mode; }
+inline void digitalWrite(uint8_t pin, uint8_t level) { fake::pins[pin].level = level; }
+inline int digitalRead(uint8_t pin) { return fake::pins[pin].level; }
+inline int analogRead(uint8_t) { return 0; }
+enum adc_attenuation_t
+{
+  ADC_0db,
+  ADC_2_5db,
+  ADC_6db,
+  ADC_11db
+};
+inline void analogSetWidth(uint8_t) {}
+inline void analogSetPinAttenuation(uint8_t, adc_attenuation_t) {}
+inline uint8_t digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline void attachInterruptArg(uint8_t pin, void (*isr)(void *), void *arg, int)
+{
+  fake::pins[pin].isr = isr;
+  fake::pins[pin].arg = arg;
+}
+inline void detachInterrupt(uint8_t pin) { fake::pins[pin].isr = nullptr; }
+
+inline uint32_t esp_random() { return (uint32_t(rand()) << 16) ^ uint32_t(rand()); }
+inline long random(long hi) { return hi > 0 ? rand() % hi : 0; }
+inline long random(long lo, long hi) { return hi > lo ? lo + rand() % (hi - lo) : lo; }
+
+#endif // FAKE_ARDUINO_H
@@ -0,0 +1,22 @@
+// DallasTemperature.h (host): hanya tipe, tidak ada DS18B20 di host
+#ifndef FAKE_DALLAS_TEMPERATURE_H
+#define FAKE_DALLAS_TEMPERATURE_H
+
+#include <OneWire.h>
+
+#define DEVICE_DISCONNECTED_C -127
+
+class DallasTemperature
+{
+public:
+  explicit DallasTemperature(OneWire *) {}
+  void begin() {}
+  void setResolution(uint8_t) {}
+  void setWaitForConversion(bool) {}
+  void requestTemperatures() {}
+  bool isConversionComplete() { return true; }
+  int16_t millisToWaitForConversion(uint8_t) { return 0; }
+  float getTempCByIndex(uint8_t) { return 25.0f; }
+};
+
+#endif // FAKE_DALLAS_TEMPERATURE_H
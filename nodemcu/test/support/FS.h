@@ -0,0 +1,149 @@
+// FS.h (host)
+// fs::FS di RAM untuk [env:native]. Isi file bisa dibaca/dirusak langsung
+// lewat fs.raw(path); writeBudget mensimulasikan listrik padam di tengah
+// penulisan (byte sesudah budget habis tidak ditulis).
+#ifndef FAKE_FS_H
+#define FAKE_FS_H
+
+#include <Arduino.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace fs
+{
+enum SeekMode
+{
+  SeekSet = 0,
+  SeekCur = 1,
+  SeekEnd = 2
+};
+
+class FS;
+
+class File : public Stream
+{
+public:
+  File() {}
+  File(FS *owner, std::shared_ptr<std::vector<uint8_t>> buf, const char *path, bool writable, size_t pos)
+      : owner(owner), buf(buf), path(path), writable(writable), pos(pos) {}
+
+  operator bool() const { return bool(buf); }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t *src, size_t n) override;
+  using Print::write;
+  size_t read(uint8_t *dst, size_t n)
+  {
+    if (!buf || pos >= buf->size())
+      return 0;
+    n = std::min(n, buf->size() - pos);
+    memcpy(dst, buf->data() + pos, n);
+    pos += n;
+    return n;
+  }
+  size_t readBytes(char *dst, size_t n) { return read((uint8_t *)dst, n); }
+  size_t readBytes(uint8_t *dst, size_t n) { return read(dst, n); }
+  int read() override
+  {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+  }
+  int peek() override { return buf && pos < buf->size() ? (*buf)[pos] : -1; }
+  int available() override { return buf && pos < buf->size() ? int(buf->size() - pos) : 0; }
+  bool seek(uint32_t off, SeekMode mode = SeekSet)
+  {
+    if (!buf)
+      return false;
+    size_t base = mode == SeekSet ? 0 : mode == SeekCur ? pos : buf->size();
+    pos = base + off;
+    return pos <= buf->size() || writable;
+  }
+  size_t position() const { return pos; }
+  size_t size() const { return buf ? buf->size() : 0; }
+  const char *name() const { return path.c_str(); }
+  void flush() override {}
+  void close() { buf.reset(); }
+
+private:
+  FS *owner = nullptr;
+  std::shared_ptr<std::vector<uint8_t>> buf;
+  std::string path;
+  bool writable = false;
+  size_t pos = 0;
+};
+
+class FS
+{
+public:
+  File open(const char *path, const char *mode = "r", bool create = false)
+  {
+    (void)create;
+    if (failOpen)
+      return File();
+    auto it = files.find(path);
+    if (mode[0] == 'r')
+    {
+      if (it == files.end())
+        return File();
+      return File(this, it->second, path, mode[1] == '+', 0);
+    }
+    if (mode[0] == 'w' || it == files.end())
+      it = files.insert_or_assign(path, std::make_shared<std::vector<uint8_t>>()).first;
+    return File(this, it->second, path, true, mode[0] == 'a' ? it->second->size() : 0);
+  }
+  File open(const String &path, const char *mode = "r") { return open(path.c_str(), mode); }
+  bool exists(const char *path) { return files.count(path) != 0; }
+  bool exists(const String &path) { return exists(path.c_str()); }
+  bool remove(const char *path) { return files.erase(path) != 0; }
+  bool remove(const String &path) { return remove(path.c_str()); }
+  // Seperti LittleFS: tujuan yang sudah ada diganti secara atomik
+  bool rename(const char *from, const char *to)
+  {
+    auto it = files.find(from);
+    if (it == files.end())
+      return false;
+    auto data = it->second;
+    files.erase(it);
+    files[to] = data;
+    return true;
+  }
+  bool mkdir(const char *) { return true; }
+
+  std::vector<uint8_t> &raw(const char *path)
+  {
+    auto &p = files[path];
+    if (!p)
+      p = std::make_shared<std::vector<uint8_t>>();
+    return *p;
+  }
+  void format() { files.clear(); }
+
+  std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> files;
+  bool failOpen = false;
+  int64_t writeBudget = -1;   // byte yang masih boleh ditulis, -1 = tak terbatas
+  uint64_t bytesWritten = 0;  // total byte ditulis (wear)
+  uint32_t writeCalls = 0;
+};
+
+inline size_t File::write(const uint8_t *src, size_t n)
+{
+  if (!buf || !writable)
+    return 0;
+  if (owner->writeBudget >= 0)
+    n = std::min<size_t>(n, size_t(owner->writeBudget));
+  if (pos + n > buf->size())
+    buf->resize(pos + n);
+  memcpy(buf->data() + pos, src, n);
+  pos += n;
+  owner->bytesWritten += n;
+  owner->writeCalls++;
+  if (owner->writeBudget >= 0)
+    owner->writeBudget -= int64_t(n);
+  return n;
+}
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif // FAKE_FS_H
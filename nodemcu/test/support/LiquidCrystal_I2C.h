@@ -0,0 +1,73 @@
+// LiquidCrystal_I2C.h (host)
+// HD44780 20x4 di balik backpack PCF8574: DDRAM 128 byte dengan address
+// counter, dan penghitung byte di bus I2C seperti library aslinya (mode
+// 4-bit: tiap byte = 2 nibble × expanderWrite data, EN naik, EN turun;
+// tiap expanderWrite = alamat + 1 byte).
+#ifndef FAKE_LIQUIDCRYSTAL_I2C_H
+#define FAKE_LIQUIDCRYSTAL_I2C_H
+
+#include <Arduino.h>
+
+class LiquidCrystal_I2C : public Print
+{
+public:
+  static const uint32_t BUS_BYTES_PER_LCD_BYTE = 2 * 3 * 2;
+
+  LiquidCrystal_I2C(uint8_t addr, uint8_t cols, uint8_t rows) : addr(addr), cols(cols), rows(rows) {}
+
+  void init()
+  {
+    // Urutan reset 4-bit + function set, display on, clear, entry mode
+    busBytes += 3 * 3 * 2 + 3 * 2 + 4 * BUS_BYTES_PER_LCD_BYTE;
+    memset(ddram, ' ', sizeof(ddram));
+    ac = 0;
+    last = this;
+  }
+  void backlight() { busBytes += 2; }
+  void clear()
+  {
+    command();
+    memset(ddram, ' ', sizeof(ddram));
+    ac = 0;
+  }
+  void setCursor(uint8_t col, uint8_t row)
+  {
+    static const uint8_t OFFSET[4] = {0x00, 0x40, 0x14, 0x54};
+    command();
+    moves++;
+    ac = uint8_t(OFFSET[row & 3] + col) & 0x7F;
+  }
+  size_t write(uint8_t c) override
+  {
+    busBytes += BUS_BYTES_PER_LCD_BYTE;
+    chars++;
+    ddram[ac] = char(c);
+    // Mode 2 baris: 0x00-0x27 lalu 0x40-0x67, kembali ke 0x00
+    ac = ac == 0x27 ? 0x40 : ac == 0x67 ? 0x00 : uint8_t(ac + 1);
+    return 1;
+  }
+  using Print::write;
+
+  // Isi yang terlihat di baris row (cols karakter)
+  std::string row(uint8_t r) const
+  {
+    static const uint8_t OFFSET[4] = {0x00, 0x40, 0x14, 0x54};
+    return std::string(ddram + OFFSET[r & 3], cols);
+  }
+  void resetCounters() { busBytes = chars = moves = 0; }
+
+  static inline LiquidCrystal_I2C *last = nullptr; // instance terakhir yang init()
+
+  uint64_t busBytes = 0;
+  uint32_t chars = 0;
+  uint32_t moves = 0;
+
+private:
+  void command() { busBytes += BUS_BYTES_PER_LCD_BYTE; }
+
+  uint8_t addr, cols, rows;
+  char ddram[128];
+  uint8_t ac = 0;
+};
+
+#endif // FAKE_LIQUIDCRYSTAL_I2C_H
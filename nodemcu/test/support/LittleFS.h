@@ -0,0 +1,27 @@
+// LittleFS.h (host)
+#ifndef FAKE_LITTLEFS_H
+#define FAKE_LITTLEFS_H
+
+#include <FS.h>
+
+class LittleFSFS : public fs::FS
+{
+public:
+  bool begin(bool formatOnFail = false, const char * = "/littlefs", uint8_t = 10, const char * = "spiffs")
+  {
+    (void)formatOnFail;
+    return true;
+  }
+  void end() {}
+  size_t totalBytes() { return 1536 * 1024; }
+  size_t usedBytes()
+  {
+    size_t n = 0;
+    for (auto &f : files)
+      n += f.second->size();
+    return n;
+  }
+};
+inline LittleFSFS LittleFS;
+
+#endif // FAKE_LITTLEFS_H
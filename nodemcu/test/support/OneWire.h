@@ -0,0 +1,13 @@
+// OneWire.h (host): hanya tipe, tidak ada bus 1-Wire di host
+#ifndef FAKE_ONEWIRE_H
+#define FAKE_ONEWIRE_H
+
+#include <Arduino.h>
+
+class OneWire
+{
+public:
+  explicit OneWire(uint8_t) {}
+};
+
+#endif // FAKE_ONEWIRE_H
@@ -0,0 +1,56 @@
+// RTClib.h (host)
+// Hanya DateTime (unixtime ↔ tanggal, UTC tanpa zona), cukup untuk kode
+// yang menghitung hari/menit dari Clock::now(); RTC_DS3231 kosong.
+#ifndef FAKE_RTCLIB_H
+#define FAKE_RTCLIB_H
+
+#include <Arduino.h>
+
+class DateTime
+{
+public:
+  DateTime(uint32_t t = 946684800u) : t(t)
+  {
+    // days → y/m/d (Howard Hinnant, civil_from_days)
+    int64_t z = int64_t(t / 86400) + 719468;
+    int64_t era = z / 146097;
+    uint32_t doe = uint32_t(z - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    d = uint8_t(doy - (153 * mp + 2) / 5 + 1);
+    m = uint8_t(mp < 10 ? mp + 3 : mp - 9);
+    y = uint16_t(int64_t(yoe) + era * 400 + (m <= 2));
+  }
+  DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour = 0, uint8_t min = 0, uint8_t sec = 0)
+  {
+    int64_t yy = int64_t(year) - (month <= 2);
+    int64_t era = yy / 400;
+    uint32_t yoe = uint32_t(yy - era * 400);
+    uint32_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = era * 146097 + doe - 719468;
+    *this = DateTime(uint32_t(days * 86400 + hour * 3600 + min * 60 + sec));
+  }
+  uint16_t year() const { return y; }
+  uint8_t month() const { return m; }
+  uint8_t day() const { return d; }
+  uint8_t hour() const { return uint8_t(t / 3600 % 24); }
+  uint8_t minute() const { return uint8_t(t / 60 % 60); }
+  uint8_t second() const { return uint8_t(t % 60); }
+  // 0 = Minggu (1 Januari 1970 hari Kamis)
+  uint8_t dayOfTheWeek() const { return uint8_t((t / 86400 + 4) % 7); }
+  uint32_t unixtime() const { return t; }
+
+private:
+  uint32_t t;
+  uint16_t y;
+  uint8_t m, d;
+};
+
+// Hanya supaya RTC.h (member RTCHandler) terkompilasi; tidak ada I2C di host
+class RTC_DS3231
+{
+};
+
+#endif // FAKE_RTCLIB_H
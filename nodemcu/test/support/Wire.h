@@ -0,0 +1,22 @@
+// Wire.h (host)
+#ifndef FAKE_WIRE_H
+#define FAKE_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire
+{
+public:
+  bool begin(int sda = -1, int scl = -1, uint32_t hz = 100000)
+  {
+    (void)sda;
+    (void)scl;
+    clockHz = hz;
+    return true;
+  }
+  void setClock(uint32_t hz) { clockHz = hz; }
+  uint32_t clockHz = 0;
+};
+inline TwoWire Wire;
+
+#endif // FAKE_WIRE_H
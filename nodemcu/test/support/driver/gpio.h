@@ -0,0 +1,43 @@
+// driver/gpio.h (host): hanya yang dipakai ButtonHandler untuk light sleep.
+// Interrupt per pin bisa dimatikan (fake::setPin tidak memanggil ISR) dan
+// jenis wake per pin dicatat di fake::pins.
+#ifndef FAKE_DRIVER_GPIO_H
+#define FAKE_DRIVER_GPIO_H
+
+#include <Arduino.h>
+
+typedef int gpio_num_t;
+
+enum gpio_int_type_t
+{
+  GPIO_INTR_DISABLE = 0,
+  GPIO_INTR_POSEDGE = 1,
+  GPIO_INTR_NEGEDGE = 2,
+  GPIO_INTR_ANYEDGE = 3,
+  GPIO_INTR_LOW_LEVEL = 4,
+  GPIO_INTR_HIGH_LEVEL = 5
+};
+
+inline int gpio_intr_enable(gpio_num_t pin)
+{
+  fake::pins[pin].intrEnabled = true;
+  return 0;
+}
+inline int gpio_intr_disable(gpio_num_t pin)
+{
+  fake::pins[pin].intrEnabled = false;
+  return 0;
+}
+inline int gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type)
+{
+  fake::pins[pin].wakeType = type;
+  return 0;
+}
+inline int gpio_wakeup_disable(gpio_num_t pin)
+{
+  fake::pins[pin].wakeType = GPIO_INTR_DISABLE;
+  return 0;
+}
+inline int gpio_set_intr_type(gpio_num_t, gpio_int_type_t) { return 0; }
+
+#endif // FAKE_DRIVER_GPIO_H
@@ -0,0 +1,20 @@
+// freertos/FreeRTOS.h (host): critical section tanpa efek; test berjalan
+// di satu thread dan "ISR" dipanggil langsung oleh fake::setPin(). Hanya
+// dipakai kode yang tidak dijaga #ifdef ARDUINO (ButtonHandler, Outbox).
+#ifndef FAKE_FREERTOS_H
+#define FAKE_FREERTOS_H
+
+#include <cstdint>
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define portMAX_DELAY UINT32_MAX
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux) ((void)(mux))
+
+#endif // FAKE_FREERTOS_H
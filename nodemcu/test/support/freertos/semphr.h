@@ -0,0 +1,16 @@
+// freertos/semphr.h (host): mutex tanpa efek, test berjalan di satu thread
+#ifndef FAKE_FREERTOS_SEMPHR_H
+#define FAKE_FREERTOS_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+typedef void *SemaphoreHandle_t;
+inline SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+  static int token;
+  return &token;
+}
+inline int xSemaphoreTake(SemaphoreHandle_t, uint32_t) { return pdTRUE; }
+inline int xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
+
+#endif // FAKE_FREERTOS_SEMPHR_H
@@ -0,0 +1,21 @@
+// rom/crc.h (host): crc32_le dengan hasil sama seperti fungsi ROM ESP32
+// (CRC-32 IEEE refleksi; crc awal 0, inversi di dalam)
+#ifndef FAKE_ROM_CRC_H
+#define FAKE_ROM_CRC_H
+
+#include <cstddef>
+#include <cstdint>
+
+inline uint32_t crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+  crc = ~crc;
+  while (len--)
+  {
+    crc ^= *buf++;
+    for (uint8_t i = 0; i < 8; i++)
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+  }
+  return ~crc;
+}
+
+#endif // FAKE_ROM_CRC_H
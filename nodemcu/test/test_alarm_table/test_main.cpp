@@ -0,0 +1,251 @@
+// AlarmTable: cek silang dengan std::map pada operasi acak, lalu benchmark
+// 10/100/1000 alarm terhadap array lama (scan linear + geser saat hapus).
+#include <unity.h>
+#include <chrono>
+#include <map>
+#include <random>
+#include <vector>
+#define ALARM_CAPACITY 1024
+#include "AlarmTable.cpp"
+
+static AlarmTable table; // ±60 KB, jangan di stack
+
+static AlarmData alarm(uint16_t id, uint8_t hour, uint8_t minute)
+{
+  AlarmData a{};
+  a.id = id;
+  a.hour = hour;
+  a.minute = minute;
+  a.duration = 30;
+  a.enabled = true;
+  a.days = ALARM_EVERY_DAY;
+  return a;
+}
+
+static void assertMatches(const std::map<uint16_t, AlarmData> &ref)
+{
+  TEST_ASSERT_EQUAL(ref.size(), table.size());
+  for (const auto &kv : ref)
+  {
+    int32_t i = table.find(kv.first);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, i);
+    TEST_ASSERT_EQUAL(kv.first, table.data()[i].id);
+    TEST_ASSERT_EQUAL(kv.second.hour, table.data()[i].hour);
+    TEST_ASSERT_EQUAL(kv.second.minute, table.data()[i].minute);
+  }
+  // byTime(): semua alarm tepat sekali, urut menit lalu id
+  const uint16_t *order = table.byTime();
+  std::vector<bool> seen(table.size());
+  for (uint16_t k = 0; k < table.size(); k++)
+  {
+    TEST_ASSERT_LESS_THAN(table.size(), order[k]);
+    TEST_ASSERT_FALSE(seen[order[k]]);
+    seen[order[k]] = true;
+    if (k)
+    {
+      const AlarmData &p = table.data()[order[k - 1]], &c = table.data()[order[k]];
+      uint16_t mp = AlarmTable::minuteOfDay(p), mc = AlarmTable::minuteOfDay(c);
+      TEST_ASSERT_TRUE(mp < mc || (mp == mc && p.id < c.id));
+    }
+  }
+}
+
+void setUp() { table.clear(); }
+void tearDown() {}
+
+static void test_random_ops_match_std_map()
+{
+  std::mt19937 rng(7);
+  std::map<uint16_t, AlarmData> ref;
+  for (int step = 0; step < 20000; step++)
+  {
+    uint16_t id = uint16_t(rng() % 1500 + 1);
+    switch (rng() % 4)
+    {
+    case 0:
+    case 1:
+    {
+      AlarmData a = alarm(id, uint8_t(rng() % 24), uint8_t(rng() % 60));
+      bool expect = !ref.count(id) && ref.size() < MAX_ALARMS;
+      TEST_ASSERT_EQUAL(expect, table.insert(a) != nullptr);
+      if (expect)
+        ref[id] = a;
+      break;
+    }
+    case 2:
+      TEST_ASSERT_EQUAL(ref.erase(id) == 1, table.remove(id));
+      break;
+    case 3:
+    {
+      uint16_t to = uint16_t(rng() % 1500 + 1);
+      bool expect = ref.count(id) && (to == id || !ref.count(to));
+      TEST_ASSERT_EQUAL(expect, table.rekey(id, to));
+      if (expect && to != id)
+      {
+        AlarmData a = ref[id];
+        a.id = to;
+        ref.erase(id);
+        ref[to] = a;
+      }
+      break;
+    }
+    }
+    if (step % 1000 == 0)
+      assertMatches(ref);
+  }
+  assertMatches(ref);
+}
+
+static void test_full_and_duplicate()
+{
+  for (uint16_t i = 0; i < MAX_ALARMS; i++)
+    TEST_ASSERT_NOT_NULL(table.insert(alarm(i + 1, 0, 0)));
+  TEST_ASSERT_NULL(table.insert(alarm(MAX_ALARMS + 1, 0, 0)));
+  TEST_ASSERT_TRUE(table.remove(5));
+  TEST_ASSERT_NULL(table.insert(alarm(6, 0, 0)));
+  TEST_ASSERT_NOT_NULL(table.insert(alarm(5, 1, 0)));
+  TEST_ASSERT_EQUAL(-1, table.find(0));
+  TEST_ASSERT_EQUAL(-1, table.find(MAX_ALARMS + 1));
+}
+
+static void test_lower_bound_and_edit_through_data()
+{
+  table.insert(alarm(1, 6, 0));
+  table.insert(alarm(2, 12, 30));
+  table.insert(alarm(3, 18, 0));
+  const uint16_t *order = table.byTime();
+  TEST_ASSERT_EQUAL(2, table.data()[order[table.lowerBound(7 * 60)]].id);
+  TEST_ASSERT_EQUAL(1, table.data()[order[table.lowerBound(0)]].id);
+  TEST_ASSERT_EQUAL(3, table.lowerBound(18 * 60 + 1));
+
+  // Edit jam langsung lewat data() (display/MQTT) lalu invalidateTime()
+  table.data()[table.find(3)].hour = 5;
+  table.invalidateTime();
+  order = table.byTime();
+  TEST_ASSERT_EQUAL(3, table.data()[order[0]].id);
+}
+
+// ─── Benchmark ───────────────────────────────────────────────
+// Array lama: scan linear untuk exists/edit/enable, hapus dengan geser
+struct LegacyTable
+{
+  AlarmData items[MAX_ALARMS];
+  uint16_t count = 0;
+  int32_t find(uint16_t id) const
+  {
+    for (uint16_t i = 0; i < count; i++)
+      if (items[i].id == id)
+        return i;
+    return -1;
+  }
+  bool remove(uint16_t id)
+  {
+    int32_t i = find(id);
+    if (i < 0)
+      return false;
+    memmove(items + i, items + i + 1, (count - i - 1) * sizeof(AlarmData));
+    count--;
+    return true;
+  }
+  // Alarm berikutnya setelah menit m: scan semua
+  int32_t next(uint16_t m) const
+  {
+    int32_t best = -1;
+    for (uint16_t i = 0; i < count; i++)
+    {
+      uint16_t x = AlarmTable::minuteOfDay(items[i]);
+      if (x >= m && (best < 0 || x < AlarmTable::minuteOfDay(items[best])))
+        best = i;
+    }
+    return best;
+  }
+};
+static LegacyTable legacy;
+
+template <typename F>
+static double nsPerOp(uint32_t ops, F fn)
+{
+  auto t0 = std::chrono::steady_clock::now();
+  fn();
+  auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / ops;
+}
+
+static void benchmark(uint16_t n)
+{
+  std::mt19937 rng(n);
+  std::vector<uint16_t> ids;
+  table.clear();
+  legacy.count = 0;
+  while (ids.size() < n)
+  {
+    uint16_t id = uint16_t(rng() % 60000 + 1);
+    AlarmData a = alarm(id, uint8_t(rng() % 24), uint8_t(rng() % 60));
+    if (!table.insert(a))
+      continue;
+    legacy.items[legacy.count++] = a;
+    ids.push_back(id);
+  }
+  const uint32_t OPS = 200000;
+  volatile int32_t sink = 0;
+  double findNew = nsPerOp(OPS, [&] {
+    for (uint32_t k = 0; k < OPS; k++)
+      sink = sink + table.find(ids[k % ids.size()]);
+  });
+  double findOld = nsPerOp(OPS, [&] {
+    for (uint32_t k = 0; k < OPS; k++)
+      sink = sink + legacy.find(ids[k % ids.size()]);
+  });
+  table.byTime();
+  double nextNew = nsPerOp(OPS, [&] {
+    for (uint32_t k = 0; k < OPS; k++)
+      sink = sink + table.lowerBound(uint16_t(k % 1440));
+  });
+  double nextOld = nsPerOp(OPS, [&] {
+    for (uint32_t k = 0; k < OPS; k++)
+      sink = sink + legacy.next(uint16_t(k % 1440));
+  });
+  // Hapus semua (urutan acak) lalu isi lagi; biaya insert ikut terukur
+  std::shuffle(ids.begin(), ids.end(), rng);
+  const uint32_t ROUNDS = 2000 / n + 1;
+  double removeNew = nsPerOp(ROUNDS * ids.size(), [&] {
+    for (uint32_t r = 0; r < ROUNDS; r++)
+    {
+      for (uint16_t id : ids)
+        table.remove(id);
+      for (uint16_t id : ids)
+        table.insert(alarm(id, 1, 2));
+    }
+  });
+  double removeOld = nsPerOp(ROUNDS * ids.size(), [&] {
+    for (uint32_t r = 0; r < ROUNDS; r++)
+    {
+      for (uint16_t id : ids)
+        legacy.remove(id);
+      for (uint16_t id : ids)
+        legacy.items[legacy.count++] = alarm(id, 1, 2);
+    }
+  });
+  char msg[220];
+  snprintf(msg, sizeof(msg),
+           "n=%4u  find %6.1f vs %7.1f ns | next alarm %6.1f vs %8.1f ns | remove+insert %6.1f vs %7.1f ns  (table vs linear array)",
+           unsigned(ids.size()), findNew, findOld, nextNew, nextOld, removeNew, removeOld);
+  TEST_MESSAGE(msg);
+}
+
+static void test_benchmark_10_100_1000()
+{
+  benchmark(10);
+  benchmark(100);
+  benchmark(1000);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_random_ops_match_std_map);
+  RUN_TEST(test_full_and_duplicate);
+  RUN_TEST(test_lower_bound_and_edit_through_data);
+  RUN_TEST(test_benchmark_10_100_1000);
+  return UNITY_END();
+}
@@ -0,0 +1,302 @@
+// Timeline Actuator (antrian per kanal, millis() wrap) dan catch-up alarm
+// terlewat di Alarm::checkAll() dengan jam & Clock palsu.
+// Storage/RecordLog dan Actuator dikompilasi di unit terpisah (lib_*.cpp)
+// karena sama-sama punya static bernama counters.
+#include <unity.h>
+#include "Schema.cpp"
+#include "AlarmTable.cpp"
+#include "Alarm.cpp"
+#include "Actuator.h"
+#include "Persistence.h"
+#include "Clock.h"
+
+// Clock & Persistence palsu: Alarm hanya butuh now() dan markDirty()
+static uint32_t fakeNow = 0;
+uint32_t Clock::now() { return fakeNow; }
+static uint32_t dirtyCount = 0;
+void Persistence::markDirty(PersistCollection) { dirtyCount++; }
+
+static fs::FS ram;
+static const uint8_t PIN = ACTUATOR_PINS[0];
+
+// Senin 1 Juni 2026, 00:00 waktu lokal
+static const uint32_t MONDAY = DateTime(2026, 6, 1).unixtime();
+
+static uint32_t at(uint8_t h, uint8_t m, uint8_t s = 0, uint32_t day = MONDAY)
+{
+  return day + h * 3600UL + m * 60UL + s;
+}
+
+// Jumlah run yang pernah diminta ke Actuator (selesai + aktif + antre)
+static uint32_t requestedRuns()
+{
+  return Actuator::stats().runs + (Actuator::active(0) ? 1 : 0) + Actuator::pending(0);
+}
+
+static void clearAlarms()
+{
+  uint16_t n;
+  AlarmData *a = Alarm::getAll(n);
+  while (n)
+  {
+    Alarm::remove(a[0].id);
+    a = Alarm::getAll(n);
+  }
+}
+
+void setUp()
+{
+  fake::quietSerial = true;
+  Actuator::cancel(0);
+  clearAlarms();
+}
+
+void tearDown() {}
+
+// ─── Actuator ────────────────────────────────────────────────
+static void test_overlapping_runs_queue_fifo()
+{
+  fake::setMillis(1000);
+  uint32_t runs = Actuator::stats().runs;
+  TEST_ASSERT_TRUE(Actuator::run(0, 3000, 1));
+  TEST_ASSERT_TRUE(Actuator::run(0, 2000, 2));
+  TEST_ASSERT_TRUE(Actuator::run(0, 1000, 3));
+  TEST_ASSERT_TRUE(Actuator::active(0));
+  TEST_ASSERT_EQUAL(2, Actuator::pending(0));
+  TEST_ASSERT_EQUAL(LED_ON, fake::pins[PIN].level);
+  TEST_ASSERT_EQUAL(3000, Actuator::idleMs());
+
+  // Tiap run mendapat durasi utuh, berurutan
+  fake::advanceMs(2999);
+  Actuator::loop();
+  TEST_ASSERT_EQUAL(2, Actuator::pending(0));
+  fake::advanceMs(1);
+  Actuator::loop();
+  TEST_ASSERT_EQUAL(1, Actuator::pending(0));
+  TEST_ASSERT_EQUAL(2000, Actuator::idleMs());
+  fake::advanceMs(2000);
+  Actuator::loop();
+  TEST_ASSERT_EQUAL(0, Actuator::pending(0));
+  TEST_ASSERT_TRUE(Actuator::active(0));
+  fake::advanceMs(1000);
+  Actuator::loop();
+  TEST_ASSERT_FALSE(Actuator::active(0));
+  TEST_ASSERT_EQUAL(LED_OFF, fake::pins[PIN].level);
+  TEST_ASSERT_EQUAL(runs + 3, Actuator::stats().runs);
+  TEST_ASSERT_EQUAL(UINT32_MAX, Actuator::idleMs());
+  // Run ke-3 diminta di t=1000 tapi baru mulai di t=6000
+  TEST_ASSERT_GREATER_OR_EQUAL(5000, Actuator::stats().maxLateMs);
+}
+
+static void test_run_survives_millis_wrap()
+{
+  fake::setMillis(UINT32_MAX - 499);
+  Actuator::run(0, 1000, 1);
+  fake::advanceMs(600); // millis() sudah wrap ke 100
+  TEST_ASSERT_LESS_THAN(1000, millis());
+  Actuator::loop();
+  TEST_ASSERT_TRUE(Actuator::active(0));
+  TEST_ASSERT_EQUAL(400, Actuator::idleMs());
+  fake::advanceMs(400);
+  Actuator::loop();
+  TEST_ASSERT_FALSE(Actuator::active(0));
+}
+
+static void test_queue_full_cancel_and_bad_channel()
+{
+  fake::setMillis(0);
+  uint32_t dropped = Actuator::stats().dropped;
+  TEST_ASSERT_TRUE(Actuator::run(0, 1000, 1));
+  for (uint8_t i = 0; i < ACTUATOR_QUEUE_LEN; i++)
+    TEST_ASSERT_TRUE(Actuator::run(0, 1000, 2 + i));
+  TEST_ASSERT_FALSE(Actuator::run(0, 1000, 99));
+  TEST_ASSERT_FALSE(Actuator::run(ACTUATOR_CHANNELS, 1000, 100));
+  TEST_ASSERT_EQUAL(dropped + 2, Actuator::stats().dropped);
+
+  Actuator::cancel(0);
+  TEST_ASSERT_FALSE(Actuator::active(0));
+  TEST_ASSERT_EQUAL(0, Actuator::pending(0));
+  TEST_ASSERT_EQUAL(LED_OFF, fake::pins[PIN].level);
+}
+
+// ─── Catch-up alarm ──────────────────────────────────────────
+// Urutan penting: lastScan di Alarm.cpp hanya 0 sekali (boot pertama)
+static void test_boot_catches_up_within_window()
+{
+  Alarm::add(1, 5, 0, 10, true);  // 3 jam lalu: di luar jendela 2 jam
+  Alarm::add(2, 7, 0, 10, true);  // 1 jam lalu: terlewat saat mati listrik
+  Alarm::add(3, 7, 30, 10, false); // nonaktif
+  Alarm::add(4, 9, 0, 10, true);  // nanti
+  uint32_t before = requestedRuns();
+  fakeNow = at(8, 0);
+  Alarm::checkAll();
+  TEST_ASSERT_EQUAL(before + 1, requestedRuns());
+  TEST_ASSERT_EQUAL(0, Alarm::find(2)->lastMinTrig);
+  TEST_ASSERT_EQUAL(1, Alarm::find(2)->lastDayTrig);
+  TEST_ASSERT_NOT_EQUAL(1, Alarm::find(1)->lastDayTrig);
+}
+
+static void test_blocked_loop_fires_every_missed_alarm_in_order()
+{
+  fakeNow = at(8, 0);
+  Alarm::checkAll();
+  Alarm::add(10, 8, 10, 60, true);
+  Alarm::add(11, 8, 20, 30, true);
+  Alarm::add(12, 8, 20, 20, true); // menit sama: dua-duanya jalan
+  Alarm::checkAll();
+  uint32_t before = requestedRuns();
+
+  // Loop tertahan (portal WiFi) 40 menit
+  fakeNow = at(8, 40, 5);
+  Alarm::checkAll();
+  TEST_ASSERT_EQUAL(before + 3, requestedRuns());
+  // Durasi tidak saling menimpa: satu aktif, dua antre
+  TEST_ASSERT_TRUE(Actuator::active(0));
+  TEST_ASSERT_EQUAL(2, Actuator::pending(0));
+
+  // Cek berikutnya di menit yang sama tidak memicu ulang
+  fakeNow += 20;
+  Alarm::checkAll();
+  TEST_ASSERT_EQUAL(before + 3, requestedRuns());
+}
+
+static void test_exact_time_and_no_double_fire()
+{
+  fakeNow = at(9, 59, 58);
+  Alarm::add(20, 10, 0, 5, true);
+  Alarm::checkAll();
+  uint32_t before = requestedRuns();
+  fakeNow = at(9, 59, 59);
+  Alarm::checkAll();
+  TEST_ASSERT_EQUAL(before, requestedRuns());
+  fakeNow = at(10, 0, 0);
+  Alarm::checkAll();
+  TEST_ASSERT_EQUAL(before + 1, requestedRuns());
+  for (int s = 1; s < 120; s++)
+  {
+    fakeNow = at(10, 0, 0) + s;
+    Alarm::checkAll();
+  }
+  TEST_ASSERT_EQUAL(before + 1, requestedRuns());
+}
+
+static void test_new_alarm_in_the_past_does_not_fire()
+{
+  fakeNow = at(11, 0);
+  Alarm::checkAll();
+  uint32_t before = requestedRuns();
+  Alarm::add(30, 10, 30, 5, true);
+  Alarm::checkAll();
+  fakeNow = at(11, 1);
+  Alarm::checkAll();
+  TEST_ASSERT_EQUAL(before, requestedRuns());
+}
+
+static void test_editing_defers_then_fires_late()
+{
+  fakeNow = at(11, 58);
+  Alarm::add(40, 12, 0, 5, true);
+  Alarm::checkAll();
+  uint32_t before = requestedRuns();
+  Alarm::setEditing(true);
+  fakeNow = at(12, 3);
+  Alarm::checkAll();
+  TEST_ASSERT_EQUAL(before, requestedRuns());
+  Alarm::setEditing(false);
+  Alarm::checkAll();
+  TEST_ASSERT_EQUAL(before + 1, requestedRuns());
+}
+
+static void test_day_mask_and_midnight_crossing()
+{
+  fakeNow = at(23, 50);
+  Alarm::checkAll();
+  // Selasa saja (bit2), 23:55 Senin tidak aktif, 00:05 Selasa aktif
+  Alarm::add(50, 23, 55, 5, true, 1 << 2);
+  Alarm::add(51, 0, 5, 5, true, 1 << 2);
+  Alarm::checkAll();
+  uint32_t before = requestedRuns();
+  // Loop tertahan melewati tengah malam
+  fakeNow = at(0, 10, 0, MONDAY + 86400);
+  Alarm::checkAll();
+  TEST_ASSERT_EQUAL(before + 1, requestedRuns());
+  TEST_ASSERT_EQUAL(2, Alarm::find(51)->lastDayTrig);
+}
+
+static void test_clock_set_backwards_fires_nothing()
+{
+  fakeNow = at(14, 0, 0, MONDAY + 86400);
+  Alarm::checkAll();
+  Alarm::add(60, 13, 30, 5, true);
+  Alarm::checkAll();
+  uint32_t before = requestedRuns();
+  // SNTP memundurkan jam 1 jam: 13:30 tidak dianggap terlewat
+  fakeNow = at(13, 0, 0, MONDAY + 86400);
+  Alarm::reschedule();
+  Alarm::checkAll();
+  TEST_ASSERT_EQUAL(before, requestedRuns());
+  // ... tapi tetap berbunyi saat jam mencapainya lagi
+  fakeNow = at(13, 30, 0, MONDAY + 86400);
+  Alarm::checkAll();
+  TEST_ASSERT_EQUAL(before + 1, requestedRuns());
+}
+
+// Isi stack dengan sampah lalu tambah alarm offline di frame yang sama
+// kedalamannya, supaya field yang lupa diisi ikut membawa sampah
+static void __attribute__((noinline)) dirtyStack()
+{
+  volatile uint8_t junk[256];
+  for (auto &b : junk)
+    b = 0xA5;
+}
+
+static void __attribute__((noinline)) addOffline(uint8_t h, uint8_t m)
+{
+  dirtyStack();
+  Alarm::addAlarmOffline(h, m, 5, true);
+}
+
+static void test_offline_alarm_runs_on_channel_0()
+{
+  const uint32_t WEDNESDAY = MONDAY + 2 * 86400UL;
+  fakeNow = at(8, 58, 0, WEDNESDAY);
+  Alarm::checkAll();
+  addOffline(9, 0);
+  uint16_t n;
+  AlarmData *a = Alarm::getAll(n);
+  TEST_ASSERT_EQUAL(1, n);
+  TEST_ASSERT_TRUE(a[0].isTemporary);
+  TEST_ASSERT_EQUAL(0, a[0].channel);
+  // tetap kanal 0 setelah disimpan dan dimuat ulang
+  Alarm::saveAll();
+  Alarm::loadAll();
+  a = Alarm::getAll(n);
+  TEST_ASSERT_EQUAL(1, n);
+  TEST_ASSERT_EQUAL(0, a[0].channel);
+  Alarm::checkAll();
+  uint32_t before = requestedRuns();
+  fakeNow = at(9, 0, 0, WEDNESDAY);
+  Alarm::checkAll();
+  TEST_ASSERT_EQUAL(before + 1, requestedRuns());
+  TEST_ASSERT_TRUE(Actuator::active(0));
+}
+
+int main()
+{
+  Storage::begin(ram);
+  Actuator::begin();
+  Alarm::loadAll();
+  UNITY_BEGIN();
+  RUN_TEST(test_overlapping_runs_queue_fifo);
+  RUN_TEST(test_run_survives_millis_wrap);
+  RUN_TEST(test_queue_full_cancel_and_bad_channel);
+  RUN_TEST(test_boot_catches_up_within_window);
+  RUN_TEST(test_blocked_loop_fires_every_missed_alarm_in_order);
+  RUN_TEST(test_exact_time_and_no_double_fire);
+  RUN_TEST(test_new_alarm_in_the_past_does_not_fire);
+  RUN_TEST(test_editing_defers_then_fires_late);
+  RUN_TEST(test_day_mask_and_midnight_crossing);
+  RUN_TEST(test_clock_set_backwards_fires_nothing);
+  RUN_TEST(test_offline_alarm_runs_on_channel_0);
+  return UNITY_END();
+}
@@ -0,0 +1,281 @@
+// ButtonHandler: debounce per tombol, long-press sekali, auto-repeat yang
+// makin cepat, antrian event penuh, idleMs() dan wake light sleep. Pin dan
+// ISR CHANGE dari fake::setPin(), jam manual.
+#include <unity.h>
+#include <vector>
+#include "ButtonHandler.cpp"
+
+static uint32_t isrWakes = 0;
+void Power::wakeFromISR() { isrWakes++; }
+
+struct Seen
+{
+  uint32_t at; // ms sejak awal langkah
+  ButtonEvent e;
+};
+
+static ButtonHandler *h = nullptr;
+
+// Panggil next() tiap 1 ms selama `ms`, seperti loop() yang tidak tidur
+static std::vector<Seen> step(uint32_t ms)
+{
+  std::vector<Seen> out;
+  uint32_t start = millis();
+  for (uint32_t t = 0; t <= ms; t++)
+  {
+    ButtonEvent e;
+    while (h->next(e))
+      out.push_back({uint32_t(millis() - start), e});
+    if (t < ms)
+      fake::advanceMs(1);
+  }
+  return out;
+}
+
+static std::vector<Seen> only(const std::vector<Seen> &v, ButtonEventType type)
+{
+  std::vector<Seen> out;
+  for (const Seen &s : v)
+    if (s.e.type == type)
+      out.push_back(s);
+  return out;
+}
+
+void setUp()
+{
+  fake::quietSerial = true;
+  static uint32_t base = 1000000;
+  fake::setMillis(base += 100000);
+  for (uint8_t pin : BUTTON_PINS)
+  {
+    fake::setPin(pin, HIGH);
+    fake::pins[pin].intrEnabled = true;
+  }
+  delete h;
+  h = new ButtonHandler();
+  h->begin();
+  // Tepi sisa test sebelumnya (ISR memakai state statis) diselesaikan dulu
+  fake::advanceMs(BUTTON_DEBOUNCE_MS);
+  ButtonEvent e;
+  while (h->next(e))
+  {
+  }
+  isrWakes = 0;
+}
+
+void tearDown() {}
+
+static void test_bouncing_contact_gives_one_press_and_one_release()
+{
+  // Pantulan selama 6 ms, lalu stabil LOW
+  fake::setPin(BTN_DOWN, LOW);
+  fake::advanceMs(2);
+  fake::setPin(BTN_DOWN, HIGH);
+  fake::advanceMs(3);
+  fake::setPin(BTN_DOWN, LOW);
+  TEST_ASSERT_EQUAL(3, isrWakes);
+  std::vector<Seen> ev = step(100);
+  TEST_ASSERT_EQUAL(1, ev.size());
+  TEST_ASSERT_EQUAL(BUTTON_DOWN, ev[0].e.button);
+  TEST_ASSERT_EQUAL(BTN_EV_PRESS, ev[0].e.type);
+  // Debounce dihitung dari tepi terakhir
+  TEST_ASSERT_EQUAL(BUTTON_DEBOUNCE_MS, ev[0].at);
+
+  fake::setPin(BTN_DOWN, HIGH);
+  fake::advanceMs(1);
+  fake::setPin(BTN_DOWN, LOW);
+  fake::advanceMs(1);
+  fake::setPin(BTN_DOWN, HIGH);
+  ev = step(100);
+  TEST_ASSERT_EQUAL(1, ev.size());
+  TEST_ASSERT_EQUAL(BTN_EV_RELEASE, ev[0].e.type);
+}
+
+static void test_glitch_shorter_than_debounce_is_ignored()
+{
+  fake::setPin(BTN_UP, LOW);
+  fake::advanceMs(BUTTON_DEBOUNCE_MS - 5);
+  fake::setPin(BTN_UP, HIGH);
+  TEST_ASSERT_EQUAL(0, step(200).size());
+}
+
+static void test_select_long_press_once_without_repeat()
+{
+  fake::setPin(BTN_SELECT, LOW);
+  std::vector<Seen> ev = step(3000);
+  TEST_ASSERT_EQUAL(2, ev.size());
+  TEST_ASSERT_EQUAL(BTN_EV_PRESS, ev[0].e.type);
+  TEST_ASSERT_EQUAL(BTN_EV_LONG, ev[1].e.type);
+  TEST_ASSERT_EQUAL(BUTTON_SELECT, ev[1].e.button);
+  TEST_ASSERT_EQUAL(ev[0].at + BUTTON_LONG_MS, ev[1].at);
+  // Setelah long terkirim SELECT tidak punya pekerjaan lagi
+  TEST_ASSERT_EQUAL(UINT32_MAX, h->idleMs());
+
+  fake::setPin(BTN_SELECT, HIGH);
+  ev = step(50);
+  TEST_ASSERT_EQUAL(1, ev.size());
+  TEST_ASSERT_EQUAL(BTN_EV_RELEASE, ev[0].e.type);
+}
+
+static void test_repeat_accelerates_to_minimum()
+{
+  fake::setPin(BTN_UP, LOW);
+  std::vector<Seen> ev = step(3000);
+  TEST_ASSERT_EQUAL(BTN_EV_PRESS, ev[0].e.type);
+  uint32_t pressAt = ev[0].at;
+  std::vector<Seen> longs = only(ev, BTN_EV_LONG);
+  TEST_ASSERT_EQUAL(1, longs.size());
+  TEST_ASSERT_EQUAL(pressAt + BUTTON_LONG_MS, longs[0].at);
+
+  // Jarak: 400, lalu 250 dikali 0.8 tiap repeat sampai 40
+  std::vector<Seen> reps = only(ev, BTN_EV_REPEAT);
+  std::vector<uint32_t> gaps;
+  uint32_t prev = pressAt;
+  for (size_t i = 0; i < reps.size(); i++)
+  {
+    TEST_ASSERT_EQUAL(i + 1, reps[i].e.repeat);
+    TEST_ASSERT_EQUAL(BUTTON_UP, reps[i].e.button);
+    gaps.push_back(reps[i].at - prev);
+    prev = reps[i].at;
+  }
+  const uint32_t want[] = {400, 250, 200, 160, 128, 102, 81, 64, 51, 40, 40, 40};
+  TEST_ASSERT_GREATER_OR_EQUAL(12, gaps.size());
+  for (size_t i = 0; i < 12; i++)
+    TEST_ASSERT_EQUAL(want[i], gaps[i]);
+  for (size_t i = 12; i < gaps.size(); i++)
+    TEST_ASSERT_EQUAL(BUTTON_REPEAT_MIN_MS, gaps[i]);
+
+  // Tekan berikutnya mulai lagi dari jarak awal
+  fake::setPin(BTN_UP, HIGH);
+  step(50);
+  fake::setPin(BTN_UP, LOW);
+  ev = only(step(1000), BTN_EV_REPEAT);
+  TEST_ASSERT_EQUAL(1, ev[0].e.repeat);
+  TEST_ASSERT_EQUAL(BUTTON_REPEAT_START_MS, ev[1].at - ev[0].at);
+}
+
+static void test_repeat_across_millis_wrap()
+{
+  fake::setMillis(UINT32_MAX - 300);
+  fake::setPin(BTN_RIGHT, LOW);
+  std::vector<Seen> reps = only(step(1000), BTN_EV_REPEAT);
+  TEST_ASSERT_LESS_THAN(1000, millis());
+  TEST_ASSERT_GREATER_OR_EQUAL(3, reps.size());
+  TEST_ASSERT_EQUAL(BUTTON_DEBOUNCE_MS + BUTTON_REPEAT_DELAY_MS, reps[0].at);
+  TEST_ASSERT_EQUAL(BUTTON_REPEAT_START_MS, reps[1].at - reps[0].at);
+}
+
+static void test_full_queue_drops_newest_and_keeps_order()
+{
+  // Empat tombol arah ditahan, loop jarang mengambil event
+  const uint8_t arrows[] = {BTN_UP, BTN_DOWN, BTN_LEFT, BTN_RIGHT};
+  for (uint8_t pin : arrows)
+    fake::setPin(pin, LOW);
+  fake::advanceMs(BUTTON_DEBOUNCE_MS);
+  std::vector<ButtonEvent> got;
+  ButtonEvent e;
+  // Satu next() per detik: tiap update menambah 4-8 event, mengambil 1
+  for (int i = 0; i < 6; i++)
+  {
+    TEST_ASSERT_TRUE(h->next(e));
+    got.push_back(e);
+    fake::advanceMs(1000);
+  }
+  TEST_ASSERT_GREATER_THAN(0, h->dropped());
+  TEST_ASSERT_EQUAL(0, h->idleMs());
+
+  // Antrian penuh: event lama tetap urut, yang baru dibuang
+  for (uint8_t i = 0; i < 4; i++)
+  {
+    TEST_ASSERT_EQUAL(BTN_EV_PRESS, got[i].type);
+    TEST_ASSERT_EQUAL(i, got[i].button);
+  }
+  size_t queued = 0;
+  while (h->next(e))
+    queued++;
+  TEST_ASSERT_EQUAL(BUTTON_QUEUE_LEN, queued);
+}
+
+static void test_idle_ms_tracks_next_deadline()
+{
+  TEST_ASSERT_EQUAL(UINT32_MAX, h->idleMs());
+  fake::setPin(BTN_LEFT, LOW);
+  fake::advanceMs(5);
+  TEST_ASSERT_EQUAL(BUTTON_DEBOUNCE_MS - 5, h->idleMs());
+  fake::advanceMs(BUTTON_DEBOUNCE_MS - 5);
+  TEST_ASSERT_EQUAL(0, h->idleMs());
+  ButtonEvent e;
+  TEST_ASSERT_TRUE(h->next(e));
+  // Ditahan: repeat pertama (400 ms) lebih dulu dari long (800 ms)
+  TEST_ASSERT_EQUAL(BUTTON_REPEAT_DELAY_MS, h->idleMs());
+  fake::advanceMs(BUTTON_REPEAT_DELAY_MS);
+  TEST_ASSERT_EQUAL(0, h->idleMs());
+  TEST_ASSERT_TRUE(h->next(e));
+  TEST_ASSERT_EQUAL(BTN_EV_REPEAT, e.type);
+  TEST_ASSERT_EQUAL(BUTTON_REPEAT_START_MS, h->idleMs());
+
+  // SELECT ditahan: hanya long yang ditunggu
+  fake::setPin(BTN_LEFT, HIGH);
+  step(50);
+  fake::setPin(BTN_SELECT, LOW);
+  fake::advanceMs(BUTTON_DEBOUNCE_MS);
+  TEST_ASSERT_TRUE(h->next(e));
+  TEST_ASSERT_EQUAL(BUTTON_LONG_MS, h->idleMs());
+}
+
+static void test_press_during_light_sleep_is_caught_on_wake()
+{
+  h->armWake();
+  TEST_ASSERT_EQUAL(GPIO_INTR_LOW_LEVEL, fake::pins[BTN_SELECT].wakeType);
+  TEST_ASSERT_FALSE(fake::pins[BTN_SELECT].intrEnabled);
+  // Selama tidur interrupt GPIO mati: tepi tidak sampai ke ISR
+  fake::setPin(BTN_SELECT, LOW);
+  fake::advanceMs(300);
+  TEST_ASSERT_EQUAL(0, isrWakes);
+  h->disarmWake();
+  TEST_ASSERT_EQUAL(0, fake::pins[BTN_SELECT].wakeType);
+  TEST_ASSERT_TRUE(fake::pins[BTN_SELECT].intrEnabled);
+
+  std::vector<Seen> ev = step(50);
+  TEST_ASSERT_EQUAL(1, ev.size());
+  TEST_ASSERT_EQUAL(BUTTON_SELECT, ev[0].e.button);
+  TEST_ASSERT_EQUAL(BTN_EV_PRESS, ev[0].e.type);
+  TEST_ASSERT_EQUAL(BUTTON_DEBOUNCE_MS, ev[0].at);
+
+  // Ditahan saat tidur lagi: bangun pada HIGH (dilepas)
+  h->armWake();
+  TEST_ASSERT_EQUAL(GPIO_INTR_HIGH_LEVEL, fake::pins[BTN_SELECT].wakeType);
+  TEST_ASSERT_EQUAL(GPIO_INTR_LOW_LEVEL, fake::pins[BTN_UP].wakeType);
+  h->disarmWake();
+  // Level tidak berubah selama tidur: tidak ada tepi baru
+  TEST_ASSERT_EQUAL(0, step(50).size());
+}
+
+static void test_button_held_at_boot_is_not_a_press()
+{
+  fake::setPin(BTN_RIGHT, LOW);
+  step(50);
+  delete h;
+  h = new ButtonHandler();
+  h->begin();
+  TEST_ASSERT_EQUAL(0, only(step(100), BTN_EV_PRESS).size());
+  fake::setPin(BTN_RIGHT, HIGH);
+  std::vector<Seen> ev = step(50);
+  TEST_ASSERT_EQUAL(1, ev.size());
+  TEST_ASSERT_EQUAL(BTN_EV_RELEASE, ev[0].e.type);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_bouncing_contact_gives_one_press_and_one_release);
+  RUN_TEST(test_glitch_shorter_than_debounce_is_ignored);
+  RUN_TEST(test_select_long_press_once_without_repeat);
+  RUN_TEST(test_repeat_accelerates_to_minimum);
+  RUN_TEST(test_repeat_across_millis_wrap);
+  RUN_TEST(test_full_queue_drops_newest_and_keeps_order);
+  RUN_TEST(test_idle_ms_tracks_next_deadline);
+  RUN_TEST(test_press_during_light_sleep_is_caught_on_wake);
+  RUN_TEST(test_button_held_at_boot_is_not_a_press);
+  return UNITY_END();
+}
@@ -0,0 +1,209 @@
+// Dispatch perintah inbound: tabel COMMANDS firmware + binary search
+// (MQTTCommands.h) dibandingkan rantai String ==/startsWith/endsWith versi
+// lama, termasuk handler, field dan coalesce tiap perintah.
+#include <unity.h>
+#include <chrono>
+#include "MQTTCommands.h"
+
+// Handler asli ada di MQTT.cpp (butuh PubSubClient/WiFi); di sini hanya
+// mencatat handler mana yang dipanggil. COMMANDS sendiri tabel firmware.
+static const char *called = nullptr;
+void handleAlarmAck(const InboundCommand &) { called = "alarmAck"; }
+void handleAckMsg(const InboundCommand &) { called = "ackMsg"; }
+void handleSensorAck(const InboundCommand &) { called = "sensorAck"; }
+void handleBackendAlarm(const InboundCommand &) { called = "backendAlarm"; }
+void handleTDSCalibration(const InboundCommand &) { called = "calibration"; }
+void handleQueryHistory(const InboundCommand &) { called = "history"; }
+void handleSetSensor(const InboundCommand &) { called = "setSensor"; }
+void handleSyncAlarm(const InboundCommand &) { called = "syncAlarm"; }
+void handleSyncSensor(const InboundCommand &) { called = "syncSensor"; }
+
+static const size_t TABLE_LEN = sizeof(COMMANDS) / sizeof(COMMANDS[0]);
+
+// Rantai perbandingan mqttCallback() → handleAck()/handleCommands() →
+// handleBackendAlarm() sebelum tabel, termasuk String baru di tiap tingkat
+static int legacyDispatch(const char *name)
+{
+  String cmd = name;
+  if (cmd == "SYNC_ALARM")
+    return CMD_SYNC_ALARM;
+  if (cmd == "SYNC_SENSOR")
+    return CMD_SYNC_SENSOR;
+  if (cmd == "ACK_MSG")
+    return CMD_ACK_MSG;
+  if (cmd.startsWith("ACK_"))
+  {
+    String ack = name;
+    if (ack.endsWith("ALARM"))
+    {
+      if (ack == "ACK_ADD_ALARM")
+        return CMD_ACK_ADD_ALARM;
+      if (ack == "ACK_EDIT_ALARM")
+        return CMD_ACK_EDIT_ALARM;
+      if (ack == "ACK_ENABLE_ALARM")
+        return CMD_ACK_ENABLE_ALARM;
+      if (ack == "ACK_DISABLE_ALARM")
+        return CMD_ACK_DISABLE_ALARM;
+      if (ack == "ACK_DELETE_ALARM")
+        return CMD_ACK_DELETE_ALARM;
+    }
+    if (ack.endsWith("SENSOR"))
+      return CMD_ACK_SET_SENSOR;
+    return -1;
+  }
+  if (cmd == "CALIBRATE_TDS")
+    return CMD_CALIBRATE_TDS;
+  String single = name;
+  if (single.endsWith("ALARM"))
+  {
+    String alarm = name;
+    if (alarm == "ADD_ALARM")
+      return CMD_ADD_ALARM;
+    if (alarm == "EDIT_ALARM")
+      return CMD_EDIT_ALARM;
+    if (alarm == "ENABLE_ALARM")
+      return CMD_ENABLE_ALARM;
+    if (alarm == "DISABLE_ALARM")
+      return CMD_DISABLE_ALARM;
+    if (alarm == "DELETE_ALARM")
+      return CMD_DELETE_ALARM;
+    return -1;
+  }
+  if (single == "SET_SENSOR")
+    return CMD_SET_SENSOR;
+  if (single == "QUERY_HISTORY")
+    return CMD_QUERY_HISTORY;
+  return -1;
+}
+
+static int tableDispatch(const char *name)
+{
+  const CommandSpec *spec = findCommand(COMMANDS, name);
+  return spec ? spec->id : -1;
+}
+
+// Campuran perintah satu device yang aktif: tiap pesan control ke backend
+// dibalas ACK_MSG, sisanya perubahan alarm/sensor dari dashboard dan sync
+static const char *const MIX[] = {
+    "ACK_MSG", "ACK_MSG", "ACK_MSG", "ACK_MSG", "ACK_MSG", "ACK_MSG",
+    "ACK_MSG", "ACK_MSG", "SET_SENSOR", "EDIT_ALARM", "ACK_SET_SENSOR",
+    "ACK_EDIT_ALARM", "ENABLE_ALARM", "DISABLE_ALARM", "ADD_ALARM",
+    "ACK_ADD_ALARM", "DELETE_ALARM", "SYNC_ALARM", "SYNC_SENSOR",
+    "QUERY_HISTORY", "CALIBRATE_TDS", "UNKNOWN_CMD"};
+static const size_t MIX_LEN = sizeof(MIX) / sizeof(MIX[0]);
+
+void setUp() {}
+void tearDown() {}
+
+static void test_every_command_is_found()
+{
+  TEST_ASSERT_EQUAL(CMD_COUNT, TABLE_LEN);
+  for (size_t i = 0; i < TABLE_LEN; i++)
+  {
+    std::string name(COMMANDS[i].name);
+    const CommandSpec *spec = findCommand(COMMANDS, name.c_str());
+    TEST_ASSERT_NOT_NULL(spec);
+    TEST_ASSERT_EQUAL(COMMANDS[i].id, spec->id);
+  }
+}
+
+static void test_unknown_and_partial_names_are_rejected()
+{
+  const char *const bad[] = {"", "ACK_", "ACK", "ACK_MSGX", "ADD_ALARMS", "A", "ZZZ", "set_sensor", "SYNC"};
+  for (const char *name : bad)
+    TEST_ASSERT_NULL(findCommand(COMMANDS, name));
+}
+
+static void test_table_matches_legacy_chain()
+{
+  for (size_t i = 0; i < MIX_LEN; i++)
+    TEST_ASSERT_EQUAL(legacyDispatch(MIX[i]), tableDispatch(MIX[i]));
+  for (size_t i = 0; i < TABLE_LEN; i++)
+  {
+    std::string name(COMMANDS[i].name);
+    TEST_ASSERT_EQUAL(legacyDispatch(name.c_str()), tableDispatch(name.c_str()));
+  }
+}
+
+// Perilaku tiap perintah: handler, field yang di-parse, coalesce. Mengubah
+// satu baris COMMANDS harus disengaja (ubah juga di sini).
+static void test_command_specs()
+{
+  struct Want
+  {
+    const char *name;
+    const char *handler;
+    uint8_t fields;
+    bool coalesce;
+  };
+  static const Want WANT[] = {
+      {"ACK_ADD_ALARM", "alarmAck", CF_ALARM | CF_TEMP_INDEX, false},
+      {"ACK_DELETE_ALARM", "alarmAck", CF_ALARM, false},
+      {"ACK_DISABLE_ALARM", "alarmAck", CF_ALARM, false},
+      {"ACK_EDIT_ALARM", "alarmAck", CF_ALARM, false},
+      {"ACK_ENABLE_ALARM", "alarmAck", CF_ALARM, false},
+      {"ACK_MSG", "ackMsg", CF_MSG_ID, false},
+      {"ACK_SET_SENSOR", "sensorAck", CF_SENSOR, false},
+      {"ADD_ALARM", "backendAlarm", CF_ALARM, false},
+      {"CALIBRATE_TDS", "calibration", CF_CALIBRATION, false},
+      {"DELETE_ALARM", "backendAlarm", CF_ALARM, false},
+      {"DISABLE_ALARM", "backendAlarm", CF_ALARM, true},
+      {"EDIT_ALARM", "backendAlarm", CF_ALARM, true},
+      {"ENABLE_ALARM", "backendAlarm", CF_ALARM, true},
+      {"QUERY_HISTORY", "history", CF_HISTORY, false},
+      {"SET_SENSOR", "setSensor", CF_SENSOR, true},
+      {"SYNC_ALARM", "syncAlarm", CF_ALARM_LIST, true},
+      {"SYNC_SENSOR", "syncSensor", CF_SENSOR_LIST, true},
+  };
+  TEST_ASSERT_EQUAL(TABLE_LEN, sizeof(WANT) / sizeof(WANT[0]));
+  for (const Want &w : WANT)
+  {
+    const CommandSpec *spec = findCommand(COMMANDS, w.name);
+    TEST_ASSERT_NOT_NULL(spec);
+    TEST_ASSERT_EQUAL(legacyDispatch(w.name), spec->id);
+    TEST_ASSERT_EQUAL(w.fields, spec->fields);
+    TEST_ASSERT_EQUAL(w.coalesce, spec->coalesce);
+    called = nullptr;
+    InboundCommand cmd = {};
+    cmd.spec = spec;
+    spec->handler(cmd);
+    TEST_ASSERT_EQUAL_STRING(w.handler, called);
+  }
+}
+
+template <typename F>
+static double nsPerCommand(F dispatch, uint32_t rounds)
+{
+  volatile int sink = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t r = 0; r < rounds; r++)
+  {
+    for (size_t i = 0; i < MIX_LEN; i++)
+      sink = sink + dispatch(MIX[i]);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / (double(rounds) * MIX_LEN);
+}
+
+static void test_benchmark_dispatch()
+{
+  const uint32_t rounds = 50000;
+  nsPerCommand(legacyDispatch, rounds / 10); // pemanasan
+  double legacy = nsPerCommand(legacyDispatch, rounds);
+  double table = nsPerCommand(tableDispatch, rounds);
+  char msg[128];
+  snprintf(msg, sizeof(msg), "dispatch over %u-command mix: legacy %.1f ns, table %.1f ns (%.1fx)",
+           (unsigned)MIX_LEN, legacy, table, legacy / table);
+  TEST_MESSAGE(msg);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_every_command_is_found);
+  RUN_TEST(test_unknown_and_partial_names_are_rejected);
+  RUN_TEST(test_table_matches_legacy_chain);
+  RUN_TEST(test_command_specs);
+  RUN_TEST(test_benchmark_dispatch);
+  return UNITY_END();
+}
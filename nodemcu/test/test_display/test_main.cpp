@@ -0,0 +1,194 @@
+// Display: framebuffer + shadow terhadap LiquidCrystal_I2C palsu (DDRAM &
+// byte I2C), termasuk perbandingan byte/s sebelum-sesudah di halaman alarm.
+#include <unity.h>
+#include "I2CBus.cpp"
+#include "Display.cpp"
+
+static Display panel(0x27, 20, 4);
+static LiquidCrystal_I2C *dev = nullptr;
+
+static void showRows(const char *r0, const char *r1, const char *r2, const char *r3)
+{
+  panel.printLine(0, r0);
+  panel.printLine(1, r1);
+  panel.printLine(2, r2);
+  panel.printLine(3, r3);
+}
+
+static std::string padded(const char *s)
+{
+  std::string out(s);
+  out.resize(20, ' ');
+  return out;
+}
+
+void setUp()
+{
+  fake::quietSerial = true;
+  // Jam selalu maju antar test supaya batas frame rate test sebelumnya lewat
+  static uint32_t base = 100000;
+  fake::setMillis(base += 1000);
+  panel.begin();
+  dev = LiquidCrystal_I2C::last;
+  dev->resetCounters();
+}
+
+void tearDown() {}
+
+static void test_lcd_shows_frame()
+{
+  TEST_ASSERT_TRUE(panel.beginFrame());
+  showRows("Row zero", "Row one", "Row two is long and cut here", "");
+  panel.endFrame();
+  TEST_ASSERT_EQUAL_STRING(padded("Row zero").c_str(), dev->row(0).c_str());
+  TEST_ASSERT_EQUAL_STRING(padded("Row one").c_str(), dev->row(1).c_str());
+  TEST_ASSERT_EQUAL_STRING("Row two is long and ", dev->row(2).c_str());
+  TEST_ASSERT_EQUAL_STRING(padded("").c_str(), dev->row(3).c_str());
+}
+
+static void test_unchanged_frame_sends_nothing()
+{
+  panel.beginFrame();
+  showRows("A", "B", "C", "D");
+  panel.endFrame();
+  dev->resetCounters();
+  fake::advanceMs(DISPLAY_FRAME_MS);
+  TEST_ASSERT_TRUE(panel.beginFrame());
+  showRows("A", "B", "C", "D");
+  panel.endFrame();
+  TEST_ASSERT_EQUAL(0, dev->busBytes);
+}
+
+static void test_single_cell_costs_one_move_and_one_char()
+{
+  panel.beginFrame();
+  showRows("12:00:00", "", "", "");
+  panel.endFrame();
+  dev->resetCounters();
+  DisplayStats before = panel.stats();
+  fake::advanceMs(DISPLAY_FRAME_MS);
+  panel.beginFrame();
+  showRows("12:00:01", "", "", "");
+  panel.endFrame();
+  TEST_ASSERT_EQUAL(1, dev->moves);
+  TEST_ASSERT_EQUAL(1, dev->chars);
+  TEST_ASSERT_EQUAL(2 * LiquidCrystal_I2C::BUS_BYTES_PER_LCD_BYTE, dev->busBytes);
+  // Perkiraan di DisplayStats cocok dengan bus palsu
+  TEST_ASSERT_EQUAL(dev->busBytes, panel.stats().i2cBytes - before.i2cBytes);
+  TEST_ASSERT_EQUAL_STRING(padded("12:00:01").c_str(), dev->row(0).c_str());
+}
+
+static void test_row_0_runs_into_row_2_without_set_cursor()
+{
+  panel.beginFrame();
+  showRows("aaaaaaaaaaaaaaaaaaaa", "", "bbbbbbbbbbbbbbbbbbbb", "");
+  panel.endFrame();
+  // Satu setCursor di awal, baris 2 melanjutkan DDRAM baris 0
+  TEST_ASSERT_EQUAL(1, dev->moves);
+  TEST_ASSERT_EQUAL(40, dev->chars);
+  TEST_ASSERT_EQUAL_STRING("bbbbbbbbbbbbbbbbbbbb", dev->row(2).c_str());
+}
+
+static void test_frame_rate_cap_and_immediate_print_outside_frame()
+{
+  TEST_ASSERT_TRUE(panel.beginFrame());
+  panel.endFrame();
+  TEST_ASSERT_FALSE(panel.beginFrame());
+  TEST_ASSERT_EQUAL(DISPLAY_FRAME_MS, panel.idleMs());
+  fake::advanceMs(DISPLAY_FRAME_MS - 1);
+  TEST_ASSERT_FALSE(panel.beginFrame());
+  fake::advanceMs(1);
+  TEST_ASSERT_TRUE(panel.beginFrame());
+  panel.endFrame();
+
+  // Di luar frame (setup, portal WiFi) printLine langsung terkirim
+  panel.printLine(3, "Portal WiFi");
+  TEST_ASSERT_EQUAL_STRING(padded("Portal WiFi").c_str(), dev->row(3).c_str());
+
+  // clear() ikut terkirim dengan tulisan berikutnya
+  panel.clear();
+  panel.printLine(0, "x");
+  TEST_ASSERT_EQUAL_STRING(padded("").c_str(), dev->row(3).c_str());
+  TEST_ASSERT_EQUAL_STRING(padded("x").c_str(), dev->row(0).c_str());
+}
+
+// ─── Sebelum / sesudah ───────────────────────────────────────
+// Halaman alarm: jam berdetak tiap detik, snapshot sensor baru tiap detik.
+// Waktu bus: 100 kHz, 9 bit per byte (8 data + ACK).
+static const double US_PER_BUS_BYTE = 90.0;
+
+static void alarmPage(uint32_t sec, char rows[4][21])
+{
+  snprintf(rows[0], 21, "%02u:%02u:%02u  Senin", unsigned(12 + sec / 3600), unsigned(sec / 60 % 60), unsigned(sec % 60));
+  snprintf(rows[1], 21, "Alarm 1  07:00  30s");
+  snprintf(rows[2], 21, "TDS %5.1f pH %4.2f", 350.0 + (sec % 7) * 0.1, 7.20 + (sec % 3) * 0.01);
+  snprintf(rows[3], 21, ">Next 18:00 ch0");
+}
+
+static void test_bytes_per_second_before_and_after()
+{
+  const uint32_t RUN_MS = 10000;
+  char rows[4][21];
+
+  // Sebelum: printLine() lama (setCursor + 20 karakter) tiap loop pass;
+  // loop hanya dibatasi waktu bus
+  LiquidCrystal_I2C legacy(0x27, 20, 4);
+  legacy.init();
+  legacy.resetCounters();
+  fake::setMillis(0);
+  while (millis() < RUN_MS)
+  {
+    uint64_t start = legacy.busBytes;
+    alarmPage(millis() / 1000, rows);
+    for (uint8_t r = 0; r < 4; r++)
+    {
+      legacy.setCursor(0, r);
+      legacy.print(rows[r]);
+      for (size_t i = strlen(rows[r]); i < 20; i++)
+        legacy.print(' ');
+    }
+    fake::clockUs += uint64_t((legacy.busBytes - start) * US_PER_BUS_BYTE) + 1000;
+  }
+  double beforeBps = legacy.busBytes * 1000.0 / RUN_MS;
+  TEST_ASSERT_EQUAL_STRING(padded(rows[2]).c_str(), legacy.row(2).c_str());
+
+  // Sesudah: frame dibatasi DISPLAY_FRAME_MS, hanya sel yang berubah
+  fake::setMillis(0);
+  panel.begin();
+  dev = LiquidCrystal_I2C::last;
+  dev->resetCounters();
+  while (millis() < RUN_MS)
+  {
+    uint64_t start = dev->busBytes;
+    if (panel.beginFrame())
+    {
+      alarmPage(millis() / 1000, rows);
+      for (uint8_t r = 0; r < 4; r++)
+        panel.printLine(r, rows[r]);
+      panel.endFrame();
+    }
+    panel.loop();
+    fake::clockUs += uint64_t((dev->busBytes - start) * US_PER_BUS_BYTE) + 1000;
+  }
+  double afterBps = dev->busBytes * 1000.0 / RUN_MS;
+  for (uint8_t r = 0; r < 4; r++)
+    TEST_ASSERT_EQUAL_STRING(padded(rows[r]).c_str(), dev->row(r).c_str());
+
+  char msg[160];
+  snprintf(msg, sizeof(msg), "alarm page, 10 s: before %.0f B/s (%.0f ms/s bus), after %.0f B/s (%.0f ms/s bus)",
+           beforeBps, beforeBps * US_PER_BUS_BYTE / 1000, afterBps, afterBps * US_PER_BUS_BYTE / 1000);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_LESS_THAN(beforeBps / 20, afterBps);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_lcd_shows_frame);
+  RUN_TEST(test_unchanged_frame_sends_nothing);
+  RUN_TEST(test_single_cell_costs_one_move_and_one_char);
+  RUN_TEST(test_row_0_runs_into_row_2_without_set_cursor);
+  RUN_TEST(test_frame_rate_cap_and_immediate_print_outside_frame);
+  RUN_TEST(test_bytes_per_second_before_and_after);
+  return UNITY_END();
+}
@@ -0,0 +1 @@
+#include "Actuator.cpp"
@@ -0,0 +1,3 @@
+#include "Schema.cpp"
+#include "AlarmTable.cpp"
+#include "Alarm.cpp"
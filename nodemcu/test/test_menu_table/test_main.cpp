@@ -0,0 +1,266 @@
+// Menu edit dari MenuTable.h: konsistensi tabel, lalu engine DisplayAlarm
+// (navigasi, wrap/clamp nilai, aksi) diperiksa lewat isi LCD palsu dan
+// panggilan publish. Alarm, Storage/Actuator dan Display/I2CBus dikompilasi
+// di lib_*.cpp; tombol, sensor, Clock, Persistence dan MQTT dipalsukan.
+#include <unity.h>
+#include <deque>
+#include <string>
+#include "DisplayAlarm.cpp"
+#include "Actuator.h"
+
+// ─── Palsu ───────────────────────────────────────────────────
+static uint32_t fakeNow = 1780000000;
+uint32_t Clock::now() { return fakeNow; }
+const DateTime &Clock::local()
+{
+  static DateTime cached;
+  cached = DateTime(fakeNow);
+  return cached;
+}
+static uint32_t dirtyCount = 0;
+void Persistence::markDirty(PersistCollection) { dirtyCount++; }
+
+static std::deque<ButtonEvent> presses;
+ButtonHandler buttonHandler;
+ButtonHandler::ButtonHandler() {}
+bool ButtonHandler::next(ButtonEvent &e)
+{
+  if (presses.empty())
+    return false;
+  e = presses.front();
+  presses.pop_front();
+  return true;
+}
+uint32_t ButtonHandler::idleMs() const { return presses.empty() ? UINT32_MAX : 0; }
+ButtonState ButtonHandler::toState(const ButtonEvent &e)
+{
+  ButtonState s = {e.button == BUTTON_UP, e.button == BUTTON_DOWN, e.button == BUTTON_LEFT,
+                   e.button == BUTTON_RIGHT, e.button == BUTTON_SELECT, true};
+  return s;
+}
+
+static SensorSetting sensorSettings[4];
+SensorSetting *Sensor::getAllSettings(uint8_t &outCount)
+{
+  outCount = 4;
+  return sensorSettings;
+}
+void Sensor::checkSensorLimits(const SensorSnapshot &) {}
+
+// Panggilan publish terakhir, sebagai teks
+static std::string published;
+void publishAlarmFromESP(const char *cmd, uint16_t id, uint8_t hour, uint8_t minute, int duration, bool enabled)
+{
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%s %u %02u:%02u %ds %s", cmd, id, hour, minute, duration, enabled ? "ON" : "OFF");
+  published = buf;
+}
+void publishSensorFromESP(const SensorSetting &s)
+{
+  char buf[64];
+  snprintf(buf, sizeof(buf), "SENSOR %u %.1f..%.1f %s", s.type, s.minValue, s.maxValue, s.enabled ? "ON" : "OFF");
+  published = buf;
+}
+static int deletedIndex = -1;
+void deleteAlarmFromESPByIndex(uint16_t index) { deletedIndex = index; }
+
+// ─── Helper ──────────────────────────────────────────────────
+static fs::FS ram;
+static DisplayAlarm *ui = nullptr;
+static LiquidCrystal_I2C *dev = nullptr;
+
+// Tekan tombol (satu atau lebih kali) lalu satu pass loop() dengan jatah frame
+static void press(ButtonId b, int times = 1)
+{
+  for (int i = 0; i < times; i++)
+    presses.push_back({b, BTN_EV_PRESS, 0});
+  fake::advanceMs(DISPLAY_FRAME_MS);
+  ui->loop();
+  lcd.loop();
+}
+
+static void assertRow(uint8_t r, const char *text)
+{
+  std::string want(text);
+  want.resize(20, ' ');
+  TEST_ASSERT_EQUAL_STRING(want.c_str(), dev->row(r).c_str());
+}
+
+static void clearAlarms()
+{
+  uint16_t n;
+  AlarmData *a = Alarm::getAll(n);
+  while (n)
+  {
+    Alarm::remove(a[0].id);
+    a = Alarm::getAll(n);
+  }
+}
+
+void setUp()
+{
+  fake::quietSerial = true;
+  static uint32_t base = 100000;
+  fake::setMillis(base += 10000);
+  presses.clear();
+  published.clear();
+  deletedIndex = -1;
+  clearAlarms();
+  const SensorSetting defaults[4] = {
+      {1, S_TEMPERATURE, 20, 30, true, false, false, 0},
+      {2, S_TURBIDITY, 0, 50, true, false, false, 0},
+      {3, S_TDS, 100, 500, true, false, false, 0},
+      {4, S_PH, 6, 8, true, false, false, 0},
+  };
+  memcpy(sensorSettings, defaults, sizeof(defaults));
+  lcd.begin();
+  dev = LiquidCrystal_I2C::last;
+  delete ui;
+  ui = new DisplayAlarm();
+  ui->loop();
+}
+
+void tearDown() {}
+
+// ─── Tabel ───────────────────────────────────────────────────
+static size_t valueSize(MenuValueType t)
+{
+  switch (t)
+  {
+  case MV_U8:
+    return sizeof(uint8_t);
+  case MV_INT:
+    return sizeof(int);
+  case MV_BOOL:
+    return sizeof(bool);
+  default:
+    return sizeof(float);
+  }
+}
+
+static void test_tables_are_consistent()
+{
+  const size_t fieldCount = sizeof(MENU_FIELDS) / sizeof(MENU_FIELDS[0]);
+  const size_t valueCount = sizeof(MENU_VALUES) / sizeof(MENU_VALUES[0]);
+  for (const EditPage &page : EDIT_PAGES)
+  {
+    TEST_ASSERT_LESS_OR_EQUAL(fieldCount, page.first + page.count);
+    // Baris 1..count field, baris 3 aksi
+    TEST_ASSERT_LESS_OR_EQUAL(2, page.count);
+    size_t recSize = page.record == REC_ALARM ? sizeof(AlarmData) : sizeof(SensorSetting);
+    for (uint8_t f = page.first; f < page.first + page.count; f++)
+    {
+      const MenuField &field = MENU_FIELDS[f];
+      TEST_ASSERT_LESS_OR_EQUAL(valueCount, field.first + field.count);
+      TEST_ASSERT_GREATER_THAN(0, field.count);
+      for (uint8_t v = field.first; v < field.first + field.count; v++)
+      {
+        const MenuValue &mv = MENU_VALUES[v];
+        TEST_ASSERT_LESS_OR_EQUAL(recSize, mv.offset + valueSize(mv.type));
+        TEST_ASSERT_LESS_OR_EQUAL(mv.hi, mv.lo);
+        TEST_ASSERT_TRUE((mv.fmt != nullptr) == (mv.type == MV_U8 || mv.type == MV_INT));
+      }
+    }
+  }
+  for (const SensorInfo &info : SENSOR_INFO)
+  {
+    TEST_ASSERT_LESS_OR_EQUAL(9, strlen(info.label));
+    TEST_ASSERT_LESS_OR_EQUAL(sizeof(SensorSnapshot), info.snapshotOffset + sizeof(float));
+  }
+}
+
+// ─── Engine ──────────────────────────────────────────────────
+static void test_alarm_edit_keys_and_save()
+{
+  Alarm::add(7, 7, 5, 30, true);
+  press(BUTTON_LEFT);
+  assertRow(1, ">Alarm 1: 07:05 ON");
+  press(BUTTON_SELECT);
+  assertRow(0, "Edit Alarm 1");
+  assertRow(1, "> Time:07:05 ON");
+  assertRow(2, "  Dur:30s");
+  assertRow(3, "  Save       Del");
+
+  // SELECT masuk nilai; jam 07 + 17 wrap ke 00, menit 05 - 6 wrap ke 59
+  press(BUTTON_SELECT);
+  assertRow(1, "  Time:[07]:05 ON");
+  press(BUTTON_UP, 17);
+  press(BUTTON_RIGHT);
+  press(BUTTON_DOWN, 6);
+  press(BUTTON_RIGHT);
+  press(BUTTON_UP);
+  assertRow(1, "  Time:00:59 [OFF]");
+  press(BUTTON_SELECT);
+
+  // Dur langsung: kiri/kanan, wrap 0..99
+  press(BUTTON_DOWN);
+  assertRow(2, "> Dur:30s");
+  press(BUTTON_RIGHT, 3);
+  assertRow(2, "> Dur:33s");
+
+  press(BUTTON_DOWN);
+  assertRow(3, "> Save       Del");
+  press(BUTTON_SELECT);
+  TEST_ASSERT_EQUAL_STRING("EDIT 7 00:59 33s OFF", published.c_str());
+  // Kembali ke daftar alarm
+  TEST_ASSERT_EQUAL(0, dev->row(0).rfind("Time: ", 0));
+}
+
+static void test_alarm_action_row_and_delete()
+{
+  Alarm::add(7, 7, 5, 30, true);
+  press(BUTTON_LEFT);
+  press(BUTTON_SELECT);
+  // Atas dari field pertama melompat ke aksi terakhir
+  press(BUTTON_UP);
+  assertRow(3, "  Save     > Del");
+  press(BUTTON_LEFT);
+  assertRow(3, "> Save       Del");
+  press(BUTTON_RIGHT);
+  press(BUTTON_SELECT);
+  TEST_ASSERT_EQUAL(0, deletedIndex);
+  TEST_ASSERT_TRUE(published.empty());
+}
+
+static void test_sensor_edit_decimals_clamp_and_save()
+{
+  // pH: satu desimal, step 0.1
+  press(BUTTON_DOWN, 3);
+  press(BUTTON_SELECT);
+  assertRow(0, "Edit pH");
+  assertRow(1, "> Min|Max:6.0|8.0");
+  assertRow(2, "  Stat:ON");
+  press(BUTTON_SELECT);
+  press(BUTTON_UP, 2);
+  assertRow(1, "  Min|Max:[6.2]|8.0");
+  press(BUTTON_SELECT);
+  press(BUTTON_DOWN);
+  press(BUTTON_LEFT);
+  assertRow(2, "> Stat:OFF");
+  press(BUTTON_DOWN);
+  press(BUTTON_SELECT);
+  TEST_ASSERT_EQUAL_STRING("SENSOR 3 6.2..8.0 OFF", published.c_str());
+  TEST_ASSERT_TRUE(sensorSettings[S_PH].pending);
+
+  // Turbidity: tanpa desimal, batas bawah di-clamp ke 0 (tidak wrap)
+  press(BUTTON_UP, 2);
+  press(BUTTON_SELECT);
+  assertRow(0, "Edit Turbidity");
+  press(BUTTON_SELECT);
+  press(BUTTON_DOWN, 3);
+  assertRow(1, "  Min|Max:[ 0]|50");
+  TEST_ASSERT_EQUAL_FLOAT(0, sensorSettings[S_TURBIDITY].minValue);
+}
+
+int main()
+{
+  Storage::begin(ram);
+  Actuator::begin();
+  Alarm::loadAll();
+  UNITY_BEGIN();
+  RUN_TEST(test_tables_are_consistent);
+  RUN_TEST(test_alarm_edit_keys_and_save);
+  RUN_TEST(test_alarm_action_row_and_delete);
+  RUN_TEST(test_sensor_edit_decimals_clamp_and_save);
+  return UNITY_END();
+}
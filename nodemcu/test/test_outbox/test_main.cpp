@@ -0,0 +1,161 @@
+// Outbox: control dikirim ulang dengan backoff sampai di-ACK (tidak pernah
+// kedaluwarsa), cancel() untuk pemanggil yang berhenti menunggu, dan spill
+// ke fs::FS RAM saat antrian RAM penuh. Storage/RecordLog di lib_storage.cpp
+// (static counters bentrok dengan Outbox.cpp).
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "Outbox.cpp"
+
+struct Sent
+{
+  uint32_t at;
+  uint32_t msgId;
+  std::string payload;
+};
+static std::vector<Sent> sent;
+static bool online = true;
+
+static bool sendFake(const OutboxEntry &e)
+{
+  if (!online)
+    return false;
+  sent.push_back({uint32_t(millis()), e.msgId, e.payload.c_str()});
+  return true;
+}
+
+static fs::FS *ram = nullptr;
+
+static uint32_t pushControl(const char *payload, uint32_t key = 0)
+{
+  uint32_t id = Outbox::nextMsgId();
+  TEST_ASSERT_TRUE(Outbox::push(0, payload, false, OUTBOX_CONTROL, id, key));
+  return id;
+}
+
+// pump() tiap 100 ms selama ms
+static void run(uint32_t ms)
+{
+  for (uint32_t t = 0; t < ms; t += 100)
+  {
+    Outbox::pump(sendFake);
+    fake::advanceMs(100);
+  }
+}
+
+void setUp()
+{
+  fake::quietSerial = true;
+  fake::setMillis(1000);
+  delete ram;
+  ram = new fs::FS();
+  Storage::begin(*ram);
+  Outbox::begin();
+  sent.clear();
+  online = true;
+}
+
+void tearDown() {}
+
+static void test_control_retries_until_acked()
+{
+  uint32_t id = pushControl("{\"cmd\":\"SET_SENSOR\"}");
+  // 10 menit tanpa ACK: masih dikirim ulang, jarak naik 2 s → 32 s lalu tetap
+  run(600000);
+  TEST_ASSERT_GREATER_THAN(20, sent.size());
+  const uint32_t gaps[] = {2000, 4000, 8000, 16000, 32000, 32000, 32000};
+  for (size_t i = 0; i < 7; i++)
+    TEST_ASSERT_UINT32_WITHIN(100, gaps[i], sent[i + 1].at - sent[i].at);
+  TEST_ASSERT_EQUAL(1, Outbox::stats().controlDepth);
+  TEST_ASSERT_EQUAL(1, Outbox::stats().stalled);
+
+  TEST_ASSERT_TRUE(Outbox::ack(id));
+  size_t n = sent.size();
+  run(100000);
+  TEST_ASSERT_EQUAL(n, sent.size());
+  TEST_ASSERT_EQUAL(0, Outbox::stats().controlDepth);
+}
+
+static void test_cancel_stops_retries()
+{
+  uint32_t keep = pushControl("keep");
+  uint32_t page = pushControl("page");
+  run(1000);
+  TEST_ASSERT_EQUAL(2, sent.size());
+
+  TEST_ASSERT_TRUE(Outbox::cancel(page));
+  TEST_ASSERT_FALSE(Outbox::cancel(page));
+  TEST_ASSERT_FALSE(Outbox::ack(page)); // ACK terlambat tidak menemukan apa-apa
+  run(60000);
+  for (size_t i = 2; i < sent.size(); i++)
+    TEST_ASSERT_EQUAL(keep, sent[i].msgId);
+  OutboxStats s = Outbox::stats();
+  TEST_ASSERT_EQUAL(1, s.controlDepth);
+  TEST_ASSERT_EQUAL(1, s.cancelled);
+  TEST_ASSERT_EQUAL(0, s.acked);
+}
+
+// Batch backfill yang diambil ulang (key sama) menggantikan entry lama:
+// antrian tidak terisi salinan walau backend tidak pernah membalas
+static void test_same_key_replaces_queued_entry()
+{
+  const uint32_t key = 0x5EB0A7C4;
+  uint32_t first = pushControl("batch v1", key);
+  run(1000);
+  uint32_t second = 0;
+  for (int i = 0; i < 20; i++)
+  {
+    second = pushControl("batch v2", key);
+    run(90000);
+  }
+  OutboxStats s = Outbox::stats();
+  TEST_ASSERT_EQUAL(1, s.controlDepth);
+  TEST_ASSERT_EQUAL(0, s.spilledDepth);
+  TEST_ASSERT_EQUAL(20, s.coalesced);
+  TEST_ASSERT_EQUAL_STRING("batch v2", sent.back().payload.c_str());
+  TEST_ASSERT_EQUAL(second, sent.back().msgId);
+  // ACK msgId lama tidak cocok lagi; msgId terbaru menutupnya
+  TEST_ASSERT_FALSE(Outbox::ack(first));
+  TEST_ASSERT_TRUE(Outbox::ack(second));
+  TEST_ASSERT_EQUAL(0, Outbox::stats().controlDepth);
+}
+
+static void test_full_queue_spills_in_order()
+{
+  online = false;
+  std::vector<uint32_t> ids;
+  for (int i = 0; i < OUTBOX_CONTROL_CAPACITY + 5; i++)
+    ids.push_back(pushControl(("m" + std::to_string(i)).c_str()));
+  OutboxStats s = Outbox::stats();
+  TEST_ASSERT_EQUAL(OUTBOX_CONTROL_CAPACITY, s.controlDepth);
+  TEST_ASSERT_EQUAL(5, s.spilledDepth);
+  // Entry di file spill tidak bisa dibatalkan
+  TEST_ASSERT_FALSE(Outbox::cancel(ids.back()));
+
+  // Semua entry RAM terkirim lalu di-ACK, spill masuk kembali sesuai urutan
+  online = true;
+  run(1000);
+  for (int i = 0; i < OUTBOX_CONTROL_CAPACITY; i++)
+    Outbox::ack(ids[i]);
+  run(1000);
+  TEST_ASSERT_EQUAL(0, Outbox::stats().spilledDepth);
+  TEST_ASSERT_FALSE(ram->exists(STORAGE_OUTBOX_SPILL));
+  // Urutan kiriman pertama tiap pesan
+  std::vector<std::string> order;
+  for (const Sent &x : sent)
+    if (std::find(order.begin(), order.end(), x.payload) == order.end())
+      order.push_back(x.payload);
+  TEST_ASSERT_EQUAL(OUTBOX_CONTROL_CAPACITY + 5, order.size());
+  for (int i = 0; i < OUTBOX_CONTROL_CAPACITY + 5; i++)
+    TEST_ASSERT_EQUAL_STRING(("m" + std::to_string(i)).c_str(), order[i].c_str());
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_control_retries_until_acked);
+  RUN_TEST(test_cancel_stops_retries);
+  RUN_TEST(test_same_key_replaces_queued_entry);
+  RUN_TEST(test_full_queue_spills_in_order);
+  return UNITY_END();
+}
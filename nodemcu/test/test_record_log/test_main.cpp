@@ -0,0 +1,264 @@
+// RecordLog di atas fs::FS RAM: round trip, CRC rusak, ekor terpotong,
+// compaction (termasuk yang terputus) dan counter wear.
+#include <unity.h>
+#include "Storage.cpp"
+#include "RecordLog.cpp"
+
+static const char *const PATH = "/test.log";
+static const uint8_t SCHEMA = 2;
+static const uint8_t REC = 6;
+
+static fs::FS *ram = nullptr;
+
+struct Rec
+{
+  uint8_t b[REC];
+};
+
+static Rec rec(uint16_t key, uint8_t salt = 0)
+{
+  Rec r;
+  for (uint8_t i = 0; i < REC; i++)
+    r.b[i] = uint8_t(key * 7 + i + salt);
+  return r;
+}
+
+static void assertHas(RecordLog &log, uint16_t key, uint8_t salt = 0)
+{
+  uint8_t len = 0;
+  const uint8_t *p = log.find(key, len);
+  TEST_ASSERT_NOT_NULL(p);
+  TEST_ASSERT_EQUAL(REC, len);
+  Rec want = rec(key, salt);
+  TEST_ASSERT_EQUAL_MEMORY(want.b, p, REC);
+}
+
+void setUp()
+{
+  delete ram;
+  ram = new fs::FS();
+  fake::quietSerial = true;
+  Storage::begin(*ram);
+}
+
+void tearDown() {}
+
+static void test_put_remove_reload()
+{
+  RecordLog log(PATH, 16, REC, SCHEMA, REC);
+  TEST_ASSERT_TRUE(log.begin());
+  for (uint16_t k = 1; k <= 5; k++)
+    TEST_ASSERT_TRUE(log.put(k * 10, rec(k * 10).b, REC));
+  TEST_ASSERT_TRUE(log.remove(30));
+  TEST_ASSERT_TRUE(log.put(20, rec(20, 1).b, REC));
+
+  RecordLog again(PATH, 16, REC, SCHEMA, REC);
+  TEST_ASSERT_TRUE(again.begin());
+  TEST_ASSERT_EQUAL(SCHEMA, again.schema());
+  TEST_ASSERT_EQUAL(4, again.count());
+  assertHas(again, 10);
+  assertHas(again, 20, 1);
+  assertHas(again, 40);
+  assertHas(again, 50);
+  uint8_t len;
+  TEST_ASSERT_NULL(again.find(30, len));
+  TEST_ASSERT_EQUAL(0, again.stats().tornRecords);
+  TEST_ASSERT_EQUAL(log.stats().lifetimeBytes, again.stats().lifetimeBytes);
+  TEST_ASSERT_EQUAL(ram->raw(PATH).size(), again.stats().lifetimeBytes);
+
+  // Urutan at() = urutan key
+  uint16_t prev = 0, key;
+  const uint8_t *p;
+  for (uint16_t i = 0; i < again.count(); i++)
+  {
+    TEST_ASSERT_TRUE(again.at(i, key, p, len));
+    TEST_ASSERT_GREATER_THAN(prev, key);
+    prev = key;
+  }
+}
+
+// Satu perubahan = satu frame kecil, bukan tulis ulang seluruh file
+static void test_one_small_record_per_change()
+{
+  RecordLog log(PATH, 16, REC, SCHEMA, REC);
+  log.begin();
+  for (uint16_t k = 1; k <= 8; k++)
+    log.put(k, rec(k).b, REC);
+  uint64_t before = ram->bytesWritten;
+  log.put(3, rec(3, 9).b, REC);
+  TEST_ASSERT_EQUAL(9 + REC, ram->bytesWritten - before);
+
+  // Isi sama: tidak menulis apa-apa
+  before = ram->bytesWritten;
+  log.put(3, rec(3, 9).b, REC);
+  TEST_ASSERT_EQUAL(0, ram->bytesWritten - before);
+  TEST_ASSERT_EQUAL(1, log.stats().skipped);
+  TEST_ASSERT_EQUAL(9, log.stats().appends);
+}
+
+static void test_crc_corruption_keeps_records_before_it()
+{
+  {
+    RecordLog log(PATH, 16, REC, SCHEMA, REC);
+    log.begin();
+    for (uint16_t k = 1; k <= 4; k++)
+      log.put(k, rec(k).b, REC);
+  }
+  // Balik satu bit di data record ke-3 (header 12 byte, frame 15 byte)
+  std::vector<uint8_t> &raw = ram->raw(PATH);
+  size_t third = 12 + 2 * (9 + REC);
+  raw[third + 5 + 2] ^= 0x10;
+
+  RecordLog log(PATH, 16, REC, SCHEMA, REC);
+  TEST_ASSERT_TRUE(log.begin());
+  TEST_ASSERT_EQUAL(1, log.stats().tornRecords);
+  TEST_ASSERT_EQUAL(2, log.count());
+  assertHas(log, 1);
+  assertHas(log, 2);
+
+  // Log sudah dipadatkan: append berikutnya terbaca lagi setelah reload
+  log.put(7, rec(7).b, REC);
+  RecordLog again(PATH, 16, REC, SCHEMA, REC);
+  again.begin();
+  TEST_ASSERT_EQUAL(0, again.stats().tornRecords);
+  TEST_ASSERT_EQUAL(3, again.count());
+  assertHas(again, 7);
+}
+
+static void test_torn_tail_from_power_cut()
+{
+  RecordLog log(PATH, 16, REC, SCHEMA, REC);
+  log.begin();
+  log.put(1, rec(1).b, REC);
+  log.put(2, rec(2).b, REC);
+  // Listrik padam setelah 6 byte dari frame berikutnya
+  ram->writeBudget = 6;
+  log.put(3, rec(3).b, REC);
+  ram->writeBudget = -1;
+
+  RecordLog again(PATH, 16, REC, SCHEMA, REC);
+  TEST_ASSERT_TRUE(again.begin());
+  TEST_ASSERT_EQUAL(1, again.stats().tornRecords);
+  TEST_ASSERT_EQUAL(2, again.count());
+  assertHas(again, 1);
+  assertHas(again, 2);
+
+  again.put(4, rec(4).b, REC);
+  RecordLog third(PATH, 16, REC, SCHEMA, REC);
+  third.begin();
+  TEST_ASSERT_EQUAL(0, third.stats().tornRecords);
+  TEST_ASSERT_EQUAL(3, third.count());
+  assertHas(third, 4);
+}
+
+static void test_compaction_bounds_file_and_keeps_wear_counters()
+{
+  RecordLog log(PATH, 16, REC, SCHEMA, REC);
+  log.begin();
+  for (uint16_t k = 1; k <= 4; k++)
+    log.put(k, rec(k).b, REC);
+  // Key yang sama diubah terus: file tumbuh sampai compaction memangkasnya
+  for (uint16_t i = 0; i < 2000; i++)
+    log.put(2, rec(2, uint8_t(i)).b, REC);
+  const RecordLogStats &s = log.stats();
+  TEST_ASSERT_GREATER_THAN(0, s.compactions);
+  TEST_ASSERT_LESS_OR_EQUAL(RECORDLOG_COMPACT_MIN_BYTES + 9 + REC, ram->raw(PATH).size());
+  TEST_ASSERT_EQUAL(s.fileBytes, ram->raw(PATH).size());
+  TEST_ASSERT_FALSE(ram->exists("/test.log.tmp"));
+
+  uint32_t lifetime = s.lifetimeBytes;
+  uint32_t compactions = s.lifetimeCompactions;
+  TEST_ASSERT_GREATER_OR_EQUAL(2004u * (9 + REC), lifetime);
+
+  RecordLog again(PATH, 16, REC, SCHEMA, REC);
+  again.begin();
+  TEST_ASSERT_EQUAL(4, again.count());
+  assertHas(again, 2, uint8_t(1999));
+  TEST_ASSERT_EQUAL(lifetime, again.stats().lifetimeBytes);
+  TEST_ASSERT_EQUAL(compactions, again.stats().lifetimeCompactions);
+}
+
+static void test_interrupted_compaction_is_recovered()
+{
+  {
+    RecordLog log(PATH, 16, REC, SCHEMA, REC);
+    log.begin();
+    log.put(1, rec(1).b, REC);
+    log.put(2, rec(2).b, REC);
+    log.compact();
+  }
+  std::vector<uint8_t> good = ram->raw(PATH);
+
+  // Crash sebelum rename: .tmp setengah jadi dibuang, log lama dipakai
+  ram->raw("/test.log.tmp") = std::vector<uint8_t>(good.begin(), good.begin() + 10);
+  {
+    RecordLog log(PATH, 16, REC, SCHEMA, REC);
+    TEST_ASSERT_TRUE(log.begin());
+    TEST_ASSERT_EQUAL(2, log.count());
+    TEST_ASSERT_FALSE(ram->exists("/test.log.tmp"));
+  }
+
+  // Log lama sudah terhapus tapi rename belum terjadi: .tmp dipakai
+  ram->raw("/test.log.tmp") = good;
+  ram->remove(PATH);
+  RecordLog log(PATH, 16, REC, SCHEMA, REC);
+  TEST_ASSERT_TRUE(log.begin());
+  TEST_ASSERT_EQUAL(2, log.count());
+  assertHas(log, 1);
+  assertHas(log, 2);
+  TEST_ASSERT_TRUE(ram->exists(PATH));
+  TEST_ASSERT_FALSE(ram->exists("/test.log.tmp"));
+}
+
+static void test_capacity_and_retain()
+{
+  RecordLog log(PATH, 4, REC, SCHEMA, REC);
+  log.begin();
+  for (uint16_t k = 1; k <= 4; k++)
+    TEST_ASSERT_TRUE(log.put(k, rec(k).b, REC));
+  TEST_ASSERT_FALSE(log.put(5, rec(5).b, REC));
+  const uint16_t keep[] = {2, 4};
+  log.retainOnly(keep, 2);
+  TEST_ASSERT_EQUAL(2, log.count());
+
+  RecordLog again(PATH, 4, REC, SCHEMA, REC);
+  again.begin();
+  TEST_ASSERT_EQUAL(2, again.count());
+  assertHas(again, 2);
+  assertHas(again, 4);
+}
+
+static void test_headerless_log_reports_raw_schema()
+{
+  // Log lama tanpa header: frame langsung dari byte 0
+  uint8_t frame[9 + REC];
+  Rec r = rec(1);
+  frame[0] = 0xA5;
+  frame[1] = 1; // PUT
+  frame[2] = 1;
+  frame[3] = 0;
+  frame[4] = REC;
+  memcpy(frame + 5, r.b, REC);
+  uint32_t crc = crc32_le(0, frame + 1, 4 + REC);
+  memcpy(frame + 5 + REC, &crc, 4);
+  ram->raw(PATH).assign(frame, frame + sizeof(frame));
+
+  RecordLog log(PATH, 16, REC, SCHEMA, REC);
+  TEST_ASSERT_TRUE(log.begin());
+  TEST_ASSERT_EQUAL(RECORDLOG_SCHEMA_RAW, log.schema());
+  assertHas(log, 1);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_put_remove_reload);
+  RUN_TEST(test_one_small_record_per_change);
+  RUN_TEST(test_crc_corruption_keeps_records_before_it);
+  RUN_TEST(test_torn_tail_from_power_cut);
+  RUN_TEST(test_compaction_bounds_file_and_keeps_wear_counters);
+  RUN_TEST(test_interrupted_compaction_is_recovered);
+  RUN_TEST(test_capacity_and_retain);
+  RUN_TEST(test_headerless_log_reports_raw_schema);
+  return UNITY_END();
+}
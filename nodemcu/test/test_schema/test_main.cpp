@@ -0,0 +1,306 @@
+// Schema: record v1 (dump struct mentah 24 byte) dibangun byte per byte,
+// lalu decode → encode → decode harus menghasilkan data yang sama.
+#include <unity.h>
+#include <cstddef>
+#include "Schema.cpp"
+
+// Layout struct lama di firmware v1 (GCC, int/enum 4 byte, bool 1 byte).
+// Offset di decodeAlarm()/decodeSensorSetting() harus cocok dengan ini.
+struct LegacyAlarm
+{
+  uint16_t id;
+  uint8_t hour;
+  uint8_t minute;
+  int duration;
+  bool enabled;
+  int lastDayTrig;
+  int lastMinTrig;
+  bool pending;
+  bool isTemporary;
+  int8_t tempIndex;
+};
+static_assert(sizeof(LegacyAlarm) == LEGACY_ALARM_SIZE, "legacy alarm size");
+static_assert(offsetof(LegacyAlarm, duration) == 4 && offsetof(LegacyAlarm, enabled) == 8 &&
+                  offsetof(LegacyAlarm, lastDayTrig) == 12 && offsetof(LegacyAlarm, lastMinTrig) == 16 &&
+                  offsetof(LegacyAlarm, pending) == 20 && offsetof(LegacyAlarm, tempIndex) == 22,
+              "legacy alarm offsets");
+
+struct LegacySensor
+{
+  uint16_t id;
+  SensorType type;
+  float minValue;
+  float maxValue;
+  bool enabled;
+  bool pending;
+  bool isTemporary;
+  uint16_t tempIndex;
+};
+static_assert(sizeof(LegacySensor) == LEGACY_SENSOR_SIZE, "legacy sensor size");
+static_assert(offsetof(LegacySensor, type) == 4 && offsetof(LegacySensor, minValue) == 8 &&
+                  offsetof(LegacySensor, enabled) == 16 && offsetof(LegacySensor, isTemporary) == 18 &&
+                  offsetof(LegacySensor, tempIndex) == 20,
+              "legacy sensor offsets");
+
+static void le32(uint8_t *p, uint32_t v)
+{
+  for (int i = 0; i < 4; i++)
+    p[i] = uint8_t(v >> (8 * i));
+}
+
+// Record v1 seperti yang ditulis firmware lama; padding diisi 0xCC supaya
+// decoder yang tidak sengaja membaca padding ketahuan
+static void legacyAlarm(uint8_t *b, uint16_t id, uint8_t hour, uint8_t minute, int duration,
+                        bool enabled, int lastDay, int lastMin, bool pending, bool temp, int8_t tempIndex)
+{
+  memset(b, 0xCC, LEGACY_ALARM_SIZE);
+  b[0] = uint8_t(id);
+  b[1] = uint8_t(id >> 8);
+  b[2] = hour;
+  b[3] = minute;
+  le32(b + 4, uint32_t(duration));
+  b[8] = enabled;
+  le32(b + 12, uint32_t(lastDay));
+  le32(b + 16, uint32_t(lastMin));
+  b[20] = pending;
+  b[21] = temp;
+  b[22] = uint8_t(tempIndex);
+}
+
+static void legacySensor(uint8_t *b, uint16_t id, uint32_t type, float lo, float hi,
+                         bool enabled, bool pending, bool temp, uint16_t tempIndex)
+{
+  memset(b, 0xCC, LEGACY_SENSOR_SIZE);
+  b[0] = uint8_t(id);
+  b[1] = uint8_t(id >> 8);
+  le32(b + 4, type);
+  memcpy(b + 8, &lo, 4);
+  memcpy(b + 12, &hi, 4);
+  b[16] = enabled;
+  b[17] = pending;
+  b[18] = temp;
+  b[20] = uint8_t(tempIndex);
+  b[21] = uint8_t(tempIndex >> 8);
+}
+
+static void assertAlarmEqual(const AlarmData &a, const AlarmData &b)
+{
+  TEST_ASSERT_EQUAL(a.id, b.id);
+  TEST_ASSERT_EQUAL(a.hour, b.hour);
+  TEST_ASSERT_EQUAL(a.minute, b.minute);
+  TEST_ASSERT_EQUAL(a.duration, b.duration);
+  TEST_ASSERT_EQUAL(a.enabled, b.enabled);
+  TEST_ASSERT_EQUAL(a.lastDayTrig, b.lastDayTrig);
+  TEST_ASSERT_EQUAL(a.lastMinTrig, b.lastMinTrig);
+  TEST_ASSERT_EQUAL(a.pending, b.pending);
+  TEST_ASSERT_EQUAL(a.isTemporary, b.isTemporary);
+  TEST_ASSERT_EQUAL(a.tempIndex, b.tempIndex);
+  TEST_ASSERT_EQUAL(a.days, b.days);
+  TEST_ASSERT_EQUAL(a.channel, b.channel);
+}
+
+static void assertSensorEqual(const SensorSetting &a, const SensorSetting &b)
+{
+  TEST_ASSERT_EQUAL(a.id, b.id);
+  TEST_ASSERT_EQUAL(a.type, b.type);
+  TEST_ASSERT_EQUAL_MEMORY(&a.minValue, &b.minValue, 4);
+  TEST_ASSERT_EQUAL_MEMORY(&a.maxValue, &b.maxValue, 4);
+  TEST_ASSERT_EQUAL(a.enabled, b.enabled);
+  TEST_ASSERT_EQUAL(a.pending, b.pending);
+  TEST_ASSERT_EQUAL(a.isTemporary, b.isTemporary);
+  TEST_ASSERT_EQUAL(a.tempIndex, b.tempIndex);
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_legacy_alarm_round_trip()
+{
+  uint8_t v1[LEGACY_ALARM_SIZE];
+  legacyAlarm(v1, 0x1234, 23, 59, 86400, true, 17, -1, true, false, -3);
+  AlarmData first;
+  TEST_ASSERT_TRUE(decodeAlarm(SCHEMA_LEGACY, v1, sizeof(v1), first));
+  TEST_ASSERT_EQUAL(0x1234, first.id);
+  TEST_ASSERT_EQUAL(23, first.hour);
+  TEST_ASSERT_EQUAL(59, first.minute);
+  TEST_ASSERT_EQUAL(86400, first.duration);
+  TEST_ASSERT_TRUE(first.enabled);
+  TEST_ASSERT_EQUAL(17, first.lastDayTrig);
+  TEST_ASSERT_EQUAL(-1, first.lastMinTrig);
+  TEST_ASSERT_TRUE(first.pending);
+  TEST_ASSERT_FALSE(first.isTemporary);
+  TEST_ASSERT_EQUAL(-3, first.tempIndex);
+  // v1 tidak punya hari & kanal
+  TEST_ASSERT_EQUAL(ALARM_EVERY_DAY, first.days);
+  TEST_ASSERT_EQUAL(0, first.channel);
+
+  uint8_t v3[ALARM_RECORD_SIZE];
+  TEST_ASSERT_EQUAL(ALARM_RECORD_SIZE, encodeAlarm(first, v3));
+  AlarmData second;
+  TEST_ASSERT_TRUE(decodeAlarm(SCHEMA_ALARM, v3, sizeof(v3), second));
+  assertAlarmEqual(first, second);
+}
+
+static void test_legacy_alarm_matches_struct_dump()
+{
+  // Record yang benar-benar hasil memcpy struct lama (padding apa adanya)
+  LegacyAlarm old;
+  memset(&old, 0xEE, sizeof(old));
+  old.id = 7;
+  old.hour = 6;
+  old.minute = 30;
+  old.duration = 45;
+  old.enabled = false;
+  old.lastDayTrig = 3;
+  old.lastMinTrig = 29;
+  old.pending = false;
+  old.isTemporary = true;
+  old.tempIndex = 5;
+  uint8_t built[LEGACY_ALARM_SIZE];
+  legacyAlarm(built, 7, 6, 30, 45, false, 3, 29, false, true, 5);
+
+  AlarmData fromDump, fromBuilt;
+  TEST_ASSERT_TRUE(decodeAlarm(SCHEMA_LEGACY, (const uint8_t *)&old, sizeof(old), fromDump));
+  TEST_ASSERT_TRUE(decodeAlarm(SCHEMA_LEGACY, built, sizeof(built), fromBuilt));
+  assertAlarmEqual(fromDump, fromBuilt);
+}
+
+static void test_legacy_sensor_round_trip()
+{
+  const float lo[] = {-2.5f, 0.0f, 6.5f, 150.25f};
+  const float hi[] = {35.0f, 5.0f, 8.5f, 1000.0f};
+  for (uint32_t t = S_TEMPERATURE; t <= S_PH; t++)
+  {
+    uint8_t v1[LEGACY_SENSOR_SIZE];
+    legacySensor(v1, uint16_t(100 + t), t, lo[t], hi[t], t & 1, t & 2, t == 3, uint16_t(0xBEEF + t));
+    SensorSetting first;
+    TEST_ASSERT_TRUE(decodeSensorSetting(SCHEMA_LEGACY, v1, sizeof(v1), first));
+    TEST_ASSERT_EQUAL(100 + t, first.id);
+    TEST_ASSERT_EQUAL(t, first.type);
+    TEST_ASSERT_EQUAL_FLOAT(lo[t], first.minValue);
+    TEST_ASSERT_EQUAL_FLOAT(hi[t], first.maxValue);
+    TEST_ASSERT_EQUAL(uint16_t(0xBEEF + t), first.tempIndex);
+
+    uint8_t v2[SENSOR_RECORD_SIZE];
+    TEST_ASSERT_EQUAL(SENSOR_RECORD_SIZE, encodeSensorSetting(first, v2));
+    SensorSetting second;
+    TEST_ASSERT_TRUE(decodeSensorSetting(SCHEMA_SENSOR, v2, sizeof(v2), second));
+    assertSensorEqual(first, second);
+  }
+}
+
+static void test_current_alarm_round_trip_all_fields()
+{
+  for (uint8_t ch = 0; ch < 8; ch++)
+  {
+    AlarmData a{};
+    a.id = uint16_t(0xFFF0 + ch);
+    a.hour = uint8_t(ch * 3);
+    a.minute = uint8_t(ch * 7);
+    a.duration = ch * 1000;
+    a.enabled = ch & 1;
+    a.pending = ch & 2;
+    a.isTemporary = ch & 4;
+    a.tempIndex = int8_t(-ch);
+    a.lastDayTrig = ch - 1;
+    a.lastMinTrig = 59 - ch;
+    a.days = uint8_t(1 << (ch % 7)) | 0x40;
+    a.channel = ch;
+    uint8_t buf[ALARM_RECORD_SIZE];
+    encodeAlarm(a, buf);
+    AlarmData b;
+    TEST_ASSERT_TRUE(decodeAlarm(SCHEMA_ALARM, buf, sizeof(buf), b));
+    assertAlarmEqual(a, b);
+  }
+}
+
+static void test_v2_alarm_reads_as_every_day_channel_0()
+{
+  AlarmData a{};
+  a.id = 9;
+  a.hour = 12;
+  a.minute = 15;
+  a.duration = 60;
+  a.enabled = true;
+  a.days = 0x01;
+  a.channel = 5;
+  uint8_t buf[ALARM_RECORD_SIZE];
+  encodeAlarm(a, buf);
+  AlarmData b;
+  TEST_ASSERT_TRUE(decodeAlarm(SCHEMA_ALARM_V2, buf, ALARM_V2_RECORD_SIZE, b));
+  TEST_ASSERT_EQUAL(ALARM_EVERY_DAY, b.days);
+  TEST_ASSERT_EQUAL(0, b.channel);
+  TEST_ASSERT_EQUAL(12, b.hour);
+}
+
+static void test_invalid_records_are_rejected()
+{
+  uint8_t v1[LEGACY_ALARM_SIZE];
+  AlarmData a;
+  legacyAlarm(v1, 1, 24, 0, 10, true, 0, 0, false, false, 0);
+  TEST_ASSERT_FALSE(decodeAlarm(SCHEMA_LEGACY, v1, sizeof(v1), a));
+  legacyAlarm(v1, 1, 0, 60, 10, true, 0, 0, false, false, 0);
+  TEST_ASSERT_FALSE(decodeAlarm(SCHEMA_LEGACY, v1, sizeof(v1), a));
+  legacyAlarm(v1, 1, 0, 0, 86401, true, 0, 0, false, false, 0);
+  TEST_ASSERT_FALSE(decodeAlarm(SCHEMA_LEGACY, v1, sizeof(v1), a));
+  legacyAlarm(v1, 1, 0, 0, -1, true, 0, 0, false, false, 0);
+  TEST_ASSERT_FALSE(decodeAlarm(SCHEMA_LEGACY, v1, sizeof(v1), a));
+  // Panjang/versi tidak cocok
+  legacyAlarm(v1, 1, 0, 0, 10, true, 0, 0, false, false, 0);
+  TEST_ASSERT_FALSE(decodeAlarm(SCHEMA_LEGACY, v1, sizeof(v1) - 1, a));
+  TEST_ASSERT_FALSE(decodeAlarm(SCHEMA_ALARM, v1, sizeof(v1), a));
+  TEST_ASSERT_FALSE(decodeAlarm(9, v1, ALARM_RECORD_SIZE, a));
+
+  AlarmData ok{};
+  ok.hour = 1;
+  ok.days = ALARM_EVERY_DAY;
+  uint8_t v3[ALARM_RECORD_SIZE];
+  encodeAlarm(ok, v3);
+  v3[12] = 0; // tanpa hari
+  TEST_ASSERT_FALSE(decodeAlarm(SCHEMA_ALARM, v3, sizeof(v3), a));
+  v3[12] = 0x80; // bit di luar minggu
+  TEST_ASSERT_FALSE(decodeAlarm(SCHEMA_ALARM, v3, sizeof(v3), a));
+
+  uint8_t s1[LEGACY_SENSOR_SIZE];
+  SensorSetting s;
+  legacySensor(s1, 1, S_PH + 1, 0, 1, true, false, false, 0);
+  TEST_ASSERT_FALSE(decodeSensorSetting(SCHEMA_LEGACY, s1, sizeof(s1), s));
+  legacySensor(s1, 1, S_TDS, NAN, 1, true, false, false, 0);
+  TEST_ASSERT_FALSE(decodeSensorSetting(SCHEMA_LEGACY, s1, sizeof(s1), s));
+  legacySensor(s1, 1, S_TDS, 0, INFINITY, true, false, false, 0);
+  TEST_ASSERT_FALSE(decodeSensorSetting(SCHEMA_LEGACY, s1, sizeof(s1), s));
+  TEST_ASSERT_FALSE(decodeSensorSetting(SCHEMA_SENSOR, s1, sizeof(s1), s));
+}
+
+static void test_tds_config_round_trip()
+{
+  TDSConfig c;
+  c.slope = 0.92f;
+  c.intercept = -4.5f;
+  uint8_t buf[CALIB_RECORD_SIZE];
+  TEST_ASSERT_EQUAL(CALIB_RECORD_SIZE, encodeTDSConfig(c, buf));
+  TDSConfig v1, v2;
+  // v1 = memcpy struct lama, layout-nya sama dengan v2
+  TEST_ASSERT_TRUE(decodeTDSConfig(SCHEMA_LEGACY, (const uint8_t *)&c, sizeof(c), v1));
+  TEST_ASSERT_TRUE(decodeTDSConfig(SCHEMA_CALIB, buf, sizeof(buf), v2));
+  TEST_ASSERT_EQUAL_FLOAT(c.slope, v2.slope);
+  TEST_ASSERT_EQUAL_FLOAT(c.intercept, v2.intercept);
+  TEST_ASSERT_EQUAL_FLOAT(v1.slope, v2.slope);
+
+  c.slope = 0;
+  encodeTDSConfig(c, buf);
+  TEST_ASSERT_FALSE(decodeTDSConfig(SCHEMA_CALIB, buf, sizeof(buf), v2));
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_legacy_alarm_round_trip);
+  RUN_TEST(test_legacy_alarm_matches_struct_dump);
+  RUN_TEST(test_legacy_sensor_round_trip);
+  RUN_TEST(test_current_alarm_round_trip_all_fields);
+  RUN_TEST(test_v2_alarm_reads_as_every_day_channel_0);
+  RUN_TEST(test_invalid_records_are_rejected);
+  RUN_TEST(test_tds_config_round_trip);
+  return UNITY_END();
+}
@@ -0,0 +1,3 @@
+#include "Schema.cpp"
+#include "Storage.cpp"
+#include "RecordLog.cpp"
@@ -0,0 +1,104 @@
+// Sensor::addSetting/editSetting: hasil return dan Persistence::markDirty()
+// hanya saat isi setting berubah. Kalibrasi (CalibStore, FileStorage)
+// dipalsukan; Schema/Storage/RecordLog di lib_storage.cpp.
+#include <unity.h>
+#include "ReadSensor.cpp"
+#include "Persistence.h"
+
+char deviceId[] = "test";
+static uint32_t dirtyCount = 0;
+void Persistence::markDirty(PersistCollection) { dirtyCount++; }
+const CalibTables &CalibStore::tables()
+{
+  static CalibTables t = {};
+  return t;
+}
+float CalibStore::adcVolts(int raw) { return raw * 3.3f / 4095; }
+TDSConfig Sensor::tdsConfig;
+void Sensor::loadTDSConfig() {}
+
+static SensorSetting setting(SensorType type, float lo, float hi, bool en = true)
+{
+  SensorSetting s = {};
+  s.type = type;
+  s.minValue = lo;
+  s.maxValue = hi;
+  s.enabled = en;
+  return s;
+}
+
+void setUp()
+{
+  fake::quietSerial = true;
+  Sensor::settingCount = 0;
+  TEST_ASSERT_TRUE(Sensor::addSetting(setting(S_TDS, 100, 500)));
+  TEST_ASSERT_TRUE(Sensor::addSetting(setting(S_PH, 6, 8)));
+  dirtyCount = 0;
+}
+
+void tearDown() {}
+
+static void test_edit_unknown_setting_returns_false()
+{
+  SensorSetting s = setting(S_TDS, 1, 2);
+  s.id = 999;
+  s.tempIndex = 7;
+  TEST_ASSERT_FALSE(Sensor::editSetting(s));
+  TEST_ASSERT_EQUAL(0, dirtyCount);
+}
+
+static void test_edit_marks_dirty_only_on_change()
+{
+  uint8_t n;
+  SensorSetting *all = Sensor::getAllSettings(n);
+  SensorSetting s = all[1];
+  s.minValue = 6.5f;
+  TEST_ASSERT_TRUE(Sensor::editSetting(s));
+  TEST_ASSERT_EQUAL(1, dirtyCount);
+  TEST_ASSERT_EQUAL_FLOAT(6.5f, all[1].minValue);
+  TEST_ASSERT_TRUE(all[1].pending);
+  TEST_ASSERT_EQUAL_FLOAT(100, all[0].minValue);
+
+  // Isi sama (sudah pending): tidak ada yang perlu ditulis
+  TEST_ASSERT_TRUE(Sensor::editSetting(s));
+  TEST_ASSERT_EQUAL(1, dirtyCount);
+
+  s.enabled = false;
+  TEST_ASSERT_TRUE(Sensor::editSetting(s));
+  TEST_ASSERT_EQUAL(2, dirtyCount);
+  TEST_ASSERT_FALSE(all[1].enabled);
+}
+
+static void test_edit_temporary_setting_by_temp_index()
+{
+  uint8_t n;
+  SensorSetting *all = Sensor::getAllSettings(n);
+  all[0].isTemporary = true;
+  all[0].tempIndex = 3;
+  SensorSetting s = setting(S_TDS, 150, 450);
+  s.id = 0;
+  s.tempIndex = 3;
+  TEST_ASSERT_TRUE(Sensor::editSetting(s));
+  TEST_ASSERT_EQUAL_FLOAT(150, all[0].minValue);
+  TEST_ASSERT_TRUE(all[0].isTemporary);
+  TEST_ASSERT_EQUAL(1, dirtyCount);
+}
+
+static void test_add_rejects_duplicate_type()
+{
+  TEST_ASSERT_FALSE(Sensor::addSetting(setting(S_PH, 5, 9)));
+  TEST_ASSERT_EQUAL(0, dirtyCount);
+  uint8_t n;
+  Sensor::getAllSettings(n);
+  TEST_ASSERT_EQUAL(2, n);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_edit_unknown_setting_returns_false);
+  RUN_TEST(test_edit_marks_dirty_only_on_change);
+  RUN_TEST(test_edit_temporary_setting_by_temp_index);
+  RUN_TEST(test_add_rejects_duplicate_type);
+  return UNITY_END();
+}
@@ -0,0 +1,149 @@
+// Storage di host: job dijalankan sinkron ke fs::FS RAM. Cek isi file,
+// pelaporan gagal, dan benchmark latensi simpan satu setting sensor
+// (tulis ulang seluruh file seperti saveAllSettings() lama vs satu frame
+// RecordLog).
+#include <unity.h>
+#include <chrono>
+#include "Storage.cpp"
+#include "RecordLog.cpp"
+
+static const char *const FILE_A = "/a.bin";
+static fs::FS *ram = nullptr;
+
+static std::string text(const char *path)
+{
+  const std::vector<uint8_t> &v = ram->raw(path);
+  return std::string(v.begin(), v.end());
+}
+
+static bool put(bool (*fn)(const char *, const uint8_t *, size_t), const char *path, const char *s)
+{
+  return fn(path, (const uint8_t *)s, strlen(s));
+}
+
+void setUp()
+{
+  delete ram;
+  ram = new fs::FS();
+  fake::quietSerial = true;
+  Storage::begin(*ram);
+}
+
+void tearDown() {}
+
+static void test_append_write_and_write_at()
+{
+  TEST_ASSERT_TRUE(put(Storage::append, FILE_A, "abc"));
+  TEST_ASSERT_TRUE(put(Storage::append, FILE_A, "def"));
+  TEST_ASSERT_EQUAL_STRING("abcdef", text(FILE_A).c_str());
+
+  TEST_ASSERT_TRUE(Storage::writeAt(FILE_A, 2, (const uint8_t *)"XY", 2));
+  TEST_ASSERT_EQUAL_STRING("abXYef", text(FILE_A).c_str());
+  TEST_ASSERT_TRUE(Storage::writeAt(FILE_A, 6, (const uint8_t *)"gh", 2));
+  TEST_ASSERT_EQUAL_STRING("abXYefgh", text(FILE_A).c_str());
+
+  // writeAt ke file yang belum ada: dibuat
+  TEST_ASSERT_TRUE(Storage::writeAt("/new.bin", 0, (const uint8_t *)"zz", 2));
+  TEST_ASSERT_EQUAL_STRING("zz", text("/new.bin").c_str());
+
+  TEST_ASSERT_TRUE(put(Storage::write, FILE_A, "w"));
+  TEST_ASSERT_EQUAL_STRING("w", text(FILE_A).c_str());
+  Storage::sync();
+  TEST_ASSERT_EQUAL(Storage::stats().submitted, Storage::stats().completed);
+}
+
+static void test_failures_are_reported()
+{
+  uint32_t failed = Storage::stats().failed;
+  ram->failOpen = true;
+  TEST_ASSERT_FALSE(put(Storage::append, FILE_A, "abc"));
+  TEST_ASSERT_FALSE(Storage::writeAt(FILE_A, 0, (const uint8_t *)"x", 1));
+  ram->failOpen = false;
+  TEST_ASSERT_EQUAL(failed + 2, Storage::stats().failed);
+
+  // Flash penuh / listrik padam di tengah tulis
+  ram->writeBudget = 2;
+  TEST_ASSERT_FALSE(put(Storage::append, FILE_A, "abcd"));
+  ram->writeBudget = -1;
+  TEST_ASSERT_EQUAL(failed + 3, Storage::stats().failed);
+  TEST_ASSERT_TRUE(put(Storage::append, FILE_A, "ok"));
+}
+
+// Append RecordLog yang gagal di tengah frame tidak boleh membuat append
+// sesudahnya hilang saat boot berikutnya
+static void test_failed_record_append_does_not_orphan_later_records()
+{
+  uint8_t rec[6] = {1, 2, 3, 4, 5, 6};
+  RecordLog log("/r.log", 8, 6, 2, 6);
+  log.begin();
+  TEST_ASSERT_TRUE(log.put(1, rec, 6));
+  ram->writeBudget = 4;
+  rec[0] = 9;
+  TEST_ASSERT_FALSE(log.put(2, rec, 6));
+  ram->writeBudget = -1;
+  TEST_ASSERT_TRUE(log.put(3, rec, 6));
+
+  RecordLog again("/r.log", 8, 6, 2, 6);
+  again.begin();
+  TEST_ASSERT_EQUAL(0, again.stats().tornRecords);
+  TEST_ASSERT_EQUAL(2, again.count());
+  uint8_t len;
+  TEST_ASSERT_NOT_NULL(again.find(1, len));
+  TEST_ASSERT_NULL(again.find(2, len));
+  TEST_ASSERT_NOT_NULL(again.find(3, len));
+}
+
+// Satu setting berubah (mis. batas pH dari menu). Lama: seluruh array
+// sensor ditulis ulang; sekarang: satu frame PUT di RecordLog.
+static void test_benchmark_save_latency()
+{
+  const int SENSORS = 4, SAVES = 20000;
+  uint8_t all[SENSORS * 24];
+  memset(all, 0x5A, sizeof(all));
+
+  using clk = std::chrono::steady_clock;
+  uint64_t bytes0 = ram->bytesWritten;
+  auto t0 = clk::now();
+  for (int i = 0; i < SAVES; i++)
+  {
+    all[i % sizeof(all)]++;
+    Storage::write("/sensor_settings.bin", all, sizeof(all));
+  }
+  auto t1 = clk::now();
+  uint64_t fullBytes = ram->bytesWritten - bytes0;
+
+  RecordLog log("/sensor_settings.log", SENSORS, 14, 2, 14);
+  log.begin();
+  uint8_t rec[14] = {};
+  bytes0 = ram->bytesWritten;
+  auto t2 = clk::now();
+  for (int i = 0; i < SAVES; i++)
+  {
+    rec[3] = uint8_t(i);
+    rec[4] = uint8_t(i >> 8);
+    log.put(uint16_t(i % SENSORS), rec, sizeof(rec));
+  }
+  auto t3 = clk::now();
+  uint64_t logBytes = ram->bytesWritten - bytes0;
+
+  double fullNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / SAVES;
+  double logNs = std::chrono::duration<double, std::nano>(t3 - t2).count() / SAVES;
+  char msg[200];
+  snprintf(msg, sizeof(msg),
+           "save one setting: full rewrite %.0f ns, %.1f B/save; record log %.0f ns, %.1f B/save "
+           "(incl. %u compactions); max write %u us",
+           fullNs, double(fullBytes) / SAVES, logNs, double(logBytes) / SAVES,
+           unsigned(log.stats().compactions), unsigned(Storage::stats().maxWriteUs));
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_LESS_THAN(fullBytes, logBytes);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_append_write_and_write_at);
+  RUN_TEST(test_failures_are_reported);
+  RUN_TEST(test_failed_record_append_does_not_orphan_later_records);
+  RUN_TEST(test_benchmark_save_latency);
+  return UNITY_END();
+}
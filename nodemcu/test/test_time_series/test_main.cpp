@@ -0,0 +1,277 @@
+// TimeSeries: round trip termasuk kanal NAN, wrap timestamp 2^32 dan escape
+// 32 bit, plus benchmark rasio kompresi & biaya encode pada deret sensor
+// kolam sintetis (10 detik/sampel, blok 512 byte seperti TelemetryLog).
+#include <unity.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "TimeSeries.cpp"
+
+static const float SCALE[TS_CHANNELS] = {10.0f, 100.0f, 10.0f, 100.0f};
+
+static TimeSeriesSample sample(uint32_t ts, float a, float b, float c, float d)
+{
+  return TimeSeriesSample{ts, {a, b, c, d}};
+}
+
+static float quantized(float v, float scale)
+{
+  return float(lroundf(v * scale)) / scale;
+}
+
+// Encode semua sampel ke satu blok, decode kembali dan bandingkan
+static size_t roundTrip(const std::vector<TimeSeriesSample> &in, size_t cap = 4096)
+{
+  std::vector<uint8_t> buf(cap);
+  TimeSeriesEncoder enc;
+  enc.begin(buf.data(), buf.size(), SCALE);
+  for (const TimeSeriesSample &s : in)
+    TEST_ASSERT_TRUE(enc.append(s));
+  TEST_ASSERT_EQUAL(in.size(), enc.count());
+
+  TimeSeriesDecoder dec;
+  dec.begin(buf.data(), enc.bytes(), SCALE);
+  for (size_t k = 0; k < in.size(); k++)
+  {
+    TimeSeriesSample out;
+    TEST_ASSERT_TRUE(dec.next(out));
+    TEST_ASSERT_EQUAL_UINT32(in[k].ts, out.ts);
+    for (uint8_t i = 0; i < TS_CHANNELS; i++)
+    {
+      // Non-finite atau di luar jangkauan int32 setelah diskala → NAN
+      float q = in[k].v[i] * SCALE[i];
+      if (!isfinite(q) || fabsf(q) >= 2.0e9f)
+        TEST_ASSERT_TRUE(isnan(out.v[i]));
+      else
+        TEST_ASSERT_EQUAL_FLOAT(quantized(in[k].v[i], SCALE[i]), out.v[i]);
+    }
+  }
+  return enc.bytes();
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_regular_series_round_trip()
+{
+  std::vector<TimeSeriesSample> in;
+  for (uint32_t k = 0; k < 200; k++)
+    in.push_back(sample(1700000000u + k * 10, 350.0f + (k % 7) * 0.1f, 7.21f, 12.3f, 28.06f));
+  size_t bytes = roundTrip(in);
+  // Sampel pertama mentah (20 byte), sisanya jauh di bawah 16 byte
+  TEST_ASSERT_LESS_THAN(20 + 199 * 4, bytes);
+}
+
+static void test_nan_channels()
+{
+  std::vector<TimeSeriesSample> in;
+  uint32_t ts = 1700000000u;
+  // Sensor suhu lepas di tengah, pH belum terbaca sejak awal, lalu pulih
+  in.push_back(sample(ts, 350.0f, NAN, 12.0f, 28.0f));
+  in.push_back(sample(ts += 10, 350.1f, NAN, 12.1f, NAN));
+  in.push_back(sample(ts += 10, 350.2f, 7.2f, 12.1f, NAN));
+  in.push_back(sample(ts += 10, NAN, 7.2f, INFINITY, -INFINITY));
+  in.push_back(sample(ts += 10, 350.3f, 7.25f, 12.2f, 28.1f));
+  // Di luar jangkauan int32 setelah diskala: disimpan sebagai NAN
+  in.push_back(sample(ts += 10, 3.0e9f, -2.5e7f, 12.2f, 28.1f));
+  in.push_back(sample(ts += 10, 0.0f, -0.01f, 0.0f, -5.0f));
+  in.push_back(sample(ts += 10, NAN, NAN, NAN, NAN));
+  in.push_back(sample(ts += 10, NAN, NAN, NAN, NAN));
+  in.push_back(sample(ts += 10, 1.0f, 14.0f, 3000.0f, 99.99f));
+  roundTrip(in);
+}
+
+static void test_first_sample_nan()
+{
+  std::vector<TimeSeriesSample> in;
+  in.push_back(sample(5, NAN, NAN, NAN, NAN));
+  in.push_back(sample(15, 350.0f, 7.0f, 12.0f, 28.0f));
+  roundTrip(in);
+}
+
+static void test_timestamp_wrap()
+{
+  std::vector<TimeSeriesSample> in;
+  uint32_t ts = 0xFFFFFFFFu - 25;
+  for (int k = 0; k < 8; k++, ts += 10)
+    in.push_back(sample(ts, 1.0f, 2.0f, 3.0f, 4.0f));
+  TEST_ASSERT_LESS_THAN(100u, in.back().ts);
+  roundTrip(in);
+}
+
+static void test_bucket_boundaries_and_32_bit_escapes()
+{
+  // dod tepat di batas tiap lebar (zigzag 127/128, 511/512, 4095/4096)
+  // lalu lompatan yang butuh escape 32 bit: jam disetel NTP maju sehari,
+  // mundur sejam, dan lompatan dari ts kecil ke hampir 2^32
+  const int32_t dods[] = {0, -64, 63, 64, -256, 255, 256, -2048, 2047, 2048,
+                          86400, -3600, -86400, 1, -1};
+  std::vector<TimeSeriesSample> in;
+  uint32_t ts = 1000;
+  int32_t delta = 10;
+  in.push_back(sample(ts, 0, 0, 0, 0));
+  for (int32_t dod : dods)
+  {
+    delta += dod;
+    ts += uint32_t(delta);
+    in.push_back(sample(ts, 0, 0, 0, 0));
+  }
+  in.push_back(sample(10, 0, 0, 0, 0));
+  in.push_back(sample(0xFFFFFFF0u, 0, 0, 0, 0));
+  in.push_back(sample(0, 0, 0, 0, 0));
+
+  // Delta nilai di batas 6/13 bit dan escape 32 bit (skala 10 → q = v*10)
+  const float deltas[] = {3.1f, -3.2f, 3.2f, 409.5f, -409.6f, 409.6f,
+                          -100000.0f, 100000000.0f, -199999999.9f};
+  float v = 0;
+  for (float d : deltas)
+  {
+    v += d;
+    in.push_back(sample(ts += 10, v, 0, 0, 0));
+  }
+  // Dari sentinel NAN ke nilai ekstrem dan sebaliknya (selisih modulo 2^32)
+  in.push_back(sample(ts += 10, NAN, -2.0e7f, 0, 0));
+  in.push_back(sample(ts += 10, -1.9e8f, 2.0e7f, 0, 0));
+  in.push_back(sample(ts += 10, NAN, NAN, 0, 0));
+  roundTrip(in);
+}
+
+static void test_block_full_never_overflows()
+{
+  uint8_t buf[64 + 8];
+  memset(buf, 0xAB, sizeof(buf));
+  TimeSeriesEncoder enc;
+  enc.begin(buf, 64, SCALE);
+  std::vector<TimeSeriesSample> in;
+  uint32_t ts = 0;
+  for (int k = 0; k < 1000; k++)
+  {
+    // Sampel terburuk: semua escape 32 bit
+    TimeSeriesSample s = sample(ts += (k & 1) ? 100000 : 1, (k & 1) ? 1e8f : -1e8f, (k & 1) ? 2e7f : -2e7f, NAN, 0);
+    if (!enc.append(s))
+      break;
+    in.push_back(s);
+  }
+  TEST_ASSERT_GREATER_THAN(0, in.size());
+  TEST_ASSERT_LESS_THAN(1000, in.size());
+  TEST_ASSERT_LESS_OR_EQUAL(64, enc.bytes());
+  for (int i = 64; i < 72; i++)
+    TEST_ASSERT_EQUAL_HEX8(0xAB, buf[i]);
+
+  TimeSeriesDecoder dec;
+  dec.begin(buf, enc.bytes(), SCALE);
+  TimeSeriesSample out;
+  for (size_t k = 0; k < in.size(); k++)
+  {
+    TEST_ASSERT_TRUE(dec.next(out));
+    TEST_ASSERT_EQUAL_UINT32(in[k].ts, out.ts);
+  }
+}
+
+static void test_truncated_block_stops_cleanly()
+{
+  std::vector<TimeSeriesSample> in;
+  for (uint32_t k = 0; k < 20; k++)
+    in.push_back(sample(k * 10, float(k), 7.0f, 1e6f * (k & 1), 28.0f));
+  uint8_t buf[512];
+  TimeSeriesEncoder enc;
+  enc.begin(buf, sizeof(buf), SCALE);
+  for (const TimeSeriesSample &s : in)
+    enc.append(s);
+  // Blok terpotong: decoder berhenti dengan false, tidak membaca lewat batas
+  TimeSeriesDecoder dec;
+  dec.begin(buf, enc.bytes() / 2, SCALE);
+  TimeSeriesSample out;
+  size_t got = 0;
+  while (got < in.size() && dec.next(out))
+    got++;
+  TEST_ASSERT_LESS_THAN(in.size(), got);
+}
+
+// Kolam ikan sehari penuh: TDS melayang pelan, pH & suhu ikut siklus
+// harian, turbidity naik saat pemberian pakan; noise ADC di tiap kanal
+// dan jarak sampel kadang meleset satu detik (loop sibuk)
+static std::vector<TimeSeriesSample> pondDay(uint32_t seed)
+{
+  std::mt19937 rng(seed);
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  std::uniform_int_distribution<int> jitter(0, 19);
+  std::vector<TimeSeriesSample> out;
+  uint32_t ts = 1718000000u;
+  float tds = 350.0f;
+  for (int k = 0; k < 8640; k++)
+  {
+    float hour = float(k) * 10.0f / 3600.0f;
+    float day = sinf((hour - 9.0f) / 24.0f * 2.0f * float(M_PI));
+    tds += noise(rng) * 0.05f;
+    float ph = 7.2f + 0.3f * day + noise(rng) * 0.01f;
+    bool feeding = fmodf(hour, 6.0f) < 0.25f;
+    float turb = 12.0f + (feeding ? 8.0f : 0.0f) + noise(rng) * 0.2f;
+    // DS18B20: resolusi 0.0625 °C
+    float temp = roundf((28.0f + 1.5f * day) * 16.0f) / 16.0f;
+    out.push_back(sample(ts, tds, ph, turb, temp));
+    int j = jitter(rng);
+    ts += 10 + (j == 0 ? 1 : j == 1 ? -1 : 0);
+  }
+  return out;
+}
+
+static void test_benchmark_compression()
+{
+  std::vector<TimeSeriesSample> day = pondDay(42);
+  uint8_t block[512];
+  size_t blocks = 0, compressed = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int rep = 0; rep < 20; rep++)
+  {
+    TimeSeriesEncoder enc;
+    enc.begin(block, sizeof(block), SCALE);
+    for (const TimeSeriesSample &s : day)
+    {
+      if (!enc.append(s))
+      {
+        if (rep == 0)
+        {
+          blocks++;
+          compressed += sizeof(block); // blok di flash selalu penuh 512 byte
+        }
+        enc.begin(block, sizeof(block), SCALE);
+        enc.append(s);
+      }
+    }
+    if (rep == 0)
+    {
+      blocks++;
+      compressed += enc.bytes();
+    }
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / (20.0 * day.size());
+
+  size_t raw = day.size() * 16; // snapshot 4 float, tanpa timestamp
+  char msg[200];
+  snprintf(msg, sizeof(msg),
+           "pond day (%u samples): %u B in %u blocks vs %u B raw 16 B snapshots -> %.1fx, %.2f B/sample, encode %.0f ns/sample",
+           unsigned(day.size()), unsigned(compressed), unsigned(blocks), unsigned(raw),
+           double(raw) / compressed, double(compressed) / day.size(), ns);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_GREATER_THAN(raw / 3, raw - compressed);
+
+  // Sampel yang sama lolos round trip lewat blok-blok 512 byte
+  std::vector<TimeSeriesSample> head(day.begin(), day.begin() + 200);
+  roundTrip(head, 512 * 4);
+}
+
+int main()
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_regular_series_round_trip);
+  RUN_TEST(test_nan_channels);
+  RUN_TEST(test_first_sample_nan);
+  RUN_TEST(test_timestamp_wrap);
+  RUN_TEST(test_bucket_boundaries_and_32_bit_escapes);
+  RUN_TEST(test_block_full_never_overflows);
+  RUN_TEST(test_truncated_block_stops_cleanly);
+  RUN_TEST(test_benchmark_compression);
+  return UNITY_END();
+}
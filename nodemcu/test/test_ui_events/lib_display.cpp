@@ -0,0 +1,2 @@
+#include "I2CBus.cpp"
+#include "Display.cpp"
@@ -0,0 +1,2 @@
+#include "Storage.cpp"
+#include "RecordLog.cpp"
@@ -0,0 +1,331 @@
+// DisplayAlarm berbasis event: pass loop() tanpa event tidak merender dan
+// tidak mengirim apa-apa ke LCD, tiap event hanya membuat basi halaman yang
+// mendaftarkannya, frame cap tetap berlaku. Ditambah Profiler (ProfileScope,
+// laporan [PROF] + reset) dan biaya CPU pass idle vs render tiap pass.
+// Alarm, Storage/Actuator dan Display/I2CBus dikompilasi di lib_*.cpp;
+// tombol, sensor, Clock, Persistence dan publish MQTT dipalsukan di sini.
+#include <unity.h>
+#include <chrono>
+#include <deque>
+#include "DisplayAlarm.cpp"
+#include "Profiler.cpp"
+#include "Actuator.h"
+
+// ─── Palsu ───────────────────────────────────────────────────
+static uint32_t fakeNow = 0;
+uint32_t Clock::now() { return fakeNow; }
+const DateTime &Clock::local()
+{
+  static DateTime cached;
+  cached = DateTime(fakeNow);
+  return cached;
+}
+void Persistence::markDirty(PersistCollection) {}
+
+// Tombol: event diantrikan langsung oleh test
+static std::deque<ButtonEvent> presses;
+ButtonHandler buttonHandler;
+ButtonHandler::ButtonHandler() {}
+bool ButtonHandler::next(ButtonEvent &e)
+{
+  if (presses.empty())
+    return false;
+  e = presses.front();
+  presses.pop_front();
+  return true;
+}
+uint32_t ButtonHandler::idleMs() const { return presses.empty() ? UINT32_MAX : 0; }
+ButtonState ButtonHandler::toState(const ButtonEvent &e)
+{
+  ButtonState s = {e.button == BUTTON_UP, e.button == BUTTON_DOWN, e.button == BUTTON_LEFT,
+                   e.button == BUTTON_RIGHT, e.button == BUTTON_SELECT, true};
+  return s;
+}
+
+static SensorSetting sensorSettings[4] = {
+    {1, S_TEMPERATURE, 20, 30, true, false, false, 0},
+    {2, S_TURBIDITY, 0, 50, true, false, false, 0},
+    {3, S_TDS, 100, 500, true, false, false, 0},
+    {4, S_PH, 6, 8, true, false, false, 0},
+};
+static uint32_t limitChecks = 0;
+SensorSetting *Sensor::getAllSettings(uint8_t &outCount)
+{
+  outCount = 4;
+  return sensorSettings;
+}
+void Sensor::checkSensorLimits(const SensorSnapshot &) { limitChecks++; }
+
+void publishAlarmFromESP(const char *, uint16_t, uint8_t, uint8_t, int, bool) {}
+void publishSensorFromESP(const SensorSetting &) {}
+void deleteAlarmFromESPByIndex(uint16_t) {}
+
+// ─── Helper ──────────────────────────────────────────────────
+static fs::FS ram;
+static DisplayAlarm *ui = nullptr;
+static LiquidCrystal_I2C *dev = nullptr;
+
+static void press(ButtonId b)
+{
+  presses.push_back({b, BTN_EV_PRESS, 0});
+}
+
+// Satu pass loop() utama setelah jatah frame berikutnya tersedia
+static void pass(uint32_t ms = DISPLAY_FRAME_MS)
+{
+  fake::advanceMs(ms);
+  ui->loop();
+  lcd.loop();
+}
+
+// true jika pass barusan merender (frame dimulai pada millis() sekarang),
+// termasuk render yang hasilnya sama dengan isi LCD
+static bool rendered()
+{
+  return lcd.idleMs() == DISPLAY_FRAME_MS;
+}
+
+static bool rowHas(uint8_t r, const char *text)
+{
+  return dev->row(r).find(text) != std::string::npos;
+}
+
+static void clearAlarms()
+{
+  uint16_t n;
+  AlarmData *a = Alarm::getAll(n);
+  while (n)
+  {
+    Alarm::remove(a[0].id);
+    a = Alarm::getAll(n);
+  }
+}
+
+void setUp()
+{
+  fake::quietSerial = true;
+  static uint32_t base = 100000;
+  fake::setMillis(base += 10000);
+  fakeNow = 1780000000;
+  presses.clear();
+  clearAlarms();
+  lcd.begin();
+  dev = LiquidCrystal_I2C::last;
+  delete ui;
+  ui = new DisplayAlarm();
+  // Pass pertama selalu merender (semua event tertunda saat start)
+  ui->loop();
+  dev->resetCounters();
+}
+
+void tearDown() {}
+
+// ─── Event ───────────────────────────────────────────────────
+static void test_idle_passes_send_nothing()
+{
+  uint32_t frames = lcd.stats().frames;
+  uint32_t checks = limitChecks;
+  uint32_t renders = 0;
+  for (int i = 0; i < 2000; i++)
+  {
+    pass(1);
+    renders += rendered();
+  }
+  TEST_ASSERT_EQUAL(0, renders);
+  TEST_ASSERT_EQUAL(0, dev->busBytes);
+  TEST_ASSERT_EQUAL(frames, lcd.stats().frames);
+  TEST_ASSERT_EQUAL(checks, limitChecks);
+  // Tanpa tombol dan tanpa event tertunda: loop boleh tidur
+  TEST_ASSERT_EQUAL(UINT32_MAX, ui->idleMs());
+}
+
+static void test_second_tick_only_hits_alarm_page()
+{
+  // Halaman sensor (default) tidak menampilkan jam
+  fakeNow++;
+  pass();
+  TEST_ASSERT_FALSE(rendered());
+
+  press(BUTTON_RIGHT);
+  pass();
+  TEST_ASSERT_TRUE(rendered());
+  TEST_ASSERT_TRUE(rowHas(0, "Time: "));
+  dev->resetCounters();
+
+  // Satu detik = satu sel berubah di baris jam
+  fakeNow++;
+  pass();
+  TEST_ASSERT_EQUAL(1, dev->chars);
+  DateTime t(fakeNow);
+  char want[21];
+  snprintf(want, sizeof(want), "Time: %02d:%02d:%02d", t.hour(), t.minute(), t.second());
+  TEST_ASSERT_TRUE(rowHas(0, want));
+
+  // Snapshot sensor tidak membuat halaman alarm basi, tapi batas tetap dicek
+  uint32_t checks = limitChecks;
+  dev->resetCounters();
+  ui->onSensorSnapshot({25, 10, 350, 7});
+  pass();
+  TEST_ASSERT_FALSE(rendered());
+  TEST_ASSERT_EQUAL(checks + 1, limitChecks);
+}
+
+static void test_sensor_snapshot_redraws_sensor_page()
+{
+  ui->onSensorSnapshot({25.5f, 10, 350, 7.25f});
+  pass();
+  TEST_ASSERT_TRUE(rowHas(0, "25.5C"));
+  TEST_ASSERT_TRUE(rowHas(2, "350.0ppm"));
+  TEST_ASSERT_TRUE(rowHas(3, "7.2"));
+  dev->resetCounters();
+
+  // Nilai sama: dirender ulang tapi tidak ada sel yang berubah
+  ui->onSensorSnapshot({25.5f, 10, 350, 7.25f});
+  pass();
+  TEST_ASSERT_TRUE(rendered());
+  TEST_ASSERT_EQUAL(0, dev->busBytes);
+}
+
+static void test_alarm_change_redraws_alarm_list()
+{
+  // Di halaman sensor perubahan tabel hanya dicatat
+  Alarm::add(1, 7, 5, 30, true);
+  pass();
+  TEST_ASSERT_FALSE(rendered());
+
+  press(BUTTON_LEFT);
+  pass();
+  TEST_ASSERT_TRUE(rowHas(1, ">Alarm 1: 07:05 ON"));
+
+  Alarm::enable(1, false);
+  pass();
+  TEST_ASSERT_TRUE(rowHas(1, ">Alarm 1: 07:05 OFF"));
+}
+
+static void test_events_wait_for_frame_cap()
+{
+  ui->onSensorSnapshot({1, 2, 3, 4});
+  pass();
+  TEST_ASSERT_TRUE(rowHas(2, "3.0ppm"));
+
+  // Snapshot baru tepat setelah frame: ditahan sampai jatah frame berikutnya
+  dev->resetCounters();
+  ui->onSensorSnapshot({1, 2, 42, 4});
+  pass(1);
+  TEST_ASSERT_FALSE(rendered());
+  TEST_ASSERT_EQUAL(0, dev->busBytes);
+  TEST_ASSERT_EQUAL(DISPLAY_FRAME_MS - 1, ui->idleMs());
+  pass(DISPLAY_FRAME_MS - 2);
+  TEST_ASSERT_EQUAL(0, dev->busBytes);
+  pass(1);
+  TEST_ASSERT_TRUE(rendered());
+  TEST_ASSERT_TRUE(rowHas(2, "42.0ppm"));
+  TEST_ASSERT_EQUAL(UINT32_MAX, ui->idleMs());
+}
+
+static void test_sensor_edit_ignores_clock_and_snapshots()
+{
+  press(BUTTON_SELECT);
+  pass();
+  TEST_ASSERT_TRUE(rowHas(0, "Temperature"));
+  dev->resetCounters();
+
+  uint32_t checks = limitChecks;
+  fakeNow++;
+  ui->onSensorSnapshot({30, 2, 3, 4});
+  pass();
+  TEST_ASSERT_FALSE(rendered());
+  // Batas tidak dicek selama setting sensor diedit
+  TEST_ASSERT_EQUAL(checks, limitChecks);
+
+  press(BUTTON_DOWN);
+  pass();
+  TEST_ASSERT_GREATER_THAN(0, dev->busBytes);
+}
+
+// ─── Profiler ────────────────────────────────────────────────
+static void test_profiler_scope_report_and_reset()
+{
+  fake::setMillis(0);
+  for (uint32_t us : {100u, 300u, 200u})
+  {
+    ProfileScope p(PROF_UI);
+    fake::clockUs += us;
+  }
+  {
+    ProfileScope p(PROF_MQTT);
+    fake::clockUs += 50;
+  }
+  TEST_ASSERT_EQUAL(600, Profiler::slot(PROF_UI).totalUs);
+  TEST_ASSERT_EQUAL(300, Profiler::slot(PROF_UI).maxUs);
+  TEST_ASSERT_EQUAL(0, Profiler::slot(PROF_SENSOR).totalUs);
+
+  std::string out;
+  fake::serialCapture = &out;
+  Profiler::report(3);
+  Profiler::report(0); // tanpa pass: tidak mencetak
+  fake::serialCapture = nullptr;
+  TEST_ASSERT_EQUAL_STRING("[PROF] ui=200/300us sensor=0/0us alarm=0/0us mqtt=16/50us persist=0/0us\r\n",
+                           out.c_str());
+  TEST_ASSERT_EQUAL(0, Profiler::slot(PROF_UI).totalUs);
+  TEST_ASSERT_EQUAL(0, Profiler::slot(PROF_MQTT).maxUs);
+}
+
+// Biaya CPU bagian UI per pass loop(): idle (event-driven) dibandingkan
+// render penuh tiap pass seperti sebelumnya. Hanya render; pembacaan sensor
+// per pass versi lama tidak ikut dihitung.
+template <typename F>
+static double nsPerPass(F body, uint32_t passes)
+{
+  auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < passes; i++)
+    body(i);
+  auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / passes;
+}
+
+static void test_benchmark_idle_vs_every_pass()
+{
+  const uint32_t PASSES = 200000;
+  press(BUTTON_LEFT); // halaman alarm: jam + daftar
+  Alarm::add(1, 7, 5, 30, true);
+  Alarm::add(2, 18, 0, 60, true);
+  pass();
+  dev->resetCounters();
+
+  uint32_t frames = lcd.stats().frames;
+  double idle = nsPerPass([](uint32_t) { pass(1); }, PASSES);
+  TEST_ASSERT_EQUAL(0, dev->busBytes);
+  TEST_ASSERT_EQUAL(frames, lcd.stats().frames);
+
+  double every = nsPerPass([](uint32_t i) {
+    fakeNow += i & 1;
+    ui->onSensorSnapshot({25, 10, float(350 + i % 7), 7});
+    // Setiap pass mendapat jatah frame dan halaman alarm basi tiap detik
+    fakeNow++;
+    pass(DISPLAY_FRAME_MS);
+  }, PASSES / 10);
+
+  char msg[160];
+  snprintf(msg, sizeof(msg), "UI per loop pass: idle %.1f ns, render every pass %.1f ns (%.0fx)",
+           idle, every, every / idle);
+  TEST_MESSAGE(msg);
+  TEST_ASSERT_LESS_THAN(every / 10, idle);
+}
+
+int main()
+{
+  Storage::begin(ram);
+  Actuator::begin();
+  Alarm::loadAll();
+  UNITY_BEGIN();
+  RUN_TEST(test_idle_passes_send_nothing);
+  RUN_TEST(test_second_tick_only_hits_alarm_page);
+  RUN_TEST(test_sensor_snapshot_redraws_sensor_page);
+  RUN_TEST(test_alarm_change_redraws_alarm_list);
+  RUN_TEST(test_events_wait_for_frame_cap);
+  RUN_TEST(test_sensor_edit_ignores_clock_and_snapshots);
+  RUN_TEST(test_profiler_scope_report_and_reset);
+  RUN_TEST(test_benchmark_idle_vs_every_pass);
+  return UNITY_END();
+}